@@ -12,6 +12,52 @@ struct VertexOutput
 
 in VertexOutput vertex_output;
 
+// BUFFERS
+
+struct PointLight
+{
+    vec3 worldPosition;
+    float lightRadius;
+    vec3 diffuseComponent;
+    vec3 specularComponent;
+};
+
+layout (std430, binding = 10) readonly buffer PointLightBuffer
+{
+    PointLight s_pointLights[];
+};
+
+struct Cluster
+{
+    uint firstLightIndex;
+    uint lightCount;
+};
+
+layout (std430, binding = 8) readonly buffer ClusterBuffer
+{
+    Cluster s_clusters[];
+};
+
+layout (std430, binding = 9) readonly buffer ClusterLightIndexBuffer
+{
+    uint s_clusterLightIndices[];
+};
+
+struct PointLightShadow
+{
+    // Negative if the light has no shadow map
+    int tier;
+    int cubeMapIndex;
+    float depthBias;
+    float padding;
+};
+
+// Indexed the same as s_pointLights - see PointShadowAtlas.h
+layout (std430, binding = 11) readonly buffer PointLightShadowBuffer
+{
+    PointLightShadow s_pointLightShadows[];
+};
+
 // UNIFORMS
 
 // Material
@@ -26,26 +72,30 @@ struct Material
     float shininess;
 
     bool useNormalMap;
+
+    // Fragments with an alpha below the cutoff are discarded when alpha testing
+    float alphaCutoff;
+    bool useAlphaTest;
 };
 
 uniform Material u_material;
 
-// Point lights
+// Light clusters
 
-struct PointLight
-{
-    vec3 worldPosition;
-    vec3 diffuseComponent;
-    vec3 specularComponent;
-    float lightRadius;
-};
-
-const uint MAX_NUMBER_OF_POINT_LIGHTS = 128;
-uniform PointLight u_pointLights[MAX_NUMBER_OF_POINT_LIGHTS];
-uniform uint u_pointLightNumber;
+uniform uvec3 u_clusterGridSize;
+uniform vec2 u_clusterTileSize;
+uniform float u_clusterDepthSliceScale;
+uniform float u_nearClip;
+uniform mat4 u_viewMatrix;
 
 uniform vec3 u_viewPosition;
 
+// Point light shadows - one cube map array per tier, storing the distance to the light over its radius
+
+uniform samplerCubeArrayShadow u_pointShadowMaps0;
+uniform samplerCubeArrayShadow u_pointShadowMaps1;
+uniform samplerCubeArrayShadow u_pointShadowMaps2;
+
 // OUTPUTS
 
 layout(location = 0) out vec4 o_fragColor;
@@ -63,6 +113,39 @@ vec3 g_specularMaterialValue;
 
 // FUNCTIONS
 
+// The fraction of the light reaching the world position which isn't blocked, filtered over 2x2 texels
+float calculatePointLightShadowFactor(uint lightIndex, vec3 worldPosition)
+{
+    PointLightShadow shadow = s_pointLightShadows[lightIndex];
+
+    if (shadow.tier < 0)
+        return 1.0f;
+
+    PointLight pointLight = s_pointLights[lightIndex];
+    vec3 lightToPosition = worldPosition - pointLight.worldPosition;
+    float depth = length(lightToPosition) / pointLight.lightRadius - shadow.depthBias;
+    vec4 coordinates = vec4(lightToPosition, float(shadow.cubeMapIndex));
+
+    if (shadow.tier == 0)
+        return texture(u_pointShadowMaps0, coordinates, depth);
+    else if (shadow.tier == 1)
+        return texture(u_pointShadowMaps1, coordinates, depth);
+    else
+        return texture(u_pointShadowMaps2, coordinates, depth);
+}
+
+// Finds the cluster the fragment is in - see LightClustering.glsl.comp
+uint getClusterIndex()
+{
+    uvec2 tile = min(uvec2(gl_FragCoord.xy / u_clusterTileSize), u_clusterGridSize.xy - 1);
+
+    float viewDepth = -(u_viewMatrix * vec4(vertex_output.worldPosition, 1.0f)).z;
+    uint slice = uint(max(log(viewDepth / u_nearClip) * u_clusterDepthSliceScale, 0.0f));
+    slice = min(slice, u_clusterGridSize.z - 1);
+
+    return tile.x + u_clusterGridSize.x * (tile.y + u_clusterGridSize.y * slice);
+}
+
 vec3 getNormalisedSurfaceNormal()
 {
     if (u_material.useNormalMap)
@@ -124,7 +207,10 @@ void main()
 
     vec4 diffuseMaterialValueWithAlpha = texture(u_material.diffuseMap, vertex_output.textureCoordinates) * u_material.diffuseColor;
     float alpha = diffuseMaterialValueWithAlpha.a;
-    
+
+    if (u_material.useAlphaTest && alpha < u_material.alphaCutoff)
+        discard;
+
     g_diffuseMaterialValue = diffuseMaterialValueWithAlpha.rgb;
     g_specularMaterialValue = texture(u_material.specularMap, vertex_output.textureCoordinates).rgb * u_material.specularColor;
 
@@ -132,15 +218,19 @@ void main()
 
     color = g_diffuseMaterialValue * LIGHT_AMBIENT;
 
-    // Calculate diffuse and specular contribution for each light
-    
-    for (uint i = 0; i < u_pointLightNumber; i++)
+    // Calculate diffuse and specular contribution for each light which reaches the fragment's cluster
+
+    Cluster cluster = s_clusters[getClusterIndex()];
+
+    for (uint i = 0; i < cluster.lightCount; i++)
     {
-        PointLight pointLight = u_pointLights[i];
+        uint lightIndex = s_clusterLightIndices[cluster.firstLightIndex + i];
+        PointLight pointLight = s_pointLights[lightIndex];
         vec3 lightDirection = normalize(pointLight.worldPosition - vertex_output.worldPosition);
 
         float lightDistance = length(pointLight.worldPosition - vertex_output.worldPosition);
         float attenuationFactor = calculatePointLightAttenuationFactor(lightDistance, pointLight.lightRadius);
+        attenuationFactor *= calculatePointLightShadowFactor(lightIndex, vertex_output.worldPosition);
 
         color += calculateDiffuseContribution(lightDirection, pointLight.diffuseComponent * attenuationFactor);
         color += calculateSpecularContribution(lightDirection, pointLight.specularComponent * attenuationFactor);
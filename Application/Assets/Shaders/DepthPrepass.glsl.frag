@@ -0,0 +1,8 @@
+#version 460 core
+
+// FUNCTIONS
+
+void main()
+{
+    // Only depth is written - color writes are disabled during the pre-pass
+}
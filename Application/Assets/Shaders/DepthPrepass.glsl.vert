@@ -0,0 +1,37 @@
+#version 460 core
+
+// ATTRIBUTES
+
+// Only positions are needed, so depth passes read the geometry arena's separate position stream
+layout (location = 0) in vec3 a_position;
+
+// BUFFERS
+
+struct DrawData
+{
+    mat4 transform;
+};
+
+layout (std430, binding = 0) readonly buffer DrawDataBuffer
+{
+    DrawData s_drawData[];
+};
+
+// UNIFORMS
+
+uniform mat4 u_projectionViewMatrix;
+
+// OUTPUTS
+
+// The main pass tests against this depth with GL_EQUAL, so the position must be calculated exactly as it is there
+invariant gl_Position;
+
+// FUNCTIONS
+
+void main()
+{
+    // Each draw command's base instance is the index of its draw data
+    mat4 transform = s_drawData[gl_BaseInstance].transform;
+
+    gl_Position = u_projectionViewMatrix * transform * vec4(a_position, 1.0f);
+}
@@ -0,0 +1,178 @@
+#version 460 core
+
+// INPUTS FROM VERTEX SHADER
+
+struct VertexOutput
+{
+    vec2 textureCoordinates;
+};
+
+in VertexOutput vertex_output;
+
+// UNIFORMS
+
+// Tone mapped and gamma corrected, so that luma differences match perceived contrast
+uniform sampler2D u_inputTexture;
+uniform vec2 u_inversePixelSize;
+
+// OUTPUTS
+
+layout(location = 0) out vec4 o_fragColor;
+
+// CONSTANTS
+
+// Local contrast needed for a pixel to be on an edge - the larger of an absolute value (for dark areas)
+// and a fraction of the brightest neighbour
+const float EDGE_THRESHOLD_MIN = 0.0312f;
+const float EDGE_THRESHOLD_MAX = 0.125f;
+
+// How much sub-pixel aliasing (single pixel features) is removed
+const float SUBPIXEL_QUALITY = 0.75f;
+
+// Distance (in pixels) of each step when searching along an edge for its ends, taking larger steps further out
+const int SEARCH_STEP_COUNT = 12;
+const float SEARCH_STEPS[SEARCH_STEP_COUNT] = float[](1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.5f, 2.0f, 2.0f, 2.0f, 2.0f, 4.0f, 8.0f);
+
+// FUNCTIONS
+
+float getLuma(vec2 textureCoordinates)
+{
+    return dot(textureLod(u_inputTexture, textureCoordinates, 0.0f).rgb, vec3(0.299f, 0.587f, 0.114f));
+}
+
+// Luma of a neighbouring pixel
+float getLuma(vec2 textureCoordinates, vec2 pixelOffset)
+{
+    return getLuma(textureCoordinates + pixelOffset * u_inversePixelSize);
+}
+
+/*
+Fast Approximate Anti-Aliasing
+
+Follows the structure of FXAA 3.11 (Timothy Lottes): find the direction of the edge through the pixel from
+the lumas of its neighbours, search along the edge for both of its ends, and then shift the pixel's sample
+towards the neighbour across the edge by how close the pixel is to the nearer end.
+*/
+void main()
+{
+    vec2 textureCoordinates = vertex_output.textureCoordinates;
+    vec3 centreColor = textureLod(u_inputTexture, textureCoordinates, 0.0f).rgb;
+
+    float lumaCentre = dot(centreColor, vec3(0.299f, 0.587f, 0.114f));
+    float lumaDown = getLuma(textureCoordinates, vec2(0.0f, -1.0f));
+    float lumaUp = getLuma(textureCoordinates, vec2(0.0f, 1.0f));
+    float lumaLeft = getLuma(textureCoordinates, vec2(-1.0f, 0.0f));
+    float lumaRight = getLuma(textureCoordinates, vec2(1.0f, 0.0f));
+
+    float lumaMin = min(lumaCentre, min(min(lumaDown, lumaUp), min(lumaLeft, lumaRight)));
+    float lumaMax = max(lumaCentre, max(max(lumaDown, lumaUp), max(lumaLeft, lumaRight)));
+    float lumaRange = lumaMax - lumaMin;
+
+    // Pixels without enough contrast aren't on an edge
+
+    if (lumaRange < max(EDGE_THRESHOLD_MIN, lumaMax * EDGE_THRESHOLD_MAX))
+    {
+        o_fragColor = vec4(centreColor, 1.0f);
+        return;
+    }
+
+    float lumaDownLeft = getLuma(textureCoordinates, vec2(-1.0f, -1.0f));
+    float lumaUpRight = getLuma(textureCoordinates, vec2(1.0f, 1.0f));
+    float lumaUpLeft = getLuma(textureCoordinates, vec2(-1.0f, 1.0f));
+    float lumaDownRight = getLuma(textureCoordinates, vec2(1.0f, -1.0f));
+
+    float lumaDownUp = lumaDown + lumaUp;
+    float lumaLeftRight = lumaLeft + lumaRight;
+    float lumaLeftCorners = lumaDownLeft + lumaUpLeft;
+    float lumaDownCorners = lumaDownLeft + lumaDownRight;
+    float lumaRightCorners = lumaDownRight + lumaUpRight;
+    float lumaUpCorners = lumaUpRight + lumaUpLeft;
+
+    // Decide whether the edge is horizontal or vertical from the gradients across each axis
+
+    float horizontalEdge = abs(-2.0f * lumaLeft + lumaLeftCorners) + 2.0f * abs(-2.0f * lumaCentre + lumaDownUp) + abs(-2.0f * lumaRight + lumaRightCorners);
+    float verticalEdge = abs(-2.0f * lumaUp + lumaUpCorners) + 2.0f * abs(-2.0f * lumaCentre + lumaLeftRight) + abs(-2.0f * lumaDown + lumaDownCorners);
+    bool isHorizontal = horizontalEdge >= verticalEdge;
+
+    // Find which side of the pixel the edge is on - the neighbour across it has the steepest gradient
+
+    float luma1 = isHorizontal ? lumaDown : lumaLeft;
+    float luma2 = isHorizontal ? lumaUp : lumaRight;
+    float gradient1 = luma1 - lumaCentre;
+    float gradient2 = luma2 - lumaCentre;
+    bool is1Steepest = abs(gradient1) >= abs(gradient2);
+    float gradientScaled = 0.25f * max(abs(gradient1), abs(gradient2));
+
+    float stepLength = isHorizontal ? u_inversePixelSize.y : u_inversePixelSize.x;
+    float lumaLocalAverage;
+
+    if (is1Steepest)
+    {
+        stepLength = -stepLength;
+        lumaLocalAverage = 0.5f * (luma1 + lumaCentre);
+    }
+    else
+        lumaLocalAverage = 0.5f * (luma2 + lumaCentre);
+
+    // Search along the middle of the edge in both directions until the luma changes, which marks its ends
+
+    vec2 edgeCoordinates = textureCoordinates;
+    if (isHorizontal)
+        edgeCoordinates.y += 0.5f * stepLength;
+    else
+        edgeCoordinates.x += 0.5f * stepLength;
+
+    vec2 searchOffset = isHorizontal ? vec2(u_inversePixelSize.x, 0.0f) : vec2(0.0f, u_inversePixelSize.y);
+    vec2 coordinates1 = edgeCoordinates;
+    vec2 coordinates2 = edgeCoordinates;
+    float lumaEnd1 = 0.0f;
+    float lumaEnd2 = 0.0f;
+    bool reachedEnd1 = false;
+    bool reachedEnd2 = false;
+
+    for (int i = 0; i < SEARCH_STEP_COUNT && !(reachedEnd1 && reachedEnd2); i++)
+    {
+        if (!reachedEnd1)
+        {
+            coordinates1 -= searchOffset * SEARCH_STEPS[i];
+            lumaEnd1 = getLuma(coordinates1) - lumaLocalAverage;
+            reachedEnd1 = abs(lumaEnd1) >= gradientScaled;
+        }
+
+        if (!reachedEnd2)
+        {
+            coordinates2 += searchOffset * SEARCH_STEPS[i];
+            lumaEnd2 = getLuma(coordinates2) - lumaLocalAverage;
+            reachedEnd2 = abs(lumaEnd2) >= gradientScaled;
+        }
+    }
+
+    float distance1 = isHorizontal ? (textureCoordinates.x - coordinates1.x) : (textureCoordinates.y - coordinates1.y);
+    float distance2 = isHorizontal ? (coordinates2.x - textureCoordinates.x) : (coordinates2.y - textureCoordinates.y);
+    bool isDirection1 = distance1 < distance2;
+    float edgeLength = distance1 + distance2;
+
+    // Only blend if the luma at the nearer end changes the opposite way to the centre, otherwise the
+    // pixel is on the far side of the edge's "step" and is already correct
+
+    bool isLumaCentreSmaller = lumaCentre < lumaLocalAverage;
+    bool correctVariation = ((isDirection1 ? lumaEnd1 : lumaEnd2) < 0.0f) != isLumaCentreSmaller;
+    float edgeOffset = correctVariation ? 0.5f - min(distance1, distance2) / edgeLength : 0.0f;
+
+    // Single pixel features have no long edge to follow, so are blurred by how much they differ from their neighbours
+
+    float lumaAverage = (1.0f / 12.0f) * (2.0f * (lumaDownUp + lumaLeftRight) + lumaLeftCorners + lumaRightCorners);
+    float subpixelOffset = clamp(abs(lumaAverage - lumaCentre) / lumaRange, 0.0f, 1.0f);
+    subpixelOffset = (-2.0f * subpixelOffset + 3.0f) * subpixelOffset * subpixelOffset;
+    subpixelOffset = subpixelOffset * subpixelOffset * SUBPIXEL_QUALITY;
+
+    float finalOffset = max(edgeOffset, subpixelOffset);
+
+    vec2 finalCoordinates = textureCoordinates;
+    if (isHorizontal)
+        finalCoordinates.y += finalOffset * stepLength;
+    else
+        finalCoordinates.x += finalOffset * stepLength;
+
+    o_fragColor = vec4(textureLod(u_inputTexture, finalCoordinates, 0.0f).rgb, 1.0f);
+}
@@ -0,0 +1,97 @@
+#version 460 core
+
+// INPUTS FROM VERTEX SHADER
+
+// Shares PBR.glsl.vert with the forward PBR renderer
+struct VertexOutput
+{
+    vec3 worldPosition;
+    vec3 normal;
+    vec2 textureCoordinates;
+    mat3 TBN;
+};
+
+in VertexOutput vertex_output;
+
+// UNIFORMS
+
+// Material
+
+struct Material
+{
+    vec4 baseColor;
+    float roughness;
+    float metalness;
+    sampler2D baseColorMap;
+    sampler2D roughnessMap;
+    sampler2D metalnessMap;
+    sampler2D normalMap;
+
+    bool useNormalMap;
+
+    // Fragments with an alpha below the cutoff are discarded when alpha testing
+    float alphaCutoff;
+    bool useAlphaTest;
+};
+
+uniform Material u_material;
+
+// OUTPUTS
+
+// G-buffer layout (8 bytes per pixel, plus depth):
+//     0 - RGBA8   - base color (rgb), metalness (a)
+//     1 - RGB10A2 - octahedral encoded normal (rg), roughness (b)
+
+layout(location = 0) out vec4 o_baseColorMetalness;
+layout(location = 1) out vec4 o_normalRoughness;
+
+// FUNCTIONS
+
+vec3 getNormalisedSurfaceNormal()
+{
+    if (u_material.useNormalMap)
+    {
+        vec4 sampleFromNormalMap = texture(u_material.normalMap, vertex_output.textureCoordinates);
+        vec3 sampledNormal = (sampleFromNormalMap.rgb * 2.0f) - 1.0f;
+        vec3 sampledNormalInWorldSpace = vertex_output.TBN * sampledNormal;
+        return normalize(sampledNormalInWorldSpace);
+    }
+    else
+        return normalize(vertex_output.normal);
+}
+
+vec2 signNotZero(vec2 v)
+{
+    return vec2(v.x >= 0.0f ? 1.0f : -1.0f, v.y >= 0.0f ? 1.0f : -1.0f);
+}
+
+/*
+Projects the normal onto an octahedron, which is then unfolded onto a square.
+This stores a unit vector in two components with a much more even precision than storing x and y.
+
+See http://jcgt.org/published/0003/02/01/
+*/
+vec2 encodeOctahedralNormal(vec3 normal)
+{
+    normal /= abs(normal.x) + abs(normal.y) + abs(normal.z);
+    vec2 encodedNormal = normal.z >= 0.0f ? normal.xy : (1.0f - abs(normal.yx)) * signNotZero(normal.xy);
+
+    // Moved from [-1, 1] to [0, 1] for the unsigned normalised attachment
+    return encodedNormal * 0.5f + 0.5f;
+}
+
+void main()
+{
+    vec4 baseColorWithAlpha = texture(u_material.baseColorMap, vertex_output.textureCoordinates) * u_material.baseColor;
+
+    // The G-buffer holds one surface per pixel, so blended materials are alpha tested here too
+    if (u_material.useAlphaTest && baseColorWithAlpha.a < u_material.alphaCutoff)
+        discard;
+
+    vec3 baseColor = baseColorWithAlpha.rgb;
+    float roughness = texture(u_material.roughnessMap, vertex_output.textureCoordinates).r * u_material.roughness;
+    float metalness = texture(u_material.metalnessMap, vertex_output.textureCoordinates).r * u_material.metalness;
+
+    o_baseColorMetalness = vec4(baseColor, metalness);
+    o_normalRoughness = vec4(encodeOctahedralNormal(getNormalisedSurfaceNormal()), roughness, 0.0f);
+}
@@ -12,6 +12,52 @@ struct VertexOutput
 
 in VertexOutput vertex_output;
 
+// BUFFERS
+
+struct PointLight
+{
+    vec3 worldPosition;
+    float lightRadius;
+    vec3 lightColor;
+    float luminousPower;
+};
+
+layout (std430, binding = 10) readonly buffer PointLightBuffer
+{
+    PointLight s_pointLights[];
+};
+
+struct Cluster
+{
+    uint firstLightIndex;
+    uint lightCount;
+};
+
+layout (std430, binding = 8) readonly buffer ClusterBuffer
+{
+    Cluster s_clusters[];
+};
+
+layout (std430, binding = 9) readonly buffer ClusterLightIndexBuffer
+{
+    uint s_clusterLightIndices[];
+};
+
+struct PointLightShadow
+{
+    // Negative if the light has no shadow map
+    int tier;
+    int cubeMapIndex;
+    float depthBias;
+    float padding;
+};
+
+// Indexed the same as s_pointLights - see PointShadowAtlas.h
+layout (std430, binding = 11) readonly buffer PointLightShadowBuffer
+{
+    PointLightShadow s_pointLightShadows[];
+};
+
 // UNIFORMS
 
 // Material
@@ -27,28 +73,41 @@ struct Material
     sampler2D normalMap;
 
     bool useNormalMap;
+
+    // Fragments with an alpha below the cutoff are discarded when alpha testing
+    float alphaCutoff;
+    bool useAlphaTest;
 };
 
 uniform Material u_material;
 
-// Point lights
-
-struct PointLight
-{
-    vec3 worldPosition;
-    vec3 lightColor;
-    float luminousPower;
-    float lightRadius;
-};
+// Light clusters
 
-const uint MAX_NUMBER_OF_POINT_LIGHTS = 128;
-uniform PointLight u_pointLights[MAX_NUMBER_OF_POINT_LIGHTS];
-uniform uint u_pointLightNumber;
+uniform uvec3 u_clusterGridSize;
+uniform vec2 u_clusterTileSize;
+uniform float u_clusterDepthSliceScale;
+uniform float u_nearClip;
+uniform mat4 u_viewMatrix;
 
 uniform vec3 u_viewPosition;
 
 uniform float u_exposure;
 
+// Point light shadows - one cube map array per tier, storing the distance to the light over its radius
+
+uniform samplerCubeArrayShadow u_pointShadowMaps0;
+uniform samplerCubeArrayShadow u_pointShadowMaps1;
+uniform samplerCubeArrayShadow u_pointShadowMaps2;
+
+// Image based lighting - see ImageBasedLighting.h
+
+uniform bool u_imageBasedLightingEnabled;
+uniform vec3 u_irradianceCoefficients[9];
+uniform samplerCube u_prefilteredEnvironmentMap;
+uniform uint u_prefilteredMipCount;
+uniform sampler2D u_BRDFLookUpTable;
+uniform float u_environmentIntensity;
+
 // OUTPUTS
 
 layout(location = 0) out vec4 o_fragColor;
@@ -89,6 +148,27 @@ MaterialProperties g_materialProperties;
 
 // FUNCTIONS
 
+// The fraction of the light reaching the world position which isn't blocked, filtered over 2x2 texels
+float calculatePointLightShadowFactor(uint lightIndex, vec3 worldPosition)
+{
+    PointLightShadow shadow = s_pointLightShadows[lightIndex];
+
+    if (shadow.tier < 0)
+        return 1.0f;
+
+    PointLight pointLight = s_pointLights[lightIndex];
+    vec3 lightToPosition = worldPosition - pointLight.worldPosition;
+    float depth = length(lightToPosition) / pointLight.lightRadius - shadow.depthBias;
+    vec4 coordinates = vec4(lightToPosition, float(shadow.cubeMapIndex));
+
+    if (shadow.tier == 0)
+        return texture(u_pointShadowMaps0, coordinates, depth);
+    else if (shadow.tier == 1)
+        return texture(u_pointShadowMaps1, coordinates, depth);
+    else
+        return texture(u_pointShadowMaps2, coordinates, depth);
+}
+
 /*
 Used the Sclick approximation to calculate the Fresnel reflectance
 */
@@ -130,6 +210,18 @@ float calculateGGXDistribution(float nDotH)
     return alpha2 / (PI * x * x);
 }
 
+// Finds the cluster the fragment is in - see LightClustering.glsl.comp
+uint getClusterIndex()
+{
+    uvec2 tile = min(uvec2(gl_FragCoord.xy / u_clusterTileSize), u_clusterGridSize.xy - 1);
+
+    float viewDepth = -(u_viewMatrix * vec4(vertex_output.worldPosition, 1.0f)).z;
+    uint slice = uint(max(log(viewDepth / u_nearClip) * u_clusterDepthSliceScale, 0.0f));
+    slice = min(slice, u_clusterGridSize.z - 1);
+
+    return tile.x + u_clusterGridSize.x * (tile.y + u_clusterGridSize.y * slice);
+}
+
 vec3 getNormalisedSurfaceNormal()
 {
     if (u_material.useNormalMap)
@@ -199,6 +291,56 @@ vec3 calculatePointLightContribution(const PointLight pointLight)
     return BRDFValue * lightRadiance * max(nDotL, 0.0f);
 }
 
+// Evaluates the environment's irradiance (divided by pi) at the normal, from its spherical harmonic - see EnvironmentMap.cpp
+vec3 calculateEnvironmentIrradiance(vec3 normal)
+{
+    vec3 irradiance = u_irradianceCoefficients[0] * 0.282095f;
+
+    irradiance += u_irradianceCoefficients[1] * 0.488603f * normal.y;
+    irradiance += u_irradianceCoefficients[2] * 0.488603f * normal.z;
+    irradiance += u_irradianceCoefficients[3] * 0.488603f * normal.x;
+
+    irradiance += u_irradianceCoefficients[4] * 1.092548f * normal.x * normal.y;
+    irradiance += u_irradianceCoefficients[5] * 1.092548f * normal.y * normal.z;
+    irradiance += u_irradianceCoefficients[6] * 0.315392f * (3.0f * normal.z * normal.z - 1.0f);
+    irradiance += u_irradianceCoefficients[7] * 1.092548f * normal.x * normal.z;
+    irradiance += u_irradianceCoefficients[8] * 0.546274f * (normal.x * normal.x - normal.y * normal.y);
+
+    return max(irradiance, vec3(0.0f));
+}
+
+/*
+Lighting from the environment map, or a rudimentary ambient term without one.
+
+The specular term uses Karis's split sum approximation: the environment prefiltered with the GGX lobe of the roughness,
+scaled by the BRDF's integral (with Fresnel factored out as F0 * scale + bias) from the look up table.
+*/
+vec3 calculateAmbientContribution()
+{
+    if (!u_imageBasedLightingEnabled)
+        return vec3(0.05f) * g_materialProperties.baseColor;
+
+    float nDotV = clamp(g_dotProducts.nDotV, 0.0f, 1.0f);
+    float roughness = g_materialProperties.roughness;
+    vec3 f0 = g_materialProperties.f0;
+
+    // Specular (surface reflection) term
+
+    vec3 reflectionDirection = reflect(-g_directions.viewDirection, g_directions.normal);
+    vec3 prefilteredRadiance = textureLod(u_prefilteredEnvironmentMap, reflectionDirection, roughness * float(u_prefilteredMipCount - 1u)).rgb;
+    vec2 BRDFScaleAndBias = textureLod(u_BRDFLookUpTable, vec2(nDotV, roughness), 0.0f).rg;
+
+    vec3 specularTerm = prefilteredRadiance * (f0 * BRDFScaleAndBias.x + BRDFScaleAndBias.y);
+
+    // Diffuse (sub-surface reflection) term, with the Fresnel reflectance of rough surfaces at grazing angles reduced (as Lagarde does)
+
+    vec3 fresnelReflectance = f0 + (max(vec3(1.0f - roughness), f0) - f0) * pow(1.0f - nDotV, 5.0f);
+    vec3 diffuseTermContribution = (vec3(1.0f) - fresnelReflectance) * (1.0f - g_materialProperties.metalness);
+    vec3 diffuseTerm = diffuseTermContribution * g_materialProperties.baseColor * calculateEnvironmentIrradiance(g_directions.normal);
+
+    return (diffuseTerm + specularTerm) * u_environmentIntensity;
+}
+
 void main()
 {
     // Initialise global values
@@ -211,21 +353,32 @@ void main()
     vec4 baseColorWithAlpha = texture(u_material.baseColorMap, vertex_output.textureCoordinates) * u_material.baseColor;
     g_materialProperties.baseColor = baseColorWithAlpha.rgb;
     g_materialProperties.alpha = baseColorWithAlpha.a;
+
+    if (u_material.useAlphaTest && g_materialProperties.alpha < u_material.alphaCutoff)
+        discard;
+
     g_materialProperties.roughness = texture(u_material.roughnessMap, vertex_output.textureCoordinates).r * u_material.roughness;
     g_materialProperties.metalness = texture(u_material.metalnessMap, vertex_output.textureCoordinates).r * u_material.metalness;
     g_materialProperties.f0 = mix(F0_FOR_DIELECTRICS, g_materialProperties.baseColor, g_materialProperties.metalness);
 
-    // Solve the reflectance equation by evaluating the contribution of each point light
+    // Solve the reflectance equation by evaluating the contribution of each point light which reaches the fragment's cluster
 
     vec3 fragmentColor = vec3(0.0f);
 
-    for (uint i = 0; i < u_pointLightNumber; i++)
-        fragmentColor += calculatePointLightContribution(u_pointLights[i]);
+    Cluster cluster = s_clusters[getClusterIndex()];
+
+    for (uint i = 0; i < cluster.lightCount; i++)
+    {
+        uint lightIndex = s_clusterLightIndices[cluster.firstLightIndex + i];
+        float shadowFactor = calculatePointLightShadowFactor(lightIndex, vertex_output.worldPosition);
+
+        if (shadowFactor > 0.0f)
+            fragmentColor += calculatePointLightContribution(s_pointLights[lightIndex]) * shadowFactor;
+    }
     
-    // Apply a rudimentary ambient term
+    // Apply the environment's lighting (or a rudimentary ambient term)
 
-    vec3 ambientTerm = vec3(0.05f) * g_materialProperties.baseColor;
-    fragmentColor += ambientTerm;
+    fragmentColor += calculateAmbientContribution();
 
     // Output the shaded color
 
@@ -8,9 +8,20 @@ layout (location = 2) in vec2 a_textureCoordinates;
 layout (location = 3) in vec3 a_tangent;
 layout (location = 4) in vec3 a_bitangent;
 
+// BUFFERS
+
+struct DrawData
+{
+    mat4 transform;
+};
+
+layout (std430, binding = 0) readonly buffer DrawDataBuffer
+{
+    DrawData s_drawData[];
+};
+
 // UNIFORMS
 
-uniform mat4 u_transform;
 uniform mat4 u_projectionViewMatrix;
 
 // OUTPUTS
@@ -25,18 +36,24 @@ struct VertexOutput
 
 out VertexOutput vertex_output;
 
+// Must match the depth pre-pass exactly, as the depth test is GL_EQUAL when it is enabled
+invariant gl_Position;
+
 // FUNCTIONS
 
 void main()
 {
-    vertex_output.worldPosition = vec3(u_transform * vec4(a_position, 1.0f));
-    vertex_output.normal = normalize(vec3(transpose(inverse(u_transform)) * vec4(a_normal, 0.0f)));
+    // Each draw command's base instance is the index of its draw data
+    mat4 transform = s_drawData[gl_BaseInstance].transform;
+
+    vertex_output.worldPosition = vec3(transform * vec4(a_position, 1.0f));
+    vertex_output.normal = normalize(vec3(transpose(inverse(transform)) * vec4(a_normal, 0.0f)));
     vertex_output.textureCoordinates = a_textureCoordinates;
 
-    vec3 normalTransformed = normalize(vec3(u_transform * vec4(a_normal, 0.0f)));
-    vec3 tangentTransformed = normalize(vec3(u_transform * vec4(a_tangent, 0.0f)));
-    vec3 bitangentTransformed = normalize(vec3(u_transform * vec4(a_bitangent, 0.0f)));
+    vec3 normalTransformed = normalize(vec3(transform * vec4(a_normal, 0.0f)));
+    vec3 tangentTransformed = normalize(vec3(transform * vec4(a_tangent, 0.0f)));
+    vec3 bitangentTransformed = normalize(vec3(transform * vec4(a_bitangent, 0.0f)));
     vertex_output.TBN = mat3(tangentTransformed, bitangentTransformed, normalTransformed);
 
-    gl_Position = u_projectionViewMatrix * u_transform * vec4(a_position, 1.0f);
+    gl_Position = u_projectionViewMatrix * transform * vec4(a_position, 1.0f);
 }
\ No newline at end of file
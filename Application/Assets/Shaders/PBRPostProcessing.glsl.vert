@@ -5,6 +5,11 @@
 layout (location = 0) in vec2 a_position;
 layout (location = 1) in vec2 a_textureCoordinates;
 
+// UNIFORMS
+
+// Render targets can be larger than what has been drawn to them, so texture coordinates are scaled to cover just that
+uniform vec2 u_textureCoordinatesScale;
+
 // OUTPUTS
 
 struct VertexOutput
@@ -18,6 +23,6 @@ out VertexOutput vertex_output;
 
 void main()
 {
-    vertex_output.textureCoordinates = a_textureCoordinates;
+    vertex_output.textureCoordinates = a_textureCoordinates * u_textureCoordinatesScale;
     gl_Position = vec4(a_position, 0.0f, 1.0f);
 }
\ No newline at end of file
@@ -0,0 +1,24 @@
+#version 460 core
+
+// INPUTS FROM GEOMETRY SHADER
+
+struct GeometryOutput
+{
+    vec3 worldPosition;
+};
+
+in GeometryOutput geometry_output;
+
+// UNIFORMS
+
+uniform vec3 u_lightPosition;
+uniform float u_lightRadius;
+
+// FUNCTIONS
+
+void main()
+{
+    // The distance to the light, over its radius, is stored rather than the projected depth, so that lookups only
+    // need the direction and distance from the light rather than which face they fall on
+    gl_FragDepth = length(geometry_output.worldPosition - u_lightPosition) / u_lightRadius;
+}
\ No newline at end of file
@@ -0,0 +1,37 @@
+#version 460 core
+
+// ATTRIBUTES
+
+// Only positions are needed, so shadow maps are drawn from the geometry arena's separate position stream
+layout (location = 0) in vec3 a_position;
+
+// BUFFERS
+
+struct DrawData
+{
+    mat4 transform;
+};
+
+layout (std430, binding = 0) readonly buffer DrawDataBuffer
+{
+    DrawData s_drawData[];
+};
+
+// OUTPUTS
+
+struct VertexOutput
+{
+    vec3 worldPosition;
+};
+
+out VertexOutput vertex_output;
+
+// FUNCTIONS
+
+void main()
+{
+    // Each draw command's base instance is the index of its draw data. The cube face is chosen in the geometry shader
+    mat4 transform = s_drawData[gl_BaseInstance].transform;
+
+    vertex_output.worldPosition = vec3(transform * vec4(a_position, 1.0f));
+}
\ No newline at end of file
@@ -0,0 +1,147 @@
+#version 460 core
+
+// INPUTS FROM VERTEX SHADER
+
+struct VertexOutput
+{
+    vec2 textureCoordinates;
+};
+
+in VertexOutput vertex_output;
+
+// UNIFORMS
+
+// Written by SMAAEdgeDetection.glsl.frag
+uniform sampler2D u_edgesTexture;
+
+// OUTPUTS
+
+// Fractions of colour to exchange across each stored edge of the pixel:
+// r - the pixel takes from the one above it    g - the pixel above takes from this one
+// b - the pixel takes from the one to its left a - the pixel to the left takes from this one
+layout(location = 0) out vec4 o_blendingWeights;
+
+// CONSTANTS
+
+// Furthest an edge is followed (in pixels) in each direction
+const int MAX_SEARCH_STEPS = 16;
+
+// FUNCTIONS
+
+vec2 getEdges(ivec2 pixel)
+{
+    pixel = clamp(pixel, ivec2(0), textureSize(u_edgesTexture, 0) - 1);
+    return texelFetch(u_edgesTexture, pixel, 0).rg;
+}
+
+// Follows an edge from the pixel in a direction, returning the number of further pixels it continues for.
+// component selects which of the stored edges (0 - left, 1 - top) is followed
+int searchEdge(ivec2 pixel, ivec2 direction, int component)
+{
+    int distance = 0;
+
+    for (int i = 1; i <= MAX_SEARCH_STEPS; i++)
+    {
+        if (getEdges(pixel + direction * i)[component] < 0.5f)
+            break;
+
+        distance = i;
+    }
+
+    return distance;
+}
+
+// Integral of a line (from startHeight at start to endHeight at end) over the pixel, which spans [0, 1]
+float getLineArea(float start, float startHeight, float end, float endHeight)
+{
+    float clippedStart = clamp(start, 0.0f, 1.0f);
+    float clippedEnd = clamp(end, 0.0f, 1.0f);
+
+    if (clippedEnd <= clippedStart)
+        return 0.0f;
+
+    float clippedStartHeight = mix(startHeight, endHeight, (clippedStart - start) / (end - start));
+    float clippedEndHeight = mix(startHeight, endHeight, (clippedEnd - start) / (end - start));
+
+    return 0.5f * (clippedStartHeight + clippedEndHeight) * (clippedEnd - clippedStart);
+}
+
+/*
+Finds how far the smoothed edge moves into the pixel (x) and into its neighbour across the edge (y).
+
+The edge runs from -distance1 to distance2 + 1, with the pixel at [0, 1]. Each end's height is where the
+edge is smoothed to - half a pixel towards the side its crossing edge is on (0 if the edge doesn't end
+within the search distance, or is crossed on both sides). A line is drawn from each end to the middle of
+the edge, and the area between the lines and the edge is the colour exchanged across it.
+
+This is the area SMAA stores in its precomputed area texture for orthogonal patterns, calculated directly.
+*/
+vec2 getArea(int distance1, int distance2, float endHeight1, float endHeight2)
+{
+    float start = -float(distance1);
+    float end = float(distance2 + 1);
+    float middle = 0.5f * (start + end);
+
+    float area1 = getLineArea(start, endHeight1, middle, 0.0f);
+    float area2 = getLineArea(middle, 0.0f, end, endHeight2);
+
+    return vec2(max(area1, 0.0f) + max(area2, 0.0f), max(-area1, 0.0f) + max(-area2, 0.0f));
+}
+
+// Height of an end of the edge, from whether it is crossed on the pixel's side and on the other side
+float getEndHeight(bool reachedEnd, float pixelSideCrossing, float otherSideCrossing)
+{
+    return reachedEnd ? 0.5f * (step(0.5f, pixelSideCrossing) - step(0.5f, otherSideCrossing)) : 0.0f;
+}
+
+/*
+SMAA blending weight calculation
+
+Second pass of SMAA 1x. Only orthogonal patterns are handled, with the edge ends found by reading the edge
+texture one pixel at a time rather than with SMAA's bilinear search texture.
+*/
+void main()
+{
+    ivec2 pixel = ivec2(gl_FragCoord.xy);
+    vec2 edges = getEdges(pixel);
+
+    // Most pixels have no edges, and the blending weight target is cleared to zero
+    if (dot(edges, vec2(1.0f)) == 0.0f)
+        discard;
+
+    vec4 blendingWeights = vec4(0.0f);
+
+    // Edge above the pixel, running horizontally - its ends are crossed by left edges
+
+    if (edges.g > 0.5f)
+    {
+        int distanceLeft = searchEdge(pixel, ivec2(-1, 0), 1);
+        int distanceRight = searchEdge(pixel, ivec2(1, 0), 1);
+
+        ivec2 leftEnd = pixel + ivec2(-distanceLeft, 0);
+        ivec2 rightEnd = pixel + ivec2(distanceRight + 1, 0);
+
+        float leftHeight = getEndHeight(distanceLeft < MAX_SEARCH_STEPS, getEdges(leftEnd).r, getEdges(leftEnd + ivec2(0, 1)).r);
+        float rightHeight = getEndHeight(distanceRight < MAX_SEARCH_STEPS, getEdges(rightEnd).r, getEdges(rightEnd + ivec2(0, 1)).r);
+
+        blendingWeights.rg = getArea(distanceLeft, distanceRight, leftHeight, rightHeight);
+    }
+
+    // Edge to the left of the pixel, running vertically - its ends are crossed by top edges
+
+    if (edges.r > 0.5f)
+    {
+        int distanceDown = searchEdge(pixel, ivec2(0, -1), 0);
+        int distanceUp = searchEdge(pixel, ivec2(0, 1), 0);
+
+        ivec2 bottomEnd = pixel + ivec2(0, -distanceDown - 1);
+        ivec2 topEnd = pixel + ivec2(0, distanceUp);
+
+        float bottomHeight = getEndHeight(distanceDown < MAX_SEARCH_STEPS, getEdges(bottomEnd).g, getEdges(bottomEnd + ivec2(-1, 0)).g);
+        float topHeight = getEndHeight(distanceUp < MAX_SEARCH_STEPS, getEdges(topEnd).g, getEdges(topEnd + ivec2(-1, 0)).g);
+
+        blendingWeights.ba = getArea(distanceDown, distanceUp, bottomHeight, topHeight);
+    }
+
+    o_blendingWeights = blendingWeights;
+}
@@ -0,0 +1,76 @@
+#version 460 core
+
+// INPUTS FROM VERTEX SHADER
+
+struct VertexOutput
+{
+    vec2 textureCoordinates;
+};
+
+in VertexOutput vertex_output;
+
+// UNIFORMS
+
+// Tone mapped and gamma corrected, so that luma differences match perceived contrast
+uniform sampler2D u_inputTexture;
+
+// OUTPUTS
+
+// r - there is an edge between the pixel and the one to its left
+// g - there is an edge between the pixel and the one above it
+layout(location = 0) out vec2 o_edges;
+
+// CONSTANTS
+
+const float EDGE_THRESHOLD = 0.1f;
+
+// An edge is dropped if a neighbouring edge has this many times its contrast, as the eye
+// only notices the strongest edge in an area
+const float LOCAL_CONTRAST_ADAPTATION_FACTOR = 2.0f;
+
+// FUNCTIONS
+
+float getLuma(ivec2 pixel)
+{
+    pixel = clamp(pixel, ivec2(0), textureSize(u_inputTexture, 0) - 1);
+    return dot(texelFetch(u_inputTexture, pixel, 0).rgb, vec3(0.2126f, 0.7152f, 0.0722f));
+}
+
+/*
+SMAA edge detection (luma)
+
+First pass of SMAA 1x (Jimenez et al., "SMAA: Enhanced Subpixel Morphological Antialiasing"). Only the left and top
+edges of each pixel are stored, as the right and bottom edges are the left and top edges of its neighbours.
+*/
+void main()
+{
+    ivec2 pixel = ivec2(gl_FragCoord.xy);
+
+    float luma = getLuma(pixel);
+    float lumaLeft = getLuma(pixel + ivec2(-1, 0));
+    float lumaTop = getLuma(pixel + ivec2(0, 1));
+
+    vec2 delta = abs(luma - vec2(lumaLeft, lumaTop));
+    vec2 edges = step(EDGE_THRESHOLD, delta);
+
+    // Most pixels have no edges, and the edge target is cleared to zero
+    if (dot(edges, vec2(1.0f)) == 0.0f)
+        discard;
+
+    // Local contrast adaptation - compare against the contrast of the edges around these two
+
+    float lumaRight = getLuma(pixel + ivec2(1, 0));
+    float lumaBottom = getLuma(pixel + ivec2(0, -1));
+    float lumaLeftLeft = getLuma(pixel + ivec2(-2, 0));
+    float lumaTopTop = getLuma(pixel + ivec2(0, 2));
+
+    vec2 neighbourDelta = abs(luma - vec2(lumaRight, lumaBottom));
+    vec2 farDelta = abs(vec2(lumaLeft, lumaTop) - vec2(lumaLeftLeft, lumaTopTop));
+
+    vec2 maxDelta = max(max(delta, neighbourDelta), farDelta);
+    float finalMaxDelta = max(maxDelta.x, maxDelta.y);
+
+    edges *= step(finalMaxDelta, LOCAL_CONTRAST_ADAPTATION_FACTOR * delta);
+
+    o_edges = edges;
+}
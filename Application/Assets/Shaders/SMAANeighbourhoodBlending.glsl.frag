@@ -0,0 +1,68 @@
+#version 460 core
+
+// INPUTS FROM VERTEX SHADER
+
+struct VertexOutput
+{
+    vec2 textureCoordinates;
+};
+
+in VertexOutput vertex_output;
+
+// UNIFORMS
+
+uniform sampler2D u_inputTexture;
+// Written by SMAABlendingWeights.glsl.frag
+uniform sampler2D u_blendingWeightsTexture;
+
+// OUTPUTS
+
+layout(location = 0) out vec4 o_fragColor;
+
+// FUNCTIONS
+
+vec3 getColor(ivec2 pixel)
+{
+    pixel = clamp(pixel, ivec2(0), textureSize(u_inputTexture, 0) - 1);
+    return texelFetch(u_inputTexture, pixel, 0).rgb;
+}
+
+vec4 getBlendingWeights(ivec2 pixel)
+{
+    pixel = clamp(pixel, ivec2(0), textureSize(u_blendingWeightsTexture, 0) - 1);
+    return texelFetch(u_blendingWeightsTexture, pixel, 0);
+}
+
+/*
+SMAA neighbourhood blending
+
+Last pass of SMAA 1x. Each pixel's weights for its right and bottom edges are stored by its neighbours, as they
+are their left and top edges. As in SMAA, a pixel only blends along the axis with the largest weight.
+*/
+void main()
+{
+    ivec2 pixel = ivec2(gl_FragCoord.xy);
+    vec3 color = getColor(pixel);
+
+    vec4 weights = getBlendingWeights(pixel);
+    float fromTop = weights.r;
+    float fromLeft = weights.b;
+    float fromBottom = getBlendingWeights(pixel + ivec2(0, -1)).g;
+    float fromRight = getBlendingWeights(pixel + ivec2(1, 0)).a;
+
+    float verticalWeight = max(fromTop, fromBottom);
+    float horizontalWeight = max(fromLeft, fromRight);
+
+    if (verticalWeight == 0.0f && horizontalWeight == 0.0f)
+    {
+        o_fragColor = vec4(color, 1.0f);
+        return;
+    }
+
+    if (verticalWeight >= horizontalWeight)
+        color = color * (1.0f - fromTop - fromBottom) + getColor(pixel + ivec2(0, 1)) * fromTop + getColor(pixel + ivec2(0, -1)) * fromBottom;
+    else
+        color = color * (1.0f - fromLeft - fromRight) + getColor(pixel + ivec2(-1, 0)) * fromLeft + getColor(pixel + ivec2(1, 0)) * fromRight;
+
+    o_fragColor = vec4(color, 1.0f);
+}
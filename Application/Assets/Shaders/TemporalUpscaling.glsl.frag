@@ -0,0 +1,118 @@
+#version 460 core
+
+// INPUTS FROM VERTEX SHADER
+
+struct VertexOutput
+{
+    vec2 textureCoordinates;
+};
+
+in VertexOutput vertex_output;
+
+// UNIFORMS
+
+// This frame, drawn with a jittered projection into the bottom left u_renderSize pixels of the textures
+uniform sampler2D u_inputTexture;
+uniform sampler2D u_depthTexture;
+uniform vec2 u_renderSize;
+// Offset of this frame's projection, in render pixels
+uniform vec2 u_jitter;
+
+// Accumulated from previous frames at the output's size - the alpha channel is the total weight of the samples in it
+uniform sampler2D u_historyTexture;
+uniform bool u_historyValid;
+
+// Without jitter
+uniform mat4 u_inverseProjectionViewMatrix;
+uniform mat4 u_previousProjectionViewMatrix;
+
+// OUTPUTS
+
+layout(location = 0) out vec4 o_fragColor;
+
+// CONSTANTS
+
+// Limits how much of the history is kept, so that changes in lighting show up within a few frames
+const float MAX_HISTORY_WEIGHT = 8.0f;
+
+// FUNCTIONS
+
+vec3 getColor(ivec2 texel)
+{
+    texel = clamp(texel, ivec2(0), ivec2(u_renderSize) - 1);
+    return texelFetch(u_inputTexture, texel, 0).rgb;
+}
+
+float getDepth(ivec2 texel)
+{
+    texel = clamp(texel, ivec2(0), ivec2(u_renderSize) - 1);
+    return texelFetch(u_depthTexture, texel, 0).r;
+}
+
+/*
+Temporal upscaling
+
+Each output pixel takes the nearest sample of this frame, weighted by how close the sample is to the pixel's centre
+(the jitter moves the samples around between frames, so over several frames every output pixel gets a close one).
+It is blended with the pixel's history, found by reprojecting its position with the previous frame's matrices.
+Only the camera moves between frames in these scenes, so the depth buffer is enough to reproject.
+
+History which no longer matches what is on screen (from disocclusion or lighting changes) is clamped to the range of
+colours around the pixel this frame.
+*/
+void main()
+{
+    vec2 textureCoordinates = vertex_output.textureCoordinates;
+
+    // A point at the centre of the output pixel is drawn at renderPosition in the jittered frame
+    vec2 renderPosition = textureCoordinates * u_renderSize + u_jitter;
+    ivec2 nearestTexel = ivec2(floor(renderPosition));
+
+    vec2 sampleOffset = (vec2(nearestTexel) + 0.5f) - renderPosition;
+    float sampleWeight = exp(-2.29f * dot(sampleOffset, sampleOffset));
+
+    vec3 currentColor = getColor(nearestTexel);
+    vec3 minColor = currentColor;
+    vec3 maxColor = currentColor;
+
+    // The closest depth around the pixel is used to reproject, so that the edges of objects keep their history
+    float closestDepth = getDepth(nearestTexel);
+
+    for (int y = -1; y <= 1; y++)
+    {
+        for (int x = -1; x <= 1; x++)
+        {
+            if (x == 0 && y == 0)
+                continue;
+
+            vec3 neighbourColor = getColor(nearestTexel + ivec2(x, y));
+            minColor = min(minColor, neighbourColor);
+            maxColor = max(maxColor, neighbourColor);
+
+            closestDepth = min(closestDepth, getDepth(nearestTexel + ivec2(x, y)));
+        }
+    }
+
+    vec4 worldPosition = u_inverseProjectionViewMatrix * vec4(textureCoordinates * 2.0f - 1.0f, closestDepth * 2.0f - 1.0f, 1.0f);
+    worldPosition /= worldPosition.w;
+
+    vec4 previousClipPosition = u_previousProjectionViewMatrix * worldPosition;
+    vec2 previousTextureCoordinates = (previousClipPosition.xy / previousClipPosition.w) * 0.5f + 0.5f;
+
+    bool historyOnScreen = all(greaterThanEqual(previousTextureCoordinates, vec2(0.0f))) && all(lessThanEqual(previousTextureCoordinates, vec2(1.0f)));
+
+    if (!u_historyValid || !historyOnScreen)
+    {
+        o_fragColor = vec4(currentColor, sampleWeight);
+        return;
+    }
+
+    vec4 history = textureLod(u_historyTexture, previousTextureCoordinates, 0.0f);
+    vec3 historyColor = clamp(history.rgb, minColor, maxColor);
+    float historyWeight = min(history.a, MAX_HISTORY_WEIGHT);
+
+    float totalWeight = historyWeight + sampleWeight;
+    vec3 color = (historyColor * historyWeight + currentColor * sampleWeight) / totalWeight;
+
+    o_fragColor = vec4(color, min(totalWeight, MAX_HISTORY_WEIGHT));
+}
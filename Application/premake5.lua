@@ -27,7 +27,9 @@ project "Application"
         "Vendor/GLM",
         "Vendor/spdlog/include",
         "Vendor/stb_image",
-        "Vendor/assimp/include"
+        "Vendor/assimp/include",
+        -- Frames rendered headlessly are written as PNGs with the zlib assimp links
+        "Vendor/assimp/contrib/zlib"
     }
 
     links
@@ -49,6 +51,14 @@ project "Application"
             "PBR_LINUX"
         }
 
+        -- The software occlusion culler rasterizes on worker threads
+        links
+        {
+            "pthread",
+            -- libEGL is loaded at runtime for headless rendering
+            "dl"
+        }
+
     filter "configurations:Debug"
         runtime "Debug"
         symbols "on"
@@ -58,7 +68,11 @@ project "Application"
             "GLFW_INCLUDE_NONE",
             "PBR_DEBUG",
             "SPDLOG_ACTIVE_LEVEL=SPDLOG_LEVEL_TRACE",
-            "SPDLOG_ACTIVE_LEVEL_SOURCE=spdlog::level::trace"
+            "SPDLOG_ACTIVE_LEVEL_SOURCE=spdlog::level::trace",
+            -- The renderer and shaders trace every bind, uniform and draw, thousands of times a frame, so those calls are
+            -- compiled out. Set these to SPDLOG_LEVEL_TRACE to see them
+            "PBR_LOG_LEVEL_RENDERER=SPDLOG_LEVEL_INFO",
+            "PBR_LOG_LEVEL_SHADER=SPDLOG_LEVEL_INFO"
         }
     
     filter {"configurations:Debug", "system:windows"}
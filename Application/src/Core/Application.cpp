@@ -1,20 +1,51 @@
 #include "PCH.h"
 #include "Application.h"
 
+#include "BatchCoordinator.h"
+#include "BatchWorker.h"
+#include "Benchmark.h"
+#include "Profiler.h"
+#include "RenderThread.h"
 #include "Renderer/Renderer.h"
 
+// Headless frames are all a 60th of a second apart, so the same frames are rendered however long each one takes
+static constexpr float HEADLESS_TIME_STEP = 1.0f / 60.0f;
+
+Application::ApplicationSpecification Application::s_specification;
+std::vector<std::string> Application::s_commandLineArguments;
+int Application::s_exitCode = 0;
 bool Application::s_running = true;
 Window* Application::s_window = nullptr;
 float Application::s_timeAtLastFrame = 0.0f;
 Workspace* Application::s_workspace = nullptr;
+Framebuffer* Application::s_headlessFramebuffer = nullptr;
+BatchWorker* Application::s_batchWorker = nullptr;
+Benchmark* Application::s_benchmark = nullptr;
+RenderThread* Application::s_renderThread = nullptr;
 
-void Application::init()
+void Application::init(int argc, char** argv)
 {
 	Log::init();
-    Window::init();
+
+    parseCommandLineArguments(argc, argv);
+
+    // The coordinator of a batch render only starts and directs the workers, so needs no window or renderer
+    if (!s_specification.needsRenderer())
+        return;
+
+    if (s_specification.isBatchWorker())
+        s_specification.headless = true;
+
+    if (!s_specification.headless)
+        Window::init();
 
     Window::WindowSpecification windowSpecification;
     windowSpecification.title = "Renderer";
+    windowSpecification.width = s_specification.width;
+    windowSpecification.height = s_specification.height;
+    windowSpecification.headless = s_specification.headless;
+    // Frames mustn't be held back to the display's refresh rate while they are measured
+    windowSpecification.vSyncEnabled = false;
     windowSpecification.onWindowCloseCallback = std::bind(Application::onWindowCloseEvent);
     windowSpecification.onWindowResizeCallback = std::bind(Application::onWindowResizeEvent, std::placeholders::_1, std::placeholders::_2);
     windowSpecification.onMouseScrollCallback = std::bind(Application::onMouseScrollEvent, std::placeholders::_1, std::placeholders::_2);
@@ -24,11 +55,101 @@ void Application::init()
     // Init renderer after the OpenGL context has been created
     Renderer::init();
 
-    s_workspace = new Workspace();
+    // Batch workers are handed the coordinator's arguments, but would all write to the same profile
+    if (!s_specification.profileFile.empty() && !s_specification.isBatchWorker())
+        Profiler::setEnabled(true);
+
+    // A headless context has no default framebuffer, so the renderer presents to an offscreen one instead
+    if (s_specification.headless)
+    {
+        Framebuffer::FramebufferSpecification framebufferSpecification;
+        framebufferSpecification.width = s_specification.width;
+        framebufferSpecification.height = s_specification.height;
+        framebufferSpecification.resizeWithWindowResizeEvents = false;
+
+        s_headlessFramebuffer = new Framebuffer(framebufferSpecification);
+        RendererUtilities::setDefaultFramebufferRendererID(s_headlessFramebuffer->getRendererID());
+    }
+
+    if (s_specification.benchmark)
+    {
+        try
+        {
+            s_benchmark = new Benchmark(s_specification);
+        }
+        catch (std::exception& e)
+        {
+            Log::error(e.what());
+            s_exitCode = 1;
+        }
+
+        return;
+    }
+
+    if (!s_specification.isBatchWorker())
+    {
+        s_workspace = new Workspace();
+
+        if (s_specification.capture)
+            startFrameCapture();
+
+        return;
+    }
+
+    try
+    {
+        s_batchWorker = new BatchWorker(s_specification.batchWorkerSocketPath);
+    }
+    catch (std::exception& e)
+    {
+        Log::error(e.what());
+        s_exitCode = 1;
+    }
 }
 
 void Application::run()
 {
+    if (s_specification.loggingBenchmark)
+    {
+        Log::measureCallOverhead();
+        return;
+    }
+
+    if (s_specification.isBatchCoordinator())
+    {
+        BatchCoordinator batchCoordinator(s_commandLineArguments);
+        s_exitCode = batchCoordinator.run() ? 0 : 1;
+        return;
+    }
+
+    if (s_specification.isBatchWorker())
+    {
+        if (s_batchWorker)
+            s_batchWorker->run();
+
+        return;
+    }
+
+    if (s_specification.benchmark)
+    {
+        if (s_benchmark)
+            runBenchmark();
+
+        return;
+    }
+
+    if (s_specification.headless)
+    {
+        runHeadless();
+        return;
+    }
+
+    if (s_specification.renderThread)
+    {
+        runWithRenderThread();
+        return;
+    }
+
     while (s_running)
     {
         // Calculate the TimeStep (time between frames)
@@ -39,29 +160,95 @@ void Application::run()
 
         Log::trace("{0} FPS", 1.0f / ts);
 
+        Profiler::beginFrame();
+
         // Clear default framebuffer (what is presented to the user by GLFW) and then render new frame
            
         Renderer::bindDefaultFramebuffer();
         Renderer::clear();
 
+        {
+            PROFILE_GPU_SCOPE("Workspace update");
+            s_workspace->onUpdate(ts);
+            s_workspace->onDraw();
+        }
+
+        Renderer::endFrame();
+
+        // Update the window which presents the new frame to the user and processes any events. Swapping can block
+        // until the GPU catches up, so only the CPU is timed
+        {
+            PROFILE_SCOPE("Swap buffers and poll events");
+            s_window->onUpdate(ts);
+        }
+
+        Profiler::endFrame();
+    }
+}
+
+void Application::runWithRenderThread()
+{
+    s_renderThread = new RenderThread(*s_window);
+
+    // Events are processed and the workspace updated for the next frame while the render thread draws the last. The
+    // profiler follows the render thread, so nothing here is profiled
+    while (s_running)
+    {
+        float currentTime = s_window->getWindowTime();
+        TimeStep ts = currentTime - s_timeAtLastFrame;
+        s_timeAtLastFrame = currentTime;
+
+        Log::trace("{0} FPS", 1.0f / ts);
+
+        s_window->pollEvents();
         s_workspace->onUpdate(ts);
 
-        // Update the window which presents the new frame to the user and processes any events
-        s_window->onUpdate(ts);
+        // Waits for the render thread if it is a full snapshot behind
+        SceneSnapshot& snapshot = s_renderThread->beginSnapshot();
+        s_workspace->takeSnapshot(snapshot);
+        s_renderThread->submitSnapshot();
     }
+
+    // Draws the snapshots already submitted, and hands the context back to this thread for shutting down
+    delete s_renderThread;
+    s_renderThread = nullptr;
 }
 
 void Application::shutdown()
 {
+    if (!s_specification.needsRenderer())
+    {
+        Log::shutdown();
+        return;
+    }
+
+    // Captured frames still being written may be drawn by the workspace's renderer, so they are finished first
+    Renderer::stopFrameCapture();
+
     // Need to call the workspace destructor before shutting down the window (and rendering context)
     delete s_workspace;
+    delete s_batchWorker;
+    delete s_benchmark;
 
+    if (s_headlessFramebuffer)
+    {
+        RendererUtilities::setDefaultFramebufferRendererID(0);
+        delete s_headlessFramebuffer;
+    }
+
+    if (Profiler::isEnabled())
+        Profiler::exportChromeTrace(s_specification.profileFile);
+
+    Profiler::shutdown();
     Renderer::shutdown();
 
     // Need to call the window destructor before shutting down the whole windowing system
     delete s_window;
 
-    Window::shutdown();
+    if (!s_specification.headless)
+        Window::shutdown();
+
+    Log::shutdown();
 }
 
 void Application::onWindowCloseEvent()
@@ -69,13 +256,232 @@ void Application::onWindowCloseEvent()
     s_running = false;
 }
 
+void Application::submitRendererCommand(std::function<void()> command)
+{
+    if (s_renderThread)
+        s_renderThread->submitRendererCommand(std::move(command));
+    else
+        command();
+}
+
 void Application::onWindowResizeEvent(uint32_t width, uint32_t height)
 {
-    Renderer::onWindowResizeEvent(width, height);
-    s_workspace->onWindowResizeEvent(width, height);
+    submitRendererCommand([width, height]() { Renderer::onWindowResizeEvent(width, height); });
+
+    // There is no workspace while benchmarking
+    if (s_workspace)
+        s_workspace->onWindowResizeEvent(width, height);
 }
 
 void Application::onMouseScrollEvent(float xOffset, float yOffset)
 {
-    s_workspace->onMouseScrollEvent(xOffset, yOffset);
+    if (s_workspace)
+        s_workspace->onMouseScrollEvent(xOffset, yOffset);
+}
+
+void Application::parseCommandLineArguments(int argc, char** argv)
+{
+    for (int i = 1; i < argc; i++)
+        s_commandLineArguments.push_back(argv[i]);
+
+    for (int i = 1; i < argc; i++)
+    {
+        std::string argument = argv[i];
+        bool hasValue = i + 1 < argc;
+
+        if (argument == "--headless")
+            s_specification.headless = true;
+        else if (argument == "--width" && hasValue)
+            s_specification.width = std::max(std::stoul(argv[++i]), 1ul);
+        else if (argument == "--height" && hasValue)
+            s_specification.height = std::max(std::stoul(argv[++i]), 1ul);
+        else if (argument == "--frames" && hasValue)
+            s_specification.frameCount = std::stoul(argv[++i]);
+        else if (argument == "--output" && hasValue)
+            s_specification.outputDirectory = argv[++i];
+        else if (argument == "--format" && hasValue)
+        {
+            std::string format = argv[++i];
+
+            if (format == "png")
+                s_specification.outputFormat = ImageWriter::Format::PNG;
+            else if (format == "exr")
+                s_specification.outputFormat = ImageWriter::Format::EXR;
+            else if (format == "raw")
+                s_specification.outputFormat = ImageWriter::Format::RAW;
+            else
+                Log::warn("Unknown output format {0}, so frames are written as PNGs", format);
+        }
+        else if (argument == "--capture")
+            s_specification.capture = true;
+        else if (argument == "--capture-pipe" && hasValue)
+        {
+            s_specification.capture = true;
+            s_specification.capturePipeCommand = argv[++i];
+        }
+        else if (argument == "--capture-hdr")
+            s_specification.captureHDR = true;
+        else if (argument == "--capture-depth")
+            s_specification.captureDepth = true;
+        else if (argument == "--profile" && hasValue)
+            s_specification.profileFile = argv[++i];
+        else if (argument == "--benchmark")
+            s_specification.benchmark = true;
+        else if (argument == "--warm-up-frames" && hasValue)
+            s_specification.benchmarkWarmUpFrameCount = std::stoul(argv[++i]);
+        else if (argument == "--benchmark-frames" && hasValue)
+            s_specification.benchmarkFrameCount = std::max(std::stoul(argv[++i]), 1ul);
+        else if (argument == "--benchmark-report" && hasValue)
+            s_specification.benchmarkReportFile = argv[++i];
+        else if (argument == "--baseline" && hasValue)
+            s_specification.benchmarkBaselineFile = argv[++i];
+        else if (argument == "--regression-threshold" && hasValue)
+            s_specification.regressionThreshold = std::stof(argv[++i]);
+        else if (argument == "--single-threaded")
+            s_specification.renderThread = false;
+        else if (argument == "--benchmark-logging")
+            s_specification.loggingBenchmark = true;
+        else if (argument == "--batch")
+            s_specification.batch = true;
+        else if (argument == "--workers" && hasValue)
+            s_specification.workerCount = std::max(std::stoul(argv[++i]), 1ul);
+        else if (argument == "--shard-size" && hasValue)
+            s_specification.shardSize = std::max(std::stoul(argv[++i]), 1ul);
+        else if (argument == "--camera-path" && hasValue)
+            s_specification.cameraPathFile = argv[++i];
+        else if (argument == "--turntable" && hasValue)
+            s_specification.turntableFrameCount = std::stoul(argv[++i]);
+        else if (argument == "--scene" && hasValue)
+            s_specification.sceneName = argv[++i];
+        else if (argument == "--renderer" && hasValue)
+            s_specification.rendererName = argv[++i];
+        else if (argument == "--batch-worker" && hasValue)
+            s_specification.batchWorkerSocketPath = argv[++i];
+        else
+            Log::warn("Ignored unknown (or incomplete) command line argument {0}", argument);
+    }
+}
+
+void Application::runHeadless()
+{
+    std::error_code errorCode;
+    std::filesystem::create_directories(s_specification.outputDirectory, errorCode);
+
+    Log::info("Rendering {0} frames at {1}x{2} to {3}", s_specification.frameCount, s_specification.width, s_specification.height, s_specification.outputDirectory.string());
+
+    for (uint32_t frameIndex = 0; frameIndex < s_specification.frameCount && s_running; frameIndex++)
+    {
+        Profiler::beginFrame();
+
+        Renderer::bindDefaultFramebuffer();
+        Renderer::clear();
+
+        {
+            PROFILE_GPU_SCOPE("Workspace update");
+            s_workspace->onUpdate(HEADLESS_TIME_STEP);
+            s_workspace->onDraw();
+        }
+
+        Renderer::endFrame();
+
+        // Captured frames are read back and written without waiting for each one
+        bool frameWritten = true;
+        if (!Renderer::isFrameCaptureActive())
+        {
+            PROFILE_SCOPE("Write frame");
+            frameWritten = writeHeadlessFrame(s_specification.outputDirectory, frameIndex);
+        }
+
+        Profiler::endFrame();
+
+        if (!frameWritten)
+        {
+            s_exitCode = 1;
+            break;
+        }
+    }
+}
+
+void Application::runBenchmark()
+{
+    // Frames are a fixed time step apart, like headless frames, though only the camera path (driven by the frame index) moves
+    for (uint32_t frameIndex = 0; frameIndex < s_benchmark->getFrameCount() && s_running; frameIndex++)
+    {
+        Profiler::beginFrame();
+
+        Renderer::bindDefaultFramebuffer();
+        Renderer::clear();
+
+        s_benchmark->drawFrame(frameIndex);
+
+        Renderer::endFrame();
+
+        {
+            PROFILE_SCOPE("Swap buffers and poll events");
+            s_window->onUpdate(HEADLESS_TIME_STEP);
+        }
+
+        Profiler::endFrame();
+
+        s_benchmark->endFrame(frameIndex);
+    }
+
+    s_exitCode = s_benchmark->finish() ? 0 : 1;
+}
+
+bool Application::writeHeadlessFrame(const std::filesystem::path& directory, uint32_t frameIndex)
+{
+    std::filesystem::path filePath = directory / getFrameFileName(frameIndex);
+
+    uint32_t width = s_headlessFramebuffer->getRenderWidth();
+    uint32_t height = s_headlessFramebuffer->getRenderHeight();
+
+    try
+    {
+        std::vector<uint8_t> pixels;
+        s_headlessFramebuffer->readColorAttachment(pixels);
+
+        switch (s_specification.outputFormat)
+        {
+        case ImageWriter::Format::PNG:
+            ImageWriter::writePNG(filePath, width, height, pixels.data());
+            break;
+        case ImageWriter::Format::EXR:
+            // The frame has been gamma corrected for display, which EXRs (being linear) undo
+            ImageWriter::writeEXR(filePath, width, height, ImageWriter::decodeSRGB(width, height, pixels.data()).data());
+            break;
+        case ImageWriter::Format::RAW:
+            ImageWriter::writeRaw(filePath, width, height, pixels.data());
+            break;
+        default:
+            ASSERT_MESSAGE(false, "Unknown image format");
+            break;
+        }
+
+        Log::info("Wrote frame {0} to {1}", frameIndex, filePath.string());
+    }
+    catch (ImageWriter::ImageWriteException& e)
+    {
+        Log::error(e.what());
+        return false;
+    }
+
+    return true;
+}
+
+void Application::startFrameCapture()
+{
+    FrameCapture::CaptureSpecification captureSpecification;
+    captureSpecification.outputDirectory = s_specification.outputDirectory;
+    captureSpecification.format = s_specification.outputFormat;
+    captureSpecification.pipeCommand = s_specification.capturePipeCommand;
+    captureSpecification.captureHDR = s_specification.captureHDR;
+    captureSpecification.captureDepth = s_specification.captureDepth;
+
+    Renderer::startFrameCapture(captureSpecification);
+}
+
+std::string Application::getFrameFileName(uint32_t frameIndex)
+{
+    return ImageWriter::getSequenceFileName("frame", frameIndex, s_specification.outputFormat);
 }
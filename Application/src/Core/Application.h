@@ -3,13 +3,73 @@
 
 #include "Platform/Window.h"
 #include "Platform/Input.h"
+#include "Renderer/Framebuffer.h"
+#include "Renderer/ImageWriter.h"
 #include "Workspace.h"
 
+class BatchWorker;
+class Benchmark;
+class RenderThread;
+
 class Application
 {
+public:
+
+	// Set from the command line (see README.md)
+	struct ApplicationSpecification
+	{
+		uint32_t width = DEFAULT_WIDTH, height = DEFAULT_HEIGHT;
+
+		// Draws the workspace on a render thread of its own (see RenderThread), while the main thread handles events and
+		// updates the next frame. Only used with a window
+		bool renderThread = true;
+
+		// Renders a fixed number of frames without a window, writing each one to the output directory, and then exits
+		bool headless = false;
+		uint32_t frameCount = 1;
+		std::filesystem::path outputDirectory = "Output";
+		ImageWriter::Format outputFormat = ImageWriter::Format::PNG;
+
+		// Captures every frame without stalling on the read back (see FrameCapture), to the output directory or a pipe
+		bool capture = false;
+		std::string capturePipeCommand;
+		bool captureHDR = false;
+		bool captureDepth = false;
+
+		// Profiles every frame (see Profiler), and writes the most recent as a Chrome trace on exit
+		std::filesystem::path profileFile;
+
+		// Benchmarking draws a test scene along a camera path, and reports the frame times (see Benchmark)
+		bool benchmark = false;
+		uint32_t benchmarkWarmUpFrameCount = 120;
+		uint32_t benchmarkFrameCount = 600;
+		std::filesystem::path benchmarkReportFile = "benchmark.json";
+		std::filesystem::path benchmarkBaselineFile;
+		// Percentage that a frame time can be slower than the baseline's before it is a regression
+		float regressionThreshold = 5.0f;
+		// Measures what a log call costs (see Log::measureCallOverhead), and exits without creating a window
+		bool loggingBenchmark = false;
+
+		// Batch rendering splits the frames of a camera path across headless worker processes (see BatchCoordinator)
+		bool batch = false;
+		uint32_t workerCount = 4;
+		uint32_t shardSize = 8;
+		std::filesystem::path cameraPathFile;
+		uint32_t turntableFrameCount = 0;
+		std::string sceneName = "fresnel";
+		std::string rendererName = "pbr";
+		// Only set for the worker processes the coordinator starts
+		std::string batchWorkerSocketPath;
+
+		bool isBatchCoordinator() const { return batch && batchWorkerSocketPath.empty(); }
+		bool isBatchWorker() const { return !batchWorkerSocketPath.empty(); }
+		// The batch coordinator and the logging benchmark draw nothing
+		bool needsRenderer() const { return !isBatchCoordinator() && !loggingBenchmark; }
+	};
+
 public:
 	
-	static void init();
+	static void init(int argc = 0, char** argv = nullptr);
 
 	static void run();
 
@@ -21,11 +81,44 @@ public:
 
 	static const Window& getWindow() { return *s_window; }
 	static const Input& getInput() { return s_window->getInput(); }
+	static const ApplicationSpecification& getSpecification() { return s_specification; }
+
+	// For renderer calls made while updating, which need the OpenGL context. Made straight away without a render
+	// thread, or on the render thread before the next frame is drawn
+	static void submitRendererCommand(std::function<void()> command);
+	static int getExitCode() { return s_exitCode; }
+
+	// Reads the headless framebuffer back and writes it to the directory. Returns false if it couldn't be written
+	static bool writeHeadlessFrame(const std::filesystem::path& directory, uint32_t frameIndex);
+	static std::string getFrameFileName(uint32_t frameIndex);
+
+private:
+
+	static void parseCommandLineArguments(int argc, char** argv);
+
+	static void runWithRenderThread();
+	static void runHeadless();
+	static void runBenchmark();
+
+	static void startFrameCapture();
 
 private:
 	
+	static ApplicationSpecification s_specification;
+	// Without the executable's path
+	static std::vector<std::string> s_commandLineArguments;
+	static int s_exitCode;
 	static bool s_running;
 	static Window* s_window;
 	static float s_timeAtLastFrame;
 	static Workspace* s_workspace;
+
+	// What is drawn to in place of the window's default framebuffer when headless
+	static Framebuffer* s_headlessFramebuffer;
+	// Draws instead of the workspace in batch worker processes
+	static BatchWorker* s_batchWorker;
+	// Draws instead of the workspace when benchmarking
+	static Benchmark* s_benchmark;
+	// Only while running the workspace with a window
+	static RenderThread* s_renderThread;
 };
\ No newline at end of file
@@ -0,0 +1,436 @@
+#include "PCH.h"
+#include "BatchCoordinator.h"
+
+#include <thread>
+
+#if defined(PBR_LINUX)
+	#include <poll.h>
+#endif
+
+#include "Renderer/Renderer.h"
+#include "TestScenes/TestSceneFactory.h"
+
+// How long each wait for messages lasts, before checking on the workers again
+static constexpr int32_t POLL_TIMEOUT_MILLISECONDS = 250;
+
+static float getSecondsSince(std::chrono::steady_clock::time_point time)
+{
+	return std::chrono::duration<float>(std::chrono::steady_clock::now() - time).count();
+}
+
+BatchCoordinator::BatchCoordinator(const std::vector<std::string>& commandLineArguments)
+	: m_commandLineArguments(commandLineArguments)
+{
+	std::error_code errorCode;
+	std::filesystem::path temporaryDirectory = std::filesystem::temp_directory_path(errorCode);
+	if (errorCode)
+		temporaryDirectory = "/tmp";
+
+	m_socketPath = (temporaryDirectory / ("pbr-batch-" + std::to_string(Process::getCurrentProcessID()) + ".sock")).string();
+	m_stagingDirectory = getStagingDirectory(Application::getSpecification());
+}
+
+BatchCoordinator::~BatchCoordinator()
+{
+	// Workers still running (if the batch failed) are killed by their Process
+	m_workers.clear();
+	m_pendingConnections.clear();
+	m_listeningSocket.reset();
+
+	std::error_code errorCode;
+	std::filesystem::remove_all(m_stagingDirectory, errorCode);
+}
+
+bool BatchCoordinator::run()
+{
+	const Application::ApplicationSpecification& specification = Application::getSpecification();
+
+	if (!validateSpecification())
+		return false;
+
+	try
+	{
+		m_frameCount = createCameraPath(specification).getFrameCount();
+	}
+	catch (CameraPath::CameraPathCreationException& e)
+	{
+		Log::error(e.what());
+		return false;
+	}
+
+	uint32_t shardSize = std::max(specification.shardSize, 1u);
+	for (uint32_t firstFrameIndex = 0; firstFrameIndex < m_frameCount; firstFrameIndex += shardSize)
+	{
+		Shard shard;
+		shard.firstFrameIndex = firstFrameIndex;
+		shard.frameCount = std::min(shardSize, m_frameCount - firstFrameIndex);
+
+		m_pendingShardIndices.push_back(static_cast<uint32_t>(m_shards.size()));
+		m_shards.push_back(shard);
+	}
+
+	m_renderedFrames.assign(m_frameCount, false);
+	m_targetWorkerCount = std::clamp(specification.workerCount, 1u, std::max(static_cast<uint32_t>(m_shards.size()), 1u));
+
+	std::error_code errorCode;
+	std::filesystem::create_directories(specification.outputDirectory, errorCode);
+	std::filesystem::create_directories(m_stagingDirectory, errorCode);
+
+	Log::info("Batch rendering {0} frames in {1} shards, across {2} workers", m_frameCount, m_shards.size(), m_targetWorkerCount);
+
+	m_startTime = std::chrono::steady_clock::now();
+
+	try
+	{
+		m_listeningSocket = UnixSocket::listen(m_socketPath);
+
+		while (m_committedFrameCount < m_frameCount && !m_failed)
+		{
+			receiveMessages();
+			checkWorkers();
+			assignShards();
+		}
+	}
+	catch (UnixSocket::UnixSocketException& e)
+	{
+		Log::error(e.what());
+		m_failed = true;
+	}
+
+	// Idle workers exit when told to, and the rest are killed
+	for (Worker& worker : m_workers)
+	{
+		if (worker.connection && !m_failed)
+			worker.connection->sendMessage(EXIT_MESSAGE);
+		else
+			worker.process->kill();
+
+		worker.process->wait();
+	}
+
+	m_workers.clear();
+
+	if (m_failed)
+	{
+		Log::error("Batch render failed after {0} of {1} frames", m_committedFrameCount, m_frameCount);
+		return false;
+	}
+
+	float seconds = getSecondsSince(m_startTime);
+	Log::info("Batch rendered {0} frames in {1:.1f} s ({2:.2f} frames/s)", m_frameCount, seconds, static_cast<float>(m_frameCount) / seconds);
+
+	return true;
+}
+
+CameraPath BatchCoordinator::createCameraPath(const Application::ApplicationSpecification& specification)
+{
+	if (!specification.cameraPathFile.empty())
+		return CameraPath::loadFromFile(specification.cameraPathFile);
+
+	return CameraPath::createTurntable(specification.turntableFrameCount);
+}
+
+std::filesystem::path BatchCoordinator::getStagingDirectory(const Application::ApplicationSpecification& specification)
+{
+	return specification.outputDirectory / ".batch-staging";
+}
+
+bool BatchCoordinator::validateSpecification() const
+{
+	// Checked before starting any workers, as each of them would fail the same way
+	const Application::ApplicationSpecification& specification = Application::getSpecification();
+
+	TestSceneFactory::TestSceneIdentifier testSceneIdentifier;
+	if (!TestSceneFactory::getTestSceneIdentifier(specification.sceneName, testSceneIdentifier))
+	{
+		Log::error("Unknown test scene {0}", specification.sceneName);
+		return false;
+	}
+
+	Renderer::RendererType rendererType;
+	if (!Renderer::getRendererType(specification.rendererName, rendererType))
+	{
+		Log::error("Unknown renderer {0}", specification.rendererName);
+		return false;
+	}
+
+	if (specification.cameraPathFile.empty() && specification.turntableFrameCount == 0)
+	{
+		Log::error("Batch rendering needs a camera path (--camera-path) or a turntable frame count (--turntable)");
+		return false;
+	}
+
+	return true;
+}
+
+void BatchCoordinator::startWorker()
+{
+	std::vector<std::string> arguments = { Process::getCurrentExecutablePath() };
+	arguments.insert(arguments.end(), m_commandLineArguments.begin(), m_commandLineArguments.end());
+	arguments.push_back("--batch-worker");
+	arguments.push_back(m_socketPath);
+
+	std::vector<std::string> environmentVariables;
+	if (!std::getenv("LP_NUM_THREADS"))
+	{
+		uint32_t threadCount = std::max(std::thread::hardware_concurrency() / m_targetWorkerCount, 1u);
+		environmentVariables.push_back("LP_NUM_THREADS=" + std::to_string(threadCount));
+	}
+
+	Worker worker;
+
+	try
+	{
+		worker.process = Process::create(arguments, environmentVariables);
+	}
+	catch (Process::ProcessCreationException& e)
+	{
+		Log::error(e.what());
+		m_failed = true;
+		return;
+	}
+
+	worker.lastProgressTime = std::chrono::steady_clock::now();
+
+	m_workers.push_back(std::move(worker));
+	m_startedWorkerCount++;
+}
+
+void BatchCoordinator::receiveMessages()
+{
+#if defined(PBR_LINUX)
+	std::vector<pollfd> pollFileDescriptors;
+	pollFileDescriptors.push_back({ m_listeningSocket->getFileDescriptor(), POLLIN, 0 });
+
+	for (const Unique<UnixSocket>& connection : m_pendingConnections)
+		pollFileDescriptors.push_back({ connection->getFileDescriptor(), POLLIN, 0 });
+
+	for (const Worker& worker : m_workers)
+	{
+		if (worker.connection && !worker.disconnected)
+			pollFileDescriptors.push_back({ worker.connection->getFileDescriptor(), POLLIN, 0 });
+	}
+
+	if (poll(pollFileDescriptors.data(), pollFileDescriptors.size(), POLL_TIMEOUT_MILLISECONDS) <= 0)
+		return;
+
+	// The sockets are visited in the order they were polled in. Closed connections are also readable
+	size_t pollIndex = 1;
+
+	std::vector<Unique<UnixSocket>> pendingConnections = std::move(m_pendingConnections);
+	m_pendingConnections.clear();
+
+	for (Unique<UnixSocket>& connection : pendingConnections)
+	{
+		bool readable = pollFileDescriptors[pollIndex++].revents != 0;
+		if (readable && !connection->receiveAvailable())
+			continue;
+
+		std::string message;
+		if (connection->popMessage(message))
+			onConnectionReady(std::move(connection), message);
+		else
+			m_pendingConnections.push_back(std::move(connection));
+	}
+
+	for (Worker& worker : m_workers)
+	{
+		if (!worker.connection || worker.disconnected)
+			continue;
+
+		bool readable = pollFileDescriptors[pollIndex++].revents != 0;
+		if (readable && !worker.connection->receiveAvailable())
+			worker.disconnected = true;
+
+		std::string message;
+		while (worker.connection->popMessage(message))
+			handleMessage(worker, message);
+	}
+
+	if (pollFileDescriptors[0].revents != 0)
+	{
+		while (Unique<UnixSocket> connection = m_listeningSocket->accept())
+			m_pendingConnections.push_back(std::move(connection));
+	}
+#endif
+}
+
+void BatchCoordinator::onConnectionReady(Unique<UnixSocket> connection, const std::string& message)
+{
+	std::istringstream messageStream(message);
+	std::string messageType;
+	int32_t processID = -1;
+	messageStream >> messageType >> processID;
+
+	auto worker = std::find_if(m_workers.begin(), m_workers.end(), [processID](const Worker& worker)
+	{
+		return worker.process->getProcessID() == processID && !worker.connection;
+	});
+
+	if (messageType != READY_MESSAGE || worker == m_workers.end())
+	{
+		Log::warn("Closed a connection that isn't from a batch worker ({0})", message);
+		return;
+	}
+
+	worker->connection = std::move(connection);
+	worker->lastProgressTime = std::chrono::steady_clock::now();
+
+	// The remaining workers can now be started without each precomputing the asset caches
+	m_assetCachesWarm = true;
+
+	Log::info("Batch worker {0} is ready", processID);
+
+	// Any messages that arrived along with the first
+	std::string nextMessage;
+	while (worker->connection->popMessage(nextMessage))
+		handleMessage(*worker, nextMessage);
+}
+
+void BatchCoordinator::handleMessage(Worker& worker, const std::string& message)
+{
+	std::istringstream messageStream(message);
+	std::string messageType;
+	uint32_t index = 0;
+	messageStream >> messageType >> index;
+
+	worker.lastProgressTime = std::chrono::steady_clock::now();
+
+	if (messageType == FRAME_MESSAGE && index < m_frameCount)
+		onFrameRendered(index);
+	else if (messageType == DONE_MESSAGE && static_cast<int32_t>(index) == worker.shardIndex)
+		worker.shardIndex = -1;
+	else if (messageType == FAILED_MESSAGE && static_cast<int32_t>(index) == worker.shardIndex)
+	{
+		Log::warn("Batch worker {0} failed to render shard {1}", worker.process->getProcessID(), index);
+
+		worker.shardIndex = -1;
+		retryShard(index);
+	}
+	else
+		Log::warn("Ignored unexpected message from batch worker {0} ({1})", worker.process->getProcessID(), message);
+}
+
+void BatchCoordinator::checkWorkers()
+{
+	for (auto worker = m_workers.begin(); worker != m_workers.end();)
+	{
+		bool busy = worker->shardIndex >= 0;
+		float timeout = worker->connection ? WORKER_FRAME_TIMEOUT : WORKER_STARTUP_TIMEOUT;
+		bool stuck = (busy || !worker->connection) && getSecondsSince(worker->lastProgressTime) > timeout;
+
+		if (worker->process->isRunning() && !worker->disconnected && !stuck)
+		{
+			++worker;
+			continue;
+		}
+
+		if (stuck)
+			Log::warn("Batch worker {0} made no progress for {1:.0f} s, so it is being stopped", worker->process->getProcessID(), timeout);
+		else
+			Log::warn("Lost batch worker {0}", worker->process->getProcessID());
+
+		worker->process->kill();
+		worker->process->wait();
+
+		if (busy)
+			retryShard(static_cast<uint32_t>(worker->shardIndex));
+
+		worker = m_workers.erase(worker);
+	}
+
+	// Until the first worker is ready, it is the only one, so the asset caches are only precomputed once
+	uint32_t wantedWorkerCount = m_assetCachesWarm ? m_targetWorkerCount : 1;
+
+	while (m_workers.size() < wantedWorkerCount && !m_pendingShardIndices.empty() && !m_failed)
+	{
+		if (m_startedWorkerCount >= m_targetWorkerCount + MAX_WORKER_RESTART_COUNT)
+		{
+			if (m_workers.empty())
+			{
+				Log::error("Too many batch workers have been lost, so no more are started");
+				m_failed = true;
+			}
+
+			break;
+		}
+
+		startWorker();
+	}
+}
+
+void BatchCoordinator::assignShards()
+{
+	for (Worker& worker : m_workers)
+	{
+		if (m_pendingShardIndices.empty())
+			return;
+
+		if (!worker.connection || worker.disconnected || worker.shardIndex >= 0)
+			continue;
+
+		uint32_t shardIndex = m_pendingShardIndices.front();
+		const Shard& shard = m_shards[shardIndex];
+
+		std::string message = std::string(SHARD_MESSAGE) + " " + std::to_string(shardIndex) + " " + std::to_string(shard.firstFrameIndex) + " " + std::to_string(shard.frameCount);
+		if (!worker.connection->sendMessage(message))
+		{
+			worker.disconnected = true;
+			continue;
+		}
+
+		m_pendingShardIndices.pop_front();
+		worker.shardIndex = static_cast<int32_t>(shardIndex);
+		worker.lastProgressTime = std::chrono::steady_clock::now();
+
+		Log::trace("Sent shard {0} (frames {1} to {2}) to batch worker {3}", shardIndex, shard.firstFrameIndex, shard.firstFrameIndex + shard.frameCount - 1, worker.process->getProcessID());
+	}
+}
+
+void BatchCoordinator::onFrameRendered(uint32_t frameIndex)
+{
+	const std::filesystem::path& outputDirectory = Application::getSpecification().outputDirectory;
+
+	m_renderedFrames[frameIndex] = true;
+
+	uint32_t previousCommittedFrameCount = m_committedFrameCount;
+
+	while (m_committedFrameCount < m_frameCount && m_renderedFrames[m_committedFrameCount])
+	{
+		std::string fileName = Application::getFrameFileName(m_committedFrameCount);
+
+		std::error_code errorCode;
+		std::filesystem::rename(m_stagingDirectory / fileName, outputDirectory / fileName, errorCode);
+
+		if (errorCode)
+		{
+			Log::error("Could not move frame {0} to {1}: {2}", m_committedFrameCount, outputDirectory.string(), errorCode.message());
+			m_failed = true;
+			return;
+		}
+
+		m_committedFrameCount++;
+	}
+
+	if (m_committedFrameCount != previousCommittedFrameCount)
+	{
+		Log::info("Batch rendered {0}/{1} frames ({2:.2f} frames/s)", m_committedFrameCount, m_frameCount,
+			static_cast<float>(m_committedFrameCount) / getSecondsSince(m_startTime));
+	}
+}
+
+void BatchCoordinator::retryShard(uint32_t shardIndex)
+{
+	Shard& shard = m_shards[shardIndex];
+	shard.attemptCount++;
+
+	if (shard.attemptCount >= MAX_SHARD_ATTEMPT_COUNT)
+	{
+		Log::error("Shard {0} (frames {1} to {2}) failed {3} times", shardIndex, shard.firstFrameIndex, shard.firstFrameIndex + shard.frameCount - 1, shard.attemptCount);
+		m_failed = true;
+		return;
+	}
+
+	// Retried first, as the frames after it can't be moved to the output until it is done
+	m_pendingShardIndices.push_front(shardIndex);
+}
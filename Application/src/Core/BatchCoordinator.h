@@ -0,0 +1,130 @@
+#pragma once
+#include "PCH.h"
+
+#include <chrono>
+#include <deque>
+
+#include "Application.h"
+#include "Platform/Process.h"
+#include "Platform/UnixSocket.h"
+#include "Scene/CameraPath.h"
+
+/*
+Renders every frame of a camera path by splitting the frames into shards (runs of consecutive frames) and handing the
+shards out to headless worker processes, each with its own OpenGL context (see BatchWorker). The coordinator itself
+creates no context.
+
+Workers are started from this executable, with the coordinator's command line plus --batch-worker, and talk to the
+coordinator over a Unix socket in lines of text:
+	- READY <processID>, from a worker once its scene is loaded
+	- SHARD <shardIndex> <firstFrameIndex> <frameCount>, from the coordinator
+	- FRAME <frameIndex>, from a worker once a frame has been written to the staging directory
+	- DONE <shardIndex> or FAILED <shardIndex>, from a worker once a shard is finished
+	- EXIT, from the coordinator
+
+Only one worker is started until it is ready, so that it alone precomputes any asset caches, which the rest then
+share. A shard is retried if its worker reports a failure, exits, or stops making progress, and workers that are lost
+are replaced. Frames are moved from the staging directory into the output directory in order, so the output is
+always the start of the sequence without gaps.
+
+With Mesa's llvmpipe each worker is limited to its share of the cores (unless LP_NUM_THREADS is already set), so
+throughput scales with the number of workers rather than them competing for the same cores.
+*/
+class BatchCoordinator
+{
+public:
+
+	static constexpr const char* READY_MESSAGE = "READY";
+	static constexpr const char* SHARD_MESSAGE = "SHARD";
+	static constexpr const char* FRAME_MESSAGE = "FRAME";
+	static constexpr const char* DONE_MESSAGE = "DONE";
+	static constexpr const char* FAILED_MESSAGE = "FAILED";
+	static constexpr const char* EXIT_MESSAGE = "EXIT";
+
+	// A shard failing this many times fails the whole batch, as it is most likely the frames rather than the workers
+	static constexpr uint32_t MAX_SHARD_ATTEMPT_COUNT = 3;
+	// How many lost workers are replaced, over the whole batch
+	static constexpr uint32_t MAX_WORKER_RESTART_COUNT = 8;
+
+	// Seconds a worker can go without progress before it is killed. Starting up can include precomputing asset caches
+	static constexpr float WORKER_STARTUP_TIMEOUT = 600.0f;
+	static constexpr float WORKER_FRAME_TIMEOUT = 120.0f;
+
+public:
+
+	BatchCoordinator() = delete;
+	// The arguments are passed on to the workers, so exclude the executable's path
+	BatchCoordinator(const std::vector<std::string>& commandLineArguments);
+	~BatchCoordinator();
+	BatchCoordinator(const BatchCoordinator&) = delete;
+
+	// Returns false if the batch could not be completed
+	bool run();
+
+	// The camera path (or turntable) given on the command line, which the coordinator and workers all create
+	static CameraPath createCameraPath(const Application::ApplicationSpecification& specification);
+	// Where workers write frames, before they are moved to the output directory in order
+	static std::filesystem::path getStagingDirectory(const Application::ApplicationSpecification& specification);
+
+private:
+
+	struct Shard
+	{
+		uint32_t firstFrameIndex = 0;
+		uint32_t frameCount = 0;
+		uint32_t attemptCount = 0;
+	};
+
+	struct Worker
+	{
+		Unique<Process> process;
+		// Set once the worker has connected and said it is ready
+		Unique<UnixSocket> connection;
+		bool disconnected = false;
+
+		int32_t shardIndex = -1;
+		std::chrono::steady_clock::time_point lastProgressTime;
+	};
+
+private:
+
+	bool validateSpecification() const;
+
+	void startWorker();
+
+	void receiveMessages();
+	void onConnectionReady(Unique<UnixSocket> connection, const std::string& message);
+	void handleMessage(Worker& worker, const std::string& message);
+
+	void checkWorkers();
+	void assignShards();
+
+	void onFrameRendered(uint32_t frameIndex);
+	void retryShard(uint32_t shardIndex);
+
+private:
+
+	std::vector<std::string> m_commandLineArguments;
+	std::string m_socketPath;
+	std::filesystem::path m_stagingDirectory;
+
+	Unique<UnixSocket> m_listeningSocket;
+	// Connections that haven't said which worker they are yet
+	std::vector<Unique<UnixSocket>> m_pendingConnections;
+	std::vector<Worker> m_workers;
+
+	uint32_t m_targetWorkerCount = 1;
+	uint32_t m_startedWorkerCount = 0;
+	// Set once the first worker is ready, as its scene (and so the asset caches) has then been loaded
+	bool m_assetCachesWarm = false;
+
+	std::vector<Shard> m_shards;
+	std::deque<uint32_t> m_pendingShardIndices;
+
+	uint32_t m_frameCount = 0;
+	std::vector<bool> m_renderedFrames;
+	uint32_t m_committedFrameCount = 0;
+
+	bool m_failed = false;
+	std::chrono::steady_clock::time_point m_startTime;
+};
@@ -0,0 +1,92 @@
+#include "PCH.h"
+#include "BatchWorker.h"
+
+#include "Application.h"
+#include "BatchCoordinator.h"
+#include "Platform/Process.h"
+#include "Renderer/Renderer.h"
+#include "TestScenes/TestSceneFactory.h"
+
+BatchWorker::BatchWorker(const std::string& socketPath)
+	: m_cameraPath(BatchCoordinator::createCameraPath(Application::getSpecification())),
+	  m_camera(static_cast<float>(Application::getSpecification().width) / static_cast<float>(Application::getSpecification().height))
+{
+	const Application::ApplicationSpecification& specification = Application::getSpecification();
+
+	TestSceneFactory::TestSceneIdentifier testSceneIdentifier;
+	if (!TestSceneFactory::getTestSceneIdentifier(specification.sceneName, testSceneIdentifier))
+		throw BatchWorkerCreationException("Unknown test scene " + specification.sceneName);
+
+	Renderer::RendererType rendererType;
+	if (!Renderer::getRendererType(specification.rendererName, rendererType))
+		throw BatchWorkerCreationException("Unknown renderer " + specification.rendererName);
+
+	m_testScene = TestSceneFactory::create(testSceneIdentifier);
+	m_scene = rendererType == Renderer::RendererType::BLINN_PHONG ? static_cast<Reference<Scene>>(m_testScene->getBlinnPhongScene()) : m_testScene->getPBRScene();
+
+	Renderer::setRendererType(rendererType);
+	// Frames must look the same whichever worker renders them, and however busy the machine is
+	Renderer::setDynamicResolutionEnabled(false);
+
+	m_socket = UnixSocket::connect(socketPath);
+}
+
+void BatchWorker::run()
+{
+	// Only sent once the scene is loaded, so the coordinator knows any asset caches have been written
+	m_socket->sendMessage(std::string(BatchCoordinator::READY_MESSAGE) + " " + std::to_string(Process::getCurrentProcessID()));
+
+	std::string message;
+	while (m_socket->receiveMessage(message))
+	{
+		std::istringstream messageStream(message);
+		std::string messageType;
+		messageStream >> messageType;
+
+		if (messageType == BatchCoordinator::EXIT_MESSAGE)
+			return;
+
+		if (messageType != BatchCoordinator::SHARD_MESSAGE)
+		{
+			Log::warn("Ignored unknown batch message {0}", message);
+			continue;
+		}
+
+		uint32_t shardIndex, firstFrameIndex, frameCount;
+		messageStream >> shardIndex >> firstFrameIndex >> frameCount;
+
+		bool rendered = messageStream && renderShard(firstFrameIndex, frameCount);
+		m_socket->sendMessage(std::string(rendered ? BatchCoordinator::DONE_MESSAGE : BatchCoordinator::FAILED_MESSAGE) + " " + std::to_string(shardIndex));
+	}
+
+	Log::warn("Lost the connection to the batch coordinator");
+}
+
+bool BatchWorker::renderShard(uint32_t firstFrameIndex, uint32_t frameCount)
+{
+	const std::filesystem::path stagingDirectory = BatchCoordinator::getStagingDirectory(Application::getSpecification());
+
+	for (uint32_t frameIndex = firstFrameIndex; frameIndex < firstFrameIndex + frameCount; frameIndex++)
+	{
+		if (frameIndex >= m_cameraPath.getFrameCount())
+			return false;
+
+		const CameraPath::CameraPose& pose = m_cameraPath.getPose(frameIndex);
+		m_camera.setPose(pose.position, pose.focusPoint, pose.verticalFieldOfView);
+
+		Renderer::bindDefaultFramebuffer();
+		Renderer::clear();
+
+		Renderer::drawScene(m_scene, m_camera);
+
+		Renderer::endFrame();
+
+		if (!Application::writeHeadlessFrame(stagingDirectory, frameIndex))
+			return false;
+
+		// Also tells the coordinator the worker is still making progress
+		m_socket->sendMessage(std::string(BatchCoordinator::FRAME_MESSAGE) + " " + std::to_string(frameIndex));
+	}
+
+	return true;
+}
@@ -0,0 +1,56 @@
+#pragma once
+#include "PCH.h"
+
+#include "Platform/UnixSocket.h"
+#include "Renderer/PoseCamera.h"
+#include "Scene/CameraPath.h"
+#include "TestScenes/TestScene.h"
+
+/*
+Renders the shards of a batch render that a BatchCoordinator hands out, in a headless worker process.
+
+The scene, renderer and camera path come from the command line the worker was started with (the coordinator's own),
+so every worker loads the same ones. Frames are written to the coordinator's staging directory, and each is reported
+once it is on disk.
+*/
+class BatchWorker
+{
+public:
+
+	struct BatchWorkerCreationException : public std::exception
+	{
+		std::string errorMessage;
+
+		BatchWorkerCreationException(const std::string errorMessage)
+			: errorMessage("BatchWorkerCreationException Occured: " + errorMessage) {}
+
+		const char* what() const noexcept override
+		{
+			return errorMessage.c_str();
+		}
+	};
+
+public:
+
+	BatchWorker() = delete;
+	// Throws if the scene, renderer or camera path are unknown, or the coordinator can't be connected to
+	BatchWorker(const std::string& socketPath);
+	BatchWorker(const BatchWorker&) = delete;
+
+	// Returns once the coordinator says to exit, or closes the connection
+	void run();
+
+private:
+
+	bool renderShard(uint32_t firstFrameIndex, uint32_t frameCount);
+
+private:
+
+	Unique<UnixSocket> m_socket;
+
+	Reference<TestScene> m_testScene;
+	Reference<Scene> m_scene;
+
+	CameraPath m_cameraPath;
+	PoseCamera m_camera;
+};
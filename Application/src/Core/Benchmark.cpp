@@ -0,0 +1,307 @@
+#include "PCH.h"
+#include "Benchmark.h"
+
+#include "glad/glad.h"
+
+#include "BatchCoordinator.h"
+#include "Profiler.h"
+#include "Renderer/Renderer.h"
+#include "TestScenes/TestSceneFactory.h"
+
+// The frame time statistics compared against a baseline
+static const std::array<const char*, 4> COMPARED_STATISTICS = { "mean", "p50", "p95", "p99" };
+
+Benchmark::Benchmark(const Application::ApplicationSpecification& specification)
+	: m_specification(specification),
+	  m_camera(static_cast<float>(specification.width) / static_cast<float>(specification.height)),
+	  m_warmUpFrameCount(specification.benchmarkWarmUpFrameCount),
+	  m_measuredFrameCount(std::max(specification.benchmarkFrameCount, 1u)),
+	  m_profilerWasEnabled(Profiler::isEnabled())
+{
+	TestSceneFactory::TestSceneIdentifier testSceneIdentifier;
+	if (!TestSceneFactory::getTestSceneIdentifier(specification.sceneName, testSceneIdentifier))
+		throw BenchmarkCreationException("Unknown test scene " + specification.sceneName);
+
+	Renderer::RendererType rendererType;
+	if (!Renderer::getRendererType(specification.rendererName, rendererType))
+		throw BenchmarkCreationException("Unknown renderer " + specification.rendererName);
+
+	// Without a camera path, the camera circles the scene once over the measured frames
+	try
+	{
+		if (specification.cameraPathFile.empty() && specification.turntableFrameCount == 0)
+			m_cameraPath = CameraPath::createTurntable(m_measuredFrameCount);
+		else
+			m_cameraPath = BatchCoordinator::createCameraPath(specification);
+	}
+	catch (CameraPath::CameraPathCreationException& e)
+	{
+		throw BenchmarkCreationException(e.what());
+	}
+
+	if (m_cameraPath.getFrameCount() == 0)
+		throw BenchmarkCreationException("The camera path has no poses");
+
+	m_testScene = TestSceneFactory::create(testSceneIdentifier);
+	m_scene = rendererType == Renderer::RendererType::BLINN_PHONG ? static_cast<Reference<Scene>>(m_testScene->getBlinnPhongScene()) : m_testScene->getPBRScene();
+
+	Renderer::setRendererType(rendererType);
+	// The render scale would otherwise depend on how the previous frames went
+	Renderer::setDynamicResolutionEnabled(false);
+
+	m_CPUFrameTimes.reserve(m_measuredFrameCount);
+	m_GPUFrameTimes.reserve(m_measuredFrameCount);
+	m_frameStatistics.reserve(m_measuredFrameCount);
+
+	// Frame times are measured by the profiler
+	Profiler::setEnabled(true);
+
+	Log::info("Benchmarking the {0} scene with the {1} renderer: {2} warm-up frames, then {3} measured frames", specification.sceneName, specification.rendererName, m_warmUpFrameCount, m_measuredFrameCount);
+}
+
+void Benchmark::drawFrame(uint32_t frameIndex)
+{
+	if (frameIndex == m_warmUpFrameCount)
+		m_firstMeasuredProfilerFrame = Profiler::getFrameIndex();
+
+	const CameraPath::CameraPose& pose = m_cameraPath.getPose(frameIndex % m_cameraPath.getFrameCount());
+	m_camera.setPose(pose.position, pose.focusPoint, pose.verticalFieldOfView);
+
+	Renderer::drawScene(m_scene, m_camera);
+}
+
+void Benchmark::endFrame(uint32_t frameIndex)
+{
+	// Frames are profiled a few frames late, so they are collected as they arrive rather than all at the end, when the
+	// profiler may no longer have the first of them
+	if (frameIndex >= m_warmUpFrameCount)
+	{
+		m_frameStatistics.push_back(FrameStatistics::getLastFrame());
+		collectProfiledFrames();
+	}
+}
+
+bool Benchmark::finish()
+{
+	// Disabling the profiler waits for the frames still in flight
+	Profiler::setEnabled(false);
+	collectProfiledFrames();
+
+	if (m_profilerWasEnabled)
+		Profiler::setEnabled(true);
+
+	if (m_CPUFrameTimes.empty())
+	{
+		Log::error("No frames were measured");
+		return false;
+	}
+
+	if (m_CPUFrameTimes.size() < m_measuredFrameCount)
+		Log::warn("Only {0} of the {1} frames were measured", m_CPUFrameTimes.size(), m_measuredFrameCount);
+
+	if (!writeReport(m_specification.benchmarkReportFile))
+		return false;
+
+	if (m_specification.benchmarkBaselineFile.empty())
+		return true;
+
+	return compareAgainstBaseline(m_specification.benchmarkBaselineFile);
+}
+
+void Benchmark::collectProfiledFrames()
+{
+	const std::deque<Profiler::FrameRecord>& frames = Profiler::getRecordedFrames();
+
+	auto firstUncollectedFrame = std::partition_point(frames.begin(), frames.end(), [this](const Profiler::FrameRecord& frame)
+	{
+		return frame.frameIndex < m_nextProfilerFrameToCollect;
+	});
+
+	for (auto frame = firstUncollectedFrame; frame != frames.end(); frame++)
+	{
+		m_nextProfilerFrameToCollect = frame->frameIndex + 1;
+
+		if (frame->frameIndex < m_firstMeasuredProfilerFrame || frame->frameIndex - m_firstMeasuredProfilerFrame >= m_measuredFrameCount)
+			continue;
+
+		m_CPUFrameTimes.push_back(frame->getCPUFrameTime());
+		m_GPUFrameTimes.push_back(frame->getGPUFrameTime());
+	}
+}
+
+bool Benchmark::writeReport(const std::filesystem::path& filePath) const
+{
+	FrameTimeSummary CPUFrameTime = summarise(m_CPUFrameTimes);
+	FrameTimeSummary GPUFrameTime = summarise(m_GPUFrameTimes);
+
+	// Min, mean and max of a counter over the measured frames
+	auto summariseCounter = [this](auto FrameStatistics::Counters::* counter)
+	{
+		uint64_t min = std::numeric_limits<uint64_t>::max();
+		uint64_t max = 0;
+		uint64_t sum = 0;
+
+		for (const FrameStatistics::Counters& frame : m_frameStatistics)
+		{
+			uint64_t value = static_cast<uint64_t>(frame.*counter);
+			min = std::min(min, value);
+			max = std::max(max, value);
+			sum += value;
+		}
+
+		return std::make_tuple(min, static_cast<float>(sum) / static_cast<float>(m_frameStatistics.size()), max);
+	};
+
+	auto [minDrawCallCount, meanDrawCallCount, maxDrawCallCount] = summariseCounter(&FrameStatistics::Counters::drawCalls);
+	auto [minTriangleCount, meanTriangleCount, maxTriangleCount] = summariseCounter(&FrameStatistics::Counters::triangles);
+
+	std::ofstream outputFileStream(filePath, std::ios::trunc);
+	if (!outputFileStream)
+	{
+		Log::error("Could not write the benchmark report to {0}", filePath.string());
+		return false;
+	}
+
+	auto writeFrameTimeSummary = [&outputFileStream](const char* name, const FrameTimeSummary& summary)
+	{
+		outputFileStream << "\t\"" << name << "\": { \"min\": " << summary.min << ", \"mean\": " << summary.mean
+			<< ", \"p50\": " << summary.p50 << ", \"p95\": " << summary.p95 << ", \"p99\": " << summary.p99 << " },\n";
+	};
+
+	// Quotes are dropped from the device's name, so that it needs no escaping
+	std::string device = reinterpret_cast<const char*>(glGetString(GL_RENDERER));
+	device.erase(std::remove(device.begin(), device.end(), '"'), device.end());
+
+	outputFileStream << std::fixed << std::setprecision(3);
+	outputFileStream << "{\n";
+	outputFileStream << "\t\"scene\": \"" << m_specification.sceneName << "\",\n";
+	outputFileStream << "\t\"renderer\": \"" << m_specification.rendererName << "\",\n";
+	outputFileStream << "\t\"device\": \"" << device << "\",\n";
+	outputFileStream << "\t\"width\": " << m_specification.width << ",\n";
+	outputFileStream << "\t\"height\": " << m_specification.height << ",\n";
+	outputFileStream << "\t\"warmUpFrames\": " << m_warmUpFrameCount << ",\n";
+	outputFileStream << "\t\"measuredFrames\": " << m_CPUFrameTimes.size() << ",\n";
+	writeFrameTimeSummary("CPUFrameTime", CPUFrameTime);
+	writeFrameTimeSummary("GPUFrameTime", GPUFrameTime);
+	outputFileStream << "\t\"drawCalls\": { \"min\": " << minDrawCallCount << ", \"mean\": " << meanDrawCallCount << ", \"max\": " << maxDrawCallCount << " },\n";
+	outputFileStream << "\t\"triangles\": { \"min\": " << minTriangleCount << ", \"mean\": " << meanTriangleCount << ", \"max\": " << maxTriangleCount << " }\n";
+	outputFileStream << "}\n";
+
+	if (!outputFileStream)
+	{
+		Log::error("Could not write the benchmark report to {0}", filePath.string());
+		return false;
+	}
+
+	Log::info("CPU frame time (ms): min {0:.3f}, mean {1:.3f}, p50 {2:.3f}, p95 {3:.3f}, p99 {4:.3f}", CPUFrameTime.min, CPUFrameTime.mean, CPUFrameTime.p50, CPUFrameTime.p95, CPUFrameTime.p99);
+	Log::info("GPU frame time (ms): min {0:.3f}, mean {1:.3f}, p50 {2:.3f}, p95 {3:.3f}, p99 {4:.3f}", GPUFrameTime.min, GPUFrameTime.mean, GPUFrameTime.p50, GPUFrameTime.p95, GPUFrameTime.p99);
+	Log::info("Draw calls: min {0}, mean {1:.1f}, max {2}", minDrawCallCount, meanDrawCallCount, maxDrawCallCount);
+	Log::info("Triangles: min {0}, mean {1:.1f}, max {2}", minTriangleCount, meanTriangleCount, maxTriangleCount);
+	Log::info("Wrote the benchmark report to {0}", filePath.string());
+
+	return true;
+}
+
+bool Benchmark::compareAgainstBaseline(const std::filesystem::path& baselineFilePath) const
+{
+	std::ifstream inputFileStream(baselineFilePath);
+	if (!inputFileStream)
+	{
+		Log::error("Could not read the benchmark baseline {0}", baselineFilePath.string());
+		return false;
+	}
+
+	std::stringstream baselineStream;
+	baselineStream << inputFileStream.rdbuf();
+	std::string baseline = baselineStream.str();
+
+	FrameTimeSummary CPUFrameTime = summarise(m_CPUFrameTimes);
+	FrameTimeSummary GPUFrameTime = summarise(m_GPUFrameTimes);
+
+	auto getStatistic = [](const FrameTimeSummary& summary, const std::string& statistic)
+	{
+		if (statistic == "mean") return summary.mean;
+		if (statistic == "p50")  return summary.p50;
+		if (statistic == "p95")  return summary.p95;
+		return summary.p99;
+	};
+
+	float threshold = m_specification.regressionThreshold / 100.0f;
+	uint32_t regressionCount = 0;
+
+	for (const auto& [section, summary] : { std::make_pair("CPUFrameTime", CPUFrameTime), std::make_pair("GPUFrameTime", GPUFrameTime) })
+	{
+		for (const char* statistic : COMPARED_STATISTICS)
+		{
+			float baselineValue;
+			if (!readReportValue(baseline, section, statistic, baselineValue))
+			{
+				Log::error("The benchmark baseline {0} has no {1} {2}", baselineFilePath.string(), section, statistic);
+				return false;
+			}
+
+			float value = getStatistic(summary, statistic);
+			float change = baselineValue > 0.0f ? value / baselineValue - 1.0f : 0.0f;
+
+			if (change > threshold)
+			{
+				Log::error("Regression in {0} {1}: {2:.3f} ms against a baseline of {3:.3f} ms ({4:+.1f}%)", section, statistic, value, baselineValue, change * 100.0f);
+				regressionCount++;
+			}
+			else
+				Log::info("{0} {1}: {2:.3f} ms against a baseline of {3:.3f} ms ({4:+.1f}%)", section, statistic, value, baselineValue, change * 100.0f);
+		}
+	}
+
+	if (regressionCount > 0)
+	{
+		Log::error("{0} frame times regressed by more than {1:.1f}% against {2}", regressionCount, m_specification.regressionThreshold, baselineFilePath.string());
+		return false;
+	}
+
+	Log::info("No frame times regressed by more than {0:.1f}% against {1}", m_specification.regressionThreshold, baselineFilePath.string());
+
+	return true;
+}
+
+Benchmark::FrameTimeSummary Benchmark::summarise(std::vector<float> frameTimes)
+{
+	FrameTimeSummary summary;
+	if (frameTimes.empty())
+		return summary;
+
+	std::sort(frameTimes.begin(), frameTimes.end());
+
+	// Nearest rank, so every percentile is a frame time that was actually measured
+	auto getPercentile = [&frameTimes](float percentile)
+	{
+		size_t rank = static_cast<size_t>(std::ceil(percentile / 100.0f * static_cast<float>(frameTimes.size())));
+		return frameTimes[std::clamp(rank, size_t(1), frameTimes.size()) - 1];
+	};
+
+	summary.min = frameTimes.front();
+	summary.mean = std::accumulate(frameTimes.begin(), frameTimes.end(), 0.0f) / static_cast<float>(frameTimes.size());
+	summary.p50 = getPercentile(50.0f);
+	summary.p95 = getPercentile(95.0f);
+	summary.p99 = getPercentile(99.0f);
+
+	return summary;
+}
+
+bool Benchmark::readReportValue(const std::string& report, const std::string& section, const std::string& statistic, float& value)
+{
+	size_t sectionStart = report.find("\"" + section + "\"");
+	if (sectionStart == std::string::npos)
+		return false;
+
+	size_t sectionEnd = report.find('}', sectionStart);
+	size_t statisticStart = report.find("\"" + statistic + "\":", sectionStart);
+	if (statisticStart == std::string::npos || statisticStart > sectionEnd)
+		return false;
+
+	const char* valueStart = report.c_str() + statisticStart + statistic.size() + 3;
+	char* valueEnd;
+	value = std::strtof(valueStart, &valueEnd);
+
+	return valueEnd != valueStart;
+}
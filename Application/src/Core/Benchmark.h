@@ -0,0 +1,100 @@
+#pragma once
+#include "PCH.h"
+
+#include "Application.h"
+#include "Renderer/FrameStatistics.h"
+#include "Renderer/PoseCamera.h"
+#include "Scene/CameraPath.h"
+#include "TestScenes/TestScene.h"
+
+/*
+Measures the frame times of a test scene, drawn by one renderer along a camera path, so that runs can be repeated and
+compared.
+
+Every run draws the same frames: the camera pose comes from the frame's index, not the time, dynamic resolution is
+off, and VSync is off so that frames aren't held back to the display. Warm-up frames are drawn first and not measured,
+so shaders, caches and drivers have settled. The CPU and GPU time of each measured frame comes from the Profiler,
+and the report is written as JSON, along with the draw call and triangle counts from FrameStatistics.
+
+Given a baseline (a report from an earlier run), the mean and percentile frame times are compared against it, and
+any more than the regression threshold slower fail the benchmark.
+*/
+class Benchmark
+{
+public:
+
+	struct BenchmarkCreationException : public std::exception
+	{
+		std::string errorMessage;
+
+		BenchmarkCreationException(const std::string errorMessage)
+			: errorMessage("BenchmarkCreationException Occured: " + errorMessage) {}
+
+		const char* what() const noexcept override
+		{
+			return errorMessage.c_str();
+		}
+	};
+
+	// In milliseconds
+	struct FrameTimeSummary
+	{
+		float min = 0.0f;
+		float mean = 0.0f;
+		float p50 = 0.0f;
+		float p95 = 0.0f;
+		float p99 = 0.0f;
+	};
+
+public:
+
+	Benchmark() = delete;
+	// Throws if the scene, renderer or camera path are unknown
+	Benchmark(const Application::ApplicationSpecification& specification);
+	Benchmark(const Benchmark&) = delete;
+
+	// Warm-up frames and then measured frames
+	uint32_t getFrameCount() const { return m_warmUpFrameCount + m_measuredFrameCount; }
+
+	// Called for each frame in turn, between Profiler::beginFrame and Renderer::endFrame
+	void drawFrame(uint32_t frameIndex);
+	// Called after Renderer::endFrame and Profiler::endFrame
+	void endFrame(uint32_t frameIndex);
+
+	// Writes the report and compares it against the baseline, if there is one. Returns false if either fails or
+	// there is a regression
+	bool finish();
+
+private:
+
+	void collectProfiledFrames();
+
+	bool writeReport(const std::filesystem::path& filePath) const;
+	bool compareAgainstBaseline(const std::filesystem::path& baselineFilePath) const;
+
+	static FrameTimeSummary summarise(std::vector<float> frameTimes);
+	// Finds "statistic" in the "section" object of a report. Only reads reports written by writeReport
+	static bool readReportValue(const std::string& report, const std::string& section, const std::string& statistic, float& value);
+
+private:
+
+	const Application::ApplicationSpecification& m_specification;
+
+	Reference<TestScene> m_testScene;
+	Reference<Scene> m_scene;
+
+	CameraPath m_cameraPath;
+	PoseCamera m_camera;
+
+	uint32_t m_warmUpFrameCount;
+	uint32_t m_measuredFrameCount;
+
+	// Profiler frame index of the first measured frame (the maximum until it is drawn), and of the next frame to collect
+	uint64_t m_firstMeasuredProfilerFrame = std::numeric_limits<uint64_t>::max();
+	uint64_t m_nextProfilerFrameToCollect = 0;
+	bool m_profilerWasEnabled;
+
+	std::vector<float> m_CPUFrameTimes;
+	std::vector<float> m_GPUFrameTimes;
+	std::vector<FrameStatistics::Counters> m_frameStatistics;
+};
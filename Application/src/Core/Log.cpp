@@ -6,8 +6,20 @@
 
 #include "spdlog/sinks/stdout_color_sinks.h"
 #include "spdlog/sinks/basic_file_sink.h"
+#include "spdlog/sinks/null_sink.h"
 
-Reference<spdlog::logger> Log::s_logger;
+#include "LogRingBuffer.h"
+
+// Shown in place of the logger's name
+static constexpr std::array<const char*, static_cast<size_t>(Log::Category::COUNT)> CATEGORY_NAMES = { "General", "Renderer", "Shader", "Assets", "Benchmark" };
+
+std::array<Reference<spdlog::logger>, static_cast<size_t>(Log::Category::COUNT)> Log::s_loggers;
+std::atomic<int> Log::s_level = SPDLOG_ACTIVE_LEVEL;
+
+Unique<LogRingBuffer> Log::s_ringBuffer;
+std::atomic<bool> Log::s_acceptingMessages = false;
+std::atomic<uint64_t> Log::s_droppedMessageCount = 0;
+std::thread Log::s_writingThread;
 
 void Log::init()
 {
@@ -18,13 +30,30 @@ void Log::init()
 		std::vector<spdlog::sink_ptr> logSinks;
 		setUpSinks(logSinks);
 
-		s_logger = createReference<spdlog::logger>("PBR", logSinks.begin(), logSinks.end());
-		spdlog::register_logger(s_logger);
+		// Every category writes to the same sinks, under its own name. Levels are filtered before messages are queued,
+		// so the loggers pass everything on
+
+		for (size_t i = 0; i < s_loggers.size(); i++)
+		{
+			if (static_cast<Category>(i) == Category::BENCHMARK)
+				s_loggers[i] = createReference<spdlog::logger>(CATEGORY_NAMES[i], createReference<spdlog::sinks::null_sink_mt>());
+			else
+				s_loggers[i] = createReference<spdlog::logger>(CATEGORY_NAMES[i], logSinks.begin(), logSinks.end());
+
+			s_loggers[i]->set_level(spdlog::level::trace);
+		}
 
 		// Set the default logging level to the maximum (trace)
 
-		s_logger->set_level(SPDLOG_ACTIVE_LEVEL_SOURCE);
-		s_logger->flush_on(SPDLOG_ACTIVE_LEVEL_SOURCE);
+		s_level = SPDLOG_ACTIVE_LEVEL_SOURCE;
+
+		s_ringBuffer = createUnique<LogRingBuffer>(RING_BUFFER_SLOT_COUNT);
+		s_acceptingMessages = true;
+		s_writingThread = std::thread(Log::writeMessages);
+
+		// The writing thread must be joined before it is destroyed, which happens after this runs, even if the
+		// application exits without shutting down
+		std::atexit(Log::shutdown);
 	}
 	catch (const spdlog::spdlog_ex& e)
 	{
@@ -32,30 +61,165 @@ void Log::init()
 	}
 }
 
+void Log::shutdown()
+{
+	if (!s_acceptingMessages.exchange(false))
+		return;
+
+	s_writingThread.join();
+}
+
 void Log::setLogLevel(LogLevel logLevel)
 {
 	switch (logLevel)
 	{
 	case Log::LogLevel::TRACE:
-		s_logger->set_level(spdlog::level::trace);
+		s_level = spdlog::level::trace;
 		break;
 	case Log::LogLevel::INFO:
-		s_logger->set_level(spdlog::level::info);
+		s_level = spdlog::level::info;
 		break;
 	case Log::LogLevel::WARN:
-		s_logger->set_level(spdlog::level::warn);
+		s_level = spdlog::level::warn;
 		break;
 	case Log::LogLevel::ERR:
-		s_logger->set_level(spdlog::level::err);
+		s_level = spdlog::level::err;
 		break;
 	case Log::LogLevel::CRITICAL:
-		s_logger->set_level(spdlog::level::critical);
+		s_level = spdlog::level::critical;
 		break;
 	default:
 		break;
 	}
 }
 
+void Log::measureCallOverhead()
+{
+	static constexpr uint32_t BATCH_SIZE = 1000;
+	static constexpr uint32_t BATCH_COUNT = 200;
+
+	using BenchmarkLog = CategoryLog<Category::BENCHMARK>;
+
+	// Calls are made in batches small enough for the ring to hold, and the writing thread is given time to empty the
+	// ring between them, so that queued calls don't measure the ring filling up
+	auto measure = [](auto&& logCall, bool waitBetweenBatches)
+	{
+		std::chrono::nanoseconds duration(0);
+
+		for (uint32_t batch = 0; batch < BATCH_COUNT; batch++)
+		{
+			auto startTime = std::chrono::steady_clock::now();
+
+			for (uint32_t i = 0; i < BATCH_SIZE; i++)
+				logCall(batch * BATCH_SIZE + i);
+
+			duration += std::chrono::steady_clock::now() - startTime;
+
+			if (waitBetweenBatches)
+				std::this_thread::sleep_for(IDLE_INTERVAL * 2);
+		}
+
+		return static_cast<double>(duration.count()) / static_cast<double>(BATCH_SIZE * BATCH_COUNT);
+	};
+
+	int level = s_level;
+
+	s_level = spdlog::level::critical;
+	double filteredCallTime = measure([](uint32_t i) { BenchmarkLog::trace("Bound texture {0} to texture slot {1}", i, i % 16); }, false);
+	s_level = spdlog::level::trace;
+	double queuedCallTime = measure([](uint32_t i) { BenchmarkLog::trace("Bound texture {0} to texture slot {1}", i, i % 16); }, true);
+	s_level = level;
+
+	// As every call was before logging was asynchronous, though to a file of its own
+	std::filesystem::path synchronousLogPath = std::filesystem::temp_directory_path() / "PBRLogBenchmark.log";
+	double synchronousCallTime = 0.0;
+	{
+		spdlog::logger synchronousLogger("Benchmark", createReference<spdlog::sinks::basic_file_sink_mt>(synchronousLogPath.string(), true));
+		synchronousLogger.set_level(spdlog::level::trace);
+		synchronousLogger.flush_on(spdlog::level::trace);
+
+		synchronousCallTime = measure([&synchronousLogger](uint32_t i) { synchronousLogger.trace("Bound texture {0} to texture slot {1}", i, i % 16); }, false);
+	}
+	std::error_code errorCode;
+	std::filesystem::remove(synchronousLogPath, errorCode);
+
+	Log::info("Log call overhead, over {0} calls:", BATCH_SIZE * BATCH_COUNT);
+	Log::info("\tCompiled out:                    none, the call is removed");
+	Log::info("\tFiltered out at runtime:         {0:.1f} ns", filteredCallTime);
+	Log::info("\tFormatted and queued:            {0:.1f} ns", queuedCallTime);
+	Log::info("\tWritten and flushed immediately: {0:.1f} ns", synchronousCallTime);
+}
+
+void Log::push(Category category, spdlog::level::level_enum level, std::string_view message)
+{
+	spdlog::log_clock::time_point time = spdlog::log_clock::now();
+
+	if (!s_acceptingMessages.load(std::memory_order_relaxed))
+	{
+		// Before logging is initialised, or after it is shut down, messages are written straight away
+		if (const Reference<spdlog::logger>& logger = s_loggers[static_cast<size_t>(category)])
+			logger->log(time, spdlog::source_loc(), level, message);
+
+		return;
+	}
+
+	while (!s_ringBuffer->push(time, level, category, message))
+	{
+		if (level < spdlog::level::warn)
+		{
+			s_droppedMessageCount.fetch_add(1, std::memory_order_relaxed);
+			return;
+		}
+
+		std::this_thread::yield();
+	}
+}
+
+void Log::writeMessages()
+{
+	LogRingBuffer::Message message;
+
+	spdlog::logger& generalLogger = *s_loggers[static_cast<size_t>(Category::GENERAL)];
+	auto lastFlushTime = std::chrono::steady_clock::now();
+	bool unflushed = false;
+
+	while (true)
+	{
+		// Read before the ring is emptied, so that everything pushed before shutting down is written
+		bool stopping = !s_acceptingMessages.load(std::memory_order_acquire);
+		bool flushNow = stopping;
+
+		while (s_ringBuffer->pop(message))
+		{
+			s_loggers[static_cast<size_t>(message.category)]->log(message.time, spdlog::source_loc(), message.level, message.text);
+
+			unflushed = true;
+			flushNow |= message.level >= spdlog::level::warn;
+		}
+
+		if (uint64_t droppedMessageCount = s_droppedMessageCount.exchange(0, std::memory_order_relaxed))
+		{
+			generalLogger.log(spdlog::level::warn, "Dropped {0} log messages, as they were logged faster than they could be written", droppedMessageCount);
+			unflushed = true;
+		}
+
+		auto currentTime = std::chrono::steady_clock::now();
+		if (unflushed && (flushNow || currentTime - lastFlushTime >= FLUSH_INTERVAL))
+		{
+			// The categories share their sinks, so flushing one logger flushes them all
+			generalLogger.flush();
+
+			lastFlushTime = currentTime;
+			unflushed = false;
+		}
+
+		if (stopping)
+			break;
+
+		std::this_thread::sleep_for(IDLE_INTERVAL);
+	}
+}
+
 void Log::setUpSinks(std::vector<spdlog::sink_ptr>& logSinks)
 {
 	logSinks.emplace_back(createReference<spdlog::sinks::stdout_color_sink_mt>());
@@ -1,8 +1,41 @@
 #pragma once
 #include "PCH.h"
 
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <thread>
+
 #include "spdlog/spdlog.h"
 
+class LogRingBuffer;
+
+// The lowest level each category is compiled in at, as an SPDLOG_LEVEL_ value. Calls below it compile to nothing
+#ifndef PBR_LOG_LEVEL_GENERAL
+	#define PBR_LOG_LEVEL_GENERAL SPDLOG_ACTIVE_LEVEL
+#endif
+#ifndef PBR_LOG_LEVEL_RENDERER
+	#define PBR_LOG_LEVEL_RENDERER SPDLOG_ACTIVE_LEVEL
+#endif
+#ifndef PBR_LOG_LEVEL_SHADER
+	#define PBR_LOG_LEVEL_SHADER SPDLOG_ACTIVE_LEVEL
+#endif
+#ifndef PBR_LOG_LEVEL_ASSETS
+	#define PBR_LOG_LEVEL_ASSETS SPDLOG_ACTIVE_LEVEL
+#endif
+
+/*
+Logs to the console and PBR.log, by category, without the calling thread waiting on either.
+
+Each category has a minimum level fixed at compile time (PBR_LOG_LEVEL_RENDERER and so on), and calls below it compile
+to nothing, so the trace calls on the render hot path cost nothing in builds that leave them out. Log::trace and the
+like log to the general category, and RendererLog, ShaderLog and AssetLog to the others.
+
+Calls that are compiled in check the runtime level, format the message on the calling thread, and push it to a lock
+free ring buffer. A writing thread drains the ring into spdlog's sinks, and flushes them in batches: at most every
+FLUSH_INTERVAL, or as soon as a warning or worse is written. If the ring is full, trace and info messages are dropped
+(and the number dropped is logged) rather than stall the caller, while warnings and errors wait for room.
+*/
 class Log
 {
 public:
@@ -16,32 +49,140 @@ public:
 		CRITICAL
 	};
 
+	enum class Category
+	{
+		GENERAL = 0,
+		RENDERER,
+		SHADER,
+		ASSETS,
+		// Written nowhere, for measuring the cost of logging
+		BENCHMARK,
+		COUNT
+	};
+
+	static constexpr uint32_t RING_BUFFER_SLOT_COUNT = 8192;
+	static constexpr std::chrono::milliseconds FLUSH_INTERVAL{ 100 };
+	// How long the writing thread sleeps once it has emptied the ring
+	static constexpr std::chrono::milliseconds IDLE_INTERVAL{ 2 };
+
 public:
 
 	static void init();
+	// Writes and flushes the messages still in the ring, and stops the writing thread. Messages logged afterwards are
+	// written on the calling thread
+	static void shutdown();
 
 	static void setLogLevel(LogLevel logLevel);
 
+	static constexpr bool isCompiledIn(Category category, spdlog::level::level_enum level)
+	{
+		switch (category)
+		{
+		case Category::GENERAL:
+			return level >= PBR_LOG_LEVEL_GENERAL;
+		case Category::RENDERER:
+			return level >= PBR_LOG_LEVEL_RENDERER;
+		case Category::SHADER:
+			return level >= PBR_LOG_LEVEL_SHADER;
+		case Category::ASSETS:
+			return level >= PBR_LOG_LEVEL_ASSETS;
+		default:
+			return true;
+		}
+	}
+
+	template<Category category, spdlog::level::level_enum level, typename... Args>
+	inline static void write(Args&&... args)
+	{
+		if constexpr (isCompiledIn(category, level))
+		{
+			if (level >= s_level.load(std::memory_order_relaxed))
+				formatAndPush(category, level, std::forward<Args>(args)...);
+		}
+	}
+
 	template<typename... Args>
-	inline static void trace(Args&&... args) { SPDLOG_LOGGER_TRACE(s_logger, std::forward<Args>(args)...); }
-	
+	inline static void trace(Args&&... args) { write<Category::GENERAL, spdlog::level::trace>(std::forward<Args>(args)...); }
+
 	template<typename... Args>
-	inline static void info(Args&&... args) { SPDLOG_LOGGER_INFO(s_logger, std::forward<Args>(args)...); }
+	inline static void info(Args&&... args) { write<Category::GENERAL, spdlog::level::info>(std::forward<Args>(args)...); }
 
 	template<typename... Args>
-	inline static void warn(Args&&... args) { SPDLOG_LOGGER_WARN(s_logger, std::forward<Args>(args)...); }
+	inline static void warn(Args&&... args) { write<Category::GENERAL, spdlog::level::warn>(std::forward<Args>(args)...); }
 
 	template<typename... Args>
-	inline static void error(Args&&... args) { SPDLOG_LOGGER_ERROR(s_logger, std::forward<Args>(args)...); }
+	inline static void error(Args&&... args) { write<Category::GENERAL, spdlog::level::err>(std::forward<Args>(args)...); }
 
 	template<typename... Args>
-	inline static void critical(Args&&... args) { SPDLOG_LOGGER_CRITICAL(s_logger, std::forward<Args>(args)...); }
+	inline static void critical(Args&&... args) { write<Category::GENERAL, spdlog::level::critical>(std::forward<Args>(args)...); }
+
+	// Logs how long a call takes when it is filtered out at runtime, when it is queued, and when it is written and
+	// flushed synchronously, as every call was before logging was asynchronous
+	static void measureCallOverhead();
 
 private:
 
+	template<typename... Args>
+	static void formatAndPush(Category category, spdlog::level::level_enum level, fmt::format_string<Args...> format, Args&&... args)
+	{
+		fmt::memory_buffer buffer;
+
+		try
+		{
+			fmt::format_to(std::back_inserter(buffer), format, std::forward<Args>(args)...);
+		}
+		catch (const fmt::format_error& e)
+		{
+			buffer.clear();
+			fmt::format_to(std::back_inserter(buffer), "Could not format a log message: {0}", e.what());
+		}
+
+		push(category, level, std::string_view(buffer.data(), buffer.size()));
+	}
+
+	// A message without arguments is written as it is, like spdlog does, rather than formatted
+	static void formatAndPush(Category category, spdlog::level::level_enum level, std::string_view message) { push(category, level, message); }
+
+	static void push(Category category, spdlog::level::level_enum level, std::string_view message);
+
+	// Run by the writing thread
+	static void writeMessages();
+
 	static void setUpSinks(std::vector<spdlog::sink_ptr>& logSinks);
 
 private:
 
-	static Reference<spdlog::logger> s_logger;
-};
\ No newline at end of file
+	static std::array<Reference<spdlog::logger>, static_cast<size_t>(Category::COUNT)> s_loggers;
+	static std::atomic<int> s_level;
+
+	static Unique<LogRingBuffer> s_ringBuffer;
+	static std::atomic<bool> s_acceptingMessages;
+	static std::atomic<uint64_t> s_droppedMessageCount;
+	static std::thread s_writingThread;
+};
+
+// Logs to one category, like Log does to the general one
+template<Log::Category category>
+class CategoryLog
+{
+public:
+
+	template<typename... Args>
+	inline static void trace(Args&&... args) { Log::write<category, spdlog::level::trace>(std::forward<Args>(args)...); }
+
+	template<typename... Args>
+	inline static void info(Args&&... args) { Log::write<category, spdlog::level::info>(std::forward<Args>(args)...); }
+
+	template<typename... Args>
+	inline static void warn(Args&&... args) { Log::write<category, spdlog::level::warn>(std::forward<Args>(args)...); }
+
+	template<typename... Args>
+	inline static void error(Args&&... args) { Log::write<category, spdlog::level::err>(std::forward<Args>(args)...); }
+
+	template<typename... Args>
+	inline static void critical(Args&&... args) { Log::write<category, spdlog::level::critical>(std::forward<Args>(args)...); }
+};
+
+using RendererLog = CategoryLog<Log::Category::RENDERER>;
+using ShaderLog = CategoryLog<Log::Category::SHADER>;
+using AssetLog = CategoryLog<Log::Category::ASSETS>;
@@ -0,0 +1,93 @@
+#include "PCH.h"
+#include "LogRingBuffer.h"
+
+#include <cstring>
+
+LogRingBuffer::LogRingBuffer(uint32_t slotCount)
+	: m_slots(createUnique<Slot[]>(slotCount)), m_slotMask(slotCount - 1)
+{
+	ASSERT_MESSAGE(slotCount >= MAX_SLOTS_PER_MESSAGE && (slotCount & (slotCount - 1)) == 0, "The slot count of a log ring buffer must be a power of two, and fit the longest message");
+
+	for (uint32_t i = 0; i < slotCount; i++)
+		m_slots[i].sequence.store(i, std::memory_order_relaxed);
+}
+
+bool LogRingBuffer::push(spdlog::log_clock::time_point time, spdlog::level::level_enum level, Log::Category category, std::string_view text)
+{
+	size_t textLength = std::min<size_t>(text.size(), SLOT_TEXT_SIZE * MAX_SLOTS_PER_MESSAGE);
+	uint32_t slotCount = std::max(static_cast<uint32_t>((textLength + SLOT_TEXT_SIZE - 1) / SLOT_TEXT_SIZE), 1u);
+
+	// Slots are freed in order, so if the last slot the message needs is free, so are the others
+	uint64_t position = m_writePosition.load(std::memory_order_relaxed);
+	while (true)
+	{
+		uint64_t lastPosition = position + slotCount - 1;
+		uint64_t sequence = m_slots[lastPosition & m_slotMask].sequence.load(std::memory_order_acquire);
+		int64_t difference = static_cast<int64_t>(sequence - lastPosition);
+
+		if (difference == 0)
+		{
+			// On failure, position is updated to where another thread moved it
+			if (m_writePosition.compare_exchange_weak(position, position + slotCount, std::memory_order_relaxed))
+				break;
+		}
+		else if (difference < 0)
+		{
+			// The slot is still a lap behind, waiting for the reader
+			return false;
+		}
+		else
+		{
+			position = m_writePosition.load(std::memory_order_relaxed);
+		}
+	}
+
+	for (uint32_t i = 0; i < slotCount; i++)
+	{
+		Slot& slot = m_slots[(position + i) & m_slotMask];
+
+		size_t offset = static_cast<size_t>(i) * SLOT_TEXT_SIZE;
+		size_t length = std::min<size_t>(textLength - offset, SLOT_TEXT_SIZE);
+
+		slot.time = time;
+		slot.level = level;
+		slot.category = category;
+		slot.slotCount = static_cast<uint16_t>(slotCount);
+		slot.textLength = static_cast<uint16_t>(length);
+		std::memcpy(slot.text, text.data() + offset, length);
+
+		slot.sequence.store(position + i + 1, std::memory_order_release);
+	}
+
+	return true;
+}
+
+bool LogRingBuffer::pop(Message& message)
+{
+	const Slot& firstSlot = m_slots[m_readPosition & m_slotMask];
+	if (firstSlot.sequence.load(std::memory_order_acquire) != m_readPosition + 1)
+		return false;
+
+	// Slots are published in order, so once the last is, all of them are
+	uint32_t slotCount = firstSlot.slotCount;
+	const Slot& lastSlot = m_slots[(m_readPosition + slotCount - 1) & m_slotMask];
+	if (lastSlot.sequence.load(std::memory_order_acquire) != m_readPosition + slotCount)
+		return false;
+
+	message.time = firstSlot.time;
+	message.level = firstSlot.level;
+	message.category = firstSlot.category;
+	message.text.clear();
+
+	for (uint32_t i = 0; i < slotCount; i++)
+	{
+		Slot& slot = m_slots[(m_readPosition + i) & m_slotMask];
+		message.text.append(slot.text, slot.textLength);
+
+		slot.sequence.store(m_readPosition + i + m_slotMask + 1, std::memory_order_release);
+	}
+
+	m_readPosition += slotCount;
+
+	return true;
+}
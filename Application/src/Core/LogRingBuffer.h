@@ -0,0 +1,68 @@
+#pragma once
+#include "PCH.h"
+
+#include <atomic>
+
+/*
+A bounded queue of log messages, which any number of threads push to without locking, and one thread pops from.
+
+Messages are copied into fixed size slots, a long one taking several consecutive slots. A push claims all of its slots
+at once, with a compare and swap of the write position, so messages from different threads never interleave, and then
+publishes each slot by advancing its sequence number (as in Dmitry Vyukov's bounded queue). The reader pops slots in
+order, and frees each by advancing its sequence number a lap further.
+*/
+class LogRingBuffer
+{
+public:
+
+	struct Message
+	{
+		spdlog::log_clock::time_point time;
+		spdlog::level::level_enum level = spdlog::level::info;
+		Log::Category category = Log::Category::GENERAL;
+		std::string text;
+	};
+
+	// Sized so that a slot, with its header, takes four cache lines
+	static constexpr uint32_t SLOT_TEXT_SIZE = 224;
+	// Longer messages are truncated
+	static constexpr uint32_t MAX_SLOTS_PER_MESSAGE = 32;
+
+public:
+
+	LogRingBuffer() = delete;
+	// The slot count must be a power of two
+	LogRingBuffer(uint32_t slotCount);
+	LogRingBuffer(const LogRingBuffer&) = delete;
+
+	// Returns false, without waiting, if there isn't room
+	bool push(spdlog::log_clock::time_point time, spdlog::level::level_enum level, Log::Category category, std::string_view text);
+	// Only called by one thread. Returns false if there is no message, or the next hasn't been pushed in full yet
+	bool pop(Message& message);
+
+private:
+
+	// Cache line aligned, so that threads writing neighbouring slots don't share lines
+	struct alignas(64) Slot
+	{
+		// The position the slot is free for, or one past the position it was pushed at
+		std::atomic<uint64_t> sequence{ 0 };
+
+		spdlog::log_clock::time_point time;
+		spdlog::level::level_enum level = spdlog::level::info;
+		Log::Category category = Log::Category::GENERAL;
+		// Of the whole message, in its first slot
+		uint16_t slotCount = 1;
+		uint16_t textLength = 0;
+		char text[SLOT_TEXT_SIZE];
+	};
+
+private:
+
+	Unique<Slot[]> m_slots;
+	uint64_t m_slotMask;
+
+	alignas(64) std::atomic<uint64_t> m_writePosition{ 0 };
+	// Only the reader uses it
+	alignas(64) uint64_t m_readPosition = 0;
+};
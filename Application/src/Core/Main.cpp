@@ -2,10 +2,10 @@
 
 #include "Core/Application.h"
 
-int main()
+int main(int argc, char** argv)
 {
-    Application::init();
+    Application::init(argc, argv);
     Application::run();
     Application::shutdown();
-    return 0;
+    return Application::getExitCode();
 }
\ No newline at end of file
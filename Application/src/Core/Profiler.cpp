@@ -0,0 +1,258 @@
+#include "PCH.h"
+#include "Profiler.h"
+
+#include "glad/glad.h"
+
+// Track IDs of the Chrome trace
+static constexpr uint32_t TRACE_PROCESS_ID = 1;
+static constexpr uint32_t TRACE_CPU_THREAD_ID = 1;
+static constexpr uint32_t TRACE_GPU_THREAD_ID = 2;
+
+bool Profiler::s_enabled = false;
+bool Profiler::s_frameActive = false;
+
+std::array<Profiler::FrameInFlight, Profiler::FRAME_LATENCY> Profiler::s_framesInFlight;
+uint64_t Profiler::s_frameCount = 0;
+std::vector<uint32_t> Profiler::s_openScopes;
+
+std::deque<Profiler::FrameRecord> Profiler::s_recordedFrames;
+
+std::chrono::steady_clock::time_point Profiler::s_startTime = std::chrono::steady_clock::now();
+int64_t Profiler::s_GPUClockOffset = 0;
+
+static std::string escapeJSONString(const std::string& string)
+{
+	std::string escapedString;
+	escapedString.reserve(string.size());
+
+	for (char character : string)
+	{
+		if (character == '"' || character == '\\')
+			escapedString += '\\';
+
+		// Control characters aren't expected in scope names, so are dropped rather than escaped
+		if (static_cast<unsigned char>(character) >= 0x20)
+			escapedString += character;
+	}
+
+	return escapedString;
+}
+
+void Profiler::shutdown()
+{
+	ASSERT_MESSAGE(!s_frameActive, "Cannot shut the profiler down during a frame");
+
+	for (FrameInFlight& frame : s_framesInFlight)
+		frame = FrameInFlight();
+
+	s_recordedFrames.clear();
+	s_enabled = false;
+}
+
+void Profiler::setEnabled(bool enabled)
+{
+	if (enabled == s_enabled)
+		return;
+
+	s_enabled = enabled;
+
+	if (enabled)
+		calibrateGPUClock();
+	else
+		resolveAllFrames();
+
+	Log::info("Profiling {0}", enabled ? "enabled" : "disabled");
+}
+
+void Profiler::beginFrame()
+{
+	if (!s_enabled)
+		return;
+
+	// The frame that last used these queries was FRAME_LATENCY frames ago, so its timestamps are normally available
+	FrameInFlight& frame = s_framesInFlight[s_frameCount % FRAME_LATENCY];
+	if (frame.pending)
+		resolveFrame(frame);
+
+	frame.record = FrameRecord();
+	frame.record.frameIndex = s_frameCount;
+	frame.scopeQueries.clear();
+	frame.usedQueryCount = 0;
+
+	s_frameActive = true;
+	beginScope("Frame", true);
+}
+
+void Profiler::endFrame()
+{
+	if (!s_frameActive)
+		return;
+
+	endScope();
+	ASSERT_MESSAGE(s_openScopes.empty(), "Every profiler scope must end within the frame it began in");
+
+	s_framesInFlight[s_frameCount % FRAME_LATENCY].pending = true;
+	s_frameCount++;
+	s_frameActive = false;
+}
+
+void Profiler::beginScope(const char* name, bool timeGPU)
+{
+	FrameInFlight& frame = s_framesInFlight[s_frameCount % FRAME_LATENCY];
+
+	s_openScopes.push_back(static_cast<uint32_t>(frame.record.scopes.size()));
+
+	ScopeRecord& scope = frame.record.scopes.emplace_back();
+	scope.name = name;
+	scope.depth = static_cast<uint32_t>(s_openScopes.size()) - 1;
+	scope.hasGPUTime = timeGPU;
+
+	ScopeQueries& queries = frame.scopeQueries.emplace_back();
+
+	if (timeGPU)
+	{
+		glPushDebugGroup(GL_DEBUG_SOURCE_APPLICATION, 0, -1, name);
+		queries.start = recordTimestamp(frame);
+	}
+
+	scope.CPUStartTime = getCPUTime();
+}
+
+void Profiler::endScope()
+{
+	ASSERT_MESSAGE(!s_openScopes.empty(), "Cannot end a profiler scope when none have begun");
+
+	FrameInFlight& frame = s_framesInFlight[s_frameCount % FRAME_LATENCY];
+
+	uint32_t scopeIndex = s_openScopes.back();
+	s_openScopes.pop_back();
+
+	ScopeRecord& scope = frame.record.scopes[scopeIndex];
+	scope.CPUDuration = getCPUTime() - scope.CPUStartTime;
+
+	if (scope.hasGPUTime)
+	{
+		frame.scopeQueries[scopeIndex].end = recordTimestamp(frame);
+		glPopDebugGroup();
+	}
+}
+
+bool Profiler::exportChromeTrace(const std::filesystem::path& filePath)
+{
+	resolveAllFrames();
+
+	std::ofstream outputFileStream(filePath, std::ios::trunc);
+	if (!outputFileStream)
+	{
+		Log::error("Could not write a profile to {0}", filePath.string());
+		return false;
+	}
+
+	outputFileStream << std::fixed << std::setprecision(3);
+	outputFileStream << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+
+	outputFileStream << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":" << TRACE_PROCESS_ID << ",\"args\":{\"name\":\"Renderer\"}},\n";
+	outputFileStream << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":" << TRACE_PROCESS_ID << ",\"tid\":" << TRACE_CPU_THREAD_ID << ",\"args\":{\"name\":\"CPU\"}},\n";
+	outputFileStream << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":" << TRACE_PROCESS_ID << ",\"tid\":" << TRACE_GPU_THREAD_ID << ",\"args\":{\"name\":\"GPU\"}}";
+
+	// Complete ("X") events, which the viewers nest by time on each track
+	auto writeEvent = [&outputFileStream](const std::string& name, const char* category, uint32_t threadID, double startTime, double duration, uint64_t frameIndex)
+	{
+		outputFileStream << ",\n{\"name\":\"" << name << "\",\"cat\":\"" << category << "\",\"ph\":\"X\",\"pid\":" << TRACE_PROCESS_ID << ",\"tid\":" << threadID
+			<< ",\"ts\":" << startTime << ",\"dur\":" << duration << ",\"args\":{\"frame\":" << frameIndex << "}}";
+	};
+
+	for (const FrameRecord& frame : s_recordedFrames)
+	{
+		for (const ScopeRecord& scope : frame.scopes)
+		{
+			std::string name = escapeJSONString(scope.name);
+
+			writeEvent(name, "CPU", TRACE_CPU_THREAD_ID, scope.CPUStartTime, scope.CPUDuration, frame.frameIndex);
+
+			if (scope.hasGPUTime)
+				writeEvent(name, "GPU", TRACE_GPU_THREAD_ID, scope.GPUStartTime, scope.GPUDuration, frame.frameIndex);
+		}
+	}
+
+	outputFileStream << "\n]}\n";
+
+	if (!outputFileStream)
+	{
+		Log::error("Could not write a profile to {0}", filePath.string());
+		return false;
+	}
+
+	Log::info("Wrote a profile of {0} frames to {1}", s_recordedFrames.size(), filePath.string());
+
+	return true;
+}
+
+uint32_t Profiler::recordTimestamp(FrameInFlight& frame)
+{
+	if (frame.usedQueryCount == frame.queryPool.size())
+		frame.queryPool.push_back(createUnique<Query>(Query::QueryType::TIMESTAMP));
+
+	uint32_t queryIndex = frame.usedQueryCount++;
+	frame.queryPool[queryIndex]->recordTimestamp();
+
+	return queryIndex;
+}
+
+void Profiler::resolveFrame(FrameInFlight& frame)
+{
+	for (size_t scopeIndex = 0; scopeIndex < frame.record.scopes.size(); scopeIndex++)
+	{
+		ScopeRecord& scope = frame.record.scopes[scopeIndex];
+		const ScopeQueries& queries = frame.scopeQueries[scopeIndex];
+
+		if (!scope.hasGPUTime)
+			continue;
+
+		uint64_t startTimestamp = frame.queryPool[queries.start]->getResult();
+		uint64_t endTimestamp = frame.queryPool[queries.end]->getResult();
+
+		scope.GPUStartTime = convertGPUTimestamp(startTimestamp);
+		scope.GPUDuration = static_cast<double>(endTimestamp - startTimestamp) / 1000.0;
+	}
+
+	s_recordedFrames.push_back(std::move(frame.record));
+	if (s_recordedFrames.size() > MAX_RECORDED_FRAME_COUNT)
+		s_recordedFrames.pop_front();
+
+	frame.pending = false;
+
+	const FrameRecord& record = s_recordedFrames.back();
+	Log::trace("Profiled frame {0}: {1:.3f} ms CPU, {2:.3f} ms GPU", record.frameIndex, record.getCPUFrameTime(), record.getGPUFrameTime());
+}
+
+void Profiler::resolveAllFrames()
+{
+	// Oldest first, so that frames are recorded in order
+	for (uint32_t i = 0; i < FRAME_LATENCY; i++)
+	{
+		FrameInFlight& frame = s_framesInFlight[(s_frameCount + i) % FRAME_LATENCY];
+		if (frame.pending)
+			resolveFrame(frame);
+	}
+}
+
+void Profiler::calibrateGPUClock()
+{
+	GLint64 GPUTime = 0;
+	glGetInteger64v(GL_TIMESTAMP, &GPUTime);
+
+	int64_t CPUTime = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - s_startTime).count();
+
+	s_GPUClockOffset = CPUTime - GPUTime;
+}
+
+double Profiler::getCPUTime()
+{
+	return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - s_startTime).count();
+}
+
+double Profiler::convertGPUTimestamp(uint64_t timestamp)
+{
+	return static_cast<double>(static_cast<int64_t>(timestamp) + s_GPUClockOffset) / 1000.0;
+}
@@ -0,0 +1,165 @@
+#pragma once
+#include "PCH.h"
+
+#include <array>
+#include <chrono>
+#include <deque>
+
+#include "Renderer/Query.h"
+
+/*
+A hierarchical frame profiler, which times nested scopes on the CPU and, for scopes that issue GL commands, on the GPU.
+
+Scopes are opened with PROFILE_SCOPE, or PROFILE_GPU_SCOPE for those that issue GL commands, and last until the end of
+the C++ scope. GPU scopes record a timestamp query at either end (timestamps nest, unlike GL_TIME_ELAPSED queries) and
+push a debug group, so that RenderDoc, Nsight and the like show the same hierarchy.
+
+Each frame's timestamps go in their own pool of queries, and are only read FRAME_LATENCY frames later, when the pool is
+reused, so the CPU doesn't wait for the GPU. Frames are recorded once their GPU times are in, and the most recent are
+kept for export as a Chrome trace (opened with about:tracing or ui.perfetto.dev), with the CPU and GPU on separate
+tracks. GPU times are moved onto the CPU's clock with an offset measured when profiling is enabled.
+
+Only one thread is profiled: the render thread when there is one (see RenderThread), or else the main thread. While
+profiling is disabled, a scope costs a branch.
+*/
+class Profiler
+{
+public:
+
+	static constexpr uint32_t FRAME_LATENCY = 3;
+	static constexpr uint32_t MAX_RECORDED_FRAME_COUNT = 1200;
+
+	struct ScopeRecord
+	{
+		std::string name;
+		// 0 for the frame itself, which every other scope is inside
+		uint32_t depth = 0;
+
+		// In microseconds since profiling was enabled
+		double CPUStartTime = 0.0;
+		double CPUDuration = 0.0;
+
+		bool hasGPUTime = false;
+		double GPUStartTime = 0.0;
+		double GPUDuration = 0.0;
+	};
+
+	struct FrameRecord
+	{
+		uint64_t frameIndex = 0;
+		// In the order they were opened, so parents come before their children. The first is the whole frame
+		std::vector<ScopeRecord> scopes;
+
+		// In milliseconds
+		float getCPUFrameTime() const { return scopes.empty() ? 0.0f : static_cast<float>(scopes.front().CPUDuration / 1000.0); }
+		float getGPUFrameTime() const { return scopes.empty() ? 0.0f : static_cast<float>(scopes.front().GPUDuration / 1000.0); }
+	};
+
+	// Times the rest of the C++ scope it is created in. The name must outlive it
+	class Scope
+	{
+	public:
+
+		Scope(const char* name, bool timeGPU)
+			: m_active(s_frameActive)
+		{
+			if (m_active)
+				beginScope(name, timeGPU);
+		}
+
+		~Scope()
+		{
+			if (m_active)
+				endScope();
+		}
+
+		Scope(const Scope&) = delete;
+
+	private:
+
+		bool m_active;
+	};
+
+public:
+
+	// Waits for the GPU times of the frames still in flight, which needs the OpenGL context
+	static void shutdown();
+
+	// Takes effect from the next frame
+	static void setEnabled(bool enabled);
+	static bool isEnabled() { return s_enabled; }
+
+	// Called at the very start and very end of each frame, around everything that is profiled
+	static void beginFrame();
+	static void endFrame();
+	// Of the profiled frame in progress, or of the next one between frames
+	static uint64_t getFrameIndex() { return s_frameCount; }
+
+	static void beginScope(const char* name, bool timeGPU);
+	static void endScope();
+
+	// The most recent frame with its GPU times, FRAME_LATENCY frames behind the current one. nullptr until there is one
+	static const FrameRecord* getLatestFrame() { return s_recordedFrames.empty() ? nullptr : &s_recordedFrames.back(); }
+	// Oldest first
+	static const std::deque<FrameRecord>& getRecordedFrames() { return s_recordedFrames; }
+
+	// Writes the recorded frames in the Chrome trace event format. Returns false if the file couldn't be written
+	static bool exportChromeTrace(const std::filesystem::path& filePath);
+
+private:
+
+	struct ScopeQueries
+	{
+		// Indices into the frame's query pool
+		uint32_t start = INVALID_QUERY;
+		uint32_t end = INVALID_QUERY;
+	};
+
+	struct FrameInFlight
+	{
+		FrameRecord record;
+		std::vector<ScopeQueries> scopeQueries;
+
+		// Grows to the most timestamps any frame has needed, and is reused
+		std::vector<Unique<Query>> queryPool;
+		uint32_t usedQueryCount = 0;
+
+		bool pending = false;
+	};
+
+	static constexpr uint32_t INVALID_QUERY = std::numeric_limits<uint32_t>::max();
+
+private:
+
+	static uint32_t recordTimestamp(FrameInFlight& frame);
+	// Waits for any of the frame's timestamps which aren't available yet
+	static void resolveFrame(FrameInFlight& frame);
+	static void resolveAllFrames();
+
+	static void calibrateGPUClock();
+	// In microseconds since profiling was enabled
+	static double getCPUTime();
+	static double convertGPUTimestamp(uint64_t timestamp);
+
+private:
+
+	static bool s_enabled;
+	static bool s_frameActive;
+
+	static std::array<FrameInFlight, FRAME_LATENCY> s_framesInFlight;
+	static uint64_t s_frameCount;
+	// Indices into the current frame's scopes, innermost last
+	static std::vector<uint32_t> s_openScopes;
+
+	static std::deque<FrameRecord> s_recordedFrames;
+
+	static std::chrono::steady_clock::time_point s_startTime;
+	// Added to a GPU timestamp to get nanoseconds since profiling was enabled
+	static int64_t s_GPUClockOffset;
+};
+
+#define PROFILE_CONCATENATE_IMPLEMENTATION(a, b) a##b
+#define PROFILE_CONCATENATE(a, b) PROFILE_CONCATENATE_IMPLEMENTATION(a, b)
+
+#define PROFILE_SCOPE(name) Profiler::Scope PROFILE_CONCATENATE(profilerScope, __LINE__)(name, false)
+#define PROFILE_GPU_SCOPE(name) Profiler::Scope PROFILE_CONCATENATE(profilerScope, __LINE__)(name, true)
@@ -0,0 +1,109 @@
+#include "PCH.h"
+#include "RenderThread.h"
+
+#include "Profiler.h"
+#include "Renderer/Renderer.h"
+
+RenderThread::RenderThread(Window& window)
+	: m_window(window)
+{
+	m_window.releaseContext();
+	m_thread = std::thread(&RenderThread::run, this);
+
+	Log::info("Started the render thread");
+}
+
+RenderThread::~RenderThread()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_stopping = true;
+	}
+	m_snapshotSubmitted.notify_one();
+
+	m_thread.join();
+	m_window.makeContextCurrent();
+
+	Log::info("Stopped the render thread after {0} frames", m_drawnFrameCount);
+}
+
+SceneSnapshot& RenderThread::beginSnapshot()
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+	m_snapshotDrawn.wait(lock, [this]() { return m_submittedFrameCount - m_drawnFrameCount < SNAPSHOT_COUNT; });
+
+	return m_snapshots[m_submittedFrameCount % SNAPSHOT_COUNT];
+}
+
+void RenderThread::submitSnapshot()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+
+		SceneSnapshot& snapshot = m_snapshots[m_submittedFrameCount % SNAPSHOT_COUNT];
+		snapshot.rendererCommands = std::move(m_pendingRendererCommands);
+		m_pendingRendererCommands.clear();
+
+		m_submittedFrameCount++;
+	}
+	m_snapshotSubmitted.notify_one();
+}
+
+void RenderThread::run()
+{
+	m_window.makeContextCurrent();
+
+	while (true)
+	{
+		uint64_t frameIndex;
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_snapshotSubmitted.wait(lock, [this]() { return m_drawnFrameCount < m_submittedFrameCount || m_stopping; });
+
+			// Snapshots submitted before stopping are still drawn
+			if (m_drawnFrameCount == m_submittedFrameCount)
+				break;
+
+			frameIndex = m_drawnFrameCount;
+		}
+
+		// The main thread doesn't touch a submitted snapshot's slot until it has been drawn
+		drawSnapshot(m_snapshots[frameIndex % SNAPSHOT_COUNT]);
+
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_drawnFrameCount++;
+		}
+		m_snapshotDrawn.notify_one();
+	}
+
+	m_window.releaseContext();
+}
+
+void RenderThread::drawSnapshot(SceneSnapshot& snapshot)
+{
+	for (const std::function<void()>& command : snapshot.rendererCommands)
+		command();
+
+	Profiler::beginFrame();
+
+	Renderer::bindDefaultFramebuffer();
+	Renderer::clear();
+
+	Renderer::drawScene(snapshot.scene, snapshot.camera);
+
+	Renderer::endFrame();
+
+	// Swapping can block until the GPU catches up, so only the CPU is timed
+	{
+		PROFILE_SCOPE("Swap buffers");
+		m_window.swapBuffers();
+	}
+
+	Profiler::endFrame();
+
+	// Released here, so that if the snapshot held the last reference to a model, its buffers are deleted with the
+	// context current
+	snapshot.scene.reset();
+	snapshot.rendererCommands.clear();
+}
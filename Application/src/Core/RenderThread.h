@@ -0,0 +1,70 @@
+#pragma once
+#include "PCH.h"
+
+#include <array>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+#include "Platform/Window.h"
+#include "Scene/SceneSnapshot.h"
+
+/*
+Draws and presents frames on a thread of its own, which owns the window's OpenGL context, so that the main thread can
+process events and update the workspace for the next frame while the GPU works on the current one.
+
+The main thread hands each frame over as a SceneSnapshot, in one of SNAPSHOT_COUNT slots. It waits for a slot the
+render thread has finished with before it writes the next, so it is never more than SNAPSHOT_COUNT - 1 frames ahead of
+the frame being drawn, and input shows up on screen within that many frames. Two slots overlap the update of one frame
+with the drawing of the last. A third would smooth over uneven frames, for a frame more of latency.
+
+Renderer calls that need the context, such as changing the renderer or anti-aliasing mode, are submitted from the
+main thread and travel with the next snapshot, so that they are made on the render thread before it is drawn.
+
+The profiler follows the render thread, which begins and ends its frames. Destroying the RenderThread draws the
+snapshots already submitted, stops the thread, and makes the context current on the main thread again.
+*/
+class RenderThread
+{
+public:
+
+	static constexpr uint32_t SNAPSHOT_COUNT = 2;
+
+public:
+
+	RenderThread() = delete;
+	// Takes the window's context from the calling thread
+	RenderThread(Window& window);
+	RenderThread(const RenderThread&) = delete;
+	~RenderThread();
+
+	// Waits until a slot is free, and returns it to be filled. Snapshots are begun and submitted in turn, on the main thread
+	SceneSnapshot& beginSnapshot();
+	void submitSnapshot();
+
+	// Made on the render thread before the next submitted snapshot is drawn
+	void submitRendererCommand(std::function<void()> command) { m_pendingRendererCommands.push_back(std::move(command)); }
+
+private:
+
+	void run();
+	void drawSnapshot(SceneSnapshot& snapshot);
+
+private:
+
+	Window& m_window;
+
+	std::array<SceneSnapshot, SNAPSHOT_COUNT> m_snapshots;
+	// Only used by the main thread, until they are moved into a snapshot
+	std::vector<std::function<void()>> m_pendingRendererCommands;
+
+	// The snapshot of frame n is in slot n % SNAPSHOT_COUNT
+	std::mutex m_mutex;
+	std::condition_variable m_snapshotSubmitted;
+	std::condition_variable m_snapshotDrawn;
+	uint64_t m_submittedFrameCount = 0;
+	uint64_t m_drawnFrameCount = 0;
+	bool m_stopping = false;
+
+	std::thread m_thread;
+};
@@ -74,13 +74,56 @@ Workspace::Workspace()
 void Workspace::onUpdate(TimeStep ts)
 {
 	m_camera.onUpdate(ts);
-	
-	Renderer::drawScene(m_currentScene, m_camera);
 
 	if (Application::getInput().isKeyPressed(KeyCode::KEY_P))
 		setSceneType(SceneType::PBR);
+	else if (Application::getInput().isKeyPressed(KeyCode::KEY_D))
+		setSceneType(SceneType::PBR_DEFERRED);
 	else if (Application::getInput().isKeyPressed(KeyCode::KEY_B))
 		setSceneType(SceneType::BLINN_PHONG);
+
+	// Z enables and X disables the depth pre-pass
+	if (Application::getInput().isKeyPressed(KeyCode::KEY_Z))
+		Application::submitRendererCommand([]() { Renderer::setDepthPrepassEnabled(true); });
+	else if (Application::getInput().isKeyPressed(KeyCode::KEY_X))
+		Application::submitRendererCommand([]() { Renderer::setDepthPrepassEnabled(false); });
+
+	// O enables and I disables software occlusion culling
+	if (Application::getInput().isKeyPressed(KeyCode::KEY_O))
+		Application::submitRendererCommand([]() { Renderer::setOcclusionCullingEnabled(true); });
+	else if (Application::getInput().isKeyPressed(KeyCode::KEY_I))
+		Application::submitRendererCommand([]() { Renderer::setOcclusionCullingEnabled(false); });
+
+	// R enables and F disables dynamic resolution
+	if (Application::getInput().isKeyPressed(KeyCode::KEY_R))
+		Application::submitRendererCommand([]() { Renderer::setDynamicResolutionEnabled(true); });
+	else if (Application::getInput().isKeyPressed(KeyCode::KEY_F))
+		Application::submitRendererCommand([]() { Renderer::setDynamicResolutionEnabled(false); });
+
+	// 1-6 select the anti-aliasing mode: off, MSAA 2x, 4x, 8x, FXAA, SMAA 1x
+	if (Application::getInput().isKeyPressed(KeyCode::KEY_1))
+		Application::submitRendererCommand([]() { Renderer::setAntiAliasingMode(AntiAliasing::Mode::OFF); });
+	else if (Application::getInput().isKeyPressed(KeyCode::KEY_2))
+		Application::submitRendererCommand([]() { Renderer::setAntiAliasingMode(AntiAliasing::Mode::MSAA_2X); });
+	else if (Application::getInput().isKeyPressed(KeyCode::KEY_3))
+		Application::submitRendererCommand([]() { Renderer::setAntiAliasingMode(AntiAliasing::Mode::MSAA_4X); });
+	else if (Application::getInput().isKeyPressed(KeyCode::KEY_4))
+		Application::submitRendererCommand([]() { Renderer::setAntiAliasingMode(AntiAliasing::Mode::MSAA_8X); });
+	else if (Application::getInput().isKeyPressed(KeyCode::KEY_5))
+		Application::submitRendererCommand([]() { Renderer::setAntiAliasingMode(AntiAliasing::Mode::FXAA); });
+	else if (Application::getInput().isKeyPressed(KeyCode::KEY_6))
+		Application::submitRendererCommand([]() { Renderer::setAntiAliasingMode(AntiAliasing::Mode::SMAA_1X); });
+}
+
+void Workspace::onDraw()
+{
+	Renderer::drawScene(m_currentScene, m_camera);
+}
+
+void Workspace::takeSnapshot(SceneSnapshot& snapshot) const
+{
+	snapshot.scene = m_currentScene->clone();
+	snapshot.camera = CameraSnapshot(m_camera);
 }
 
 void Workspace::onWindowResizeEvent(uint32_t width, uint32_t height)
@@ -99,14 +142,19 @@ void Workspace::setSceneType(SceneType sceneType)
 	{
 	case Workspace::SceneType::BLINN_PHONG:
 		m_currentScene = m_blinnPhongScene;
-		Renderer::setRendererType(Renderer::RendererType::BLINN_PHONG);
+		Application::submitRendererCommand([]() { Renderer::setRendererType(Renderer::RendererType::BLINN_PHONG); });
 		Log::info("Switched to Blinn-Phong scene");
 		break;
 	case Workspace::SceneType::PBR:
 		m_currentScene = m_PBRScene;
-		Renderer::setRendererType(Renderer::RendererType::PBR);
+		Application::submitRendererCommand([]() { Renderer::setRendererType(Renderer::RendererType::PBR); });
 		Log::info("Switched to PBR scene");
 		break;
+	case Workspace::SceneType::PBR_DEFERRED:
+		m_currentScene = m_PBRScene;
+		Application::submitRendererCommand([]() { Renderer::setRendererType(Renderer::RendererType::PBR_DEFERRED); });
+		Log::info("Switched to PBR scene (deferred)");
+		break;
 	default:
 		ASSERT_MESSAGE(false, "Unknown sceneType");
 		break;
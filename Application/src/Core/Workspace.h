@@ -4,6 +4,7 @@
 #include "Renderer/WorkspaceCamera.h"
 #include "Renderer/Texture.h"
 #include "Scene/Scene.h"
+#include "Scene/SceneSnapshot.h"
 
 class Workspace
 {
@@ -11,7 +12,12 @@ public:
 
 	Workspace();
 
+	// Moves the camera and handles key presses. Renderer settings are changed through Application::submitRendererCommand
 	void onUpdate(TimeStep ts);
+	// Draws the current scene, on the thread the OpenGL context is current on
+	void onDraw();
+	// Copies what onDraw would draw, for the render thread to draw instead
+	void takeSnapshot(SceneSnapshot& snapshot) const;
 
 	void onWindowResizeEvent(uint32_t width, uint32_t height);
 	void onMouseScrollEvent(float xOffset, float yOffset);
@@ -21,7 +27,9 @@ private:
 	enum class SceneType
 	{
 		BLINN_PHONG = 0,
-		PBR
+		PBR,
+		// The PBR scene drawn with the deferred renderer
+		PBR_DEFERRED
 	};
 
 	void setSceneType(SceneType sceneType);
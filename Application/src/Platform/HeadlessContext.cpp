@@ -0,0 +1,162 @@
+#include "PCH.h"
+#include "HeadlessContext.h"
+
+#include "glad/glad.h"
+
+#if defined(PBR_LINUX)
+	#include <dlfcn.h>
+#endif
+
+// The parts of EGL used, declared here as libEGL is loaded at runtime (as GLFW does)
+
+using EGLDisplay = void*;
+using EGLConfig = void*;
+using EGLContext = void*;
+using EGLSurface = void*;
+using EGLint = int32_t;
+using EGLBoolean = uint32_t;
+using EGLenum = uint32_t;
+
+static constexpr EGLint EGL_NONE = 0x3038;
+static constexpr EGLint EGL_EXTENSIONS = 0x3055;
+static constexpr EGLint EGL_RENDERABLE_TYPE = 0x3040;
+static constexpr EGLint EGL_OPENGL_BIT = 0x0008;
+static constexpr EGLenum EGL_OPENGL_API = 0x30A2;
+static constexpr EGLint EGL_CONTEXT_MAJOR_VERSION = 0x3098;
+static constexpr EGLint EGL_CONTEXT_MINOR_VERSION = 0x30FB;
+static constexpr EGLint EGL_CONTEXT_OPENGL_PROFILE_MASK = 0x30FD;
+static constexpr EGLint EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT = 0x0001;
+static constexpr EGLenum EGL_PLATFORM_SURFACELESS_MESA = 0x31DD;
+
+using PFN_eglGetProcAddress = void* (*)(const char*);
+using PFN_eglGetError = EGLint (*)();
+using PFN_eglQueryString = const char* (*)(EGLDisplay, EGLint);
+using PFN_eglGetDisplay = EGLDisplay (*)(void*);
+using PFN_eglGetPlatformDisplayEXT = EGLDisplay (*)(EGLenum, void*, const EGLint*);
+using PFN_eglInitialize = EGLBoolean (*)(EGLDisplay, EGLint*, EGLint*);
+using PFN_eglTerminate = EGLBoolean (*)(EGLDisplay);
+using PFN_eglBindAPI = EGLBoolean (*)(EGLenum);
+using PFN_eglChooseConfig = EGLBoolean (*)(EGLDisplay, const EGLint*, EGLConfig*, EGLint, EGLint*);
+using PFN_eglCreateContext = EGLContext (*)(EGLDisplay, EGLConfig, EGLContext, const EGLint*);
+using PFN_eglDestroyContext = EGLBoolean (*)(EGLDisplay, EGLContext);
+using PFN_eglMakeCurrent = EGLBoolean (*)(EGLDisplay, EGLSurface, EGLSurface, EGLContext);
+
+static PFN_eglGetProcAddress s_eglGetProcAddress = nullptr;
+static PFN_eglGetError s_eglGetError = nullptr;
+static PFN_eglQueryString s_eglQueryString = nullptr;
+static PFN_eglGetDisplay s_eglGetDisplay = nullptr;
+static PFN_eglInitialize s_eglInitialize = nullptr;
+static PFN_eglTerminate s_eglTerminate = nullptr;
+static PFN_eglBindAPI s_eglBindAPI = nullptr;
+static PFN_eglChooseConfig s_eglChooseConfig = nullptr;
+static PFN_eglCreateContext s_eglCreateContext = nullptr;
+static PFN_eglDestroyContext s_eglDestroyContext = nullptr;
+static PFN_eglMakeCurrent s_eglMakeCurrent = nullptr;
+
+HeadlessContext::HeadlessContext()
+{
+	loadEGL();
+	createContext();
+
+	Log::info("Created headless OpenGL context: {0} ({1})", reinterpret_cast<const char*>(glGetString(GL_RENDERER)), reinterpret_cast<const char*>(glGetString(GL_VERSION)));
+}
+
+HeadlessContext::~HeadlessContext()
+{
+	if (m_display)
+	{
+		s_eglMakeCurrent(m_display, nullptr, nullptr, nullptr);
+
+		if (m_context)
+			s_eglDestroyContext(m_display, m_context);
+
+		s_eglTerminate(m_display);
+	}
+
+#if defined(PBR_LINUX)
+	if (m_libraryHandle)
+		dlclose(m_libraryHandle);
+#endif
+}
+
+void HeadlessContext::loadEGL()
+{
+#if defined(PBR_LINUX)
+	m_libraryHandle = dlopen("libEGL.so.1", RTLD_LAZY | RTLD_LOCAL);
+	if (!m_libraryHandle)
+		m_libraryHandle = dlopen("libEGL.so", RTLD_LAZY | RTLD_LOCAL);
+
+	ASSERT_MESSAGE(m_libraryHandle, "Failed to load libEGL for headless rendering");
+
+	auto loadFunction = [this](auto& function, const char* name)
+	{
+		function = reinterpret_cast<std::remove_reference_t<decltype(function)>>(dlsym(m_libraryHandle, name));
+		ASSERT_MESSAGE(function, "Failed to load EGL function {0}", name);
+	};
+
+	loadFunction(s_eglGetProcAddress, "eglGetProcAddress");
+	loadFunction(s_eglGetError, "eglGetError");
+	loadFunction(s_eglQueryString, "eglQueryString");
+	loadFunction(s_eglGetDisplay, "eglGetDisplay");
+	loadFunction(s_eglInitialize, "eglInitialize");
+	loadFunction(s_eglTerminate, "eglTerminate");
+	loadFunction(s_eglBindAPI, "eglBindAPI");
+	loadFunction(s_eglChooseConfig, "eglChooseConfig");
+	loadFunction(s_eglCreateContext, "eglCreateContext");
+	loadFunction(s_eglDestroyContext, "eglDestroyContext");
+	loadFunction(s_eglMakeCurrent, "eglMakeCurrent");
+#else
+	ASSERT_MESSAGE(false, "Headless rendering is only supported on Linux");
+#endif
+}
+
+void HeadlessContext::createContext()
+{
+	// The surfaceless platform needs no display server at all. Client extensions are queried without a display
+
+	const char* clientExtensions = s_eglQueryString(nullptr, EGL_EXTENSIONS);
+	bool surfacelessPlatformSupported = clientExtensions && std::string(clientExtensions).find("EGL_MESA_platform_surfaceless") != std::string::npos;
+
+	auto eglGetPlatformDisplayEXT = reinterpret_cast<PFN_eglGetPlatformDisplayEXT>(s_eglGetProcAddress("eglGetPlatformDisplayEXT"));
+
+	if (surfacelessPlatformSupported && eglGetPlatformDisplayEXT)
+		m_display = eglGetPlatformDisplayEXT(EGL_PLATFORM_SURFACELESS_MESA, nullptr, nullptr);
+	else
+	{
+		Log::warn("EGL_MESA_platform_surfaceless is not supported, so the default EGL display is used for headless rendering");
+		m_display = s_eglGetDisplay(nullptr);
+	}
+
+	ASSERT_MESSAGE(m_display, "Failed to get an EGL display (error {0:#x})", s_eglGetError());
+
+	EGLint majorVersion, minorVersion;
+	bool initialised = s_eglInitialize(m_display, &majorVersion, &minorVersion);
+	ASSERT_MESSAGE(initialised, "Failed to initialise EGL (error {0:#x})", s_eglGetError());
+
+	Log::info("Initialised EGL {0}.{1}", majorVersion, minorVersion);
+
+	s_eglBindAPI(EGL_OPENGL_API);
+
+	const EGLint configAttributes[] = { EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT, EGL_NONE };
+	EGLConfig config = nullptr;
+	EGLint configCount = 0;
+	s_eglChooseConfig(m_display, configAttributes, &config, 1, &configCount);
+	ASSERT_MESSAGE(configCount > 0, "Failed to find an EGL config supporting OpenGL (error {0:#x})", s_eglGetError());
+
+	const EGLint contextAttributes[] =
+	{
+		EGL_CONTEXT_MAJOR_VERSION, 4,
+		EGL_CONTEXT_MINOR_VERSION, 6,
+		EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+		EGL_NONE
+	};
+
+	m_context = s_eglCreateContext(m_display, config, nullptr, contextAttributes);
+	ASSERT_MESSAGE(m_context, "Failed to create an OpenGL 4.6 context with EGL (error {0:#x})", s_eglGetError());
+
+	// There are no surfaces, so the context has no default framebuffer (EGL_KHR_surfaceless_context)
+	bool madeCurrent = s_eglMakeCurrent(m_display, nullptr, nullptr, m_context);
+	ASSERT_MESSAGE(madeCurrent, "Failed to make the headless OpenGL context current (error {0:#x})", s_eglGetError());
+
+	gladLoadGLLoader(reinterpret_cast<GLADloadproc>(s_eglGetProcAddress));
+}
@@ -0,0 +1,31 @@
+#pragma once
+#include "PCH.h"
+
+/*
+An OpenGL 4.6 core context with no window or display, for rendering on machines without an X server.
+
+Created through EGL on the surfaceless platform (EGL_MESA_platform_surfaceless), falling back to the default
+display when the extension is missing. The context has no default framebuffer, so everything is drawn to
+framebuffer objects. Works with Mesa's llvmpipe software driver as well as GPU drivers.
+
+libEGL is loaded at runtime rather than linked, so windowed builds don't depend on it. Only Linux is supported.
+*/
+class HeadlessContext
+{
+public:
+
+	HeadlessContext();
+	~HeadlessContext();
+	HeadlessContext(const HeadlessContext&) = delete;
+
+private:
+
+	void loadEGL();
+	void createContext();
+
+private:
+
+	void* m_libraryHandle = nullptr;
+	void* m_display = nullptr;
+	void* m_context = nullptr;
+};
@@ -3,7 +3,9 @@
 
 bool Input::isKeyPressed(KeyCode keyCode) const
 {
-    ASSERT_MESSAGE(m_glfwWindow, "Cannot poll inputs as m_glfwWindow is a nullptr");
+    // Headless windows have no input
+    if (!m_glfwWindow)
+        return false;
 
     int32_t action = glfwGetKey(m_glfwWindow, static_cast<int32_t>(keyCode));
     return action == GLFW_PRESS;
@@ -11,7 +13,8 @@ bool Input::isKeyPressed(KeyCode keyCode) const
 
 bool Input::isMouseButtonPressed(MouseButtonCode mousebuttonCode) const
 {
-    ASSERT_MESSAGE(m_glfwWindow, "Cannot poll inputs as m_glfwWindow is a nullptr");
+    if (!m_glfwWindow)
+        return false;
 
     int32_t action = glfwGetMouseButton(m_glfwWindow, static_cast<int32_t>(mousebuttonCode));
     return action == GLFW_PRESS;
@@ -19,7 +22,8 @@ bool Input::isMouseButtonPressed(MouseButtonCode mousebuttonCode) const
 
 glm::vec2 Input::getMousePosition() const
 {
-    ASSERT_MESSAGE(m_glfwWindow, "Cannot poll inputs as m_glfwWindow is a nullptr");
+    if (!m_glfwWindow)
+        return { 0.0f, 0.0f };
 
     double x, y;
     glfwGetCursorPos(m_glfwWindow, &x, &y);
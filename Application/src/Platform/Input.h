@@ -21,7 +21,8 @@ private:
 
 	Input() = default;
 
-	GLFWwindow* m_glfwWindow;
+	// A nullptr for headless windows, which have no input
+	GLFWwindow* m_glfwWindow = nullptr;
 
 	friend class Window;
 };
\ No newline at end of file
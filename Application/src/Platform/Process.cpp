@@ -0,0 +1,141 @@
+#include "PCH.h"
+#include "Process.h"
+
+#include <cstring>
+
+#if defined(PBR_LINUX)
+	#include <spawn.h>
+	#include <signal.h>
+	#include <sys/wait.h>
+	#include <unistd.h>
+
+	extern char** environ;
+#endif
+
+Process::Process(const std::vector<std::string>& arguments, const std::vector<std::string>& environmentVariables)
+{
+	ASSERT_MESSAGE(!arguments.empty(), "A process needs the path of its executable");
+
+#if defined(PBR_LINUX)
+	std::vector<std::string> environment(environmentVariables);
+
+	// Variables that are overridden aren't inherited
+	for (char** variable = environ; *variable; variable++)
+	{
+		std::string inheritedVariable = *variable;
+		std::string name = inheritedVariable.substr(0, inheritedVariable.find('='));
+
+		bool overridden = std::any_of(environmentVariables.begin(), environmentVariables.end(), [&name](const std::string& environmentVariable)
+		{
+			return environmentVariable.compare(0, name.size() + 1, name + "=") == 0;
+		});
+
+		if (!overridden)
+			environment.push_back(inheritedVariable);
+	}
+
+	auto toCStrings = [](const std::vector<std::string>& strings)
+	{
+		std::vector<char*> cStrings;
+		for (const std::string& string : strings)
+			cStrings.push_back(const_cast<char*>(string.c_str()));
+
+		cStrings.push_back(nullptr);
+		return cStrings;
+	};
+
+	std::vector<char*> argumentCStrings = toCStrings(arguments);
+	std::vector<char*> environmentCStrings = toCStrings(environment);
+
+	pid_t processID;
+	int32_t error = posix_spawn(&processID, arguments[0].c_str(), nullptr, nullptr, argumentCStrings.data(), environmentCStrings.data());
+	if (error != 0)
+		throw ProcessCreationException("Could not start " + arguments[0] + ": " + std::strerror(error));
+
+	m_processID = processID;
+	m_running = true;
+
+	Log::info("Started process {0} ({1})", m_processID, arguments[0]);
+#else
+	throw ProcessCreationException("Child processes are only supported on Linux");
+#endif
+}
+
+Process::~Process()
+{
+	if (isRunning())
+	{
+		kill();
+		wait();
+	}
+}
+
+bool Process::isRunning()
+{
+#if defined(PBR_LINUX)
+	if (!m_running)
+		return false;
+
+	int32_t status;
+	if (waitpid(m_processID, &status, WNOHANG) == m_processID)
+		onExited(status);
+#endif
+
+	return m_running;
+}
+
+void Process::kill()
+{
+#if defined(PBR_LINUX)
+	if (m_running)
+		::kill(m_processID, SIGKILL);
+#endif
+}
+
+int32_t Process::wait()
+{
+#if defined(PBR_LINUX)
+	if (!m_running)
+		return m_exitCode;
+
+	int32_t status;
+	if (waitpid(m_processID, &status, 0) == m_processID)
+		onExited(status);
+	else
+		m_running = false;
+#endif
+
+	return m_exitCode;
+}
+
+int32_t Process::getCurrentProcessID()
+{
+#if defined(PBR_LINUX)
+	return static_cast<int32_t>(getpid());
+#else
+	return 0;
+#endif
+}
+
+std::string Process::getCurrentExecutablePath()
+{
+	std::error_code errorCode;
+	std::filesystem::path executablePath = std::filesystem::read_symlink("/proc/self/exe", errorCode);
+
+	return errorCode ? std::string() : executablePath.string();
+}
+
+void Process::onExited(int32_t status)
+{
+#if defined(PBR_LINUX)
+	m_running = false;
+
+	// Processes killed by a signal report the negated signal, as shells do
+	if (WIFEXITED(status))
+		m_exitCode = WEXITSTATUS(status);
+	else if (WIFSIGNALED(status))
+		m_exitCode = -WTERMSIG(status);
+
+	Log::info("Process {0} exited with code {1}", m_processID, m_exitCode);
+#endif
+}
@@ -0,0 +1,62 @@
+#pragma once
+#include "PCH.h"
+
+/*
+A child process, started from an executable and a list of arguments. It is killed if still running when destroyed.
+
+Only Linux is supported.
+*/
+class Process
+{
+public:
+
+	struct ProcessCreationException : public std::exception
+	{
+		std::string errorMessage;
+
+		ProcessCreationException(const std::string errorMessage)
+			: errorMessage("ProcessCreationException Occured: " + errorMessage) {}
+
+		const char* what() const noexcept override
+		{
+			return errorMessage.c_str();
+		}
+	};
+
+public:
+
+	Process() = delete;
+	// The first argument is the path of the executable. Environment variables are "NAME=value", and are added to
+	// (or replace) this process's
+	Process(const std::vector<std::string>& arguments, const std::vector<std::string>& environmentVariables = {});
+	~Process();
+	Process(const Process&) = delete;
+
+	static Unique<Process> create(const std::vector<std::string>& arguments, const std::vector<std::string>& environmentVariables = {})
+	{
+		return createUnique<Process>(arguments, environmentVariables);
+	}
+
+	// Doesn't block. Once it has exited, the exit code is available
+	bool isRunning();
+	int32_t getExitCode() const { return m_exitCode; }
+
+	void kill();
+	// Blocks until the process exits, returning its exit code
+	int32_t wait();
+
+	int32_t getProcessID() const { return m_processID; }
+
+	static int32_t getCurrentProcessID();
+	static std::string getCurrentExecutablePath();
+
+private:
+
+	void onExited(int32_t status);
+
+private:
+
+	int32_t m_processID = -1;
+	bool m_running = false;
+	int32_t m_exitCode = 0;
+};
@@ -0,0 +1,181 @@
+#include "PCH.h"
+#include "UnixSocket.h"
+
+#include <cstring>
+
+#if defined(PBR_LINUX)
+	#include <sys/socket.h>
+	#include <sys/un.h>
+	#include <fcntl.h>
+	#include <unistd.h>
+#endif
+
+#if defined(PBR_LINUX)
+static sockaddr_un createSocketAddress(const std::string& path)
+{
+	sockaddr_un address = {};
+	address.sun_family = AF_UNIX;
+
+	if (path.size() >= sizeof(address.sun_path))
+		throw UnixSocket::UnixSocketException("Socket path " + path + " is too long");
+
+	std::strncpy(address.sun_path, path.c_str(), sizeof(address.sun_path) - 1);
+
+	return address;
+}
+#endif
+
+UnixSocket::UnixSocket(int32_t fileDescriptor, const std::string& listeningPath)
+	: m_fileDescriptor(fileDescriptor), m_listeningPath(listeningPath)
+{
+}
+
+UnixSocket::~UnixSocket()
+{
+#if defined(PBR_LINUX)
+	if (m_fileDescriptor >= 0)
+		close(m_fileDescriptor);
+
+	if (!m_listeningPath.empty())
+		unlink(m_listeningPath.c_str());
+#endif
+}
+
+Unique<UnixSocket> UnixSocket::listen(const std::string& path)
+{
+#if defined(PBR_LINUX)
+	sockaddr_un address = createSocketAddress(path);
+
+	int32_t fileDescriptor = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+	if (fileDescriptor < 0)
+		throw UnixSocketException(std::string("Could not create socket: ") + std::strerror(errno));
+
+	// Accepting must not block, as it is only tried when poll reports a pending connection
+	fcntl(fileDescriptor, F_SETFL, fcntl(fileDescriptor, F_GETFL) | O_NONBLOCK);
+
+	unlink(path.c_str());
+
+	if (bind(fileDescriptor, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 || ::listen(fileDescriptor, SOMAXCONN) != 0)
+	{
+		std::string error = std::strerror(errno);
+		close(fileDescriptor);
+		throw UnixSocketException("Could not listen on " + path + ": " + error);
+	}
+
+	Log::info("Listening on socket {0}", path);
+
+	return createUnique<UnixSocket>(fileDescriptor, path);
+#else
+	throw UnixSocketException("Unix sockets are only supported on Linux");
+#endif
+}
+
+Unique<UnixSocket> UnixSocket::connect(const std::string& path)
+{
+#if defined(PBR_LINUX)
+	sockaddr_un address = createSocketAddress(path);
+
+	int32_t fileDescriptor = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+	if (fileDescriptor < 0)
+		throw UnixSocketException(std::string("Could not create socket: ") + std::strerror(errno));
+
+	if (::connect(fileDescriptor, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0)
+	{
+		std::string error = std::strerror(errno);
+		close(fileDescriptor);
+		throw UnixSocketException("Could not connect to " + path + ": " + error);
+	}
+
+	return createUnique<UnixSocket>(fileDescriptor);
+#else
+	throw UnixSocketException("Unix sockets are only supported on Linux");
+#endif
+}
+
+Unique<UnixSocket> UnixSocket::accept() const
+{
+#if defined(PBR_LINUX)
+	int32_t fileDescriptor = accept4(m_fileDescriptor, nullptr, nullptr, SOCK_CLOEXEC);
+	if (fileDescriptor < 0)
+		return nullptr;
+
+	return createUnique<UnixSocket>(fileDescriptor);
+#else
+	return nullptr;
+#endif
+}
+
+bool UnixSocket::sendMessage(const std::string& message) const
+{
+#if defined(PBR_LINUX)
+	std::string line = message + '\n';
+
+	size_t sentSize = 0;
+	while (sentSize < line.size())
+	{
+		ssize_t result = send(m_fileDescriptor, line.data() + sentSize, line.size() - sentSize, MSG_NOSIGNAL);
+		if (result < 0 && errno == EINTR)
+			continue;
+		if (result <= 0)
+			return false;
+
+		sentSize += static_cast<size_t>(result);
+	}
+
+	return true;
+#else
+	return false;
+#endif
+}
+
+bool UnixSocket::receiveAvailable()
+{
+#if defined(PBR_LINUX)
+	char buffer[4096];
+	ssize_t result = recv(m_fileDescriptor, buffer, sizeof(buffer), MSG_DONTWAIT);
+
+	if (result < 0)
+		return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+	if (result == 0)
+		return false;
+
+	m_receiveBuffer.append(buffer, static_cast<size_t>(result));
+	return true;
+#else
+	return false;
+#endif
+}
+
+bool UnixSocket::popMessage(std::string& message)
+{
+	size_t lineEnd = m_receiveBuffer.find('\n');
+	if (lineEnd == std::string::npos)
+		return false;
+
+	message = m_receiveBuffer.substr(0, lineEnd);
+	m_receiveBuffer.erase(0, lineEnd + 1);
+
+	return true;
+}
+
+bool UnixSocket::receiveMessage(std::string& message)
+{
+#if defined(PBR_LINUX)
+	while (!popMessage(message))
+	{
+		char buffer[4096];
+		ssize_t result = recv(m_fileDescriptor, buffer, sizeof(buffer), 0);
+
+		if (result < 0 && errno == EINTR)
+			continue;
+		if (result <= 0)
+			return false;
+
+		m_receiveBuffer.append(buffer, static_cast<size_t>(result));
+	}
+
+	return true;
+#else
+	return popMessage(message);
+#endif
+}
@@ -0,0 +1,61 @@
+#pragma once
+#include "PCH.h"
+
+/*
+A local stream socket, bound to a socket file, for communicating between processes on one machine.
+
+Messages are single lines of text. They are buffered as they are received, as a read may return part of a message
+or several of them. Sending never raises SIGPIPE, so a peer closing its end is reported rather than ending the process.
+
+Only Linux is supported.
+*/
+class UnixSocket
+{
+public:
+
+	struct UnixSocketException : public std::exception
+	{
+		std::string errorMessage;
+
+		UnixSocketException(const std::string errorMessage)
+			: errorMessage("UnixSocketException Occured: " + errorMessage) {}
+
+		const char* what() const noexcept override
+		{
+			return errorMessage.c_str();
+		}
+	};
+
+public:
+
+	UnixSocket() = delete;
+	// Takes ownership of the file descriptor. A listening socket removes its socket file when destroyed
+	UnixSocket(int32_t fileDescriptor, const std::string& listeningPath = "");
+	~UnixSocket();
+	UnixSocket(const UnixSocket&) = delete;
+
+	// Replaces any existing socket file at the path
+	static Unique<UnixSocket> listen(const std::string& path);
+	static Unique<UnixSocket> connect(const std::string& path);
+
+	// Returns nullptr if there is no pending connection (listening sockets only)
+	Unique<UnixSocket> accept() const;
+
+	// Both return false once the connection has been closed
+	bool sendMessage(const std::string& message) const;
+	// Reads what has arrived without blocking, for use once poll reports the socket as readable
+	bool receiveAvailable();
+
+	// Takes the oldest complete message received, if there is one
+	bool popMessage(std::string& message);
+	// Blocks until a complete message is received. Returns false if the connection is closed first
+	bool receiveMessage(std::string& message);
+
+	int32_t getFileDescriptor() const { return m_fileDescriptor; }
+
+private:
+
+	int32_t m_fileDescriptor = -1;
+	std::string m_listeningPath;
+	std::string m_receiveBuffer;
+};
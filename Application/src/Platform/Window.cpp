@@ -20,8 +20,16 @@ void Window::shutdown()
 }
 
 Window::Window(const WindowSpecification& specification)
-	: m_specification(specification)
+	: m_specification(specification), m_width(specification.width), m_height(specification.height), m_creationTime(std::chrono::steady_clock::now())
 {
+	if (m_specification.headless)
+	{
+		m_headlessContext = createUnique<HeadlessContext>();
+
+		Log::info("Created headless window with width = {0}, height = {1}", m_specification.width, m_specification.height);
+		return;
+	}
+
 	createGLFWWindow();
 	setUpOpenGLContext();
 
@@ -35,17 +43,58 @@ Window::Window(const WindowSpecification& specification)
 
 Window::~Window()
 {
-	glfwDestroyWindow(m_glfwWindow);
+	if (m_glfwWindow)
+		glfwDestroyWindow(m_glfwWindow);
 }
 
 void Window::onUpdate(TimeStep ts)
 {
-	glfwSwapBuffers(m_glfwWindow);
-	glfwPollEvents();
+	// Headless windows have nothing to present, or events to process
+	if (m_specification.headless)
+		return;
+
+	swapBuffers();
+	pollEvents();
+}
+
+void Window::swapBuffers()
+{
+	if (!m_specification.headless)
+		glfwSwapBuffers(m_glfwWindow);
+}
+
+void Window::pollEvents()
+{
+	if (!m_specification.headless)
+		glfwPollEvents();
+}
+
+void Window::makeContextCurrent()
+{
+	// Headless contexts stay on the thread that created them
+	if (!m_specification.headless)
+		glfwMakeContextCurrent(m_glfwWindow);
+}
+
+void Window::releaseContext()
+{
+	if (!m_specification.headless)
+		glfwMakeContextCurrent(nullptr);
+}
+
+float Window::getWindowTime() const
+{
+	if (m_specification.headless)
+		return std::chrono::duration<float>(std::chrono::steady_clock::now() - m_creationTime).count();
+
+	return static_cast<float>(glfwGetTime());
 }
 
 void Window::setVSync(bool vSyncEnabled)
 {
+	if (m_specification.headless)
+		return;
+
 	if (vSyncEnabled)
 		glfwSwapInterval(1);
 	else
@@ -81,11 +130,11 @@ void Window::registerGLFWEventCallbacks()
 	// Set up event callbacks
 
 	// Specify window data that will be available in all of GLFW's callback functions
-	glfwSetWindowUserPointer(m_glfwWindow, &m_specification);
+	glfwSetWindowUserPointer(m_glfwWindow, this);
 
 	glfwSetWindowCloseCallback(m_glfwWindow, [](GLFWwindow* glfwWindow)
 	{
-		WindowSpecification* specification = static_cast<WindowSpecification*>(glfwGetWindowUserPointer(glfwWindow));
+		WindowSpecification* specification = &static_cast<Window*>(glfwGetWindowUserPointer(glfwWindow))->m_specification;
 
 		if (specification->onWindowCloseCallback)
 			specification->onWindowCloseCallback();
@@ -93,10 +142,13 @@ void Window::registerGLFWEventCallbacks()
 
 	glfwSetWindowSizeCallback(m_glfwWindow, [](GLFWwindow* glfwWindow, int width, int height)
 	{
-		WindowSpecification* specification = static_cast<WindowSpecification*>(glfwGetWindowUserPointer(glfwWindow));
+		Window* window = static_cast<Window*>(glfwGetWindowUserPointer(glfwWindow));
+		WindowSpecification* specification = &window->m_specification;
 
 		specification->width = width;
 		specification->height = height;
+		window->m_width.store(static_cast<uint32_t>(width), std::memory_order_relaxed);
+		window->m_height.store(static_cast<uint32_t>(height), std::memory_order_relaxed);
 
 		if (specification->onWindowResizeCallback)
 			specification->onWindowResizeCallback(static_cast<uint32_t>(width), static_cast<uint32_t>(height));
@@ -104,7 +156,7 @@ void Window::registerGLFWEventCallbacks()
 
 	glfwSetScrollCallback(m_glfwWindow, [](GLFWwindow* glfwWindow, double xOffset, double yOffset)
 	{
-		WindowSpecification* specification = static_cast<WindowSpecification*>(glfwGetWindowUserPointer(glfwWindow));
+		WindowSpecification* specification = &static_cast<Window*>(glfwGetWindowUserPointer(glfwWindow))->m_specification;
 
 		if (specification->onMouseScrollCallback)
 			specification->onMouseScrollCallback(static_cast<float>(xOffset), static_cast<float>(yOffset));
@@ -1,9 +1,13 @@
 #pragma once
 #include "PCH.h"
 
+#include <atomic>
+#include <chrono>
+
 #include "glfw3.h"
 
 #include "Input.h"
+#include "HeadlessContext.h"
 
 class Window
 {
@@ -14,6 +18,9 @@ public:
 		std::string title = "Hello World";
 		uint32_t width = DEFAULT_WIDTH, height = DEFAULT_HEIGHT;
 		bool vSyncEnabled = false;
+		// No GLFW window is opened, and the OpenGL context is created with HeadlessContext instead. It has no
+		// default framebuffer or input, and the width and height are those of the offscreen framebuffer drawn to
+		bool headless = false;
 
 		// Redefinition of default values through the default constructor
 		// is necessary to get around a gcc bug.
@@ -21,7 +28,7 @@ public:
 		WindowSpecification()
 			: title("Hello World"),
 			  width(DEFAULT_WIDTH), height(DEFAULT_HEIGHT),
-			  vSyncEnabled(false) {}
+			  vSyncEnabled(false), headless(false) {}
 		
 		// Callback event methods
 
@@ -32,7 +39,7 @@ public:
 
 public:
 
-	// Initialise the windowing system
+	// Initialise the windowing system. Not needed by headless windows
 	static void init();
 
 	// Shutdown the windowing system
@@ -41,17 +48,30 @@ public:
 	Window(const WindowSpecification& specification = WindowSpecification());
 	~Window();
 
+	// Presents the frame and processes events
 	void onUpdate(TimeStep ts);
 
-	float getWindowTime() const { return static_cast<float>(glfwGetTime()); }
+	// Can be called from whichever thread the OpenGL context is current on
+	void swapBuffers();
+	// Only called from the main thread, which GLFW delivers events on
+	void pollEvents();
+
+	// The OpenGL context is current on one thread at a time, which is the main thread once the window is created
+	void makeContextCurrent();
+	void releaseContext();
+
+	float getWindowTime() const;
 
 	const Input& getInput() const { return m_input; }
 
 	bool getVSyncEnabled() const { return m_specification.vSyncEnabled; }
 	void setVSync(bool vSyncEnabled);
 
-	uint32_t getWidth() const { return m_specification.width; }
-	uint32_t getHeight() const { return m_specification.height; }
+	// Read by the render thread while the main thread processes resize events
+	uint32_t getWidth() const { return m_width.load(std::memory_order_relaxed); }
+	uint32_t getHeight() const { return m_height.load(std::memory_order_relaxed); }
+
+	bool isHeadless() const { return m_specification.headless; }
 
 private:
 
@@ -62,6 +82,12 @@ private:
 private:
 
 	WindowSpecification m_specification;
-	GLFWwindow* m_glfwWindow;
+	GLFWwindow* m_glfwWindow = nullptr;
 	Input m_input;
+
+	std::atomic<uint32_t> m_width;
+	std::atomic<uint32_t> m_height;
+
+	Unique<HeadlessContext> m_headlessContext;
+	std::chrono::steady_clock::time_point m_creationTime;
 };
\ No newline at end of file
@@ -0,0 +1,229 @@
+#include "PCH.h"
+#include "AntiAliasing.h"
+
+#include "Core/Application.h"
+
+#include "RenderTargetPool.h"
+
+AntiAliasing::AntiAliasing()
+{
+	// The passes all draw a screen quad, so share the post processing vertex shader
+
+	m_FXAAShader = createUnique<Shader>(std::initializer_list<std::string>
+	{
+		"Assets/Shaders/PBRPostProcessing.glsl.vert",
+		"Assets/Shaders/FXAA.glsl.frag"
+	});
+
+	m_SMAAEdgeDetectionShader = createUnique<Shader>(std::initializer_list<std::string>
+	{
+		"Assets/Shaders/PBRPostProcessing.glsl.vert",
+		"Assets/Shaders/SMAAEdgeDetection.glsl.frag"
+	});
+
+	m_SMAABlendingWeightsShader = createUnique<Shader>(std::initializer_list<std::string>
+	{
+		"Assets/Shaders/PBRPostProcessing.glsl.vert",
+		"Assets/Shaders/SMAABlendingWeights.glsl.frag"
+	});
+
+	m_SMAANeighbourhoodBlendingShader = createUnique<Shader>(std::initializer_list<std::string>
+	{
+		"Assets/Shaders/PBRPostProcessing.glsl.vert",
+		"Assets/Shaders/SMAANeighbourhoodBlending.glsl.frag"
+	});
+
+	initialiseQuadBuffers();
+}
+
+void AntiAliasing::draw(const Framebuffer& input)
+{
+	ASSERT_MESSAGE(input.getSpecification().samples == 1, "Post process anti-aliasing needs a single sample input");
+
+	m_quadVertexBuffer->bind();
+	m_quadIndexBuffer->bind();
+
+	switch (m_mode)
+	{
+	case Mode::FXAA:
+		drawFXAA(input);
+		break;
+	case Mode::SMAA_1X:
+		drawSMAA(input);
+		break;
+	default:
+		ASSERT_MESSAGE(false, "Anti-aliasing mode is not a post process mode");
+		break;
+	}
+}
+
+uint64_t AntiAliasing::getMemoryUsage() const
+{
+	if (m_mode != Mode::SMAA_1X)
+		return 0;
+
+	return Framebuffer::getMemoryUsage(getSMAAEdgesFramebufferSpecification()) + Framebuffer::getMemoryUsage(getSMAABlendingWeightsFramebufferSpecification());
+}
+
+uint32_t AntiAliasing::getSampleCount(Mode mode)
+{
+	switch (mode)
+	{
+	case Mode::MSAA_2X:
+		return 2;
+		break;
+	case Mode::MSAA_4X:
+		return 4;
+		break;
+	case Mode::MSAA_8X:
+		return 8;
+		break;
+	default:
+		return 1;
+		break;
+	}
+}
+
+const char* AntiAliasing::getModeName(Mode mode)
+{
+	switch (mode)
+	{
+	case Mode::OFF:
+		return "Off";
+		break;
+	case Mode::MSAA_2X:
+		return "MSAA 2x";
+		break;
+	case Mode::MSAA_4X:
+		return "MSAA 4x";
+		break;
+	case Mode::MSAA_8X:
+		return "MSAA 8x";
+		break;
+	case Mode::FXAA:
+		return "FXAA";
+		break;
+	case Mode::SMAA_1X:
+		return "SMAA 1x";
+		break;
+	default:
+		ASSERT_MESSAGE(false, "Unknown anti-aliasing mode");
+		return "";
+		break;
+	}
+}
+
+void AntiAliasing::initialiseQuadBuffers()
+{
+	static constexpr float quadVertices[] =
+	{
+		-1.0f, -1.0f,  0.0f, 0.0f,
+		 1.0f, -1.0f,  1.0f, 0.0f,
+		 1.0f,  1.0f,  1.0f, 1.0f,
+		-1.0f,  1.0f,  0.0f, 1.0f
+	};
+
+	static constexpr uint32_t quadIndices[6] =
+	{
+		0, 1, 2,
+		0, 2, 3
+	};
+
+	VertexBufferLayout vertexBufferLayout =
+	{
+		{ ShaderDataType::FLOAT2, "a_position" },
+		{ ShaderDataType::FLOAT2, "a_textureCoordinates"},
+	};
+
+	m_quadVertexBuffer = createUnique<VertexBuffer>(static_cast<const void*>(quadVertices), sizeof(quadVertices), vertexBufferLayout);
+	m_quadIndexBuffer = createUnique<IndexBuffer>(quadIndices, 6);
+}
+
+Framebuffer::FramebufferSpecification AntiAliasing::getSMAAEdgesFramebufferSpecification()
+{
+	Framebuffer::FramebufferSpecification edgesFramebufferSpecification;
+	edgesFramebufferSpecification.width = Application::getWindow().getWidth();
+	edgesFramebufferSpecification.height = Application::getWindow().getHeight();
+	edgesFramebufferSpecification.colorAttachmentFormats = { Framebuffer::ColorAttachmentFormat::RG8 };
+	edgesFramebufferSpecification.depthAttachmentFormat = Framebuffer::DepthAttachmentFormat::NONE;
+	// Pixels without edges are discarded in both passes, leaving them cleared to zero
+	edgesFramebufferSpecification.clearColor = { 0.0f, 0.0f, 0.0f, 0.0f };
+
+	return edgesFramebufferSpecification;
+}
+
+Framebuffer::FramebufferSpecification AntiAliasing::getSMAABlendingWeightsFramebufferSpecification()
+{
+	Framebuffer::FramebufferSpecification blendingWeightsFramebufferSpecification = getSMAAEdgesFramebufferSpecification();
+	blendingWeightsFramebufferSpecification.colorAttachmentFormats = { Framebuffer::ColorAttachmentFormat::RGBA8 };
+
+	return blendingWeightsFramebufferSpecification;
+}
+
+void AntiAliasing::drawFXAA(const Framebuffer& input)
+{
+	const Framebuffer::FramebufferSpecification& inputSpecification = input.getSpecification();
+
+	RendererUtilities::bindDefaultFramebuffer();
+
+	m_FXAAShader->bind();
+
+	input.bindColorAttachment(0);
+	m_FXAAShader->setUniformToValue("u_inputTexture", 0);
+	m_FXAAShader->setUniformToValue("u_textureCoordinatesScale", input.getTextureCoordinatesScale());
+	// Pixel offsets are in texture coordinates, so are relative to the allocated size rather than the render size
+	m_FXAAShader->setUniformToValue("u_inversePixelSize", glm::vec2(1.0f / static_cast<float>(inputSpecification.width), 1.0f / static_cast<float>(inputSpecification.height)));
+
+	RendererUtilities::drawIndexed(m_quadIndexBuffer->getCount());
+
+	RendererLog::trace("Drew FXAA pass");
+}
+
+void AntiAliasing::drawSMAA(const Framebuffer& input)
+{
+	// The intermediate targets are returned to the pool as soon as they have been read
+
+	const Framebuffer& edgesFramebuffer = RenderTargetPool::acquire(getSMAAEdgesFramebufferSpecification());
+	const Framebuffer& blendingWeightsFramebuffer = RenderTargetPool::acquire(getSMAABlendingWeightsFramebufferSpecification());
+
+	// Edges
+
+	edgesFramebuffer.clear();
+
+	m_SMAAEdgeDetectionShader->bind();
+
+	input.bindColorAttachment(0);
+	m_SMAAEdgeDetectionShader->setUniformToValue("u_inputTexture", 0);
+
+	RendererUtilities::drawIndexed(m_quadIndexBuffer->getCount());
+
+	// Blending weights
+
+	blendingWeightsFramebuffer.clear();
+
+	m_SMAABlendingWeightsShader->bind();
+
+	edgesFramebuffer.bindColorAttachment(0);
+	m_SMAABlendingWeightsShader->setUniformToValue("u_edgesTexture", 0);
+
+	RendererUtilities::drawIndexed(m_quadIndexBuffer->getCount());
+
+	RenderTargetPool::release(edgesFramebuffer);
+
+	// Neighbourhood blending
+
+	RendererUtilities::bindDefaultFramebuffer();
+
+	m_SMAANeighbourhoodBlendingShader->bind();
+
+	input.bindColorAttachment(0);
+	blendingWeightsFramebuffer.bindColorAttachment(1);
+	m_SMAANeighbourhoodBlendingShader->setUniformToValue("u_inputTexture", 0);
+	m_SMAANeighbourhoodBlendingShader->setUniformToValue("u_blendingWeightsTexture", 1);
+
+	RendererUtilities::drawIndexed(m_quadIndexBuffer->getCount());
+
+	RenderTargetPool::release(blendingWeightsFramebuffer);
+
+	RendererLog::trace("Drew SMAA 1x passes");
+}
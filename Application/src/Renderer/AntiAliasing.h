@@ -0,0 +1,80 @@
+#pragma once
+#include "PCH.h"
+
+#include "Framebuffer.h"
+#include "Shader.h"
+#include "VertexBuffer.h"
+#include "IndexBuffer.h"
+
+/*
+The anti-aliasing mode of a renderer, and the post process passes for the modes which need them.
+
+MSAA modes only change the number of samples of the renderer's scene framebuffer. The post process modes (FXAA and
+SMAA 1x) draw the scene single sampled, which at high resolutions saves most of the memory and resolve bandwidth
+that MSAA costs on HDR targets, and then anti-alias the final tone mapped image as it is drawn to the screen:
+
+	FXAA    - one pass, which finds the direction of the edge through each pixel and blends along it
+	SMAA 1x - edge detection, then the blending weights of each edge (from its length and how it ends),
+	          then blending each pixel with its neighbours by those weights
+
+The intermediate targets SMAA needs are requested from the render target pool only while its passes are drawn.
+*/
+class AntiAliasing
+{
+public:
+
+	enum class Mode
+	{
+		OFF = 0,
+		MSAA_2X,
+		MSAA_4X,
+		MSAA_8X,
+		FXAA,
+		SMAA_1X
+	};
+
+public:
+
+	AntiAliasing();
+	~AntiAliasing() = default;
+	AntiAliasing(const AntiAliasing&) = delete;
+
+	void setMode(Mode mode) { m_mode = mode; }
+	Mode getMode() const { return m_mode; }
+
+	// Samples per pixel for the scene framebuffer - 1 unless an MSAA mode is in use
+	uint32_t getSampleCount() const { return getSampleCount(m_mode); }
+	// Whether the scene is drawn single sampled, then anti-aliased by draw()
+	bool isPostProcess() const { return m_mode == Mode::FXAA || m_mode == Mode::SMAA_1X; }
+
+	// Draws the first color attachment of the input to the default framebuffer with the post process mode in use.
+	// The input must be single sampled, and already tone mapped and gamma corrected
+	void draw(const Framebuffer& input);
+
+	// Bytes needed by the intermediate targets of the mode in use, at the window's size
+	uint64_t getMemoryUsage() const;
+
+	static uint32_t getSampleCount(Mode mode);
+	static const char* getModeName(Mode mode);
+
+private:
+
+	void initialiseQuadBuffers();
+	static Framebuffer::FramebufferSpecification getSMAAEdgesFramebufferSpecification();
+	static Framebuffer::FramebufferSpecification getSMAABlendingWeightsFramebufferSpecification();
+
+	void drawFXAA(const Framebuffer& input);
+	void drawSMAA(const Framebuffer& input);
+
+private:
+
+	Mode m_mode = Mode::MSAA_8X;
+
+	Unique<Shader> m_FXAAShader;
+	Unique<Shader> m_SMAAEdgeDetectionShader;
+	Unique<Shader> m_SMAABlendingWeightsShader;
+	Unique<Shader> m_SMAANeighbourhoodBlendingShader;
+
+	Unique<VertexBuffer> m_quadVertexBuffer;
+	Unique<IndexBuffer> m_quadIndexBuffer;
+};
@@ -1,11 +1,15 @@
 #include "PCH.h"
 #include "BlinnPhongRendererImplementation.h"
 
+#include "Core/Application.h"
+
 #include "VertexBufferLayout.h"
+#include "GeometryArena.h"
+#include "RenderGraph.h"
 
 BlinnPhongRendererImplementation::BlinnPhongRendererImplementation()
 {
-	initialiseMultisampleFramebuffer();
+	m_antiAliasing = createUnique<AntiAliasing>();
 
 	m_blinnPhongShader = createUnique<Shader>(std::initializer_list<std::string>
 	{
@@ -13,91 +17,193 @@ BlinnPhongRendererImplementation::BlinnPhongRendererImplementation()
 		"Assets/Shaders/BlinnPhong.glsl.frag"
 	});
 
+	m_depthPrepassShader = createUnique<Shader>(std::initializer_list<std::string>
+	{
+		"Assets/Shaders/DepthPrepass.glsl.vert",
+		"Assets/Shaders/DepthPrepass.glsl.frag"
+	});
+
 	initialiseDefaultMaterialTextures();
 
-	Log::info("Blinn-Phong renderer initialised");
+	m_drawList = createUnique<IndirectDrawList>();
+
+	m_lightClusterGrid = createUnique<LightClusterGrid>();
+	m_pointLightBuffer = createUnique<StorageBuffer>(sizeof(PointLightData) * 1024);
+	m_pointShadowAtlas = createUnique<PointShadowAtlas>();
+	m_shadedSampleQuery = createUnique<Query>(Query::QueryType::SAMPLES_PASSED);
+
+	RendererLog::info("Blinn-Phong renderer initialised");
+}
+
+void BlinnPhongRendererImplementation::setAntiAliasingMode(AntiAliasing::Mode mode)
+{
+	// The framebuffer is requested with the mode's sample count from the next frame
+	m_antiAliasing->setMode(mode);
 }
 
-void BlinnPhongRendererImplementation::onWindowResizeEvent(uint32_t width, uint32_t height)
+uint64_t BlinnPhongRendererImplementation::getRenderTargetMemoryUsage() const
 {
-	m_multisampleFramebuffer->onWindowResizeEvent(width, height);
+	return Framebuffer::getMemoryUsage(getFramebufferSpecification()) + m_antiAliasing->getMemoryUsage() + m_pointShadowAtlas->getMemoryUsage();
 }
 
 void BlinnPhongRendererImplementation::beginScene(const Camera& camera, const std::vector<Reference<PointLight>>& pointLights)
 {
-	Log::trace("Beginning to render a Blinn-Phong scene");
+	RendererLog::trace("Beginning to render a Blinn-Phong scene");
 
-	m_multisampleFramebuffer->bind();
-	m_multisampleFramebuffer->clear();
+	// Lights are assigned to clusters with a compute shader, so this is done before the Blinn-Phong shader is bound
+
+	m_lightClusterGrid->build(pointLights, camera, Application::getWindow().getWidth(), Application::getWindow().getHeight());
+	m_lightClusterGrid->bind();
+
+	uploadPointLights(pointLights);
+	m_pointShadowAtlas->beginScene(pointLights, camera);
 
 	m_blinnPhongShader->bind();
 
-	m_blinnPhongShader->setUniformToValue("u_projectionViewMatrix", camera.getProjectionMatrix() * camera.getViewMatrix());
+	m_projectionViewMatrix = camera.getProjectionMatrix() * camera.getViewMatrix();
+	m_blinnPhongShader->setUniformToValue("u_projectionViewMatrix", m_projectionViewMatrix);
 	m_blinnPhongShader->setUniformToValue("u_viewPosition", camera.getCameraPosition());
 
-	setLightUniforms(pointLights);
+	m_lightClusterGrid->setClusterUniforms(*m_blinnPhongShader);
+
+	m_drawList->clear(camera.getCameraPosition());
 }
 
 void BlinnPhongRendererImplementation::endScene(float exposureLevel)
 {
-	// Blit contents of m_framebuffer to the default framebuffer so it appears in the window
-	m_multisampleFramebuffer->blitToTargetFramebuffer();
+	// Shadow maps are kept from frame to frame rather than created by the graph, so they are drawn before it
+
+	m_drawList->upload();
+	m_pointShadowAtlas->drawShadowMaps(*m_drawList);
+	m_pointShadowAtlas->bind(*m_blinnPhongShader);
 
-	Log::trace("Ended the rendering of a Blinn-Phong scene");
+	RenderGraph renderGraph;
+
+	RenderGraph::ResourceHandle sceneFramebuffer = renderGraph.createFramebuffer("Scene", getFramebufferSpecification());
+
+	renderGraph.addPass("Scene", {}, { { sceneFramebuffer, RenderGraph::Access::ATTACHMENT } }, [this, sceneFramebuffer](RenderGraph& graph)
+	{
+		Framebuffer& framebuffer = graph.getFramebuffer(sceneFramebuffer);
+		framebuffer.bind();
+		framebuffer.clear();
+
+		drawBatches();
+	});
+
+	// The Blinn-Phong shader gamma corrects its output, so the framebuffer can be anti-aliased as it is.
+	// Otherwise, blit (resolving any MSAA samples) the scene to the default framebuffer so it appears in the window
+
+	if (m_antiAliasing->isPostProcess())
+	{
+		renderGraph.addPass("Anti-aliasing", { { sceneFramebuffer, RenderGraph::Access::TEXTURE } }, { { RenderGraph::DEFAULT_FRAMEBUFFER, RenderGraph::Access::ATTACHMENT } }, [this, sceneFramebuffer](RenderGraph& graph)
+		{
+			m_antiAliasing->draw(graph.getFramebuffer(sceneFramebuffer));
+		});
+	}
+	else
+	{
+		renderGraph.addPass("Present", { { sceneFramebuffer, RenderGraph::Access::BLIT } }, { { RenderGraph::DEFAULT_FRAMEBUFFER, RenderGraph::Access::ATTACHMENT } }, [sceneFramebuffer](RenderGraph& graph)
+		{
+			graph.getFramebuffer(sceneFramebuffer).blitToTargetFramebuffer();
+		});
+	}
+
+	renderGraph.compile();
+	renderGraph.execute();
+
+	RendererLog::trace("Ended the rendering of a Blinn-Phong scene");
 
 	// exposureLevel is not used in the BlinnPhong renderer but is still passed in to keep the API consistent
 }
 
 void BlinnPhongRendererImplementation::drawScene(Reference<Scene> scene, const Camera& camera)
 {
-	Log::trace("Drawing Blinn-Phong scene");
+	RendererLog::trace("Drawing Blinn-Phong scene");
 
 	beginScene(camera, scene->getPointLights());
 
-	for (auto modelAndTransform : scene->getModelsAndTransforms())
-		drawModel(modelAndTransform.first, modelAndTransform.second);
+	const auto& modelsAndTransforms = scene->getModelsAndTransforms();
+	for (uint32_t i = 0; i < static_cast<uint32_t>(modelsAndTransforms.size()); i++)
+	{
+		if (isModelVisible(i))
+			drawModel(modelsAndTransforms[i].first, modelsAndTransforms[i].second);
+	}
 
 	endScene();
 }
 
 void BlinnPhongRendererImplementation::drawModel(Reference<Model> model, const glm::mat4& transform)
 {
-	Log::trace("Drawing Blinn-Phong model {0} with {1} meshes", model->getModelIdentifier(), static_cast<uint32_t>(model->getMeshes().size()));
+	RendererLog::trace("Drawing Blinn-Phong model {0} with {1} meshes", model->getModelIdentifier(), static_cast<uint32_t>(model->getMeshes().size()));
 
-	model->getVertexBuffer()->bind();
-	model->getIndexBuffer()->bind();
+	// Draws are deferred until endScene so that the meshes of all models can be batched by material
+	m_drawList->addModel(model, transform);
+}
 
-	const std::vector<Reference<Material>>& materials = model->getMaterials();
-	const auto& materialToMeshMapping = model->getMaterialToMeshMapping();
-	const std::vector<Model::Mesh>& meshes = model->getMeshes();
+void BlinnPhongRendererImplementation::drawBatches()
+{
+	m_drawList->bind();
 
-	for (uint32_t i = 0; i < materials.size(); i++)
+	if (m_depthPrepassEnabled)
+		drawDepthPrepass();
+
+	GeometryArena::bind();
+	m_blinnPhongShader->bind();
+
+	if (m_shadedSampleCountingEnabled)
+		m_shadedSampleQuery->begin();
+
+	m_boundTextureSet = IndirectDrawList::NO_TEXTURE_SET;
+
+	const std::vector<IndirectDrawList::Batch>& batches = m_drawList->getBatches();
+
+	for (uint32_t i = 0; i < static_cast<uint32_t>(batches.size()); i++)
 	{
-		const BlinnPhongMaterial& material = static_cast<const BlinnPhongMaterial&>(*materials[i]);
-		setMaterialUniforms(material);
+		if (i == 0 || batches[i].pass != batches[i - 1].pass)
+			setPassState(batches[i].pass, m_depthPrepassEnabled);
 
-		const std::vector<uint32_t>& meshesForTheCurrentMaterial = materialToMeshMapping.at(i);
+		setBatchMaterial(batches[i]);
 
-		for (uint32_t meshIndex : meshesForTheCurrentMaterial)
-		{
-			const Model::Mesh& mesh = meshes[meshIndex];
+		RendererUtilities::multiDrawIndexedIndirect(IndirectDrawList::getCommandOffset(batches[i]), batches[i].drawCount, m_drawList->getBatchCommands(batches[i]));
+	}
 
-			glm::mat4 meshTransform = transform * mesh.transform;
-			m_blinnPhongShader->setUniformToValue("u_transform", meshTransform);
+	if (m_shadedSampleCountingEnabled)
+	{
+		m_shadedSampleQuery->end();
+		m_shadedSampleCount = m_shadedSampleQuery->getResult();
 
-			const void* startOfIndices = reinterpret_cast<const void*>(static_cast<uint64_t>(sizeof(uint32_t)) * static_cast<uint64_t>(mesh.baseIndex));
-			RendererUtilities::drawIndexedFromVertexOffset(mesh.indexCount, startOfIndices, mesh.baseVertex);
-		}
+		RendererLog::trace("Shaded {0} samples in the main pass (depth pre-pass {1})", m_shadedSampleCount, m_depthPrepassEnabled ? "enabled" : "disabled");
 	}
+
+	resetPassState();
+}
+
+void BlinnPhongRendererImplementation::drawDepthPrepass()
+{
+	GeometryArena::bindPositions();
+
+	m_depthPrepassShader->bind();
+	m_depthPrepassShader->setUniformToValue("u_projectionViewMatrix", m_projectionViewMatrix);
+
+	RendererUtilities::setColorWriteEnabled(false);
+
+	// Materials don't affect the depth of solid geometry, so its batches (which come first) can all be drawn at once
+	RendererUtilities::multiDrawIndexedIndirect(nullptr, m_drawList->getSolidDrawCount(), m_drawList->getCommands().data());
+
+	RendererUtilities::setColorWriteEnabled(true);
+
+	RendererLog::trace("Drew depth pre-pass of {0} draws", m_drawList->getSolidDrawCount());
 }
 
-void BlinnPhongRendererImplementation::initialiseMultisampleFramebuffer()
+Framebuffer::FramebufferSpecification BlinnPhongRendererImplementation::getFramebufferSpecification() const
 {
-	Framebuffer::FramebufferSpecification multisampleFramebufferSpecification;
-	multisampleFramebufferSpecification.samples = 8;
-	multisampleFramebufferSpecification.clearColor = { 0.1f, 0.1f, 0.1f, 1.0f };
+	Framebuffer::FramebufferSpecification framebufferSpecification;
+	framebufferSpecification.width = Application::getWindow().getWidth();
+	framebufferSpecification.height = Application::getWindow().getHeight();
+	framebufferSpecification.samples = m_antiAliasing->getSampleCount();
+	framebufferSpecification.clearColor = { 0.1f, 0.1f, 0.1f, 1.0f };
 
-	m_multisampleFramebuffer = createUnique<Framebuffer>(multisampleFramebufferSpecification);
+	return framebufferSpecification;
 }
 
 void BlinnPhongRendererImplementation::initialiseDefaultMaterialTextures()
@@ -107,18 +213,35 @@ void BlinnPhongRendererImplementation::initialiseDefaultMaterialTextures()
 	m_defaultSpecularMapTexture = createUnique<Texture>(static_cast<void*>(whitePixelImageData), 1, 1, 4);
 }
 
-void BlinnPhongRendererImplementation::setLightUniforms(const std::vector<Reference<PointLight>>& pointLights)
+void BlinnPhongRendererImplementation::uploadPointLights(const std::vector<Reference<PointLight>>& pointLights)
+{
+	// Lights are in the same order as they were given to the cluster grid, as that is how the clusters refer to them
+
+	m_pointLightData.clear();
+
+	for (const Reference<PointLight>& light : pointLights)
+	{
+		const BlinnPhongPointLight& pointLight = static_cast<const BlinnPhongPointLight&>(*light);
+		m_pointLightData.push_back({ pointLight.worldPosition, pointLight.lightRadius, pointLight.diffuseComponent, 0.0f, pointLight.specularComponent, 0.0f });
+	}
+
+	if (!m_pointLightData.empty())
+		m_pointLightBuffer->setData(static_cast<const void*>(m_pointLightData.data()), sizeof(PointLightData) * m_pointLightData.size());
+
+	m_pointLightBuffer->bind(LightClusterGrid::POINT_LIGHTS_BINDING_POINT);
+}
+
+void BlinnPhongRendererImplementation::setBatchMaterial(const IndirectDrawList::Batch& batch)
 {
-	m_blinnPhongShader->setUniformToValue("u_pointLightNumber", static_cast<uint32_t>(pointLights.size()));
+	const BlinnPhongMaterial& material = static_cast<const BlinnPhongMaterial&>(*batch.material);
+
+	setMaterialUniforms(material);
 
-	for (uint32_t i = 0; i < static_cast<uint32_t>(pointLights.size()); i++)
+	// Batches are sorted so that those sharing textures are next to each other, and only the first needs to bind them
+	if (batch.textureSet != m_boundTextureSet)
 	{
-		const BlinnPhongPointLight& pointLight = static_cast<const BlinnPhongPointLight&>(*pointLights[i]);
-		std::string uniformName = "u_pointLights[" + std::to_string(i) + "]";
-		m_blinnPhongShader->setUniformToValue(uniformName + ".worldPosition", pointLight.worldPosition);
-		m_blinnPhongShader->setUniformToValue(uniformName + ".diffuseComponent", pointLight.diffuseComponent);
-		m_blinnPhongShader->setUniformToValue(uniformName + ".specularComponent", pointLight.specularComponent);
-		m_blinnPhongShader->setUniformToValue(uniformName + ".lightRadius", pointLight.lightRadius);
+		bindMaterialTextures(material);
+		m_boundTextureSet = batch.textureSet;
 	}
 }
 
@@ -126,7 +249,13 @@ void BlinnPhongRendererImplementation::setMaterialUniforms(const BlinnPhongMater
 {
 	m_blinnPhongShader->setUniformToValue("u_material.diffuseColor", material.diffuseColor);
 	m_blinnPhongShader->setUniformToValue("u_material.specularColor", material.specularColor);
+	m_blinnPhongShader->setUniformToValue("u_material.shininess", material.shininess);
+	m_blinnPhongShader->setUniformToValue("u_material.alphaCutoff", material.alphaCutoff);
+	m_blinnPhongShader->setUniformToValue("u_material.useAlphaTest", material.alphaMode == Material::AlphaMode::MASK);
+}
 
+void BlinnPhongRendererImplementation::bindMaterialTextures(const BlinnPhongMaterial& material)
+{
 	if (material.diffuseMap)
 		material.diffuseMap->bind(0);
 	else
@@ -148,5 +277,4 @@ void BlinnPhongRendererImplementation::setMaterialUniforms(const BlinnPhongMater
 
 	m_blinnPhongShader->setUniformToValue("u_material.diffuseMap", 0);
 	m_blinnPhongShader->setUniformToValue("u_material.specularMap", 1);
-	m_blinnPhongShader->setUniformToValue("u_material.shininess", material.shininess);
 }
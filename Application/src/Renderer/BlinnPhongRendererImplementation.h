@@ -7,36 +7,83 @@
 #include "Shader.h"
 #include "VertexBuffer.h"
 #include "IndexBuffer.h"
+#include "IndirectDrawList.h"
 #include "Material.h"
+#include "Query.h"
+#include "LightClusterGrid.h"
+#include "PointShadowAtlas.h"
 
 class BlinnPhongRendererImplementation : public RendererImplementation
 {
+public:
+
+	// Matches the PointLight struct in BlinnPhong.glsl.frag (std430 layout)
+	struct PointLightData
+	{
+		glm::vec3 worldPosition;
+		float lightRadius;
+		glm::vec3 diffuseComponent;
+		float padding0;
+		glm::vec3 specularComponent;
+		float padding1;
+	};
+
 public:
 
 	BlinnPhongRendererImplementation();
 	virtual ~BlinnPhongRendererImplementation() = default;
 	BlinnPhongRendererImplementation(const BlinnPhongRendererImplementation&) = delete;
 
-	void onWindowResizeEvent(uint32_t width, uint32_t height) override;
-
 	void beginScene(const Camera& camera, const std::vector<Reference<PointLight>>& pointLights) override;
 	void endScene(float exposureLevel = 1.0f) override;
 
 	void drawScene(Reference<Scene> scene, const Camera& camera) override;
 	void drawModel(Reference<Model> model, const glm::mat4& transform) override;
 
+	void setDepthPrepassEnabled(bool enabled) override { m_depthPrepassEnabled = enabled; }
+
+	void setShadedSampleCountingEnabled(bool enabled) override { m_shadedSampleCountingEnabled = enabled; }
+	uint64_t getShadedSampleCount() const override { return m_shadedSampleCount; }
+
+	void setAntiAliasingMode(AntiAliasing::Mode mode) override;
+	uint64_t getRenderTargetMemoryUsage() const override;
+
 private:
 
-	void initialiseMultisampleFramebuffer();
+	// The framebuffer the scene is drawn to, which each frame's render graph creates. At the window's size, with
+	// the anti-aliasing mode's samples
+	Framebuffer::FramebufferSpecification getFramebufferSpecification() const;
 	void initialiseDefaultMaterialTextures();
 
-	void setLightUniforms(const std::vector<Reference<PointLight>>& pointLights);
+	void uploadPointLights(const std::vector<Reference<PointLight>>& pointLights);
+	void setBatchMaterial(const IndirectDrawList::Batch& batch);
 	void setMaterialUniforms(const BlinnPhongMaterial& material);
+	void bindMaterialTextures(const BlinnPhongMaterial& material);
+
+	void drawBatches();
+	void drawDepthPrepass();
 
 private:
 
-	Unique<Framebuffer> m_multisampleFramebuffer;
+	Unique<AntiAliasing> m_antiAliasing;
+	Unique<IndirectDrawList> m_drawList;
+
+	Unique<LightClusterGrid> m_lightClusterGrid;
+	Unique<StorageBuffer> m_pointLightBuffer;
+	Unique<PointShadowAtlas> m_pointShadowAtlas;
+	std::vector<PointLightData> m_pointLightData;
+
+	uint32_t m_boundTextureSet = IndirectDrawList::NO_TEXTURE_SET;
+	glm::mat4 m_projectionViewMatrix = glm::mat4(1.0f);
+
+	bool m_depthPrepassEnabled = false;
+
+	bool m_shadedSampleCountingEnabled = false;
+	uint64_t m_shadedSampleCount = 0;
+	Unique<Query> m_shadedSampleQuery;
+
 	Unique<Shader> m_blinnPhongShader;
+	Unique<Shader> m_depthPrepassShader;
 
 	// Default texture maps
 
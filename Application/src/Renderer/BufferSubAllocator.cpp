@@ -0,0 +1,89 @@
+#include "PCH.h"
+#include "BufferSubAllocator.h"
+
+BufferSubAllocator::BufferSubAllocator(uint32_t capacity)
+	: m_capacity(capacity)
+{
+	if (capacity)
+		m_freeBlocks[0] = capacity;
+}
+
+uint32_t BufferSubAllocator::allocate(uint32_t size)
+{
+	if (!size)
+		return INVALID_OFFSET;
+
+	// First fit - blocks are ordered by offset so this favours packing allocations towards the start of the buffer
+
+	for (auto it = m_freeBlocks.begin(); it != m_freeBlocks.end(); it++)
+	{
+		if (it->second < size)
+			continue;
+
+		uint32_t offset = it->first;
+		uint32_t remainingSize = it->second - size;
+
+		m_freeBlocks.erase(it);
+
+		if (remainingSize)
+			m_freeBlocks[offset + size] = remainingSize;
+
+		m_usedSize += size;
+
+		return offset;
+	}
+
+	return INVALID_OFFSET;
+}
+
+void BufferSubAllocator::free(uint32_t offset, uint32_t size)
+{
+	if (offset == INVALID_OFFSET || !size)
+		return;
+
+	ASSERT_MESSAGE(offset + size <= m_capacity, "Cannot free a range that lies outside of the managed buffer");
+
+	m_usedSize -= size;
+
+	insertFreeBlock(offset, size);
+}
+
+void BufferSubAllocator::grow(uint32_t newCapacity)
+{
+	ASSERT_MESSAGE(newCapacity >= m_capacity, "BufferSubAllocator cannot shrink");
+
+	if (newCapacity == m_capacity)
+		return;
+
+	uint32_t previousCapacity = m_capacity;
+	m_capacity = newCapacity;
+
+	insertFreeBlock(previousCapacity, newCapacity - previousCapacity);
+}
+
+void BufferSubAllocator::insertFreeBlock(uint32_t offset, uint32_t size)
+{
+	auto [it, inserted] = m_freeBlocks.emplace(offset, size);
+	ASSERT_MESSAGE(inserted, "Range has already been freed");
+
+	// Coalesce with the following free block
+
+	auto next = std::next(it);
+	if (next != m_freeBlocks.end() && it->first + it->second == next->first)
+	{
+		it->second += next->second;
+		m_freeBlocks.erase(next);
+	}
+
+	// Coalesce with the preceding free block
+
+	if (it != m_freeBlocks.begin())
+	{
+		auto previous = std::prev(it);
+		if (previous->first + previous->second == it->first)
+		{
+			previous->second += it->second;
+			m_freeBlocks.erase(it);
+		}
+	}
+}
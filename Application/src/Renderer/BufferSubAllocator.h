@@ -0,0 +1,45 @@
+#pragma once
+#include "PCH.h"
+
+#include <map>
+
+/*
+Manages ranges of a larger GPU buffer, measured in elements (vertices, indices etc.).
+
+Free ranges are kept in a list ordered by offset, so that when a range is freed it can be
+merged (coalesced) with any free neighbours, keeping fragmentation of the buffer low.
+*/
+class BufferSubAllocator
+{
+public:
+
+	static constexpr uint32_t INVALID_OFFSET = std::numeric_limits<uint32_t>::max();
+
+public:
+
+	BufferSubAllocator() = delete;
+	BufferSubAllocator(uint32_t capacity);
+
+	// Returns INVALID_OFFSET if there is no free range large enough
+	uint32_t allocate(uint32_t size);
+	void free(uint32_t offset, uint32_t size);
+
+	// Extends the managed range, with the new space being added to the end as free space
+	void grow(uint32_t newCapacity);
+
+	uint32_t getCapacity() const { return m_capacity; }
+	uint32_t getUsedSize() const { return m_usedSize; }
+	uint32_t getFreeBlockCount() const { return static_cast<uint32_t>(m_freeBlocks.size()); }
+
+private:
+
+	void insertFreeBlock(uint32_t offset, uint32_t size);
+
+private:
+
+	uint32_t m_capacity = 0;
+	uint32_t m_usedSize = 0;
+
+	// Maps the offset of each free block to its size
+	std::map<uint32_t, uint32_t> m_freeBlocks;
+};
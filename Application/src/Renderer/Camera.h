@@ -11,4 +11,7 @@ public:
 	virtual glm::mat4 getProjectionMatrix() const = 0;
 	
 	virtual glm::vec3 getCameraPosition() const = 0;
+
+	virtual float getNearClip() const = 0;
+	virtual float getFarClip() const = 0;
 };
\ No newline at end of file
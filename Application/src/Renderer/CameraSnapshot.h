@@ -0,0 +1,34 @@
+#pragma once
+#include "PCH.h"
+
+#include "Camera.h"
+
+/*
+The matrices and clip planes of another camera, as they were when it was copied, so that a frame can be drawn on the
+render thread while the camera itself goes on being moved on the main thread.
+*/
+class CameraSnapshot : public Camera
+{
+public:
+
+	CameraSnapshot() = default;
+	CameraSnapshot(const Camera& camera)
+		: m_viewMatrix(camera.getViewMatrix()), m_projectionMatrix(camera.getProjectionMatrix()), m_cameraPosition(camera.getCameraPosition()),
+		  m_nearClip(camera.getNearClip()), m_farClip(camera.getFarClip()) {}
+
+	glm::mat4 getViewMatrix() const override { return m_viewMatrix; }
+	glm::mat4 getProjectionMatrix() const override { return m_projectionMatrix; }
+
+	glm::vec3 getCameraPosition() const override { return m_cameraPosition; }
+
+	float getNearClip() const override { return m_nearClip; }
+	float getFarClip() const override { return m_farClip; }
+
+private:
+
+	glm::mat4 m_viewMatrix = glm::mat4(1.0f);
+	glm::mat4 m_projectionMatrix = glm::mat4(1.0f);
+	glm::vec3 m_cameraPosition = { 0.0f, 0.0f, 0.0f };
+
+	float m_nearClip = 0.01f, m_farClip = 100.0f;
+};
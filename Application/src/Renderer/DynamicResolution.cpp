@@ -0,0 +1,18 @@
+#include "PCH.h"
+#include "DynamicResolution.h"
+
+void DynamicResolution::addFrameTime(float frameTime, float renderScale)
+{
+	if (frameTime <= 0.0f)
+		return;
+
+	float estimatedRenderScale = renderScale * std::sqrt((m_targetFrameTime * TARGET_HEADROOM) / frameTime);
+	estimatedRenderScale = std::clamp(estimatedRenderScale, MIN_RENDER_SCALE, MAX_RENDER_SCALE);
+
+	if (std::abs(estimatedRenderScale - m_renderScale) < MIN_ADJUSTMENT)
+		return;
+
+	m_renderScale += (estimatedRenderScale - m_renderScale) * ADJUSTMENT_RATE;
+
+	RendererLog::trace("Render scale {0:.3f} (frame time {1:.3f} ms at scale {2:.3f}, target {3:.3f} ms)", m_renderScale, frameTime, renderScale, m_targetFrameTime);
+}
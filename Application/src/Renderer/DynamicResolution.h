@@ -0,0 +1,48 @@
+#pragma once
+#include "PCH.h"
+
+/*
+Chooses the scale the scene is drawn at (relative to the window) to hold the GPU frame time at a target.
+
+GPU timer results arrive a few frames late, by which time the scale has already changed, so each result is paired
+with the scale its frame was drawn at. Most of the frame's cost is per pixel, so the scale which would have met the
+target is estimated from the square root of the ratio of the target to the measured time, and the scale is moved
+part of the way towards it each result to avoid oscillating.
+*/
+class DynamicResolution
+{
+public:
+
+	static constexpr float MIN_RENDER_SCALE = 0.5f;
+	static constexpr float MAX_RENDER_SCALE = 1.0f;
+
+public:
+
+	DynamicResolution() = default;
+	~DynamicResolution() = default;
+	DynamicResolution(const DynamicResolution&) = delete;
+
+	void setTargetFrameTime(float targetFrameTime) { m_targetFrameTime = targetFrameTime; }
+	float getTargetFrameTime() const { return m_targetFrameTime; }
+
+	// frameTime is in milliseconds, of a frame drawn at renderScale
+	void addFrameTime(float frameTime, float renderScale);
+
+	float getRenderScale() const { return m_renderScale; }
+	void reset() { m_renderScale = MAX_RENDER_SCALE; }
+
+private:
+
+	// Aims slightly under the target, so that small variations between frames don't go over it
+	static constexpr float TARGET_HEADROOM = 0.9f;
+	// Fraction of the way towards the estimated scale moved each result
+	static constexpr float ADJUSTMENT_RATE = 0.2f;
+	// Estimates this close to the current scale are ignored, so that the scale settles rather than drifting with noise
+	static constexpr float MIN_ADJUSTMENT = 0.01f;
+
+private:
+
+	// 60 frames per second
+	float m_targetFrameTime = 1000.0f / 60.0f;
+	float m_renderScale = MAX_RENDER_SCALE;
+};
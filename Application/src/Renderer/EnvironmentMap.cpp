@@ -0,0 +1,356 @@
+#include "PCH.h"
+#include "EnvironmentMap.h"
+
+#include "glad/glad.h"
+#include "glm/gtc/constants.hpp"
+#include "stb_image.h"
+
+#include <random>
+
+#include "GLStateCache.h"
+#include "Shader.h"
+
+// The environment is drawn into a cube map with a full mip chain, which the prefiltering samples from
+static constexpr uint32_t ENVIRONMENT_CUBE_MAP_SIZE = 512;
+// Samples per texel when prefiltering - few are needed, as each is read from a mip matching its footprint
+static constexpr uint32_t PREFILTER_SAMPLE_COUNT = 256;
+static constexpr uint32_t WORK_GROUP_SIZE = 8;
+
+// Half float RGBA
+static constexpr uint32_t PREFILTERED_MAP_BYTES_PER_TEXEL = 8;
+
+static constexpr uint32_t CACHE_MAGIC = 0x4C424950; // "PIBL"
+// Increase when the cache's layout, or how its contents are computed, changes
+static constexpr uint32_t CACHE_VERSION = 1;
+
+struct EnvironmentMapCacheHeader
+{
+	uint32_t magic;
+	uint32_t version;
+	uint64_t sourceFileSize;
+	int64_t sourceLastWriteTime;
+	uint32_t prefilteredMapSize;
+	uint32_t prefilteredMapMipCount;
+};
+
+EnvironmentMap::EnvironmentMap(const std::string& filePath)
+	: m_filePath(filePath)
+{
+	std::error_code errorCode;
+	SourceStamp sourceStamp;
+	sourceStamp.fileSize = static_cast<uint64_t>(std::filesystem::file_size(m_filePath, errorCode));
+	if (errorCode)
+		throw EnvironmentMapCreationException("Could not find environment map " + m_filePath);
+	sourceStamp.lastWriteTime = static_cast<int64_t>(std::filesystem::last_write_time(m_filePath).time_since_epoch().count());
+
+	std::filesystem::path cachePath = std::filesystem::path(CACHE_DIRECTORY) / (std::filesystem::path(m_filePath).filename().string() + ".ibl");
+
+	if (loadFromCache(cachePath, sourceStamp))
+	{
+		AssetLog::info("Loaded environment map {0} from {1}", m_filePath, cachePath.string());
+		return;
+	}
+
+	precompute();
+	saveToCache(cachePath, sourceStamp);
+
+	AssetLog::info("Precomputed environment map {0} and cached it in {1}", m_filePath, cachePath.string());
+}
+
+EnvironmentMap::~EnvironmentMap()
+{
+	GLStateCache::deleteTexture(m_prefilteredMapRendererID);
+
+	AssetLog::info("Deleted environment map {0}", m_filePath);
+}
+
+void EnvironmentMap::bindPrefilteredMap(uint32_t textureSlot) const
+{
+	GLStateCache::bindTextureUnit(textureSlot, m_prefilteredMapRendererID);
+}
+
+uint64_t EnvironmentMap::getMemoryUsage() const
+{
+	uint64_t memoryUsage = 0;
+	for (uint32_t mip = 0; mip < PREFILTERED_MAP_MIP_COUNT; mip++)
+		memoryUsage += getPrefilteredMipByteSize(mip);
+
+	return memoryUsage;
+}
+
+bool EnvironmentMap::loadFromCache(const std::filesystem::path& cachePath, const SourceStamp& sourceStamp)
+{
+	std::ifstream inputFileStream(cachePath, std::ios::binary);
+	if (!inputFileStream)
+		return false;
+
+	EnvironmentMapCacheHeader header;
+	inputFileStream.read(reinterpret_cast<char*>(&header), sizeof(header));
+
+	if (!inputFileStream || header.magic != CACHE_MAGIC || header.version != CACHE_VERSION ||
+		header.sourceFileSize != sourceStamp.fileSize || header.sourceLastWriteTime != sourceStamp.lastWriteTime ||
+		header.prefilteredMapSize != PREFILTERED_MAP_SIZE || header.prefilteredMapMipCount != PREFILTERED_MAP_MIP_COUNT)
+	{
+		AssetLog::info("Cache {0} is out of date, so environment map {1} will be precomputed again", cachePath.string(), m_filePath);
+		return false;
+	}
+
+	inputFileStream.read(reinterpret_cast<char*>(m_irradianceCoefficients.data()), sizeof(m_irradianceCoefficients));
+
+	std::vector<std::vector<uint8_t>> mips(PREFILTERED_MAP_MIP_COUNT);
+	for (uint32_t mip = 0; mip < PREFILTERED_MAP_MIP_COUNT; mip++)
+	{
+		mips[mip].resize(getPrefilteredMipByteSize(mip));
+		inputFileStream.read(reinterpret_cast<char*>(mips[mip].data()), mips[mip].size());
+	}
+
+	if (!inputFileStream)
+	{
+		AssetLog::warn("Cache {0} is truncated, so environment map {1} will be precomputed again", cachePath.string(), m_filePath);
+		return false;
+	}
+
+	createPrefilteredMap();
+
+	for (uint32_t mip = 0; mip < PREFILTERED_MAP_MIP_COUNT; mip++)
+	{
+		uint32_t mipSize = PREFILTERED_MAP_SIZE >> mip;
+		glTextureSubImage3D(m_prefilteredMapRendererID, mip, 0, 0, 0, mipSize, mipSize, 6, GL_RGBA, GL_HALF_FLOAT, mips[mip].data());
+	}
+
+	return true;
+}
+
+void EnvironmentMap::saveToCache(const std::filesystem::path& cachePath, const SourceStamp& sourceStamp) const
+{
+	std::error_code errorCode;
+	std::filesystem::create_directories(cachePath.parent_path(), errorCode);
+
+	std::filesystem::path temporaryCachePath = getTemporaryCachePath(cachePath);
+
+	std::ofstream outputFileStream(temporaryCachePath, std::ios::binary | std::ios::trunc);
+	if (!outputFileStream)
+	{
+		AssetLog::warn("Could not write to {0}, so environment map {1} will be precomputed again next time", cachePath.string(), m_filePath);
+		return;
+	}
+
+	EnvironmentMapCacheHeader header;
+	header.magic = CACHE_MAGIC;
+	header.version = CACHE_VERSION;
+	header.sourceFileSize = sourceStamp.fileSize;
+	header.sourceLastWriteTime = sourceStamp.lastWriteTime;
+	header.prefilteredMapSize = PREFILTERED_MAP_SIZE;
+	header.prefilteredMapMipCount = PREFILTERED_MAP_MIP_COUNT;
+
+	outputFileStream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	outputFileStream.write(reinterpret_cast<const char*>(m_irradianceCoefficients.data()), sizeof(m_irradianceCoefficients));
+
+	// The prefiltered map is read back in its stored half float format, so loading it needs no conversion
+	std::vector<uint8_t> mipData;
+	for (uint32_t mip = 0; mip < PREFILTERED_MAP_MIP_COUNT; mip++)
+	{
+		mipData.resize(getPrefilteredMipByteSize(mip));
+		glGetTextureImage(m_prefilteredMapRendererID, mip, GL_RGBA, GL_HALF_FLOAT, static_cast<GLsizei>(mipData.size()), mipData.data());
+		outputFileStream.write(reinterpret_cast<const char*>(mipData.data()), mipData.size());
+	}
+
+	outputFileStream.close();
+	commitTemporaryCacheFile(temporaryCachePath, cachePath);
+}
+
+std::filesystem::path EnvironmentMap::getTemporaryCachePath(const std::filesystem::path& cachePath)
+{
+	// Unique to the writer, as several processes may precompute the same cache file at once
+	std::random_device randomDevice;
+	return cachePath.string() + "." + std::to_string(randomDevice()) + ".tmp";
+}
+
+void EnvironmentMap::commitTemporaryCacheFile(const std::filesystem::path& temporaryCachePath, const std::filesystem::path& cachePath)
+{
+	// Renaming replaces any existing cache file atomically, so readers see either the old or the new file
+	std::error_code errorCode;
+	std::filesystem::rename(temporaryCachePath, cachePath, errorCode);
+
+	if (errorCode)
+	{
+		AssetLog::warn("Could not move {0} to {1}: {2}", temporaryCachePath.string(), cachePath.string(), errorCode.message());
+		std::filesystem::remove(temporaryCachePath, errorCode);
+	}
+}
+
+void EnvironmentMap::precompute()
+{
+	int32_t width, height, channels;
+
+	// Rows are flipped so that the first row is the bottom (the -y direction), as with Texture
+	stbi_set_flip_vertically_on_load(true);
+
+	float* pixels = stbi_loadf(m_filePath.c_str(), &width, &height, &channels, 3);
+	if (!pixels)
+		throw EnvironmentMapCreationException("Could not load environment map " + m_filePath + ": " + stbi_failure_reason());
+
+	AssetLog::trace("Loaded {0}x{1} environment image {2}", width, height, m_filePath);
+
+	m_irradianceCoefficients = calculateIrradianceCoefficients(pixels, static_cast<uint32_t>(width), static_cast<uint32_t>(height));
+
+	RendererID environmentCubeMapRendererID = createEnvironmentCubeMap(pixels, static_cast<uint32_t>(width), static_cast<uint32_t>(height));
+	stbi_image_free(pixels);
+
+	createPrefilteredMap();
+	prefilter(environmentCubeMapRendererID);
+
+	GLStateCache::deleteTexture(environmentCubeMapRendererID);
+
+	// The prefiltered map is read back next, to be cached
+	glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT | GL_TEXTURE_UPDATE_BARRIER_BIT);
+}
+
+void EnvironmentMap::createPrefilteredMap()
+{
+	glCreateTextures(GL_TEXTURE_CUBE_MAP, 1, &m_prefilteredMapRendererID);
+	glTextureStorage2D(m_prefilteredMapRendererID, PREFILTERED_MAP_MIP_COUNT, GL_RGBA16F, PREFILTERED_MAP_SIZE, PREFILTERED_MAP_SIZE);
+
+	glTextureParameteri(m_prefilteredMapRendererID, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+	glTextureParameteri(m_prefilteredMapRendererID, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTextureParameteri(m_prefilteredMapRendererID, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTextureParameteri(m_prefilteredMapRendererID, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	glTextureParameteri(m_prefilteredMapRendererID, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+}
+
+RendererID EnvironmentMap::createEnvironmentCubeMap(const float* pixels, uint32_t width, uint32_t height) const
+{
+	// Upload the equirectangular image with mips, so that the cube map samples it at about its own resolution
+
+	uint32_t environmentTextureMipCount = static_cast<uint32_t>(std::log2(std::max(width, height))) + 1;
+
+	RendererID environmentTextureRendererID;
+	glCreateTextures(GL_TEXTURE_2D, 1, &environmentTextureRendererID);
+	glTextureStorage2D(environmentTextureRendererID, environmentTextureMipCount, GL_RGB32F, width, height);
+	glTextureSubImage2D(environmentTextureRendererID, 0, 0, 0, width, height, GL_RGB, GL_FLOAT, pixels);
+	glGenerateTextureMipmap(environmentTextureRendererID);
+
+	glTextureParameteri(environmentTextureRendererID, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+	glTextureParameteri(environmentTextureRendererID, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTextureParameteri(environmentTextureRendererID, GL_TEXTURE_WRAP_S, GL_REPEAT);
+	glTextureParameteri(environmentTextureRendererID, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+	uint32_t cubeMapMipCount = static_cast<uint32_t>(std::log2(ENVIRONMENT_CUBE_MAP_SIZE)) + 1;
+
+	RendererID cubeMapRendererID;
+	glCreateTextures(GL_TEXTURE_CUBE_MAP, 1, &cubeMapRendererID);
+	glTextureStorage2D(cubeMapRendererID, cubeMapMipCount, GL_RGBA16F, ENVIRONMENT_CUBE_MAP_SIZE, ENVIRONMENT_CUBE_MAP_SIZE);
+	glTextureParameteri(cubeMapRendererID, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+	glTextureParameteri(cubeMapRendererID, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+	// Draw each face of the cube map from the image
+
+	Shader cubeMapShader({ "Assets/Shaders/EnvironmentCubeMap.glsl.comp" });
+	cubeMapShader.bind();
+
+	// A cube map face covers a quarter of the image's width
+	float environmentTextureLevel = std::max(std::log2(static_cast<float>(width) / (4.0f * static_cast<float>(ENVIRONMENT_CUBE_MAP_SIZE))), 0.0f);
+
+	GLStateCache::bindTextureUnit(0, environmentTextureRendererID);
+	cubeMapShader.setUniformToValue("u_environmentTexture", 0);
+	cubeMapShader.setUniformToValue("u_environmentTextureLevel", environmentTextureLevel);
+	cubeMapShader.setUniformToValue("u_cubeMapSize", ENVIRONMENT_CUBE_MAP_SIZE);
+
+	glBindImageTexture(0, cubeMapRendererID, 0, GL_TRUE, 0, GL_WRITE_ONLY, GL_RGBA16F);
+
+	uint32_t groupCount = (ENVIRONMENT_CUBE_MAP_SIZE + WORK_GROUP_SIZE - 1) / WORK_GROUP_SIZE;
+	RendererUtilities::dispatchCompute(groupCount, groupCount, 6);
+
+	glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT | GL_TEXTURE_UPDATE_BARRIER_BIT);
+	glGenerateTextureMipmap(cubeMapRendererID);
+
+	GLStateCache::deleteTexture(environmentTextureRendererID);
+
+	return cubeMapRendererID;
+}
+
+void EnvironmentMap::prefilter(RendererID environmentCubeMapRendererID)
+{
+	Shader prefilteringShader({ "Assets/Shaders/EnvironmentPrefiltering.glsl.comp" });
+	prefilteringShader.bind();
+
+	float environmentTexelSolidAngle = 4.0f * glm::pi<float>() / (6.0f * static_cast<float>(ENVIRONMENT_CUBE_MAP_SIZE * ENVIRONMENT_CUBE_MAP_SIZE));
+
+	GLStateCache::bindTextureUnit(0, environmentCubeMapRendererID);
+	prefilteringShader.setUniformToValue("u_environmentMap", 0);
+	prefilteringShader.setUniformToValue("u_environmentTexelSolidAngle", environmentTexelSolidAngle);
+	prefilteringShader.setUniformToValue("u_sampleCount", PREFILTER_SAMPLE_COUNT);
+
+	for (uint32_t mip = 0; mip < PREFILTERED_MAP_MIP_COUNT; mip++)
+	{
+		uint32_t mipSize = PREFILTERED_MAP_SIZE >> mip;
+		float roughness = static_cast<float>(mip) / static_cast<float>(PREFILTERED_MAP_MIP_COUNT - 1);
+
+		prefilteringShader.setUniformToValue("u_roughness", roughness);
+		prefilteringShader.setUniformToValue("u_levelSize", mipSize);
+
+		// Every face of the mip is written at once
+		glBindImageTexture(0, m_prefilteredMapRendererID, mip, GL_TRUE, 0, GL_WRITE_ONLY, GL_RGBA16F);
+
+		uint32_t groupCount = (mipSize + WORK_GROUP_SIZE - 1) / WORK_GROUP_SIZE;
+		RendererUtilities::dispatchCompute(groupCount, groupCount, 6);
+	}
+
+	AssetLog::trace("Prefiltered environment map {0} into {1} mips", m_filePath, PREFILTERED_MAP_MIP_COUNT);
+}
+
+/*
+Projects the radiance onto the first 9 real spherical harmonics, weighting each texel by its solid angle, then convolves
+them with the clamped cosine lobe (scaling each band by pi, 2pi / 3 and pi / 4). See Ramamoorthi and Hanrahan's
+"An Efficient Representation for Irradiance Environment Maps". The basis is evaluated the same way in the lighting shaders.
+*/
+std::array<glm::vec3, EnvironmentMap::IRRADIANCE_COEFFICIENT_COUNT> EnvironmentMap::calculateIrradianceCoefficients(const float* pixels, uint32_t width, uint32_t height)
+{
+	const float pi = glm::pi<float>();
+
+	std::array<glm::vec3, IRRADIANCE_COEFFICIENT_COUNT> coefficients = {};
+
+	for (uint32_t y = 0; y < height; y++)
+	{
+		// Latitude, from -pi / 2 at the bottom row to pi / 2 at the top
+		float latitude = ((static_cast<float>(y) + 0.5f) / static_cast<float>(height) - 0.5f) * pi;
+		float texelSolidAngle = (2.0f * pi / static_cast<float>(width)) * (pi / static_cast<float>(height)) * std::cos(latitude);
+
+		for (uint32_t x = 0; x < width; x++)
+		{
+			float longitude = ((static_cast<float>(x) + 0.5f) / static_cast<float>(width) - 0.5f) * 2.0f * pi;
+			glm::vec3 direction = { std::cos(latitude) * std::cos(longitude), std::sin(latitude), std::cos(latitude) * std::sin(longitude) };
+
+			const float* pixel = pixels + (static_cast<uint64_t>(y) * width + x) * 3;
+			glm::vec3 radiance = glm::vec3(pixel[0], pixel[1], pixel[2]) * texelSolidAngle;
+
+			coefficients[0] += radiance * 0.282095f;
+			coefficients[1] += radiance * 0.488603f * direction.y;
+			coefficients[2] += radiance * 0.488603f * direction.z;
+			coefficients[3] += radiance * 0.488603f * direction.x;
+			coefficients[4] += radiance * 1.092548f * direction.x * direction.y;
+			coefficients[5] += radiance * 1.092548f * direction.y * direction.z;
+			coefficients[6] += radiance * 0.315392f * (3.0f * direction.z * direction.z - 1.0f);
+			coefficients[7] += radiance * 1.092548f * direction.x * direction.z;
+			coefficients[8] += radiance * 0.546274f * (direction.x * direction.x - direction.y * direction.y);
+		}
+	}
+
+	// Convolve with the cosine lobe to get irradiance, then divide by pi for the radiance a white diffuse surface reflects
+
+	const std::array<float, 3> bandScales = { pi, 2.0f * pi / 3.0f, pi / 4.0f };
+
+	for (uint32_t i = 0; i < IRRADIANCE_COEFFICIENT_COUNT; i++)
+	{
+		uint32_t band = i == 0 ? 0 : (i < 4 ? 1 : 2);
+		coefficients[i] *= bandScales[band] / pi;
+	}
+
+	return coefficients;
+}
+
+uint64_t EnvironmentMap::getPrefilteredMipByteSize(uint32_t mip)
+{
+	uint64_t mipSize = PREFILTERED_MAP_SIZE >> mip;
+	return mipSize * mipSize * 6 * PREFILTERED_MAP_BYTES_PER_TEXEL;
+}
@@ -0,0 +1,97 @@
+#pragma once
+#include "PCH.h"
+
+#include <array>
+
+#include "glm/glm.hpp"
+
+#include "RendererUtilities.h"
+
+/*
+An HDR environment surrounding a PBR scene, stored ready to light it with (see ImageBasedLighting):
+	- Its diffuse irradiance, as the 9 coefficients of an order 2 spherical harmonic, which Ramamoorthi and Hanrahan
+	  showed is within a few percent of the true irradiance
+	- Its specular radiance, as a cube map whose mips are prefiltered with the GGX lobes of increasing roughnesses
+
+These are precomputed from an equirectangular .hdr image the first time it is used, which takes a while, and the results
+are written to a file in CACHE_DIRECTORY. After that, creating the environment map only reads the cache file (the
+image itself isn't loaded), until the image changes.
+*/
+class EnvironmentMap
+{
+public:
+
+	struct EnvironmentMapCreationException : public std::exception
+	{
+		std::string errorMessage;
+
+		EnvironmentMapCreationException(const std::string errorMessage)
+			: errorMessage("EnvironmentMapCreationException Occured: " + errorMessage) {}
+
+		const char* what() const noexcept override
+		{
+			return errorMessage.c_str();
+		}
+	};
+
+	static constexpr uint32_t IRRADIANCE_COEFFICIENT_COUNT = 9;
+
+	// The first mip is a perfect mirror and the last (8x8) has a roughness of 1
+	static constexpr uint32_t PREFILTERED_MAP_SIZE = 256;
+	static constexpr uint32_t PREFILTERED_MAP_MIP_COUNT = 6;
+
+	// Where precomputed image based lighting is cached, relative to the working directory
+	static constexpr const char* CACHE_DIRECTORY = "Assets/Cache";
+
+public:
+
+	EnvironmentMap() = delete;
+	EnvironmentMap(const std::string& filePath);
+	~EnvironmentMap();
+	EnvironmentMap(const EnvironmentMap&) = delete;
+
+	static Reference<EnvironmentMap> create(const std::string& filePath) { return createReference<EnvironmentMap>(filePath); }
+
+	void bindPrefilteredMap(uint32_t textureSlot) const;
+
+	// Coefficients of the irradiance divided by pi, i.e. the radiance diffusely reflected by a white surface
+	const std::array<glm::vec3, IRRADIANCE_COEFFICIENT_COUNT>& getIrradianceCoefficients() const { return m_irradianceCoefficients; }
+
+	const std::string& getFilePath() const { return m_filePath; }
+
+	// Bytes used by the prefiltered cube map
+	uint64_t getMemoryUsage() const;
+
+	// Cache files are written under a temporary name and then renamed, so that processes sharing the cache (such as
+	// batch rendering workers) never read one that is partly written
+	static std::filesystem::path getTemporaryCachePath(const std::filesystem::path& cachePath);
+	static void commitTemporaryCacheFile(const std::filesystem::path& temporaryCachePath, const std::filesystem::path& cachePath);
+
+private:
+
+	// Identifies the version of the image the cache was made from
+	struct SourceStamp
+	{
+		uint64_t fileSize;
+		int64_t lastWriteTime;
+	};
+
+	bool loadFromCache(const std::filesystem::path& cachePath, const SourceStamp& sourceStamp);
+	void saveToCache(const std::filesystem::path& cachePath, const SourceStamp& sourceStamp) const;
+
+	void precompute();
+	void createPrefilteredMap();
+	RendererID createEnvironmentCubeMap(const float* pixels, uint32_t width, uint32_t height) const;
+	void prefilter(RendererID environmentCubeMapRendererID);
+
+	static std::array<glm::vec3, IRRADIANCE_COEFFICIENT_COUNT> calculateIrradianceCoefficients(const float* pixels, uint32_t width, uint32_t height);
+
+	static uint64_t getPrefilteredMipByteSize(uint32_t mip);
+
+private:
+
+	std::string m_filePath;
+
+	std::array<glm::vec3, IRRADIANCE_COEFFICIENT_COUNT> m_irradianceCoefficients = {};
+	RendererID m_prefilteredMapRendererID = 0;
+};
@@ -0,0 +1,416 @@
+#include "PCH.h"
+#include "FrameCapture.h"
+
+#include <chrono>
+
+#if defined(PBR_LINUX)
+	#include <signal.h>
+#endif
+
+#include "Core/Application.h"
+#include "Core/Profiler.h"
+
+#include "FrameStatistics.h"
+#include "GLStateCache.h"
+
+// How long each wait for a fence lasts before it is retried, in nanoseconds
+static constexpr GLuint64 FENCE_WAIT_TIMEOUT = 1000000000;
+
+static constexpr uint32_t COLOR_BYTES_PER_PIXEL = 4;
+static constexpr uint32_t HDR_BYTES_PER_PIXEL = 4 * sizeof(float);
+static constexpr uint32_t DEPTH_BYTES_PER_PIXEL = sizeof(float);
+
+FrameCapture::FrameCapture(const CaptureSpecification& specification)
+	: m_specification(specification)
+{
+	// One slot is read while the one before it is encoded, so at least two are needed to overlap them
+	m_slots.resize(std::max(m_specification.slotCount, 2u));
+
+	std::error_code errorCode;
+	std::filesystem::create_directories(m_specification.outputDirectory, errorCode);
+
+	if (!m_specification.pipeCommand.empty())
+	{
+#if defined(PBR_LINUX)
+		// A pipe whose reader has exited would otherwise end the process on the next write
+		signal(SIGPIPE, SIG_IGN);
+		m_pipe = popen(m_specification.pipeCommand.c_str(), "w");
+#elif defined(PBR_WINDOWS)
+		m_pipe = _popen(m_specification.pipeCommand.c_str(), "wb");
+#endif
+
+		if (m_pipe)
+			RendererLog::info("Piping captured frames to {0}", m_specification.pipeCommand);
+		else
+		{
+			RendererLog::error("Could not start {0}, so captured frames will be dropped", m_specification.pipeCommand);
+			m_pipeFailed = true;
+		}
+	}
+
+	m_encodingThread = std::thread(&FrameCapture::encodeSlots, this);
+
+	RendererLog::info("Started capturing frames to {0}", m_specification.pipeCommand.empty() ? m_specification.outputDirectory.string() : m_specification.pipeCommand);
+}
+
+FrameCapture::~FrameCapture()
+{
+	waitUntilAllSlotsFree();
+
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_stopping = true;
+	}
+
+	m_slotEncodeQueued.notify_one();
+	m_encodingThread.join();
+
+	deleteSlotBuffers();
+
+	if (m_pipe)
+	{
+#if defined(PBR_LINUX)
+		pclose(m_pipe);
+#elif defined(PBR_WINDOWS)
+		_pclose(m_pipe);
+#endif
+	}
+
+	RendererLog::info("Stopped capturing frames, after {0} frames", m_capturedFrameCount);
+}
+
+void FrameCapture::addAttachmentCapturePass(RenderGraph& renderGraph, RenderGraph::ResourceHandle HDRFramebuffer, RenderGraph::ResourceHandle depthFramebuffer)
+{
+	if (!m_specification.captureHDR && !m_specification.captureDepth)
+		return;
+
+	uint32_t width = Application::getWindow().getWidth();
+	uint32_t height = Application::getWindow().getHeight();
+
+	if (!m_attachmentFramebuffer || m_attachmentFramebuffer->getSpecification().width != width || m_attachmentFramebuffer->getSpecification().height != height)
+		createAttachmentFramebuffer(width, height);
+
+	// Written outside of the graph's framebuffers, so that the pass isn't culled
+	RenderGraph::ResourceHandle captureFramebuffer = renderGraph.importFramebuffer("Frame capture", *m_attachmentFramebuffer);
+
+	std::vector<RenderGraph::ResourceAccess> reads = { { HDRFramebuffer, RenderGraph::Access::BLIT } };
+	if (depthFramebuffer != HDRFramebuffer)
+		reads.push_back({ depthFramebuffer, RenderGraph::Access::BLIT });
+
+	renderGraph.addPass("Frame capture", reads, { { captureFramebuffer, RenderGraph::Access::ATTACHMENT } }, [this, HDRFramebuffer, depthFramebuffer](RenderGraph& graph)
+	{
+		// Depth can't be filtered, so both are copied with nearest filtering. Multisampled framebuffers are resolved by the blit,
+		// and are always drawn at full size, which a resolving blit requires
+
+		auto blitToCaptureFramebuffer = [this](const Framebuffer& source, GLbitfield mask)
+		{
+			glBlitNamedFramebuffer(
+				source.getRendererID(),
+				m_attachmentFramebuffer->getRendererID(),
+				0, 0, source.getRenderWidth(), source.getRenderHeight(),
+				0, 0, m_attachmentFramebuffer->getRenderWidth(), m_attachmentFramebuffer->getRenderHeight(),
+				mask,
+				GL_NEAREST
+			);
+			FrameStatistics::recordFramebufferBlit();
+		};
+
+		if (m_specification.captureHDR)
+			blitToCaptureFramebuffer(graph.getFramebuffer(HDRFramebuffer), GL_COLOR_BUFFER_BIT);
+
+		if (m_specification.captureDepth)
+			blitToCaptureFramebuffer(graph.getFramebuffer(depthFramebuffer), GL_DEPTH_BUFFER_BIT);
+
+		m_attachmentsCapturedThisFrame = true;
+	});
+}
+
+void FrameCapture::captureFrame()
+{
+	PROFILE_GPU_SCOPE("Frame capture");
+
+	auto startTime = std::chrono::steady_clock::now();
+
+	uint32_t width = Application::getWindow().getWidth();
+	uint32_t height = Application::getWindow().getHeight();
+
+	handOverReadSlots(false);
+
+	// Nothing is drawn while the window is minimised
+	if (width == 0 || height == 0)
+		return;
+
+	if (width != m_bufferWidth || height != m_bufferHeight)
+	{
+		waitUntilAllSlotsFree();
+		deleteSlotBuffers();
+		createSlotBuffers(width, height);
+	}
+
+	uint32_t slotIndex = m_nextSlot;
+	waitUntilSlotFree(slotIndex);
+
+	Slot& slot = m_slots[slotIndex];
+	slot.frameIndex = m_capturedFrameCount;
+	slot.width = width;
+	slot.height = height;
+	// The renderer may not have drawn them (the Blinn-Phong renderer doesn't), or may have drawn them before a resize
+	slot.attachmentsCaptured = m_attachmentsCapturedThisFrame && m_attachmentFramebuffer &&
+		m_attachmentFramebuffer->getRenderWidth() == width && m_attachmentFramebuffer->getRenderHeight() == height;
+
+	// The reads are written to the pack buffers by the GPU, so return straight away
+
+	RendererID defaultFramebufferRendererID = RendererUtilities::getDefaultFramebufferRendererID();
+	GLStateCache::bindFramebuffer(defaultFramebufferRendererID);
+	glNamedFramebufferReadBuffer(defaultFramebufferRendererID, defaultFramebufferRendererID == 0 ? GL_BACK : GL_COLOR_ATTACHMENT0);
+
+	GLStateCache::bindBuffer(GL_PIXEL_PACK_BUFFER, slot.colorBuffer);
+	glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+
+	if (slot.attachmentsCaptured)
+	{
+		GLStateCache::bindFramebuffer(m_attachmentFramebuffer->getRendererID());
+
+		if (m_specification.captureHDR)
+		{
+			GLStateCache::bindBuffer(GL_PIXEL_PACK_BUFFER, slot.HDRBuffer);
+			glNamedFramebufferReadBuffer(m_attachmentFramebuffer->getRendererID(), GL_COLOR_ATTACHMENT0);
+			glReadPixels(0, 0, width, height, GL_RGBA, GL_FLOAT, nullptr);
+		}
+
+		if (m_specification.captureDepth)
+		{
+			GLStateCache::bindBuffer(GL_PIXEL_PACK_BUFFER, slot.depthBuffer);
+			glReadPixels(0, 0, width, height, GL_DEPTH_COMPONENT, GL_FLOAT, nullptr);
+		}
+
+		GLStateCache::bindFramebuffer(defaultFramebufferRendererID);
+	}
+
+	GLStateCache::bindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+	slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	slot.state = SlotState::READING;
+
+	m_readingSlots.push_back(slotIndex);
+	m_nextSlot = (m_nextSlot + 1) % static_cast<uint32_t>(m_slots.size());
+
+	m_capturedFrameCount++;
+	m_attachmentsCapturedThisFrame = false;
+
+	m_lastCaptureTime = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+
+	RendererLog::trace("Captured frame {0} in {1:.3f} ms", slot.frameIndex, m_lastCaptureTime);
+}
+
+void FrameCapture::createSlotBuffers(uint32_t width, uint32_t height)
+{
+	size_t pixelCount = static_cast<size_t>(width) * height;
+
+	for (Slot& slot : m_slots)
+	{
+		slot.colorBuffer = createReadBuffer(pixelCount * COLOR_BYTES_PER_PIXEL, reinterpret_cast<const void**>(&slot.colorPixels));
+
+		if (m_specification.captureHDR)
+			slot.HDRBuffer = createReadBuffer(pixelCount * HDR_BYTES_PER_PIXEL, reinterpret_cast<const void**>(&slot.HDRPixels));
+
+		if (m_specification.captureDepth)
+			slot.depthBuffer = createReadBuffer(pixelCount * DEPTH_BYTES_PER_PIXEL, reinterpret_cast<const void**>(&slot.depthPixels));
+	}
+
+	m_bufferWidth = width;
+	m_bufferHeight = height;
+
+	RendererLog::info("Created {0} frame capture slots for {1}x{2} frames", m_slots.size(), width, height);
+}
+
+void FrameCapture::deleteSlotBuffers()
+{
+	for (Slot& slot : m_slots)
+	{
+		for (RendererID* buffer : { &slot.colorBuffer, &slot.HDRBuffer, &slot.depthBuffer })
+		{
+			if (*buffer == 0)
+				continue;
+
+			glUnmapNamedBuffer(*buffer);
+			GLStateCache::deleteBuffer(*buffer);
+			*buffer = 0;
+		}
+
+		slot.colorPixels = nullptr;
+		slot.HDRPixels = nullptr;
+		slot.depthPixels = nullptr;
+	}
+
+	m_bufferWidth = 0;
+	m_bufferHeight = 0;
+}
+
+RendererID FrameCapture::createReadBuffer(size_t size, const void** mappedPointer)
+{
+	// Kept in client memory and mapped for as long as it exists. Coherent, so the pixels are visible once the fence has signalled
+
+	GLbitfield flags = GL_MAP_READ_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+
+	RendererID buffer;
+	glCreateBuffers(1, &buffer);
+	glNamedBufferStorage(buffer, size, nullptr, flags | GL_CLIENT_STORAGE_BIT);
+
+	*mappedPointer = glMapNamedBufferRange(buffer, 0, size, flags);
+
+	return buffer;
+}
+
+void FrameCapture::createAttachmentFramebuffer(uint32_t width, uint32_t height)
+{
+	// Only read back once the frame is drawn, so can't be a transient framebuffer shared through the render target pool
+
+	Framebuffer::FramebufferSpecification framebufferSpecification;
+	framebufferSpecification.width = width;
+	framebufferSpecification.height = height;
+	framebufferSpecification.colorAttachmentFormats = { Framebuffer::ColorAttachmentFormat::RGBA16F };
+	framebufferSpecification.resizeWithWindowResizeEvents = false;
+
+	m_attachmentFramebuffer = createUnique<Framebuffer>(framebufferSpecification);
+}
+
+void FrameCapture::handOverReadSlots(bool waitForOldest)
+{
+	while (!m_readingSlots.empty())
+	{
+		uint32_t slotIndex = m_readingSlots.front();
+		Slot& slot = m_slots[slotIndex];
+
+		GLenum result = glClientWaitSync(slot.fence, GL_SYNC_FLUSH_COMMANDS_BIT, waitForOldest ? FENCE_WAIT_TIMEOUT : 0);
+
+		if (result == GL_TIMEOUT_EXPIRED)
+		{
+			if (waitForOldest)
+				continue;
+
+			return;
+		}
+
+		if (result == GL_WAIT_FAILED)
+			RendererLog::error("Failed to wait for frame {0} to be read back", slot.frameIndex);
+
+		glDeleteSync(slot.fence);
+		slot.fence = nullptr;
+		m_readingSlots.pop_front();
+
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			slot.state = SlotState::ENCODING;
+			m_encodeQueue.push_back(slotIndex);
+		}
+
+		m_slotEncodeQueued.notify_one();
+
+		// Only the oldest is waited for. The rest are handed over if they are already done
+		waitForOldest = false;
+	}
+}
+
+void FrameCapture::waitUntilSlotFree(uint32_t slotIndex)
+{
+	while (std::find(m_readingSlots.begin(), m_readingSlots.end(), slotIndex) != m_readingSlots.end())
+		handOverReadSlots(true);
+
+	std::unique_lock<std::mutex> lock(m_mutex);
+
+	if (m_slots[slotIndex].state != SlotState::FREE)
+		RendererLog::warn("Frame capture is waiting for frame {0} to be written, as encoding has fallen behind", m_slots[slotIndex].frameIndex);
+
+	m_slotFreed.wait(lock, [this, slotIndex]() { return m_slots[slotIndex].state == SlotState::FREE; });
+}
+
+void FrameCapture::waitUntilAllSlotsFree()
+{
+	while (!m_readingSlots.empty())
+		handOverReadSlots(true);
+
+	std::unique_lock<std::mutex> lock(m_mutex);
+	m_slotFreed.wait(lock, [this]()
+	{
+		return std::all_of(m_slots.begin(), m_slots.end(), [](const Slot& slot) { return slot.state == SlotState::FREE; });
+	});
+}
+
+void FrameCapture::encodeSlots()
+{
+	while (true)
+	{
+		uint32_t slotIndex;
+
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_slotEncodeQueued.wait(lock, [this]() { return !m_encodeQueue.empty() || m_stopping; });
+
+			if (m_encodeQueue.empty())
+				return;
+
+			slotIndex = m_encodeQueue.front();
+			m_encodeQueue.pop_front();
+		}
+
+		encodeSlot(m_slots[slotIndex]);
+
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_slots[slotIndex].state = SlotState::FREE;
+		}
+
+		m_slotFreed.notify_all();
+	}
+}
+
+void FrameCapture::encodeSlot(const Slot& slot)
+{
+	const std::filesystem::path& outputDirectory = m_specification.outputDirectory;
+
+	try
+	{
+		if (!m_specification.pipeCommand.empty())
+		{
+			if (!m_pipeFailed && !ImageWriter::writeRaw(m_pipe, slot.width, slot.height, slot.colorPixels))
+			{
+				RendererLog::error("Could not write to {0}, so later captured frames will be dropped", m_specification.pipeCommand);
+				m_pipeFailed = true;
+			}
+		}
+		else
+		{
+			std::filesystem::path filePath = outputDirectory / ImageWriter::getSequenceFileName("frame", slot.frameIndex, m_specification.format);
+
+			switch (m_specification.format)
+			{
+			case ImageWriter::Format::PNG:
+				ImageWriter::writePNG(filePath, slot.width, slot.height, slot.colorPixels);
+				break;
+			case ImageWriter::Format::EXR:
+				// The frame has been gamma corrected for display, which EXRs (being linear) undo
+				ImageWriter::writeEXR(filePath, slot.width, slot.height, ImageWriter::decodeSRGB(slot.width, slot.height, slot.colorPixels).data());
+				break;
+			case ImageWriter::Format::RAW:
+				ImageWriter::writeRaw(filePath, slot.width, slot.height, slot.colorPixels);
+				break;
+			default:
+				ASSERT_MESSAGE(false, "Unknown image format");
+				break;
+			}
+		}
+
+		if (slot.attachmentsCaptured && m_specification.captureHDR)
+			ImageWriter::writeEXR(outputDirectory / ImageWriter::getSequenceFileName("hdr", slot.frameIndex, ImageWriter::Format::EXR), slot.width, slot.height, slot.HDRPixels);
+
+		if (slot.attachmentsCaptured && m_specification.captureDepth)
+			ImageWriter::writeEXR(outputDirectory / ImageWriter::getSequenceFileName("depth", slot.frameIndex, ImageWriter::Format::EXR), slot.width, slot.height, slot.depthPixels, 1);
+	}
+	catch (ImageWriter::ImageWriteException& e)
+	{
+		RendererLog::error(e.what());
+	}
+
+	RendererLog::trace("Wrote captured frame {0}", slot.frameIndex);
+}
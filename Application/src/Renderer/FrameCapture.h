@@ -0,0 +1,138 @@
+#pragma once
+#include "PCH.h"
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+
+#include "glad/glad.h"
+
+#include "Framebuffer.h"
+#include "ImageWriter.h"
+#include "RenderGraph.h"
+
+/*
+Captures every frame drawn without stalling the renderer, to an image sequence or a pipe to a video encoder.
+
+At the end of each frame the final image (and optionally the HDR color and depth the PBR renderers drew it from) is
+read into a ring of pixel pack buffers, and a fence is placed after the reads. The GPU copies the pixels while the
+next frames are drawn, and once a slot's fence has signalled (normally a frame or two later) its buffers are handed
+to a background thread, which encodes them straight from the persistently mapped buffers and then frees the slot.
+The render thread only issues the reads and polls the fences. It only waits if every slot is still busy, which means
+the GPU or the encoding has fallen a whole ring behind.
+
+The renderers copy the HDR color and depth in a render graph pass (see addAttachmentCapturePass), as their framebuffers
+only exist while the graph executes. Multisampled framebuffers are resolved by the copy. The Blinn-Phong renderer
+has neither, so only its final image is captured.
+
+Frames are written as <prefix>_0000 onwards (frame, hdr and depth). HDR color and depth are always OpenEXR, while the
+final image uses the chosen format, or is piped as raw RGBA (top row first) to the standard input of a command.
+*/
+class FrameCapture
+{
+public:
+
+	struct CaptureSpecification
+	{
+		std::filesystem::path outputDirectory = "Output";
+		ImageWriter::Format format = ImageWriter::Format::PNG;
+		// If set, final images are written to this command's standard input instead of files, e.g.
+		// ffmpeg -f rawvideo -pix_fmt rgba -s 1280x720 -r 60 -i - capture.mp4
+		std::string pipeCommand;
+
+		bool captureHDR = false;
+		bool captureDepth = false;
+
+		// How many frames can be in flight between being read and being encoded
+		uint32_t slotCount = 3;
+	};
+
+public:
+
+	FrameCapture(const CaptureSpecification& specification);
+	// Waits for every frame still in flight to be written
+	~FrameCapture();
+	FrameCapture(const FrameCapture&) = delete;
+
+	// Copies the HDR color and depth into the capture's own framebuffer, if they are captured. The framebuffers may be the
+	// same one, and are read as the source of a blit
+	void addAttachmentCapturePass(RenderGraph& renderGraph, RenderGraph::ResourceHandle HDRFramebuffer, RenderGraph::ResourceHandle depthFramebuffer);
+
+	// Reads back the frame just drawn to the default framebuffer. Called once all drawing for the frame is done
+	void captureFrame();
+
+	uint32_t getCapturedFrameCount() const { return m_capturedFrameCount; }
+	// Milliseconds of render thread time the last captureFrame took
+	float getLastCaptureTime() const { return m_lastCaptureTime; }
+
+private:
+
+	enum class SlotState
+	{
+		FREE = 0,
+		// Waiting for the GPU to finish copying the pixels
+		READING,
+		// Being written by the encoding thread
+		ENCODING
+	};
+
+	struct Slot
+	{
+		SlotState state = SlotState::FREE;
+		GLsync fence = nullptr;
+
+		uint32_t frameIndex = 0;
+		uint32_t width = 0, height = 0;
+		bool attachmentsCaptured = false;
+
+		// Persistently mapped, so the encoding thread reads the pixels in place
+		RendererID colorBuffer = 0, HDRBuffer = 0, depthBuffer = 0;
+		const uint8_t* colorPixels = nullptr;
+		const float* HDRPixels = nullptr;
+		const float* depthPixels = nullptr;
+	};
+
+private:
+
+	void createSlotBuffers(uint32_t width, uint32_t height);
+	void deleteSlotBuffers();
+	RendererID createReadBuffer(size_t size, const void** mappedPointer);
+
+	void createAttachmentFramebuffer(uint32_t width, uint32_t height);
+
+	// Hands slots whose reads have finished to the encoding thread, in the order they were read. Waits for the
+	// oldest if waitForOldest is set
+	void handOverReadSlots(bool waitForOldest);
+	void waitUntilSlotFree(uint32_t slotIndex);
+	void waitUntilAllSlotsFree();
+
+	void encodeSlots();
+	void encodeSlot(const Slot& slot);
+
+private:
+
+	CaptureSpecification m_specification;
+
+	std::vector<Slot> m_slots;
+	uint32_t m_nextSlot = 0;
+	// Indices of the slots being read, oldest first
+	std::deque<uint32_t> m_readingSlots;
+	uint32_t m_bufferWidth = 0, m_bufferHeight = 0;
+
+	Unique<Framebuffer> m_attachmentFramebuffer;
+	bool m_attachmentsCapturedThisFrame = false;
+
+	uint32_t m_capturedFrameCount = 0;
+	float m_lastCaptureTime = 0.0f;
+
+	std::FILE* m_pipe = nullptr;
+	bool m_pipeFailed = false;
+
+	// Shared with the encoding thread
+	std::thread m_encodingThread;
+	std::mutex m_mutex;
+	std::condition_variable m_slotEncodeQueued, m_slotFreed;
+	std::deque<uint32_t> m_encodeQueue;
+	bool m_stopping = false;
+};
@@ -0,0 +1,91 @@
+#include "PCH.h"
+#include "FrameStatistics.h"
+
+#include "GLStateCache.h"
+#include "IndirectBuffer.h"
+
+FrameStatistics::Counters FrameStatistics::s_currentFrame;
+std::deque<FrameStatistics::Counters> FrameStatistics::s_history;
+
+void FrameStatistics::recordDraw(uint32_t indexCount, uint32_t instanceCount)
+{
+	s_currentFrame.drawCalls++;
+	s_currentFrame.draws++;
+	s_currentFrame.triangles += static_cast<uint64_t>(indexCount / 3) * instanceCount;
+	s_currentFrame.instances += instanceCount;
+}
+
+void FrameStatistics::recordIndirectDraws(const DrawElementsIndirectCommand* commands, uint32_t drawCount)
+{
+	s_currentFrame.drawCalls++;
+	s_currentFrame.draws += drawCount;
+
+	for (uint32_t i = 0; i < drawCount; i++)
+	{
+		s_currentFrame.triangles += static_cast<uint64_t>(commands[i].count / 3) * commands[i].instanceCount;
+		s_currentFrame.instances += commands[i].instanceCount;
+	}
+}
+
+void FrameStatistics::endFrame()
+{
+	const GLStateCache::Statistics& stateCacheStatistics = GLStateCache::getStatistics();
+
+	s_currentFrame.programBinds = stateCacheStatistics.programBinds;
+	s_currentFrame.textureBinds = stateCacheStatistics.textureBinds;
+	s_currentFrame.bufferBinds = stateCacheStatistics.bufferBinds;
+	s_currentFrame.vertexArrayBinds = stateCacheStatistics.vertexArrayBinds;
+	s_currentFrame.framebufferBinds = stateCacheStatistics.framebufferBinds;
+	s_currentFrame.uniformCalls = stateCacheStatistics.uniformUploads + stateCacheStatistics.uniformUploadsElided;
+	s_currentFrame.uniformUploads = stateCacheStatistics.uniformUploads;
+
+	GLStateCache::resetStatistics();
+
+	s_history.push_back(s_currentFrame);
+	if (s_history.size() > HISTORY_LENGTH)
+		s_history.pop_front();
+
+	s_currentFrame = Counters();
+
+	const Counters& frame = s_history.back();
+
+	RendererLog::trace("Frame statistics:");
+	RendererLog::trace("\tDraw calls:      {0} ({1} draws, {2} triangles, {3} instances)", frame.drawCalls, frame.draws, frame.triangles, frame.instances);
+	RendererLog::trace("\tDispatches:      {0}", frame.computeDispatches);
+	RendererLog::trace("\tBinds:           {0} programs, {1} textures, {2} buffers, {3} vertex arrays, {4} framebuffers", frame.programBinds, frame.textureBinds, frame.bufferBinds, frame.vertexArrayBinds, frame.framebufferBinds);
+	RendererLog::trace("\tBlits:           {0}", frame.framebufferBlits);
+	RendererLog::trace("\tUniforms:        {0} calls, {1} uploads", frame.uniformCalls, frame.uniformUploads);
+	RendererLog::trace("\tBytes uploaded:  {0}", frame.bytesUploaded);
+}
+
+const FrameStatistics::Counters& FrameStatistics::getLastFrame()
+{
+	static const Counters NO_FRAME;
+
+	return s_history.empty() ? NO_FRAME : s_history.back();
+}
+
+FrameStatistics::Counters FrameStatistics::getHistoryMaximum()
+{
+	Counters maximum;
+
+	for (const Counters& frame : s_history)
+	{
+		maximum.drawCalls = std::max(maximum.drawCalls, frame.drawCalls);
+		maximum.draws = std::max(maximum.draws, frame.draws);
+		maximum.triangles = std::max(maximum.triangles, frame.triangles);
+		maximum.instances = std::max(maximum.instances, frame.instances);
+		maximum.computeDispatches = std::max(maximum.computeDispatches, frame.computeDispatches);
+		maximum.programBinds = std::max(maximum.programBinds, frame.programBinds);
+		maximum.textureBinds = std::max(maximum.textureBinds, frame.textureBinds);
+		maximum.bufferBinds = std::max(maximum.bufferBinds, frame.bufferBinds);
+		maximum.vertexArrayBinds = std::max(maximum.vertexArrayBinds, frame.vertexArrayBinds);
+		maximum.framebufferBinds = std::max(maximum.framebufferBinds, frame.framebufferBinds);
+		maximum.framebufferBlits = std::max(maximum.framebufferBlits, frame.framebufferBlits);
+		maximum.uniformCalls = std::max(maximum.uniformCalls, frame.uniformCalls);
+		maximum.uniformUploads = std::max(maximum.uniformUploads, frame.uniformUploads);
+		maximum.bytesUploaded = std::max(maximum.bytesUploaded, frame.bytesUploaded);
+	}
+
+	return maximum;
+}
@@ -0,0 +1,77 @@
+#pragma once
+#include "PCH.h"
+
+#include <deque>
+
+struct DrawElementsIndirectCommand;
+
+/*
+Counts the work the renderer hands to OpenGL each frame, so that how much a frame does can be checked against a budget.
+
+Draws and compute dispatches are counted by RendererUtilities, blits by Framebuffer, and uploads by the buffer and
+texture classes. Binds and uniforms are counted by GLStateCache, which every bind and setUniformToValue goes through,
+and are taken from its statistics when the frame ends.
+
+Renderer::endFrame ends each frame, which moves its counters into a rolling history of the last HISTORY_LENGTH frames
+and starts the next at zero.
+*/
+class FrameStatistics
+{
+public:
+
+	struct Counters
+	{
+		// API calls. A multi-draw is one draw call, of as many draws as it has commands
+		uint32_t drawCalls = 0;
+		uint32_t draws = 0;
+		// As submitted. Draws the GPU culler drops, and triangles a geometry shader emits, aren't known on the CPU
+		uint64_t triangles = 0;
+		uint64_t instances = 0;
+		uint32_t computeDispatches = 0;
+
+		// Only those which reached OpenGL, rather than being elided by GLStateCache
+		uint32_t programBinds = 0;
+		uint32_t textureBinds = 0;
+		uint32_t bufferBinds = 0;
+		uint32_t vertexArrayBinds = 0;
+		uint32_t framebufferBinds = 0;
+		uint32_t framebufferBlits = 0;
+
+		// Every setUniformToValue call, and those of them that changed the value and so were uploaded
+		uint32_t uniformCalls = 0;
+		uint32_t uniformUploads = 0;
+
+		// To buffers and textures, from the CPU
+		uint64_t bytesUploaded = 0;
+	};
+
+	static constexpr uint32_t HISTORY_LENGTH = 240;
+
+public:
+
+	static void recordDraw(uint32_t indexCount, uint32_t instanceCount = 1);
+	// The commands are the CPU's copy of those drawn
+	static void recordIndirectDraws(const DrawElementsIndirectCommand* commands, uint32_t drawCount);
+	static void recordComputeDispatch() { s_currentFrame.computeDispatches++; }
+	static void recordFramebufferBlit() { s_currentFrame.framebufferBlits++; }
+	static void recordUpload(uint64_t byteCount) { s_currentFrame.bytesUploaded += byteCount; }
+
+	// Resets the GLStateCache statistics, along with the frame's own counters
+	static void endFrame();
+
+	// The frame still being drawn, without its binds and uniforms until it ends
+	static const Counters& getCurrentFrame() { return s_currentFrame; }
+	// The last frame to end. All zero before the first one has
+	static const Counters& getLastFrame();
+	// Oldest first
+	static const std::deque<Counters>& getHistory() { return s_history; }
+	// The most of each counter in any frame of the history, to compare against a budget
+	static Counters getHistoryMaximum();
+
+	static void clearHistory() { s_history.clear(); }
+
+private:
+
+	static Counters s_currentFrame;
+	static std::deque<Counters> s_history;
+};
@@ -3,41 +3,60 @@
 
 #include "Core/Application.h"
 
+#include "FrameStatistics.h"
+#include "GLStateCache.h"
+
 Framebuffer::Framebuffer(const FramebufferSpecification& specification)
 	: m_specification(specification)
 {
 	createFramebuffer(m_specification.width, m_specification.height);
 
-	Log::info("Created framebuffer {0}", m_rendererID);
+	m_renderWidth = m_specification.width;
+	m_renderHeight = m_specification.height;
+
+	RendererLog::info("Created framebuffer {0}", m_rendererID);
 }
 
 Framebuffer::~Framebuffer()
 {
 	deleteFramebuffer();
 
-	Log::info("Deleted framebuffer {0}", m_rendererID);
+	RendererLog::info("Deleted framebuffer {0}", m_rendererID);
 }
 
 void Framebuffer::bind() const
 {
-	glBindFramebuffer(GL_FRAMEBUFFER, m_rendererID);
-	glViewport(0, 0, m_specification.width, m_specification.height);
+	GLStateCache::bindFramebuffer(m_rendererID);
+	GLStateCache::setViewport(0, 0, m_renderWidth, m_renderHeight);
 
-	Log::trace("Bound framebuffer {0}", m_rendererID);
+	RendererLog::trace("Bound framebuffer {0}", m_rendererID);
 }
 
-void Framebuffer::bindColorAttachment(uint32_t textureSlot) const
+void Framebuffer::bindColorAttachment(uint32_t textureSlot, uint32_t attachmentIndex) const
 {
-	glBindTextureUnit(textureSlot, m_colorAttachmentRendererID);
+	ASSERT_MESSAGE(attachmentIndex < m_colorAttachmentRendererIDs.size(), "Framebuffer {0} has no color attachment {1}", m_rendererID, attachmentIndex);
+
+	GLStateCache::bindTextureUnit(textureSlot, m_colorAttachmentRendererIDs[attachmentIndex]);
 
-	Log::trace("Bound color attachment {0} of framebuffer {1}, to texture slot {2}", m_colorAttachmentRendererID, m_rendererID, textureSlot);
+	RendererLog::trace("Bound color attachment {0} of framebuffer {1}, to texture slot {2}", m_colorAttachmentRendererIDs[attachmentIndex], m_rendererID, textureSlot);
 }
 
 void Framebuffer::bindDepthAttachment(uint32_t textureSlot) const
 {
-	glBindTextureUnit(textureSlot, m_depthAttachmentRendererID);
+	GLStateCache::bindTextureUnit(textureSlot, m_depthAttachmentRendererID);
+
+	RendererLog::trace("Bound depth attachment {0} of framebuffer {1}, to texture slot {2}", m_depthAttachmentRendererID, m_rendererID, textureSlot);
+}
+
+void Framebuffer::bindColorAttachmentImage(uint32_t imageUnit, uint32_t attachmentIndex) const
+{
+	ASSERT_MESSAGE(attachmentIndex < m_colorAttachmentRendererIDs.size(), "Framebuffer {0} has no color attachment {1}", m_rendererID, attachmentIndex);
+	ASSERT_MESSAGE(m_specification.samples == 1, "Multisampled color attachments cannot be bound as images");
+
+	GLenum sizedInternalFormat = getOpenGLColorAttachmentSizedInternalFormat(m_specification.colorAttachmentFormats[attachmentIndex]);
+	glBindImageTexture(imageUnit, m_colorAttachmentRendererIDs[attachmentIndex], 0, GL_FALSE, 0, GL_WRITE_ONLY, sizedInternalFormat);
 
-	Log::trace("Bound depth attachment {0} of framebuffer {1}, to texture slot {2}", m_depthAttachmentRendererID, m_rendererID, textureSlot);
+	RendererLog::trace("Bound color attachment {0} of framebuffer {1}, to image unit {2}", m_colorAttachmentRendererIDs[attachmentIndex], m_rendererID, imageUnit);
 }
 
 void Framebuffer::onWindowResizeEvent(uint32_t width, uint32_t height)
@@ -45,10 +64,24 @@ void Framebuffer::onWindowResizeEvent(uint32_t width, uint32_t height)
 	if (m_specification.resizeWithWindowResizeEvents)
 	{
 		resize(width, height);
-		Log::trace("Resized framebuffer {0} to ({1}, {2})", m_rendererID, width, height);
+		RendererLog::trace("Resized framebuffer {0} to ({1}, {2})", m_rendererID, width, height);
 	}
 }
 
+void Framebuffer::setRenderSize(uint32_t width, uint32_t height)
+{
+	m_renderWidth = std::clamp(width, 1u, m_specification.width);
+	m_renderHeight = std::clamp(height, 1u, m_specification.height);
+}
+
+glm::vec2 Framebuffer::getTextureCoordinatesScale() const
+{
+	return glm::vec2(
+		static_cast<float>(m_renderWidth) / static_cast<float>(m_specification.width),
+		static_cast<float>(m_renderHeight) / static_cast<float>(m_specification.height)
+	);
+}
+
 void Framebuffer::clear() const
 {
 	bind();
@@ -56,33 +89,83 @@ void Framebuffer::clear() const
 	RendererUtilities::setClearColor(m_specification.clearColor);
 	RendererUtilities::clear();
 
-	Log::trace("Cleared framebuffer {0}", m_rendererID);
+	RendererLog::trace("Cleared framebuffer {0}", m_rendererID);
 }
 
-void Framebuffer::blitToTargetFramebuffer(Reference<const Framebuffer> target)
+void Framebuffer::blitToTargetFramebuffer(const Framebuffer* target) const
 {
-	// Will blit to the default framebuffer if target is a nullptr
+	// Will blit to the default framebuffer if target is a nullptr. Only the render size of each framebuffer is blitted
 
-	RendererID targetFramebufferRendererID = 0;
+	RendererID targetFramebufferRendererID = RendererUtilities::getDefaultFramebufferRendererID();
 	uint32_t targetFramebufferWidth = Application::getWindow().getWidth();
 	uint32_t targetFramebufferHeight = Application::getWindow().getHeight();
 	if (target)
 	{
 		targetFramebufferRendererID = target->m_rendererID;
-		targetFramebufferWidth = target->m_specification.width;
-		targetFramebufferHeight = target->m_specification.height;
+		targetFramebufferWidth = target->m_renderWidth;
+		targetFramebufferHeight = target->m_renderHeight;
 	}
 
 	glBlitNamedFramebuffer(
 		m_rendererID, 
 		targetFramebufferRendererID,
-		0, 0, m_specification.width, m_specification.height,
+		0, 0, m_renderWidth, m_renderHeight,
 		0, 0, targetFramebufferWidth, targetFramebufferHeight,
 		GL_COLOR_BUFFER_BIT,
 		GL_LINEAR
 	);
+	FrameStatistics::recordFramebufferBlit();
+
+	RendererLog::trace("Blitted color attachment {0} of framebuffer {1}, to framebuffer {2}", m_colorAttachmentRendererIDs[0], m_rendererID, targetFramebufferRendererID);
+}
+
+void Framebuffer::readColorAttachment(std::vector<uint8_t>& pixels, uint32_t attachmentIndex) const
+{
+	pixels.resize(static_cast<size_t>(m_renderWidth) * m_renderHeight * 4);
+	readColorAttachment(pixels.data(), pixels.size() * sizeof(uint8_t), GL_UNSIGNED_BYTE, attachmentIndex);
+}
+
+void Framebuffer::readColorAttachment(std::vector<float>& pixels, uint32_t attachmentIndex) const
+{
+	pixels.resize(static_cast<size_t>(m_renderWidth) * m_renderHeight * 4);
+	readColorAttachment(pixels.data(), pixels.size() * sizeof(float), GL_FLOAT, attachmentIndex);
+}
+
+void Framebuffer::readColorAttachment(void* pixels, size_t byteSize, GLenum type, uint32_t attachmentIndex) const
+{
+	ASSERT_MESSAGE(attachmentIndex < m_colorAttachmentRendererIDs.size(), "Framebuffer {0} has no color attachment {1}", m_rendererID, attachmentIndex);
+	ASSERT_MESSAGE(m_specification.samples == 1, "Multisampled color attachments cannot be read back");
+
+	glGetTextureSubImage(m_colorAttachmentRendererIDs[attachmentIndex], 0, 0, 0, 0, m_renderWidth, m_renderHeight, 1, GL_RGBA, type, static_cast<GLsizei>(byteSize), pixels);
+
+	RendererLog::trace("Read back color attachment {0} of framebuffer {1}", m_colorAttachmentRendererIDs[attachmentIndex], m_rendererID);
+}
+
+void Framebuffer::invalidate() const
+{
+	std::vector<GLenum> attachments;
+	for (uint32_t i = 0; i < static_cast<uint32_t>(m_colorAttachmentRendererIDs.size()); i++)
+		attachments.push_back(GL_COLOR_ATTACHMENT0 + i);
+	if (m_specification.depthAttachmentFormat != DepthAttachmentFormat::NONE)
+		attachments.push_back(getOpenGLDepthAttachmentType());
+
+	glInvalidateNamedFramebufferData(m_rendererID, static_cast<int32_t>(attachments.size()), attachments.data());
+
+	RendererLog::trace("Invalidated framebuffer {0}", m_rendererID);
+}
+
+uint64_t Framebuffer::getMemoryUsage() const
+{
+	return getMemoryUsage(m_specification);
+}
+
+uint64_t Framebuffer::getMemoryUsage(const FramebufferSpecification& specification)
+{
+	uint64_t bytesPerPixel = getDepthAttachmentBytesPerPixel(specification.depthAttachmentFormat);
+	for (ColorAttachmentFormat colorAttachmentFormat : specification.colorAttachmentFormats)
+		bytesPerPixel += getColorAttachmentBytesPerPixel(colorAttachmentFormat);
 
-	Log::trace("Blitted color attachment {0} of framebuffer {1}, to framebuffer {2}", m_colorAttachmentRendererID, m_rendererID, targetFramebufferRendererID);
+	return static_cast<uint64_t>(specification.width) * static_cast<uint64_t>(specification.height) * specification.samples * bytesPerPixel;
 }
 
 void Framebuffer::resize(uint32_t width, uint32_t height)
@@ -96,37 +179,60 @@ void Framebuffer::resize(uint32_t width, uint32_t height)
 
 	m_specification.width = width;
 	m_specification.height = height;
+
+	m_renderWidth = width;
+	m_renderHeight = height;
 }
 
 void Framebuffer::createFramebuffer(uint32_t width, uint32_t height)
 {
 	glCreateFramebuffers(1, &m_rendererID);
 
-	glBindFramebuffer(GL_FRAMEBUFFER, m_rendererID);
-	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	GLStateCache::bindFramebuffer(m_rendererID);
+	GLStateCache::bindFramebuffer(0);
 
-	setUpColorAttachment(width, height);
+	setUpColorAttachments(width, height);
 	setUpDepthAttachment(width, height);
 
 	ASSERT_MESSAGE(glCheckNamedFramebufferStatus(m_rendererID, GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE, "Framebuffer {0} is not complete / has not been created properly", m_rendererID);
 }
 
-void Framebuffer::setUpColorAttachment(uint32_t width, uint32_t height)
+void Framebuffer::setUpColorAttachments(uint32_t width, uint32_t height)
 {
-	GLenum colorAttachmentSizedInternalFormat = getOpenGLColorAttachmentSizedInternalFormat();
-	
-	if (m_specification.samples > 1)
-	{
-		glCreateTextures(GL_TEXTURE_2D_MULTISAMPLE, 1, &m_colorAttachmentRendererID);
-		glTextureStorage2DMultisample(m_colorAttachmentRendererID, m_specification.samples, colorAttachmentSizedInternalFormat, width, height, false);
-	}
-	else
+	uint32_t colorAttachmentCount = static_cast<uint32_t>(m_specification.colorAttachmentFormats.size());
+	m_colorAttachmentRendererIDs.resize(colorAttachmentCount);
+
+	std::vector<GLenum> drawBuffers(colorAttachmentCount);
+
+	for (uint32_t i = 0; i < colorAttachmentCount; i++)
 	{
-		glCreateTextures(GL_TEXTURE_2D, 1, &m_colorAttachmentRendererID);
-		glTextureStorage2D(m_colorAttachmentRendererID, 1, colorAttachmentSizedInternalFormat, width, height);
+		GLenum colorAttachmentSizedInternalFormat = getOpenGLColorAttachmentSizedInternalFormat(m_specification.colorAttachmentFormats[i]);
+		RendererID& colorAttachmentRendererID = m_colorAttachmentRendererIDs[i];
+
+		if (m_specification.samples > 1)
+		{
+			glCreateTextures(GL_TEXTURE_2D_MULTISAMPLE, 1, &colorAttachmentRendererID);
+			glTextureStorage2DMultisample(colorAttachmentRendererID, m_specification.samples, colorAttachmentSizedInternalFormat, width, height, false);
+		}
+		else
+		{
+			glCreateTextures(GL_TEXTURE_2D, 1, &colorAttachmentRendererID);
+			glTextureStorage2D(colorAttachmentRendererID, 1, colorAttachmentSizedInternalFormat, width, height);
+
+			// Post processing passes filter between pixels, and must not read past the edges of the screen
+			glTextureParameteri(colorAttachmentRendererID, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+			glTextureParameteri(colorAttachmentRendererID, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+			glTextureParameteri(colorAttachmentRendererID, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+			glTextureParameteri(colorAttachmentRendererID, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+		}
+
+		glNamedFramebufferTexture(m_rendererID, GL_COLOR_ATTACHMENT0 + i, colorAttachmentRendererID, 0);
+		drawBuffers[i] = GL_COLOR_ATTACHMENT0 + i;
 	}
 
-	glNamedFramebufferTexture(m_rendererID, GL_COLOR_ATTACHMENT0, m_colorAttachmentRendererID, 0);
+	// Fragment shader outputs are written to every attachment (output location i goes to attachment i)
+	if (colorAttachmentCount > 1)
+		glNamedFramebufferDrawBuffers(m_rendererID, static_cast<int32_t>(colorAttachmentCount), drawBuffers.data());
 }
 
 void Framebuffer::setUpDepthAttachment(uint32_t width, uint32_t height)
@@ -152,9 +258,9 @@ void Framebuffer::setUpDepthAttachment(uint32_t width, uint32_t height)
 	glNamedFramebufferTexture(m_rendererID, depthAttachmentType, m_depthAttachmentRendererID, 0);
 }
 
-GLenum Framebuffer::getOpenGLColorAttachmentSizedInternalFormat() const
+GLenum Framebuffer::getOpenGLColorAttachmentSizedInternalFormat(ColorAttachmentFormat colorAttachmentFormat)
 {
-	switch (m_specification.colorAttachmentFormat)
+	switch (colorAttachmentFormat)
 	{
 	case ColorAttachmentFormat::RGBA8:
 		return GL_RGBA8;
@@ -162,6 +268,12 @@ GLenum Framebuffer::getOpenGLColorAttachmentSizedInternalFormat() const
 	case ColorAttachmentFormat::RGBA16F:
 		return GL_RGBA16F;
 		break;
+	case ColorAttachmentFormat::RGB10A2:
+		return GL_RGB10_A2;
+		break;
+	case ColorAttachmentFormat::RG8:
+		return GL_RG8;
+		break;
 	default:
 		ASSERT_MESSAGE(false, "Cannot get OpenGL equivalent of color attachment format");
 		return 0;
@@ -169,6 +281,29 @@ GLenum Framebuffer::getOpenGLColorAttachmentSizedInternalFormat() const
 	}
 }
 
+uint32_t Framebuffer::getColorAttachmentBytesPerPixel(ColorAttachmentFormat colorAttachmentFormat)
+{
+	switch (colorAttachmentFormat)
+	{
+	case ColorAttachmentFormat::RGBA8:
+		return 4;
+		break;
+	case ColorAttachmentFormat::RGBA16F:
+		return 8;
+		break;
+	case ColorAttachmentFormat::RGB10A2:
+		return 4;
+		break;
+	case ColorAttachmentFormat::RG8:
+		return 2;
+		break;
+	default:
+		ASSERT_MESSAGE(false, "Cannot get size of color attachment format");
+		return 0;
+		break;
+	}
+}
+
 GLenum Framebuffer::getOpenGLDepthAttachmentSizedInternalFormat() const
 {
 	switch (m_specification.depthAttachmentFormat)
@@ -197,9 +332,27 @@ GLenum Framebuffer::getOpenGLDepthAttachmentType() const
 	}
 }
 
+uint32_t Framebuffer::getDepthAttachmentBytesPerPixel(DepthAttachmentFormat depthAttachmentFormat)
+{
+	switch (depthAttachmentFormat)
+	{
+	case DepthAttachmentFormat::NONE:
+		return 0;
+		break;
+	case DepthAttachmentFormat::DEPTH24STENCIL8:
+		return 4;
+		break;
+	default:
+		ASSERT_MESSAGE(false, "Cannot get size of depth attachment format");
+		return 0;
+		break;
+	}
+}
+
 void Framebuffer::deleteFramebuffer() const
 {
-	glDeleteFramebuffers(1, &m_rendererID);
-	glDeleteTextures(1, &m_colorAttachmentRendererID);
-	glDeleteTextures(1, &m_depthAttachmentRendererID);
+	GLStateCache::deleteFramebuffer(m_rendererID);
+	for (RendererID colorAttachmentRendererID : m_colorAttachmentRendererIDs)
+		GLStateCache::deleteTexture(colorAttachmentRendererID);
+	GLStateCache::deleteTexture(m_depthAttachmentRendererID);
 }
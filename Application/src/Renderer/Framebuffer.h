@@ -13,7 +13,9 @@ public:
 	enum class ColorAttachmentFormat
 	{
 		RGBA8 = 0,
-		RGBA16F
+		RGBA16F,
+		RGB10A2,
+		RG8
 	};
 
 	enum class DepthAttachmentFormat
@@ -25,7 +27,8 @@ public:
 	struct FramebufferSpecification
 	{
 		uint32_t width = DEFAULT_WIDTH, height = DEFAULT_HEIGHT;
-		ColorAttachmentFormat colorAttachmentFormat = ColorAttachmentFormat::RGBA8;
+		// One color attachment is created for each format, attached to GL_COLOR_ATTACHMENT0 onwards
+		std::vector<ColorAttachmentFormat> colorAttachmentFormats = { ColorAttachmentFormat::RGBA8 };
 		DepthAttachmentFormat depthAttachmentFormat = DepthAttachmentFormat::DEPTH24STENCIL8;
 		bool resizeWithWindowResizeEvents = true;
 		glm::vec4 clearColor = { 0.0f, 0.0f, 0.0f, 1.0f };
@@ -40,32 +43,67 @@ public:
 	Framebuffer(const Framebuffer&) = delete;
 
 	void bind() const;
-	void bindColorAttachment(uint32_t textureSlot = 0) const;
+	void bindColorAttachment(uint32_t textureSlot = 0, uint32_t attachmentIndex = 0) const;
 	void bindDepthAttachment(uint32_t textureSlot = 0) const;
+	// Binds a color attachment to an image unit, so that compute shaders can write to it (single sample framebuffers only)
+	void bindColorAttachmentImage(uint32_t imageUnit, uint32_t attachmentIndex = 0) const;
 
 	void onWindowResizeEvent(uint32_t width, uint32_t height);
 
+	// Draws to a sub-rect of the attachments (from the bottom left corner) rather than all of them, so that the
+	// size drawn at can change every frame without reallocating. Clamped to the allocated size, and reset to it on resize
+	void setRenderSize(uint32_t width, uint32_t height);
+	uint32_t getRenderWidth() const { return m_renderWidth; }
+	uint32_t getRenderHeight() const { return m_renderHeight; }
+	// What the texture coordinates of a screen quad are multiplied by to sample only the render size of the attachments
+	glm::vec2 getTextureCoordinatesScale() const;
+
+	void setClearColor(const glm::vec4& clearColor) { m_specification.clearColor = clearColor; }
+
 	void clear() const;
 
-	void blitToTargetFramebuffer(Reference<const Framebuffer> target = nullptr);
+	void blitToTargetFramebuffer(const Framebuffer* target = nullptr) const;
+
+	// Reads the render size of a color attachment back as RGBA, bottom row first (single sample framebuffers only).
+	// Waits for the GPU to finish drawing to it, so is for offline rendering rather than every frame
+	void readColorAttachment(std::vector<uint8_t>& pixels, uint32_t attachmentIndex = 0) const;
+	void readColorAttachment(std::vector<float>& pixels, uint32_t attachmentIndex = 0) const;
+
+	// Tells the driver the contents of every attachment are no longer needed, so they don't have to be kept (or written
+	// back to memory, on tiled GPUs). Called once a multisampled framebuffer has been resolved
+	void invalidate() const;
+
+	const FramebufferSpecification& getSpecification() const { return m_specification; }
+	RendererID getRendererID() const { return m_rendererID; }
+
+	// Bytes of GPU memory used by the attachments (including every sample of multisampled attachments)
+	uint64_t getMemoryUsage() const;
+	// As above, for a framebuffer created with the specification
+	static uint64_t getMemoryUsage(const FramebufferSpecification& specification);
 
 private:
 
 	void resize(uint32_t width, uint32_t height);
 
 	void createFramebuffer(uint32_t width, uint32_t height);
-	void setUpColorAttachment(uint32_t width, uint32_t height);
+	void setUpColorAttachments(uint32_t width, uint32_t height);
 	void setUpDepthAttachment(uint32_t width, uint32_t height);
 
-	GLenum getOpenGLColorAttachmentSizedInternalFormat() const;
+	static GLenum getOpenGLColorAttachmentSizedInternalFormat(ColorAttachmentFormat colorAttachmentFormat);
+	static uint32_t getColorAttachmentBytesPerPixel(ColorAttachmentFormat colorAttachmentFormat);
 	GLenum getOpenGLDepthAttachmentSizedInternalFormat() const;
 	GLenum getOpenGLDepthAttachmentType() const;
+	static uint32_t getDepthAttachmentBytesPerPixel(DepthAttachmentFormat depthAttachmentFormat);
 
 	void deleteFramebuffer() const;
 
+	void readColorAttachment(void* pixels, size_t byteSize, GLenum type, uint32_t attachmentIndex) const;
+
 private:
 
 	RendererID m_rendererID = 0;
-	RendererID m_colorAttachmentRendererID = 0, m_depthAttachmentRendererID = 0;
+	std::vector<RendererID> m_colorAttachmentRendererIDs;
+	RendererID m_depthAttachmentRendererID = 0;
 	FramebufferSpecification m_specification;
+	uint32_t m_renderWidth = 0, m_renderHeight = 0;
 };
\ No newline at end of file
@@ -0,0 +1,267 @@
+#include "PCH.h"
+#include "GLStateCache.h"
+
+#include <cstring>
+
+RendererID GLStateCache::s_program = 0;
+
+std::unordered_map<GLenum, RendererID> GLStateCache::s_buffers;
+std::unordered_map<uint64_t, RendererID> GLStateCache::s_indexedBuffers;
+
+RendererID GLStateCache::s_vertexArray = 0;
+std::unordered_map<uint64_t, std::pair<RendererID, uint32_t>> GLStateCache::s_vertexArrayVertexBuffers;
+std::unordered_map<RendererID, RendererID> GLStateCache::s_vertexArrayIndexBuffers;
+
+std::vector<RendererID> GLStateCache::s_textureUnits;
+
+RendererID GLStateCache::s_framebuffer = 0;
+std::array<int32_t, 4> GLStateCache::s_viewport = { 0, 0, 0, 0 };
+
+std::unordered_map<RendererID, std::unordered_map<int32_t, GLStateCache::UniformValue>> GLStateCache::s_uniformValues;
+
+GLStateCache::Statistics GLStateCache::s_statistics;
+
+void GLStateCache::init()
+{
+	// Start from the state of a new context
+
+	int32_t textureUnitCount;
+	glGetIntegerv(GL_MAX_COMBINED_TEXTURE_IMAGE_UNITS, &textureUnitCount);
+	s_textureUnits.assign(textureUnitCount, 0);
+
+	glGetIntegerv(GL_VIEWPORT, s_viewport.data());
+
+	RendererLog::info("GL state cache initialised with {0} texture units", textureUnitCount);
+}
+
+void GLStateCache::shutdown()
+{
+	s_program = 0;
+	s_buffers.clear();
+	s_indexedBuffers.clear();
+	s_vertexArray = 0;
+	s_vertexArrayVertexBuffers.clear();
+	s_vertexArrayIndexBuffers.clear();
+	s_textureUnits.clear();
+	s_framebuffer = 0;
+	s_uniformValues.clear();
+}
+
+void GLStateCache::useProgram(RendererID program)
+{
+	if (program == s_program)
+	{
+		s_statistics.programBindsElided++;
+		return;
+	}
+
+	glUseProgram(program);
+	s_program = program;
+	s_statistics.programBinds++;
+}
+
+void GLStateCache::bindBuffer(GLenum target, RendererID buffer)
+{
+	auto it = s_buffers.find(target);
+	if (it != s_buffers.end() && it->second == buffer)
+	{
+		s_statistics.bufferBindsElided++;
+		return;
+	}
+
+	glBindBuffer(target, buffer);
+	s_buffers[target] = buffer;
+	s_statistics.bufferBinds++;
+}
+
+void GLStateCache::bindBufferBase(GLenum target, uint32_t index, RendererID buffer)
+{
+	uint64_t key = getIndexedKey(target, index);
+
+	auto it = s_indexedBuffers.find(key);
+	if (it != s_indexedBuffers.end() && it->second == buffer)
+	{
+		s_statistics.bufferBindsElided++;
+		return;
+	}
+
+	// Binding to an indexed target also binds to the generic target
+	glBindBufferBase(target, index, buffer);
+	s_indexedBuffers[key] = buffer;
+	s_buffers[target] = buffer;
+	s_statistics.bufferBinds++;
+}
+
+void GLStateCache::bindVertexArray(RendererID vertexArray)
+{
+	if (vertexArray == s_vertexArray)
+	{
+		s_statistics.vertexArrayBindsElided++;
+		return;
+	}
+
+	glBindVertexArray(vertexArray);
+	s_vertexArray = vertexArray;
+	s_statistics.vertexArrayBinds++;
+}
+
+void GLStateCache::setVertexArrayVertexBuffer(RendererID vertexArray, uint32_t bindingIndex, RendererID buffer, uint32_t stride)
+{
+	std::pair<RendererID, uint32_t> binding = { buffer, stride };
+
+	auto it = s_vertexArrayVertexBuffers.find(getIndexedKey(vertexArray, bindingIndex));
+	if (it != s_vertexArrayVertexBuffers.end() && it->second == binding)
+	{
+		s_statistics.bufferBindsElided++;
+		return;
+	}
+
+	glVertexArrayVertexBuffer(vertexArray, bindingIndex, buffer, 0, stride);
+	s_vertexArrayVertexBuffers[getIndexedKey(vertexArray, bindingIndex)] = binding;
+	s_statistics.bufferBinds++;
+}
+
+void GLStateCache::bindIndexBuffer(RendererID buffer)
+{
+	ASSERT_MESSAGE(s_vertexArray != 0, "An index buffer can only be bound once a vertex array has been bound");
+
+	auto it = s_vertexArrayIndexBuffers.find(s_vertexArray);
+	if (it != s_vertexArrayIndexBuffers.end() && it->second == buffer)
+	{
+		s_statistics.bufferBindsElided++;
+		return;
+	}
+
+	glVertexArrayElementBuffer(s_vertexArray, buffer);
+	s_vertexArrayIndexBuffers[s_vertexArray] = buffer;
+	s_statistics.bufferBinds++;
+}
+
+void GLStateCache::bindTextureUnit(uint32_t unit, RendererID texture)
+{
+	ASSERT_MESSAGE(unit < s_textureUnits.size(), "Texture unit {0} is out of range", unit);
+
+	if (s_textureUnits[unit] == texture)
+	{
+		s_statistics.textureBindsElided++;
+		return;
+	}
+
+	glBindTextureUnit(unit, texture);
+	s_textureUnits[unit] = texture;
+	s_statistics.textureBinds++;
+}
+
+void GLStateCache::bindFramebuffer(RendererID framebuffer)
+{
+	if (framebuffer == s_framebuffer)
+	{
+		s_statistics.framebufferBindsElided++;
+		return;
+	}
+
+	glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+	s_framebuffer = framebuffer;
+	s_statistics.framebufferBinds++;
+}
+
+void GLStateCache::setViewport(int32_t x, int32_t y, int32_t width, int32_t height)
+{
+	std::array<int32_t, 4> viewport = { x, y, width, height };
+
+	if (viewport == s_viewport)
+	{
+		s_statistics.viewportChangesElided++;
+		return;
+	}
+
+	glViewport(x, y, width, height);
+	s_viewport = viewport;
+	s_statistics.viewportChanges++;
+}
+
+void GLStateCache::deleteProgram(RendererID program)
+{
+	glDeleteProgram(program);
+
+	// A program that is in use is only flagged for deletion, so it stays bound (and its name can't be reused yet)
+	s_uniformValues.erase(program);
+}
+
+void GLStateCache::deleteBuffer(RendererID buffer)
+{
+	glDeleteBuffers(1, &buffer);
+
+	// OpenGL resets any bindings of a deleted buffer to 0
+
+	for (auto& [target, boundBuffer] : s_buffers)
+		if (boundBuffer == buffer)
+			boundBuffer = 0;
+
+	for (auto& [key, boundBuffer] : s_indexedBuffers)
+		if (boundBuffer == buffer)
+			boundBuffer = 0;
+
+	for (auto& [key, binding] : s_vertexArrayVertexBuffers)
+		if (binding.first == buffer)
+			binding.first = 0;
+
+	for (auto& [vertexArray, indexBuffer] : s_vertexArrayIndexBuffers)
+		if (indexBuffer == buffer)
+			indexBuffer = 0;
+}
+
+void GLStateCache::deleteTexture(RendererID texture)
+{
+	glDeleteTextures(1, &texture);
+
+	for (RendererID& boundTexture : s_textureUnits)
+		if (boundTexture == texture)
+			boundTexture = 0;
+}
+
+void GLStateCache::deleteFramebuffer(RendererID framebuffer)
+{
+	glDeleteFramebuffers(1, &framebuffer);
+
+	if (s_framebuffer == framebuffer)
+		s_framebuffer = 0;
+}
+
+void GLStateCache::deleteVertexArray(RendererID vertexArray)
+{
+	glDeleteVertexArrays(1, &vertexArray);
+
+	if (s_vertexArray == vertexArray)
+		s_vertexArray = 0;
+
+	for (auto it = s_vertexArrayVertexBuffers.begin(); it != s_vertexArrayVertexBuffers.end();)
+	{
+		if (static_cast<RendererID>(it->first >> 32) == vertexArray)
+			it = s_vertexArrayVertexBuffers.erase(it);
+		else
+			it++;
+	}
+
+	s_vertexArrayIndexBuffers.erase(vertexArray);
+}
+
+bool GLStateCache::updateUniformBytes(RendererID program, int32_t location, const void* value, size_t size)
+{
+	// Uniforms which aren't active in the program can't be cached
+	if (location == -1)
+		return true;
+
+	UniformValue& cachedValue = s_uniformValues[program][location];
+
+	if (cachedValue.size == size && std::memcmp(cachedValue.data.data(), value, size) == 0)
+	{
+		s_statistics.uniformUploadsElided++;
+		return false;
+	}
+
+	std::memcpy(cachedValue.data.data(), value, size);
+	cachedValue.size = size;
+	s_statistics.uniformUploads++;
+	return true;
+}
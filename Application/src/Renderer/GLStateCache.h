@@ -0,0 +1,111 @@
+#pragma once
+#include "PCH.h"
+
+#include <array>
+
+#include "glad/glad.h"
+
+#include "RendererUtilities.h"
+
+/*
+Shadows the OpenGL state that the renderer changes, so that calls which would not change it can be dropped.
+
+All renderer classes bind programs, vertex arrays, buffers, textures and framebuffers, set the viewport and upload
+uniforms through here. Objects must also be deleted through here, as OpenGL reuses the names of
+deleted objects and a stale entry would otherwise stop a new object with the same name being bound.
+*/
+class GLStateCache
+{
+public:
+
+	struct Statistics
+	{
+		uint32_t programBinds = 0,       programBindsElided = 0;
+		uint32_t bufferBinds = 0,        bufferBindsElided = 0;
+		uint32_t textureBinds = 0,       textureBindsElided = 0;
+		uint32_t framebufferBinds = 0,   framebufferBindsElided = 0;
+		uint32_t viewportChanges = 0,    viewportChangesElided = 0;
+		uint32_t vertexArrayBinds = 0,   vertexArrayBindsElided = 0;
+		uint32_t uniformUploads = 0,     uniformUploadsElided = 0;
+	};
+
+public:
+
+	static void init();
+	static void shutdown();
+
+	static void useProgram(RendererID program);
+
+	// For non-indexed targets (GL_DRAW_INDIRECT_BUFFER, GL_PARAMETER_BUFFER etc.)
+	static void bindBuffer(GLenum target, RendererID buffer);
+	// For indexed targets (GL_SHADER_STORAGE_BUFFER, GL_UNIFORM_BUFFER)
+	static void bindBufferBase(GLenum target, uint32_t index, RendererID buffer);
+
+	static void bindVertexArray(RendererID vertexArray);
+	// Vertex and index buffers are part of a vertex array's state, so are cached per vertex array
+	static void setVertexArrayVertexBuffer(RendererID vertexArray, uint32_t bindingIndex, RendererID buffer, uint32_t stride);
+	// Sets the index buffer of the bound vertex array
+	static void bindIndexBuffer(RendererID buffer);
+
+	static void bindTextureUnit(uint32_t unit, RendererID texture);
+
+	static void bindFramebuffer(RendererID framebuffer);
+	static void setViewport(int32_t x, int32_t y, int32_t width, int32_t height);
+
+	// Records the value of a uniform in a program. Returns whether the value has changed and needs uploading
+	template<typename T>
+	static bool updateUniform(RendererID program, int32_t location, const T& value);
+
+	static void deleteProgram(RendererID program);
+	static void deleteBuffer(RendererID buffer);
+	static void deleteTexture(RendererID texture);
+	static void deleteFramebuffer(RendererID framebuffer);
+	static void deleteVertexArray(RendererID vertexArray);
+
+	static const Statistics& getStatistics() { return s_statistics; }
+	static void resetStatistics() { s_statistics = Statistics(); }
+
+private:
+
+	struct UniformValue
+	{
+		// Large enough for the largest uniform type (glm::mat4)
+		std::array<uint8_t, 64> data;
+		size_t size = 0;
+	};
+
+private:
+
+	static bool updateUniformBytes(RendererID program, int32_t location, const void* value, size_t size);
+
+	static uint64_t getIndexedKey(uint32_t object, uint32_t index) { return (static_cast<uint64_t>(object) << 32) | index; }
+
+private:
+
+	static RendererID s_program;
+
+	static std::unordered_map<GLenum, RendererID> s_buffers;
+	static std::unordered_map<uint64_t, RendererID> s_indexedBuffers;
+
+	static RendererID s_vertexArray;
+	// Keyed by vertex array and binding index, storing the buffer and its stride
+	static std::unordered_map<uint64_t, std::pair<RendererID, uint32_t>> s_vertexArrayVertexBuffers;
+	static std::unordered_map<RendererID, RendererID> s_vertexArrayIndexBuffers;
+
+	static std::vector<RendererID> s_textureUnits;
+
+	static RendererID s_framebuffer;
+	static std::array<int32_t, 4> s_viewport;
+
+	static std::unordered_map<RendererID, std::unordered_map<int32_t, UniformValue>> s_uniformValues;
+
+	static Statistics s_statistics;
+};
+
+template<typename T>
+bool GLStateCache::updateUniform(RendererID program, int32_t location, const T& value)
+{
+	static_assert(std::is_trivially_copyable_v<T> && sizeof(T) <= sizeof(UniformValue::data), "Uniform type cannot be cached");
+
+	return updateUniformBytes(program, location, static_cast<const void*>(&value), sizeof(T));
+}
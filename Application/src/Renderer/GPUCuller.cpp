@@ -0,0 +1,218 @@
+#include "PCH.h"
+#include "GPUCuller.h"
+
+#include "glad/glad.h"
+
+#include "GLStateCache.h"
+
+static constexpr uint32_t PHASE_COUNT = 2;
+
+static constexpr uint32_t INITIAL_DRAW_CAPACITY = 1024;
+static constexpr uint32_t INITIAL_BATCH_CAPACITY = 64;
+
+// Must match local_size in the compute shaders
+static constexpr uint32_t CULLING_WORK_GROUP_SIZE = 64;
+static constexpr uint32_t DEPTH_PYRAMID_WORK_GROUP_SIZE = 8;
+
+GPUCuller::GPUCuller()
+{
+	m_cullingShader = createUnique<Shader>(std::initializer_list<std::string>
+	{
+		"Assets/Shaders/DrawCulling.glsl.comp"
+	});
+
+	m_depthPyramidShader = createUnique<Shader>(std::initializer_list<std::string>
+	{
+		"Assets/Shaders/DepthPyramid.glsl.comp"
+	});
+
+	m_culledCommandBuffer = createUnique<IndirectBuffer>(INITIAL_DRAW_CAPACITY * PHASE_COUNT);
+	m_drawCountBuffer = createUnique<StorageBuffer>(sizeof(uint32_t) * INITIAL_BATCH_CAPACITY * PHASE_COUNT);
+	m_drawCapacity = INITIAL_DRAW_CAPACITY;
+	m_batchCapacity = INITIAL_BATCH_CAPACITY;
+
+	m_lateDrawFlagsBuffer = createUnique<StorageBuffer>(sizeof(uint32_t) * INITIAL_DRAW_CAPACITY);
+	m_cullingStatisticsBuffer = createUnique<StorageBuffer>(sizeof(uint32_t));
+
+	RendererLog::info("GPU culler initialised");
+}
+
+GPUCuller::~GPUCuller()
+{
+	deleteDepthPyramid();
+}
+
+void GPUCuller::cull(const IndirectDrawList& drawList, const glm::mat4& projectionViewMatrix, Phase phase)
+{
+	uint32_t drawCount = drawList.getDrawCount();
+	uint32_t phaseIndex = static_cast<uint32_t>(phase);
+
+	if (phase == Phase::EARLY)
+	{
+		// Buffers are only resized at the start of the frame, as the late phase relies on them being the same size
+		reserve(drawCount, drawList.getBatchCount());
+		m_cullingStatisticsBuffer->clear(0, sizeof(uint32_t));
+	}
+
+	m_drawCountBuffer->clear(sizeof(uint32_t) * m_batchCapacity * phaseIndex, sizeof(uint32_t) * m_batchCapacity);
+
+	if (!drawCount)
+		return;
+
+	drawList.bind();
+	drawList.bindForCulling();
+	m_culledCommandBuffer->bindAsStorageBuffer(CULLED_COMMANDS_BINDING_POINT);
+	m_drawCountBuffer->bind(DRAW_COUNTS_BINDING_POINT);
+	m_lateDrawFlagsBuffer->bind(LATE_DRAW_FLAGS_BINDING_POINT);
+	m_cullingStatisticsBuffer->bind(CULLING_STATISTICS_BINDING_POINT);
+
+	m_cullingShader->bind();
+
+	m_cullingShader->setUniformToValue("u_phase", phaseIndex);
+	m_cullingShader->setUniformToValue("u_drawCount", drawCount);
+	m_cullingShader->setUniformToValue("u_culledCommandOffset", m_drawCapacity * phaseIndex);
+	m_cullingShader->setUniformToValue("u_drawCountOffset", m_batchCapacity * phaseIndex);
+	m_cullingShader->setUniformToValue("u_projectionViewMatrix", projectionViewMatrix);
+
+	// On the first frame there is no depth pyramid, so the early phase can only cull against the frustum
+	m_cullingShader->setUniformToValue("u_occlusionCullingEnabled", m_depthPyramidValid);
+	m_cullingShader->setUniformToValue("u_depthPyramidProjectionViewMatrix", m_depthPyramidProjectionViewMatrix);
+
+	if (m_depthPyramidValid)
+		GLStateCache::bindTextureUnit(0, m_depthPyramidRendererID);
+	m_cullingShader->setUniformToValue("u_depthPyramid", 0);
+
+	RendererUtilities::dispatchCompute((drawCount + CULLING_WORK_GROUP_SIZE - 1) / CULLING_WORK_GROUP_SIZE);
+
+	// The culled commands and draw counts are read by the indirect draws, and the late draw flags by the late phase
+	glMemoryBarrier(GL_COMMAND_BARRIER_BIT | GL_SHADER_STORAGE_BARRIER_BIT);
+
+	RendererLog::trace("Culled {0} draws on the GPU ({1} phase)", drawCount, phase == Phase::EARLY ? "early" : "late");
+}
+
+void GPUCuller::buildDepthPyramid(const Framebuffer& framebuffer, const glm::mat4& projectionViewMatrix)
+{
+	const Framebuffer::FramebufferSpecification& framebufferSpecification = framebuffer.getSpecification();
+
+	if (framebufferSpecification.width != m_depthPyramidWidth || framebufferSpecification.height != m_depthPyramidHeight)
+		createDepthPyramid(framebufferSpecification.width, framebufferSpecification.height);
+
+	m_depthPyramidShader->bind();
+
+	// Level 0 is built from the depth attachment, which may be multisampled. The pyramid keeps the allocated size of
+	// the framebuffer, so that it isn't recreated as the render size changes
+
+	bool multisampled = framebufferSpecification.samples > 1;
+	framebuffer.bindDepthAttachment(multisampled ? 1 : 0);
+
+	m_depthPyramidShader->setUniformToValue("u_sourceSize", glm::uvec2(framebuffer.getRenderWidth(), framebuffer.getRenderHeight()));
+	m_depthPyramidShader->setUniformToValue("u_multisampled", multisampled);
+	m_depthPyramidShader->setUniformToValue("u_sampleCount", framebufferSpecification.samples);
+	m_depthPyramidShader->setUniformToValue("u_depthTexture", 0);
+	m_depthPyramidShader->setUniformToValue("u_multisampleDepthTexture", 1);
+
+	for (uint32_t level = 0; level < m_depthPyramidLevelCount; level++)
+	{
+		uint32_t levelWidth = std::max(m_depthPyramidWidth >> level, 1u);
+		uint32_t levelHeight = std::max(m_depthPyramidHeight >> level, 1u);
+
+		// Every other level is built from the level before it
+		if (level > 0)
+			glBindImageTexture(0, m_depthPyramidRendererID, level - 1, GL_FALSE, 0, GL_READ_ONLY, GL_R32F);
+		glBindImageTexture(1, m_depthPyramidRendererID, level, GL_FALSE, 0, GL_WRITE_ONLY, GL_R32F);
+
+		m_depthPyramidShader->setUniformToValue("u_level", level);
+		m_depthPyramidShader->setUniformToValue("u_destinationSize", glm::uvec2(levelWidth, levelHeight));
+
+		RendererUtilities::dispatchCompute(
+			(levelWidth + DEPTH_PYRAMID_WORK_GROUP_SIZE - 1) / DEPTH_PYRAMID_WORK_GROUP_SIZE,
+			(levelHeight + DEPTH_PYRAMID_WORK_GROUP_SIZE - 1) / DEPTH_PYRAMID_WORK_GROUP_SIZE
+		);
+
+		glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+	}
+
+	// The pyramid is sampled by the culling shader
+	glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT);
+
+	m_depthPyramidValid = true;
+	m_depthPyramidProjectionViewMatrix = projectionViewMatrix;
+
+	RendererLog::trace("Built {0} level depth pyramid {1}", m_depthPyramidLevelCount, m_depthPyramidRendererID);
+}
+
+void GPUCuller::bind() const
+{
+	m_culledCommandBuffer->bind();
+	m_drawCountBuffer->bindAsParameterBuffer();
+}
+
+const void* GPUCuller::getCommandOffset(Phase phase, const IndirectDrawList::Batch& batch) const
+{
+	uint64_t commandIndex = static_cast<uint64_t>(m_drawCapacity) * static_cast<uint64_t>(phase) + batch.firstDraw;
+	return reinterpret_cast<const void*>(static_cast<uint64_t>(sizeof(DrawElementsIndirectCommand)) * commandIndex);
+}
+
+const void* GPUCuller::getDrawCountOffset(Phase phase, uint32_t batchIndex) const
+{
+	uint64_t drawCountIndex = static_cast<uint64_t>(m_batchCapacity) * static_cast<uint64_t>(phase) + batchIndex;
+	return reinterpret_cast<const void*>(static_cast<uint64_t>(sizeof(uint32_t)) * drawCountIndex);
+}
+
+uint32_t GPUCuller::readBackVisibleDrawCount() const
+{
+	uint32_t visibleDrawCount = 0;
+	m_cullingStatisticsBuffer->getData(static_cast<void*>(&visibleDrawCount), sizeof(uint32_t));
+
+	return visibleDrawCount;
+}
+
+void GPUCuller::reserve(uint32_t drawCount, uint32_t batchCount)
+{
+	if (drawCount > m_drawCapacity)
+	{
+		m_drawCapacity = std::max(drawCount, m_drawCapacity * 2);
+		m_culledCommandBuffer->reserve(m_drawCapacity * PHASE_COUNT);
+		m_lateDrawFlagsBuffer->reserve(sizeof(uint32_t) * m_drawCapacity);
+	}
+
+	if (batchCount > m_batchCapacity)
+	{
+		m_batchCapacity = std::max(batchCount, m_batchCapacity * 2);
+		m_drawCountBuffer->reserve(sizeof(uint32_t) * m_batchCapacity * PHASE_COUNT);
+	}
+}
+
+void GPUCuller::createDepthPyramid(uint32_t width, uint32_t height)
+{
+	deleteDepthPyramid();
+
+	// Level 0 is the same size as the depth attachment, so that no depth information is lost before the first reduction
+	m_depthPyramidWidth = width;
+	m_depthPyramidHeight = height;
+	m_depthPyramidLevelCount = static_cast<uint32_t>(std::floor(std::log2(static_cast<float>(std::max(width, height))))) + 1;
+
+	glCreateTextures(GL_TEXTURE_2D, 1, &m_depthPyramidRendererID);
+	glTextureStorage2D(m_depthPyramidRendererID, m_depthPyramidLevelCount, GL_R32F, width, height);
+	glTextureParameteri(m_depthPyramidRendererID, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_NEAREST);
+	glTextureParameteri(m_depthPyramidRendererID, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	glTextureParameteri(m_depthPyramidRendererID, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTextureParameteri(m_depthPyramidRendererID, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+	// The new pyramid has no contents until it is built
+	m_depthPyramidValid = false;
+
+	RendererLog::info("Created depth pyramid {0} with size ({1}, {2}) and {3} levels", m_depthPyramidRendererID, width, height, m_depthPyramidLevelCount);
+}
+
+void GPUCuller::deleteDepthPyramid()
+{
+	if (!m_depthPyramidRendererID)
+		return;
+
+	GLStateCache::deleteTexture(m_depthPyramidRendererID);
+
+	RendererLog::info("Deleted depth pyramid {0}", m_depthPyramidRendererID);
+
+	m_depthPyramidRendererID = 0;
+}
@@ -0,0 +1,88 @@
+#pragma once
+#include "PCH.h"
+
+#include "glm/glm.hpp"
+
+#include "Shader.h"
+#include "Framebuffer.h"
+#include "IndirectBuffer.h"
+#include "StorageBuffer.h"
+#include "IndirectDrawList.h"
+
+/*
+Culls the draws of an IndirectDrawList on the GPU, against the view frustum and a hierarchical depth (Hi-Z) pyramid.
+
+Culling happens in two phases each frame:
+	EARLY - Draws are tested against the depth pyramid built during the previous frame. The survivors are
+	        drawn, and the depth they produce is used to build a new pyramid.
+	LATE  - Draws the early phase found to be occluded are tested again against the new pyramid, and drawn if visible.
+Anything which comes into view is therefore drawn in the frame it becomes visible, rather than popping in a frame late.
+
+Surviving draws are appended to their batch's range of an output indirect buffer, with the number of draws
+in each range written to a parameter buffer to be consumed by glMultiDrawElementsIndirectCount.
+*/
+class GPUCuller
+{
+public:
+
+	enum class Phase
+	{
+		EARLY = 0,
+		LATE
+	};
+
+	static constexpr uint32_t CULLED_COMMANDS_BINDING_POINT = 3;
+	static constexpr uint32_t DRAW_COUNTS_BINDING_POINT = 4;
+	static constexpr uint32_t LATE_DRAW_FLAGS_BINDING_POINT = 5;
+	static constexpr uint32_t CULLING_STATISTICS_BINDING_POINT = 6;
+
+public:
+
+	GPUCuller();
+	~GPUCuller();
+	GPUCuller(const GPUCuller&) = delete;
+
+	// The draw list must have been uploaded before it is culled
+	void cull(const IndirectDrawList& drawList, const glm::mat4& projectionViewMatrix, Phase phase);
+
+	// Builds the depth pyramid from the depth attachment of the framebuffer, as seen by projectionViewMatrix
+	void buildDepthPyramid(const Framebuffer& framebuffer, const glm::mat4& projectionViewMatrix);
+
+	// Binds the culled commands and the draw counts, ready for drawing
+	void bind() const;
+
+	const void* getCommandOffset(Phase phase, const IndirectDrawList::Batch& batch) const;
+	const void* getDrawCountOffset(Phase phase, uint32_t batchIndex) const;
+
+	// Number of draws which survived both phases of culling this frame
+	// This is for debugging - it stalls until culling has finished on the GPU
+	uint32_t readBackVisibleDrawCount() const;
+
+private:
+
+	void reserve(uint32_t drawCount, uint32_t batchCount);
+
+	void createDepthPyramid(uint32_t width, uint32_t height);
+	void deleteDepthPyramid();
+
+private:
+
+	Unique<Shader> m_cullingShader;
+	Unique<Shader> m_depthPyramidShader;
+
+	// Each phase has its own region of these buffers, so the early draws aren't overwritten before they have been drawn
+	Unique<IndirectBuffer> m_culledCommandBuffer;
+	Unique<StorageBuffer> m_drawCountBuffer;
+	uint32_t m_drawCapacity = 0;
+	uint32_t m_batchCapacity = 0;
+
+	Unique<StorageBuffer> m_lateDrawFlagsBuffer;
+	Unique<StorageBuffer> m_cullingStatisticsBuffer;
+
+	RendererID m_depthPyramidRendererID = 0;
+	uint32_t m_depthPyramidWidth = 0, m_depthPyramidHeight = 0;
+	uint32_t m_depthPyramidLevelCount = 0;
+	// The pyramid is only valid once it has been built, and occlusion culling must use the matrix it was built with
+	bool m_depthPyramidValid = false;
+	glm::mat4 m_depthPyramidProjectionViewMatrix = glm::mat4(1.0f);
+};
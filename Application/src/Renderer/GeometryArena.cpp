@@ -0,0 +1,114 @@
+#include "PCH.h"
+#include "GeometryArena.h"
+
+Unique<VertexBuffer> GeometryArena::s_vertexBuffer;
+Unique<VertexBuffer> GeometryArena::s_positionVertexBuffer;
+Unique<IndexBuffer> GeometryArena::s_indexBuffer;
+Unique<BufferSubAllocator> GeometryArena::s_vertexAllocator;
+Unique<BufferSubAllocator> GeometryArena::s_indexAllocator;
+uint32_t GeometryArena::s_vertexStride = 0;
+
+void GeometryArena::init(const VertexBufferLayout& vertexBufferLayout, const VertexBufferLayout& positionVertexBufferLayout)
+{
+	ASSERT_MESSAGE(positionVertexBufferLayout.getStride() == sizeof(glm::vec3), "Position vertex buffer layout must only contain a position");
+
+	s_vertexStride = vertexBufferLayout.getStride();
+
+	s_vertexBuffer = createUnique<VertexBuffer>(static_cast<size_t>(INITIAL_VERTEX_CAPACITY) * s_vertexStride, vertexBufferLayout);
+	s_positionVertexBuffer = createUnique<VertexBuffer>(static_cast<size_t>(INITIAL_VERTEX_CAPACITY) * sizeof(glm::vec3), positionVertexBufferLayout);
+	s_indexBuffer = createUnique<IndexBuffer>(INITIAL_INDEX_CAPACITY);
+
+	s_vertexAllocator = createUnique<BufferSubAllocator>(INITIAL_VERTEX_CAPACITY);
+	s_indexAllocator = createUnique<BufferSubAllocator>(INITIAL_INDEX_CAPACITY);
+
+	RendererLog::info("Geometry arena initialised");
+}
+
+void GeometryArena::shutdown()
+{
+	s_vertexBuffer.reset();
+	s_positionVertexBuffer.reset();
+	s_indexBuffer.reset();
+	s_vertexAllocator.reset();
+	s_indexAllocator.reset();
+}
+
+GeometryArena::Allocation GeometryArena::allocate(const void* vertices, const glm::vec3* positions, uint32_t vertexCount, const uint32_t* indices, uint32_t indexCount)
+{
+	ASSERT_MESSAGE(isInitialised(), "Geometry arena must be initialised before geometry can be uploaded");
+
+	Allocation allocation;
+	allocation.vertexCount = vertexCount;
+	allocation.indexCount = indexCount;
+	allocation.baseVertex = allocateVertices(vertexCount);
+	allocation.firstIndex = allocateIndices(indexCount);
+
+	s_vertexBuffer->setData(vertices, static_cast<size_t>(vertexCount) * s_vertexStride, static_cast<size_t>(allocation.baseVertex) * s_vertexStride);
+	s_positionVertexBuffer->setData(static_cast<const void*>(positions), static_cast<size_t>(vertexCount) * sizeof(glm::vec3), static_cast<size_t>(allocation.baseVertex) * sizeof(glm::vec3));
+	s_indexBuffer->setData(indices, indexCount, allocation.firstIndex);
+
+	RendererLog::trace("Allocated {0} vertices at {1} and {2} indices at {3} in the geometry arena", vertexCount, allocation.baseVertex, indexCount, allocation.firstIndex);
+
+	return allocation;
+}
+
+void GeometryArena::free(Allocation& allocation)
+{
+	if (!allocation.isValid() || !isInitialised())
+		return;
+
+	s_vertexAllocator->free(allocation.baseVertex, allocation.vertexCount);
+	s_indexAllocator->free(allocation.firstIndex, allocation.indexCount);
+
+	RendererLog::trace("Freed {0} vertices at {1} and {2} indices at {3} in the geometry arena", allocation.vertexCount, allocation.baseVertex, allocation.indexCount, allocation.firstIndex);
+
+	allocation = Allocation();
+}
+
+void GeometryArena::bind()
+{
+	s_vertexBuffer->bind();
+	s_indexBuffer->bind();
+}
+
+void GeometryArena::bindPositions()
+{
+	// The position stream has its own vertex array, which needs the index buffer attaching too
+	s_positionVertexBuffer->bind();
+	s_indexBuffer->bind();
+}
+
+uint32_t GeometryArena::allocateVertices(uint32_t vertexCount)
+{
+	uint32_t baseVertex = s_vertexAllocator->allocate(vertexCount);
+
+	if (baseVertex == BufferSubAllocator::INVALID_OFFSET)
+	{
+		// Not enough contiguous space - at least double the capacity, so that the copy cost is amortised
+
+		uint32_t newCapacity = std::max(s_vertexAllocator->getCapacity() * 2, s_vertexAllocator->getCapacity() + vertexCount);
+		s_vertexBuffer->resize(static_cast<size_t>(newCapacity) * s_vertexStride);
+		s_positionVertexBuffer->resize(static_cast<size_t>(newCapacity) * sizeof(glm::vec3));
+		s_vertexAllocator->grow(newCapacity);
+
+		baseVertex = s_vertexAllocator->allocate(vertexCount);
+	}
+
+	return baseVertex;
+}
+
+uint32_t GeometryArena::allocateIndices(uint32_t indexCount)
+{
+	uint32_t firstIndex = s_indexAllocator->allocate(indexCount);
+
+	if (firstIndex == BufferSubAllocator::INVALID_OFFSET)
+	{
+		uint32_t newCapacity = std::max(s_indexAllocator->getCapacity() * 2, s_indexAllocator->getCapacity() + indexCount);
+		s_indexBuffer->resize(newCapacity);
+		s_indexAllocator->grow(newCapacity);
+
+		firstIndex = s_indexAllocator->allocate(indexCount);
+	}
+
+	return firstIndex;
+}
@@ -0,0 +1,72 @@
+#pragma once
+#include "PCH.h"
+
+#include "glm/glm.hpp"
+
+#include "VertexBuffer.h"
+#include "IndexBuffer.h"
+#include "BufferSubAllocator.h"
+
+/*
+Scene-wide vertex and index buffers that the geometry of every model is uploaded into.
+
+Because all models share the same buffers, they only need to be bound once per frame and
+draws for any number of models can be submitted together with glMultiDrawElementsIndirect.
+The buffers grow (preserving their contents) when an allocation doesn't fit.
+
+Vertex positions are also kept in a separate position-only stream, at the same vertex offsets, so that
+depth-only passes fetch just the positions rather than whole vertices.
+*/
+class GeometryArena
+{
+public:
+
+	struct Allocation
+	{
+		uint32_t baseVertex = BufferSubAllocator::INVALID_OFFSET;
+		uint32_t vertexCount = 0;
+		uint32_t firstIndex = BufferSubAllocator::INVALID_OFFSET;
+		uint32_t indexCount = 0;
+
+		bool isValid() const { return baseVertex != BufferSubAllocator::INVALID_OFFSET; }
+	};
+
+	static constexpr uint32_t INITIAL_VERTEX_CAPACITY = 1 << 18;
+	static constexpr uint32_t INITIAL_INDEX_CAPACITY = 1 << 20;
+
+public:
+
+	// The position layout must be a single FLOAT3 attribute
+	static void init(const VertexBufferLayout& vertexBufferLayout, const VertexBufferLayout& positionVertexBufferLayout);
+	static void shutdown();
+
+	static bool isInitialised() { return s_vertexBuffer != nullptr; }
+
+	// Indices are relative to the start of the uploaded vertices - offset them using Allocation::baseVertex when drawing.
+	// The positions are the same vertices' positions, for the position-only stream
+	static Allocation allocate(const void* vertices, const glm::vec3* positions, uint32_t vertexCount, const uint32_t* indices, uint32_t indexCount);
+	static void free(Allocation& allocation);
+
+	static void bind();
+	// Binds the position-only stream in place of the full vertices, for depth-only passes
+	static void bindPositions();
+
+	static uint32_t getVertexCapacity() { return s_vertexAllocator->getCapacity(); }
+	static uint32_t getIndexCapacity() { return s_indexAllocator->getCapacity(); }
+
+private:
+
+	static uint32_t allocateVertices(uint32_t vertexCount);
+	static uint32_t allocateIndices(uint32_t indexCount);
+
+private:
+
+	static Unique<VertexBuffer> s_vertexBuffer;
+	static Unique<VertexBuffer> s_positionVertexBuffer;
+	static Unique<IndexBuffer> s_indexBuffer;
+
+	static Unique<BufferSubAllocator> s_vertexAllocator;
+	static Unique<BufferSubAllocator> s_indexAllocator;
+
+	static uint32_t s_vertexStride;
+};
@@ -0,0 +1,172 @@
+#include "PCH.h"
+#include "ImageBasedLighting.h"
+
+#include "glad/glad.h"
+
+#include "GLStateCache.h"
+
+static constexpr uint32_t BRDF_LOOK_UP_TABLE_SAMPLE_COUNT = 1024;
+static constexpr uint32_t WORK_GROUP_SIZE = 8;
+
+// Half float RG
+static constexpr uint32_t BRDF_LOOK_UP_TABLE_BYTES_PER_TEXEL = 4;
+
+static constexpr uint32_t CACHE_MAGIC = 0x54554C42; // "BLUT"
+// Increase when the cache's layout, or how its contents are computed, changes
+static constexpr uint32_t CACHE_VERSION = 1;
+
+struct BRDFLookUpTableCacheHeader
+{
+	uint32_t magic;
+	uint32_t version;
+	uint32_t size;
+	uint32_t sampleCount;
+};
+
+// The names of the elements of the irradiance coefficient array uniform, which are set one at a time
+static const std::array<std::string, EnvironmentMap::IRRADIANCE_COEFFICIENT_COUNT> IRRADIANCE_COEFFICIENT_UNIFORMS = []()
+{
+	std::array<std::string, EnvironmentMap::IRRADIANCE_COEFFICIENT_COUNT> uniforms;
+	for (uint32_t i = 0; i < EnvironmentMap::IRRADIANCE_COEFFICIENT_COUNT; i++)
+		uniforms[i] = "u_irradianceCoefficients[" + std::to_string(i) + "]";
+
+	return uniforms;
+}();
+
+ImageBasedLighting::ImageBasedLighting()
+{
+	glCreateTextures(GL_TEXTURE_2D, 1, &m_BRDFLookUpTableRendererID);
+	glTextureStorage2D(m_BRDFLookUpTableRendererID, 1, GL_RG16F, BRDF_LOOK_UP_TABLE_SIZE, BRDF_LOOK_UP_TABLE_SIZE);
+
+	glTextureParameteri(m_BRDFLookUpTableRendererID, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTextureParameteri(m_BRDFLookUpTableRendererID, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTextureParameteri(m_BRDFLookUpTableRendererID, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTextureParameteri(m_BRDFLookUpTableRendererID, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+	std::filesystem::path cachePath = std::filesystem::path(EnvironmentMap::CACHE_DIRECTORY) / "BRDFLookUpTable.bin";
+
+	if (loadBRDFLookUpTableFromCache(cachePath))
+	{
+		AssetLog::info("Loaded BRDF look up table from {0}", cachePath.string());
+		return;
+	}
+
+	calculateBRDFLookUpTable();
+	saveBRDFLookUpTableToCache(cachePath);
+
+	AssetLog::info("Calculated BRDF look up table and cached it in {0}", cachePath.string());
+}
+
+ImageBasedLighting::~ImageBasedLighting()
+{
+	GLStateCache::deleteTexture(m_BRDFLookUpTableRendererID);
+}
+
+void ImageBasedLighting::setEnvironmentMap(const Reference<EnvironmentMap>& environmentMap, float intensity)
+{
+	m_environmentMap = environmentMap;
+	m_intensity = intensity;
+}
+
+void ImageBasedLighting::bind(Shader& shader) const
+{
+	// Samplers of different types can't share a texture slot, so the slots are set even without an environment map
+
+	shader.setUniformToValue("u_prefilteredEnvironmentMap", static_cast<int32_t>(PREFILTERED_MAP_TEXTURE_SLOT));
+	shader.setUniformToValue("u_BRDFLookUpTable", static_cast<int32_t>(BRDF_LOOK_UP_TABLE_TEXTURE_SLOT));
+	shader.setUniformToValue("u_imageBasedLightingEnabled", static_cast<bool>(m_environmentMap));
+
+	if (!m_environmentMap)
+		return;
+
+	m_environmentMap->bindPrefilteredMap(PREFILTERED_MAP_TEXTURE_SLOT);
+	GLStateCache::bindTextureUnit(BRDF_LOOK_UP_TABLE_TEXTURE_SLOT, m_BRDFLookUpTableRendererID);
+
+	const auto& irradianceCoefficients = m_environmentMap->getIrradianceCoefficients();
+	for (uint32_t i = 0; i < EnvironmentMap::IRRADIANCE_COEFFICIENT_COUNT; i++)
+		shader.setUniformToValue(IRRADIANCE_COEFFICIENT_UNIFORMS[i], irradianceCoefficients[i]);
+
+	shader.setUniformToValue("u_prefilteredMipCount", EnvironmentMap::PREFILTERED_MAP_MIP_COUNT);
+	shader.setUniformToValue("u_environmentIntensity", m_intensity);
+}
+
+uint64_t ImageBasedLighting::getMemoryUsage() const
+{
+	uint64_t memoryUsage = static_cast<uint64_t>(BRDF_LOOK_UP_TABLE_SIZE) * BRDF_LOOK_UP_TABLE_SIZE * BRDF_LOOK_UP_TABLE_BYTES_PER_TEXEL;
+
+	if (m_environmentMap)
+		memoryUsage += m_environmentMap->getMemoryUsage();
+
+	return memoryUsage;
+}
+
+bool ImageBasedLighting::loadBRDFLookUpTableFromCache(const std::filesystem::path& cachePath)
+{
+	std::ifstream inputFileStream(cachePath, std::ios::binary);
+	if (!inputFileStream)
+		return false;
+
+	BRDFLookUpTableCacheHeader header;
+	inputFileStream.read(reinterpret_cast<char*>(&header), sizeof(header));
+
+	if (!inputFileStream || header.magic != CACHE_MAGIC || header.version != CACHE_VERSION ||
+		header.size != BRDF_LOOK_UP_TABLE_SIZE || header.sampleCount != BRDF_LOOK_UP_TABLE_SAMPLE_COUNT)
+		return false;
+
+	std::vector<uint8_t> lookUpTableData(static_cast<size_t>(BRDF_LOOK_UP_TABLE_SIZE) * BRDF_LOOK_UP_TABLE_SIZE * BRDF_LOOK_UP_TABLE_BYTES_PER_TEXEL);
+	inputFileStream.read(reinterpret_cast<char*>(lookUpTableData.data()), lookUpTableData.size());
+
+	if (!inputFileStream)
+		return false;
+
+	glTextureSubImage2D(m_BRDFLookUpTableRendererID, 0, 0, 0, BRDF_LOOK_UP_TABLE_SIZE, BRDF_LOOK_UP_TABLE_SIZE, GL_RG, GL_HALF_FLOAT, lookUpTableData.data());
+
+	return true;
+}
+
+void ImageBasedLighting::saveBRDFLookUpTableToCache(const std::filesystem::path& cachePath) const
+{
+	std::error_code errorCode;
+	std::filesystem::create_directories(cachePath.parent_path(), errorCode);
+
+	std::filesystem::path temporaryCachePath = EnvironmentMap::getTemporaryCachePath(cachePath);
+
+	std::ofstream outputFileStream(temporaryCachePath, std::ios::binary | std::ios::trunc);
+	if (!outputFileStream)
+	{
+		AssetLog::warn("Could not write to {0}, so the BRDF look up table will be calculated again next time", cachePath.string());
+		return;
+	}
+
+	BRDFLookUpTableCacheHeader header;
+	header.magic = CACHE_MAGIC;
+	header.version = CACHE_VERSION;
+	header.size = BRDF_LOOK_UP_TABLE_SIZE;
+	header.sampleCount = BRDF_LOOK_UP_TABLE_SAMPLE_COUNT;
+
+	std::vector<uint8_t> lookUpTableData(static_cast<size_t>(BRDF_LOOK_UP_TABLE_SIZE) * BRDF_LOOK_UP_TABLE_SIZE * BRDF_LOOK_UP_TABLE_BYTES_PER_TEXEL);
+	glGetTextureImage(m_BRDFLookUpTableRendererID, 0, GL_RG, GL_HALF_FLOAT, static_cast<GLsizei>(lookUpTableData.size()), lookUpTableData.data());
+
+	outputFileStream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	outputFileStream.write(reinterpret_cast<const char*>(lookUpTableData.data()), lookUpTableData.size());
+
+	outputFileStream.close();
+	EnvironmentMap::commitTemporaryCacheFile(temporaryCachePath, cachePath);
+}
+
+void ImageBasedLighting::calculateBRDFLookUpTable()
+{
+	Shader lookUpTableShader({ "Assets/Shaders/BRDFLookUpTable.glsl.comp" });
+	lookUpTableShader.bind();
+
+	lookUpTableShader.setUniformToValue("u_size", BRDF_LOOK_UP_TABLE_SIZE);
+	lookUpTableShader.setUniformToValue("u_sampleCount", BRDF_LOOK_UP_TABLE_SAMPLE_COUNT);
+
+	glBindImageTexture(0, m_BRDFLookUpTableRendererID, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RG16F);
+
+	uint32_t groupCount = (BRDF_LOOK_UP_TABLE_SIZE + WORK_GROUP_SIZE - 1) / WORK_GROUP_SIZE;
+	RendererUtilities::dispatchCompute(groupCount, groupCount);
+
+	// The table is read back next, to be cached, and then sampled
+	glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT | GL_TEXTURE_UPDATE_BARRIER_BIT);
+}
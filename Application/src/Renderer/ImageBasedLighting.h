@@ -0,0 +1,55 @@
+#pragma once
+#include "PCH.h"
+
+#include "EnvironmentMap.h"
+#include "Shader.h"
+
+/*
+Lights PBR scenes with their EnvironmentMap, in a handful of fetches per pixel:
+	- Diffuse lighting evaluates the environment's irradiance spherical harmonic at the normal
+	- Specular lighting uses Karis's split sum approximation. The prefiltered environment is read at the reflection
+	  direction from the mip matching the roughness, and is scaled by a look up table of the BRDF's integral
+	  (indexed by n.v and roughness, with Fresnel factored out)
+
+The BRDF look up table is the same for every environment, so it is owned here rather than by each environment map.
+It is cached in EnvironmentMap::CACHE_DIRECTORY as well.
+
+Without an environment map, the lighting shaders fall back to a constant ambient term.
+*/
+class ImageBasedLighting
+{
+public:
+
+	static constexpr uint32_t PREFILTERED_MAP_TEXTURE_SLOT = 4;
+	static constexpr uint32_t BRDF_LOOK_UP_TABLE_TEXTURE_SLOT = 5;
+
+	static constexpr uint32_t BRDF_LOOK_UP_TABLE_SIZE = 128;
+
+public:
+
+	ImageBasedLighting();
+	~ImageBasedLighting();
+	ImageBasedLighting(const ImageBasedLighting&) = delete;
+
+	// The intensity scales the environment's radiance, to balance it against the scene's point lights
+	void setEnvironmentMap(const Reference<EnvironmentMap>& environmentMap, float intensity = 1.0f);
+
+	// Binds the environment map and the BRDF look up table, and sets the shader's image based lighting uniforms
+	void bind(Shader& shader) const;
+
+	// Bytes used by the BRDF look up table and the environment map
+	uint64_t getMemoryUsage() const;
+
+private:
+
+	bool loadBRDFLookUpTableFromCache(const std::filesystem::path& cachePath);
+	void saveBRDFLookUpTableToCache(const std::filesystem::path& cachePath) const;
+	void calculateBRDFLookUpTable();
+
+private:
+
+	RendererID m_BRDFLookUpTableRendererID = 0;
+
+	Reference<EnvironmentMap> m_environmentMap;
+	float m_intensity = 1.0f;
+};
@@ -0,0 +1,276 @@
+#include "PCH.h"
+#include "ImageWriter.h"
+
+#include <array>
+#include <cstring>
+
+#include "zlib.h"
+#include "glm/gtc/packing.hpp"
+
+// Bytes are appended one at a time, so the files are the same on big and little endian machines
+
+static void appendBigEndian(std::vector<uint8_t>& bytes, uint32_t value)
+{
+	for (int32_t shift = 24; shift >= 0; shift -= 8)
+		bytes.push_back(static_cast<uint8_t>(value >> shift));
+}
+
+template<typename T>
+static void appendLittleEndian(std::vector<uint8_t>& bytes, T value)
+{
+	uint64_t bits = 0;
+	std::memcpy(&bits, &value, sizeof(T));
+
+	for (uint32_t i = 0; i < sizeof(T); i++)
+		bytes.push_back(static_cast<uint8_t>(bits >> (i * 8)));
+}
+
+static void appendString(std::vector<uint8_t>& bytes, const std::string& string)
+{
+	// Including the null terminator
+	bytes.insert(bytes.end(), string.c_str(), string.c_str() + string.size() + 1);
+}
+
+static void writeFile(const std::filesystem::path& filePath, const std::vector<uint8_t>& bytes)
+{
+	std::ofstream outputFileStream(filePath, std::ios::binary | std::ios::trunc);
+	outputFileStream.write(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+
+	if (!outputFileStream)
+		throw ImageWriter::ImageWriteException("Failed to write " + filePath.string());
+}
+
+// PNG
+
+static void appendPNGChunk(std::vector<uint8_t>& bytes, const char* type, const std::vector<uint8_t>& data)
+{
+	appendBigEndian(bytes, static_cast<uint32_t>(data.size()));
+
+	size_t typeOffset = bytes.size();
+	bytes.insert(bytes.end(), type, type + 4);
+	bytes.insert(bytes.end(), data.begin(), data.end());
+
+	// The CRC covers the type and the data, but not the length
+	uLong crc = crc32(0, bytes.data() + typeOffset, static_cast<uInt>(bytes.size() - typeOffset));
+	appendBigEndian(bytes, static_cast<uint32_t>(crc));
+}
+
+void ImageWriter::writePNG(const std::filesystem::path& filePath, uint32_t width, uint32_t height, const uint8_t* pixels)
+{
+	// Every row starts with its filter type, which is always none. The rows are flipped, as PNGs start at the top
+
+	size_t rowSize = 1 + static_cast<size_t>(width) * 3;
+	std::vector<uint8_t> rows(rowSize * height);
+
+	for (uint32_t y = 0; y < height; y++)
+	{
+		const uint8_t* sourceRow = pixels + static_cast<size_t>(height - 1 - y) * width * 4;
+		uint8_t* row = rows.data() + y * rowSize;
+
+		row[0] = 0;
+		for (uint32_t x = 0; x < width; x++)
+			std::memcpy(row + 1 + x * 3, sourceRow + x * 4, 3);
+	}
+
+	uLongf compressedSize = compressBound(static_cast<uLong>(rows.size()));
+	std::vector<uint8_t> compressedRows(compressedSize);
+
+	// The fastest level, as frames are written while rendering and compress well anyway
+	if (compress2(compressedRows.data(), &compressedSize, rows.data(), static_cast<uLong>(rows.size()), Z_BEST_SPEED) != Z_OK)
+		throw ImageWriteException("Failed to compress " + filePath.string());
+
+	compressedRows.resize(compressedSize);
+
+	std::vector<uint8_t> header;
+	appendBigEndian(header, width);
+	appendBigEndian(header, height);
+	header.push_back(8); // Bit depth
+	header.push_back(2); // RGB
+	header.push_back(0); // Deflate
+	header.push_back(0); // Adaptive filtering
+	header.push_back(0); // Not interlaced
+
+	static const uint8_t PNG_SIGNATURE[] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+
+	std::vector<uint8_t> bytes(std::begin(PNG_SIGNATURE), std::end(PNG_SIGNATURE));
+	appendPNGChunk(bytes, "IHDR", header);
+	appendPNGChunk(bytes, "IDAT", compressedRows);
+	appendPNGChunk(bytes, "IEND", {});
+
+	writeFile(filePath, bytes);
+}
+
+// EXR
+
+static void appendEXRAttribute(std::vector<uint8_t>& bytes, const std::string& name, const std::string& type, const std::vector<uint8_t>& value)
+{
+	appendString(bytes, name);
+	appendString(bytes, type);
+	appendLittleEndian(bytes, static_cast<int32_t>(value.size()));
+	bytes.insert(bytes.end(), value.begin(), value.end());
+}
+
+void ImageWriter::writeEXR(const std::filesystem::path& filePath, uint32_t width, uint32_t height, const float* pixels, uint32_t channelCount)
+{
+	ASSERT_MESSAGE(channelCount == 4 || channelCount == 1, "OpenEXR images are written from RGBA or single channel pixels");
+
+	static constexpr uint32_t EXR_MAGIC = 20000630;
+	static constexpr uint32_t EXR_VERSION = 2;
+	static constexpr int32_t EXR_PIXEL_TYPE_HALF = 1;
+
+	// Channels are stored in alphabetical order, so are the reverse of the RGBA pixels
+	struct Channel
+	{
+		const char* name;
+		uint32_t pixelOffset;
+	};
+
+	static const std::vector<Channel> RGB_CHANNELS = { { "B", 2 }, { "G", 1 }, { "R", 0 } };
+	static const std::vector<Channel> DEPTH_CHANNELS = { { "Z", 0 } };
+	const std::vector<Channel>& imageChannels = channelCount == 1 ? DEPTH_CHANNELS : RGB_CHANNELS;
+
+	std::vector<uint8_t> bytes;
+	appendLittleEndian(bytes, EXR_MAGIC);
+	appendLittleEndian(bytes, EXR_VERSION);
+
+	std::vector<uint8_t> channels;
+	for (const Channel& channel : imageChannels)
+	{
+		appendString(channels, channel.name);
+		appendLittleEndian(channels, EXR_PIXEL_TYPE_HALF);
+		appendLittleEndian(channels, static_cast<uint32_t>(0)); // Not perceptually linear, and reserved bytes
+		appendLittleEndian(channels, static_cast<int32_t>(1)); // x sampling
+		appendLittleEndian(channels, static_cast<int32_t>(1)); // y sampling
+	}
+	channels.push_back(0);
+
+	std::vector<uint8_t> window;
+	appendLittleEndian(window, static_cast<int32_t>(0));
+	appendLittleEndian(window, static_cast<int32_t>(0));
+	appendLittleEndian(window, static_cast<int32_t>(width - 1));
+	appendLittleEndian(window, static_cast<int32_t>(height - 1));
+
+	std::vector<uint8_t> pixelAspectRatio, screenWindowCenter, screenWindowWidth;
+	appendLittleEndian(pixelAspectRatio, 1.0f);
+	appendLittleEndian(screenWindowCenter, 0.0f);
+	appendLittleEndian(screenWindowCenter, 0.0f);
+	appendLittleEndian(screenWindowWidth, 1.0f);
+
+	appendEXRAttribute(bytes, "channels", "chlist", channels);
+	appendEXRAttribute(bytes, "compression", "compression", { 0 }); // None
+	appendEXRAttribute(bytes, "dataWindow", "box2i", window);
+	appendEXRAttribute(bytes, "displayWindow", "box2i", window);
+	appendEXRAttribute(bytes, "lineOrder", "lineOrder", { 0 }); // Increasing y (top row first)
+	appendEXRAttribute(bytes, "pixelAspectRatio", "float", pixelAspectRatio);
+	appendEXRAttribute(bytes, "screenWindowCenter", "v2f", screenWindowCenter);
+	appendEXRAttribute(bytes, "screenWindowWidth", "float", screenWindowWidth);
+	bytes.push_back(0);
+
+	// Uncompressed files have one scanline per block, each starting with its y and size. The offset table that
+	// precedes them points to the start of each block
+
+	uint32_t blockDataSize = width * static_cast<uint32_t>(imageChannels.size()) * sizeof(uint16_t);
+	uint64_t blockSize = sizeof(int32_t) * 2 + blockDataSize;
+	uint64_t firstBlockOffset = bytes.size() + static_cast<uint64_t>(height) * sizeof(uint64_t);
+
+	for (uint32_t y = 0; y < height; y++)
+		appendLittleEndian(bytes, firstBlockOffset + y * blockSize);
+
+	bytes.reserve(firstBlockOffset + height * blockSize);
+
+	for (uint32_t y = 0; y < height; y++)
+	{
+		appendLittleEndian(bytes, static_cast<int32_t>(y));
+		appendLittleEndian(bytes, blockDataSize);
+
+		const float* sourceRow = pixels + static_cast<size_t>(height - 1 - y) * width * channelCount;
+
+		for (const Channel& channel : imageChannels)
+		{
+			for (uint32_t x = 0; x < width; x++)
+				appendLittleEndian(bytes, static_cast<uint16_t>(glm::packHalf1x16(sourceRow[x * channelCount + channel.pixelOffset])));
+		}
+	}
+
+	writeFile(filePath, bytes);
+}
+
+// Raw
+
+void ImageWriter::writeRaw(const std::filesystem::path& filePath, uint32_t width, uint32_t height, const uint8_t* pixels)
+{
+	std::FILE* file = std::fopen(filePath.string().c_str(), "wb");
+	bool written = file && writeRaw(file, width, height, pixels);
+
+	if (file)
+		written = std::fclose(file) == 0 && written;
+
+	if (!written)
+		throw ImageWriteException("Failed to write " + filePath.string());
+}
+
+bool ImageWriter::writeRaw(std::FILE* stream, uint32_t width, uint32_t height, const uint8_t* pixels)
+{
+	// Row by row, as the rows are flipped
+	size_t rowSize = static_cast<size_t>(width) * 4;
+
+	for (uint32_t y = 0; y < height; y++)
+	{
+		if (std::fwrite(pixels + static_cast<size_t>(height - 1 - y) * rowSize, 1, rowSize, stream) != rowSize)
+			return false;
+	}
+
+	return true;
+}
+
+std::vector<float> ImageWriter::decodeSRGB(uint32_t width, uint32_t height, const uint8_t* pixels)
+{
+	static const std::array<float, 256> SRGB_TO_LINEAR = []()
+	{
+		std::array<float, 256> linearValues;
+		for (uint32_t i = 0; i < 256; i++)
+		{
+			float value = static_cast<float>(i) / 255.0f;
+			linearValues[i] = value <= 0.04045f ? value / 12.92f : std::pow((value + 0.055f) / 1.055f, 2.4f);
+		}
+
+		return linearValues;
+	}();
+
+	size_t channelCount = static_cast<size_t>(width) * height * 4;
+	std::vector<float> linearPixels(channelCount);
+
+	// Alpha isn't encoded
+	for (size_t i = 0; i < channelCount; i++)
+		linearPixels[i] = (i % 4 == 3) ? static_cast<float>(pixels[i]) / 255.0f : SRGB_TO_LINEAR[pixels[i]];
+
+	return linearPixels;
+}
+
+const char* ImageWriter::getFileExtension(Format format)
+{
+	switch (format)
+	{
+	case Format::PNG:
+		return ".png";
+		break;
+	case Format::EXR:
+		return ".exr";
+		break;
+	case Format::RAW:
+		return ".raw";
+		break;
+	default:
+		ASSERT_MESSAGE(false, "Unknown image format");
+		return "";
+		break;
+	}
+}
+
+std::string ImageWriter::getSequenceFileName(const std::string& prefix, uint32_t frameIndex, Format format)
+{
+	char frameNumber[16];
+	std::snprintf(frameNumber, sizeof(frameNumber), "%04u", frameIndex);
+
+	return prefix + "_" + frameNumber + getFileExtension(format);
+}
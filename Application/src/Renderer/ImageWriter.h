@@ -0,0 +1,53 @@
+#pragma once
+#include "PCH.h"
+
+/*
+Writes rendered frames to disk, without any dependencies beyond the zlib already linked for assimp.
+
+	- PNG is 8 bit RGB, deflated with zlib, for frames compared or viewed directly
+	- OpenEXR is uncompressed half float scanlines, for frames passed on to compositing. Pixels must be linear
+	- Raw is 8 bit RGBA with the top row first and no header, as video encoders read from a pipe
+
+All take pixels with the bottom row first (as read back from OpenGL). PNG and OpenEXR drop the alpha channel, and
+OpenEXR also takes single channel images, such as depth, which are written as a Z channel.
+*/
+class ImageWriter
+{
+public:
+
+	enum class Format
+	{
+		PNG = 0,
+		EXR,
+		RAW
+	};
+
+	struct ImageWriteException : public std::exception
+	{
+		std::string errorMessage;
+
+		ImageWriteException(const std::string errorMessage)
+			: errorMessage("ImageWriteException Occured: " + errorMessage) {}
+
+		const char* what() const noexcept override
+		{
+			return errorMessage.c_str();
+		}
+	};
+
+public:
+
+	static void writePNG(const std::filesystem::path& filePath, uint32_t width, uint32_t height, const uint8_t* pixels);
+	// The pixels have either 4 channels (RGBA) or 1 (Z)
+	static void writeEXR(const std::filesystem::path& filePath, uint32_t width, uint32_t height, const float* pixels, uint32_t channelCount = 4);
+	static void writeRaw(const std::filesystem::path& filePath, uint32_t width, uint32_t height, const uint8_t* pixels);
+	// Writes raw pixels to an open stream, such as a pipe to a video encoder. Returns false if the write fails
+	static bool writeRaw(std::FILE* stream, uint32_t width, uint32_t height, const uint8_t* pixels);
+
+	// Decodes 8 bit RGBA pixels encoded for display (as the final frame is) to linear floats, for writing OpenEXR images
+	static std::vector<float> decodeSRGB(uint32_t width, uint32_t height, const uint8_t* pixels);
+
+	static const char* getFileExtension(Format format);
+	// The name of an image in a numbered sequence, such as frame_0042.png
+	static std::string getSequenceFileName(const std::string& prefix, uint32_t frameIndex, Format format);
+};
\ No newline at end of file
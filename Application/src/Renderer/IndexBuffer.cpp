@@ -3,26 +3,65 @@
 
 #include "glad/glad.h"
 
+#include "FrameStatistics.h"
+#include "GLStateCache.h"
+
 IndexBuffer::IndexBuffer(const uint32_t* data, uint32_t count)
 	: m_count(count)
 {
 	glCreateBuffers(1, &m_rendererID);
 
 	glNamedBufferData(m_rendererID, sizeof(uint32_t) * count, static_cast<const void*>(data), GL_STATIC_DRAW);
+	if (data)
+		FrameStatistics::recordUpload(sizeof(uint32_t) * count);
+
+	RendererLog::info("Created index buffer {0}", m_rendererID);
+}
+
+IndexBuffer::IndexBuffer(uint32_t count)
+	: m_count(count)
+{
+	glCreateBuffers(1, &m_rendererID);
+
+	glNamedBufferData(m_rendererID, sizeof(uint32_t) * count, nullptr, GL_DYNAMIC_DRAW);
 
-	Log::info("Created index buffer {0}", m_rendererID);
+	RendererLog::info("Created empty index buffer {0} with space for {1} indices", m_rendererID, count);
 }
 
 IndexBuffer::~IndexBuffer()
 {
-	glDeleteBuffers(1, &m_rendererID);
+	GLStateCache::deleteBuffer(m_rendererID);
 
-	Log::info("Deleted index buffer {0}", m_rendererID);
+	RendererLog::info("Deleted index buffer {0}", m_rendererID);
 }
 
 void IndexBuffer::bind() const
 {
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_rendererID);
+	GLStateCache::bindIndexBuffer(m_rendererID);
+
+	RendererLog::trace("Bound index buffer {0}", m_rendererID);
+}
+
+void IndexBuffer::setData(const uint32_t* data, uint32_t count, uint32_t offset)
+{
+	ASSERT_MESSAGE(offset + count <= m_count, "Data does not fit within the index buffer");
+
+	glNamedBufferSubData(m_rendererID, sizeof(uint32_t) * offset, sizeof(uint32_t) * count, static_cast<const void*>(data));
+	FrameStatistics::recordUpload(sizeof(uint32_t) * count);
+
+	RendererLog::trace("Set {0} indices of index buffer {1}, at offset {2}", count, m_rendererID, offset);
+}
+
+void IndexBuffer::resize(uint32_t count)
+{
+	RendererID previousRendererID = m_rendererID;
+
+	glCreateBuffers(1, &m_rendererID);
+	glNamedBufferData(m_rendererID, sizeof(uint32_t) * count, nullptr, GL_DYNAMIC_DRAW);
+	glCopyNamedBufferSubData(previousRendererID, m_rendererID, 0, 0, sizeof(uint32_t) * std::min(count, m_count));
+	GLStateCache::deleteBuffer(previousRendererID);
+
+	RendererLog::info("Resized index buffer {0} from {1} to {2} indices (now index buffer {3})", previousRendererID, m_count, count, m_rendererID);
 
-	Log::trace("Bound index buffer {0}", m_rendererID);
+	m_count = count;
 }
@@ -9,11 +9,19 @@ public:
 
 	IndexBuffer() = delete;
 	IndexBuffer(const uint32_t* data, uint32_t count);
+	// Creates an empty buffer whose contents are filled in later using setData
+	IndexBuffer(uint32_t count);
 	~IndexBuffer();
 	IndexBuffer(const IndexBuffer&) = delete;
 
+	// The index buffer is part of the state of a vertex array, so this must be called after binding a vertex buffer
 	void bind() const;
 
+	void setData(const uint32_t* data, uint32_t count, uint32_t offset = 0);
+
+	// Reallocates the buffer with a new count, preserving as much of the existing contents as will fit
+	void resize(uint32_t count);
+
 	uint32_t getCount() const { return m_count; }
 
 private:
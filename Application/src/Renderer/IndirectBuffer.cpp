@@ -0,0 +1,59 @@
+#include "PCH.h"
+#include "IndirectBuffer.h"
+
+#include "glad/glad.h"
+
+#include "FrameStatistics.h"
+#include "GLStateCache.h"
+
+IndirectBuffer::IndirectBuffer(uint32_t commandCount)
+	: m_commandCapacity(commandCount)
+{
+	glCreateBuffers(1, &m_rendererID);
+
+	glNamedBufferData(m_rendererID, sizeof(DrawElementsIndirectCommand) * commandCount, nullptr, GL_DYNAMIC_DRAW);
+
+	RendererLog::info("Created indirect buffer {0}", m_rendererID);
+}
+
+IndirectBuffer::~IndirectBuffer()
+{
+	GLStateCache::deleteBuffer(m_rendererID);
+
+	RendererLog::info("Deleted indirect buffer {0}", m_rendererID);
+}
+
+void IndirectBuffer::bind() const
+{
+	GLStateCache::bindBuffer(GL_DRAW_INDIRECT_BUFFER, m_rendererID);
+
+	RendererLog::trace("Bound indirect buffer {0}", m_rendererID);
+}
+
+void IndirectBuffer::bindAsStorageBuffer(uint32_t bindingPoint) const
+{
+	GLStateCache::bindBufferBase(GL_SHADER_STORAGE_BUFFER, bindingPoint, m_rendererID);
+
+	RendererLog::trace("Bound indirect buffer {0} to storage buffer binding point {1}", m_rendererID, bindingPoint);
+}
+
+void IndirectBuffer::setData(const DrawElementsIndirectCommand* commands, uint32_t commandCount)
+{
+	reserve(commandCount);
+
+	glNamedBufferSubData(m_rendererID, 0, sizeof(DrawElementsIndirectCommand) * commandCount, static_cast<const void*>(commands));
+	FrameStatistics::recordUpload(sizeof(DrawElementsIndirectCommand) * commandCount);
+
+	RendererLog::trace("Set {0} commands of indirect buffer {1}", commandCount, m_rendererID);
+}
+
+void IndirectBuffer::reserve(uint32_t commandCount)
+{
+	if (commandCount <= m_commandCapacity)
+		return;
+
+	m_commandCapacity = std::max(commandCount, m_commandCapacity * 2);
+	glNamedBufferData(m_rendererID, sizeof(DrawElementsIndirectCommand) * m_commandCapacity, nullptr, GL_DYNAMIC_DRAW);
+
+	RendererLog::trace("Reallocated indirect buffer {0} with space for {1} commands", m_rendererID, m_commandCapacity);
+}
@@ -0,0 +1,40 @@
+#pragma once
+#include "PCH.h"
+
+#include "RendererUtilities.h"
+
+// Layout of a single command read by glMultiDrawElementsIndirect - defined by the OpenGL specification
+struct DrawElementsIndirectCommand
+{
+	uint32_t count;
+	uint32_t instanceCount;
+	uint32_t firstIndex;
+	int32_t baseVertex;
+	uint32_t baseInstance;
+};
+
+class IndirectBuffer
+{
+public:
+
+	IndirectBuffer() = delete;
+	IndirectBuffer(uint32_t commandCount);
+	~IndirectBuffer();
+	IndirectBuffer(const IndirectBuffer&) = delete;
+
+	void bind() const;
+	// Allows compute shaders to read or write the commands
+	void bindAsStorageBuffer(uint32_t bindingPoint) const;
+
+	// The buffer is reallocated if the commands do not fit within its current size
+	void setData(const DrawElementsIndirectCommand* commands, uint32_t commandCount);
+	// Ensures there is space for commandCount commands - the contents are discarded if the buffer is reallocated
+	void reserve(uint32_t commandCount);
+
+	uint32_t getCommandCapacity() const { return m_commandCapacity; }
+
+private:
+
+	RendererID m_rendererID;
+	uint32_t m_commandCapacity = 0;
+};
@@ -0,0 +1,220 @@
+#include "PCH.h"
+#include "IndirectDrawList.h"
+
+#include "Core/Profiler.h"
+
+static constexpr uint32_t INITIAL_DRAW_CAPACITY = 1024;
+
+// Every draw in a list is made with its renderer's one shader
+static constexpr uint32_t SHADER_VARIANT = 0;
+
+IndirectDrawList::IndirectDrawList()
+{
+	m_indirectBuffer = createUnique<IndirectBuffer>(INITIAL_DRAW_CAPACITY);
+	m_drawDataBuffer = createUnique<StorageBuffer>(sizeof(DrawData) * INITIAL_DRAW_CAPACITY);
+	m_drawBoundsBuffer = createUnique<StorageBuffer>(sizeof(DrawBounds) * INITIAL_DRAW_CAPACITY);
+}
+
+void IndirectDrawList::clear(const glm::vec3& viewPosition)
+{
+	m_viewPosition = viewPosition;
+
+	m_renderQueue.clear();
+
+	m_materials.clear();
+	m_materialIndices.clear();
+	m_textureSetIndices.clear();
+
+	m_addedCommands.clear();
+	m_addedDrawData.clear();
+	m_addedDrawBounds.clear();
+	m_addedDrawMaterialIndices.clear();
+
+	m_batches.clear();
+	m_commands.clear();
+	m_drawData.clear();
+	m_drawBounds.clear();
+	m_solidDrawCount = 0;
+}
+
+void IndirectDrawList::addModel(const Reference<Model>& model, const glm::mat4& transform)
+{
+	const GeometryArena::Allocation& geometryAllocation = model->getGeometryAllocation();
+	const std::vector<Reference<Material>>& materials = model->getMaterials();
+	const auto& materialToMeshMapping = model->getMaterialToMeshMapping();
+	const std::vector<Model::Mesh>& meshes = model->getMeshes();
+
+	for (uint32_t i = 0; i < materials.size(); i++)
+	{
+		uint32_t materialIndex = getMaterialIndex(materials[i]);
+		uint32_t textureSet = m_materials[materialIndex].textureSet;
+		RenderQueue::Pass pass = getPass(materials[i]->alphaMode);
+
+		for (uint32_t meshIndex : materialToMeshMapping.at(i))
+		{
+			const Model::Mesh& mesh = meshes[meshIndex];
+			glm::mat4 meshTransform = transform * mesh.transform;
+
+			DrawElementsIndirectCommand command;
+			command.count = mesh.indexCount;
+			command.instanceCount = 1;
+			command.firstIndex = geometryAllocation.firstIndex + mesh.baseIndex;
+			command.baseVertex = static_cast<int32_t>(geometryAllocation.baseVertex + mesh.baseVertex);
+			command.baseInstance = 0;
+
+			// Draws are sorted by the distance to the centre of their bounds
+			glm::vec3 boundsCentre = glm::vec3(meshTransform * glm::vec4(0.5f * (mesh.boundsMin + mesh.boundsMax), 1.0f));
+			float depth = glm::length(boundsCentre - m_viewPosition);
+
+			uint32_t drawIndex = static_cast<uint32_t>(m_addedCommands.size());
+			m_renderQueue.submit(RenderQueue::createSortKey(pass, SHADER_VARIANT, textureSet, materialIndex, depth), drawIndex);
+
+			m_addedCommands.push_back(command);
+			m_addedDrawData.push_back({ meshTransform });
+			// The batch's index and position are only known once the draws have been sorted in upload()
+			m_addedDrawBounds.push_back({ mesh.boundsMin, 0, mesh.boundsMax, 0 });
+			m_addedDrawMaterialIndices.push_back(materialIndex);
+		}
+	}
+}
+
+void IndirectDrawList::upload()
+{
+	PROFILE_GPU_SCOPE("Draw list upload");
+
+	m_renderQueue.sort();
+
+	const std::vector<RenderQueue::DrawPacket>& packets = m_renderQueue.getPackets();
+
+	// Lay the draws out in sorted order, starting a new batch whenever the state in the key changes
+
+	for (uint32_t i = 0; i < static_cast<uint32_t>(packets.size()); i++)
+	{
+		uint32_t drawIndex = packets[i].drawIndex;
+		uint32_t materialIndex = m_addedDrawMaterialIndices[drawIndex];
+
+		if (i == 0 || RenderQueue::getStateFromSortKey(packets[i].key) != RenderQueue::getStateFromSortKey(packets[i - 1].key))
+		{
+			Batch batch;
+			batch.material = m_materials[materialIndex].material;
+			batch.pass = RenderQueue::getPassFromSortKey(packets[i].key);
+			batch.textureSet = m_materials[materialIndex].textureSet;
+			batch.firstDraw = i;
+			batch.drawCount = 0;
+			m_batches.push_back(batch);
+		}
+
+		Batch& batch = m_batches.back();
+		batch.drawCount++;
+
+		DrawElementsIndirectCommand command = m_addedCommands[drawIndex];
+		command.baseInstance = i;
+		m_commands.push_back(command);
+
+		m_drawData.push_back(m_addedDrawData[drawIndex]);
+
+		DrawBounds drawBounds = m_addedDrawBounds[drawIndex];
+		drawBounds.batchIndex = static_cast<uint32_t>(m_batches.size()) - 1;
+		drawBounds.batchFirstDraw = batch.firstDraw;
+		m_drawBounds.push_back(drawBounds);
+
+		if (batch.pass == RenderQueue::Pass::SOLID)
+			m_solidDrawCount++;
+	}
+
+	countStateChanges();
+
+	if (m_commands.empty())
+		return;
+
+	m_indirectBuffer->setData(m_commands.data(), static_cast<uint32_t>(m_commands.size()));
+	m_drawDataBuffer->setData(static_cast<const void*>(m_drawData.data()), sizeof(DrawData) * m_drawData.size());
+	m_drawBoundsBuffer->setData(static_cast<const void*>(m_drawBounds.data()), sizeof(DrawBounds) * m_drawBounds.size());
+
+	RendererLog::trace("Uploaded {0} indirect draws in {1} batches", m_commands.size(), m_batches.size());
+	RendererLog::trace("\tTexture set changes: {0} unsorted, {1} sorted", m_unsortedStateChanges.textureSetChanges, m_sortedStateChanges.textureSetChanges);
+	RendererLog::trace("\tMaterial changes:    {0} unsorted, {1} sorted", m_unsortedStateChanges.materialChanges, m_sortedStateChanges.materialChanges);
+}
+
+void IndirectDrawList::bind() const
+{
+	m_indirectBuffer->bind();
+	m_drawDataBuffer->bind(DRAW_DATA_BINDING_POINT);
+}
+
+void IndirectDrawList::bindForCulling() const
+{
+	m_indirectBuffer->bindAsStorageBuffer(DRAW_COMMANDS_BINDING_POINT);
+	m_drawBoundsBuffer->bind(DRAW_BOUNDS_BINDING_POINT);
+}
+
+const void* IndirectDrawList::getCommandOffset(const Batch& batch)
+{
+	return reinterpret_cast<const void*>(static_cast<uint64_t>(sizeof(DrawElementsIndirectCommand)) * static_cast<uint64_t>(batch.firstDraw));
+}
+
+RenderQueue::Pass IndirectDrawList::getPass(Material::AlphaMode alphaMode)
+{
+	switch (alphaMode)
+	{
+	case Material::AlphaMode::SOLID:
+		return RenderQueue::Pass::SOLID;
+		break;
+	case Material::AlphaMode::MASK:
+		return RenderQueue::Pass::MASKED;
+		break;
+	case Material::AlphaMode::BLEND:
+		return RenderQueue::Pass::BLENDED;
+		break;
+	default:
+		ASSERT_MESSAGE(false, "Cannot get render queue pass from alpha mode");
+		return RenderQueue::Pass::SOLID;
+		break;
+	}
+}
+
+uint32_t IndirectDrawList::getMaterialIndex(const Reference<Material>& material)
+{
+	auto it = m_materialIndices.find(material.get());
+	if (it != m_materialIndices.end())
+		return it->second;
+
+	// First time the material has been seen this frame
+
+	Material::TextureSet textureSet = material->getTextureSet();
+	auto textureSetIt = m_textureSetIndices.find(textureSet);
+	if (textureSetIt == m_textureSetIndices.end())
+		textureSetIt = m_textureSetIndices.emplace(textureSet, static_cast<uint32_t>(m_textureSetIndices.size())).first;
+
+	uint32_t materialIndex = static_cast<uint32_t>(m_materials.size());
+	m_materials.push_back({ material, textureSetIt->second });
+	m_materialIndices[material.get()] = materialIndex;
+
+	return materialIndex;
+}
+
+void IndirectDrawList::countStateChanges()
+{
+	// Unsorted - as if each draw was made separately, in the order the draws were added
+
+	m_unsortedStateChanges = StateChanges();
+
+	for (uint32_t i = 1; i < static_cast<uint32_t>(m_addedDrawMaterialIndices.size()); i++)
+	{
+		const MaterialEntry& previous = m_materials[m_addedDrawMaterialIndices[i - 1]];
+		const MaterialEntry& current = m_materials[m_addedDrawMaterialIndices[i]];
+
+		m_unsortedStateChanges.textureSetChanges += previous.textureSet != current.textureSet;
+		m_unsortedStateChanges.materialChanges += previous.material != current.material;
+	}
+
+	// Sorted - state only changes between batches
+
+	m_sortedStateChanges = StateChanges();
+
+	for (uint32_t i = 1; i < static_cast<uint32_t>(m_batches.size()); i++)
+	{
+		m_sortedStateChanges.textureSetChanges += m_batches[i - 1].textureSet != m_batches[i].textureSet;
+		m_sortedStateChanges.materialChanges += m_batches[i - 1].material != m_batches[i].material;
+	}
+}
@@ -0,0 +1,148 @@
+#pragma once
+#include "PCH.h"
+
+#include <map>
+
+#include "glm/glm.hpp"
+
+#include "IndirectBuffer.h"
+#include "StorageBuffer.h"
+#include "RenderQueue.h"
+#include "Material.h"
+#include "Scene/Model.h"
+
+/*
+Collects the meshes submitted during a frame into batches that share a material.
+
+Every mesh is given a render queue key when it is added, and the sorted keys decide the order of the batches
+(grouping materials which share textures) and the order of draws within them (front to back). The material's
+alpha mode picks the pass, so solid batches come first, then alpha tested ones, then blended ones back to front.
+
+Each batch is drawn with a single glMultiDrawElementsIndirect call over the geometry arena, so the number
+of draw calls depends on the number of materials rather than the number of models. Per-draw data (the
+mesh's transform) is placed in a storage buffer and looked up in the vertex shader via gl_BaseInstance,
+which each command sets to its own index - this keeps the lookup valid when the GPU culler compacts the commands.
+*/
+class IndirectDrawList
+{
+public:
+
+	// Matches the DrawData struct in the vertex shaders (std430 layout)
+	struct DrawData
+	{
+		glm::mat4 transform;
+	};
+
+	// Matches the DrawBounds struct in the culling compute shader (std430 layout)
+	struct DrawBounds
+	{
+		glm::vec3 boundsMin;
+		uint32_t batchIndex;
+		glm::vec3 boundsMax;
+		uint32_t batchFirstDraw;
+	};
+
+	struct Batch
+	{
+		Reference<Material> material;
+		RenderQueue::Pass pass;
+		// Consecutive batches with the same texture set don't need to rebind textures
+		uint32_t textureSet;
+		uint32_t firstDraw;
+		uint32_t drawCount;
+	};
+
+	// Number of times state would change between consecutive draws
+	struct StateChanges
+	{
+		uint32_t textureSetChanges = 0;
+		uint32_t materialChanges = 0;
+	};
+
+	static constexpr uint32_t DRAW_DATA_BINDING_POINT = 0;
+	static constexpr uint32_t DRAW_BOUNDS_BINDING_POINT = 1;
+	static constexpr uint32_t DRAW_COMMANDS_BINDING_POINT = 2;
+
+	// Never the texture set of a batch, so can be used to force textures to be bound
+	static constexpr uint32_t NO_TEXTURE_SET = std::numeric_limits<uint32_t>::max();
+
+public:
+
+	IndirectDrawList();
+	IndirectDrawList(const IndirectDrawList&) = delete;
+
+	// The view position is used to sort draws front to back
+	void clear(const glm::vec3& viewPosition);
+
+	void addModel(const Reference<Model>& model, const glm::mat4& transform);
+
+	// Sorts the draws into batches and uploads the commands and per-draw data to the GPU
+	void upload();
+
+	void bind() const;
+	// Binds the commands and bounds as storage buffers, to be read by the culling compute shader
+	void bindForCulling() const;
+
+	const std::vector<Batch>& getBatches() const { return m_batches; }
+	// The uploaded draws, in sorted order
+	const std::vector<DrawElementsIndirectCommand>& getCommands() const { return m_commands; }
+	const DrawElementsIndirectCommand* getBatchCommands(const Batch& batch) const { return m_commands.data() + batch.firstDraw; }
+	const std::vector<DrawData>& getDrawData() const { return m_drawData; }
+	const std::vector<DrawBounds>& getDrawBounds() const { return m_drawBounds; }
+	uint32_t getDrawCount() const { return static_cast<uint32_t>(m_commands.size()); }
+	uint32_t getBatchCount() const { return static_cast<uint32_t>(m_batches.size()); }
+	// Solid draws come first, so these are the first draws of the commands
+	uint32_t getSolidDrawCount() const { return m_solidDrawCount; }
+
+	// State changes if draws were made in the order they were added, compared to the sorted order of the batches
+	const StateChanges& getUnsortedStateChanges() const { return m_unsortedStateChanges; }
+	const StateChanges& getSortedStateChanges() const { return m_sortedStateChanges; }
+
+	static const void* getCommandOffset(const Batch& batch);
+
+private:
+
+	struct MaterialEntry
+	{
+		Reference<Material> material;
+		uint32_t textureSet;
+	};
+
+private:
+
+	static RenderQueue::Pass getPass(Material::AlphaMode alphaMode);
+
+	uint32_t getMaterialIndex(const Reference<Material>& material);
+	void countStateChanges();
+
+private:
+
+	glm::vec3 m_viewPosition = glm::vec3(0.0f);
+
+	RenderQueue m_renderQueue;
+
+	// Materials and texture sets are given indices in the order they are first seen each frame, which become part of the sort keys
+	std::vector<MaterialEntry> m_materials;
+	std::unordered_map<const Material*, uint32_t> m_materialIndices;
+	std::map<Material::TextureSet, uint32_t> m_textureSetIndices;
+
+	// Draws in the order they were added
+	std::vector<DrawElementsIndirectCommand> m_addedCommands;
+	std::vector<DrawData> m_addedDrawData;
+	std::vector<DrawBounds> m_addedDrawBounds;
+	std::vector<uint32_t> m_addedDrawMaterialIndices;
+
+	// Draws in sorted order, as uploaded
+	std::vector<Batch> m_batches;
+	std::vector<DrawElementsIndirectCommand> m_commands;
+	std::vector<DrawData> m_drawData;
+	std::vector<DrawBounds> m_drawBounds;
+	uint32_t m_solidDrawCount = 0;
+
+	StateChanges m_unsortedStateChanges;
+	StateChanges m_sortedStateChanges;
+
+	Unique<IndirectBuffer> m_indirectBuffer;
+	Unique<StorageBuffer> m_drawDataBuffer;
+	Unique<StorageBuffer> m_drawBoundsBuffer;
+};
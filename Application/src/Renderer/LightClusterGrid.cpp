@@ -0,0 +1,85 @@
+#include "PCH.h"
+#include "LightClusterGrid.h"
+
+#include "glad/glad.h"
+
+#include "Core/Profiler.h"
+
+static constexpr uint32_t CLUSTERING_WORK_GROUP_SIZE = 128;
+
+// Matches the Cluster struct in the shaders (std430 layout)
+struct Cluster
+{
+	uint32_t firstLightIndex;
+	uint32_t lightCount;
+};
+
+LightClusterGrid::LightClusterGrid()
+{
+	m_clusteringShader = createUnique<Shader>(std::initializer_list<std::string>
+	{
+		"Assets/Shaders/LightClustering.glsl.comp"
+	});
+
+	m_lightBoundsBuffer = createUnique<StorageBuffer>(sizeof(glm::vec4) * 1024);
+	m_clusterBuffer = createUnique<StorageBuffer>(sizeof(Cluster) * CLUSTER_COUNT);
+	m_clusterLightIndexBuffer = createUnique<StorageBuffer>(sizeof(uint32_t) * CLUSTER_COUNT * MAX_LIGHTS_PER_CLUSTER);
+}
+
+void LightClusterGrid::build(const std::vector<Reference<PointLight>>& pointLights, const Camera& camera, uint32_t width, uint32_t height)
+{
+	PROFILE_GPU_SCOPE("Light clustering");
+
+	m_viewMatrix = camera.getViewMatrix();
+	m_nearClip = camera.getNearClip();
+	m_farClip = camera.getFarClip();
+	m_tileSize = glm::vec2(static_cast<float>(width) / GRID_WIDTH, static_cast<float>(height) / GRID_HEIGHT);
+
+	// Only the position and radius of each light are needed to assign it to clusters
+
+	m_lightBounds.clear();
+	for (const Reference<PointLight>& pointLight : pointLights)
+		m_lightBounds.emplace_back(pointLight->worldPosition, pointLight->lightRadius);
+
+	if (!m_lightBounds.empty())
+		m_lightBoundsBuffer->setData(static_cast<const void*>(m_lightBounds.data()), sizeof(glm::vec4) * m_lightBounds.size());
+
+	m_lightBoundsBuffer->bind(LIGHT_BOUNDS_BINDING_POINT);
+	m_clusterBuffer->bind(CLUSTERS_BINDING_POINT);
+	m_clusterLightIndexBuffer->bind(CLUSTER_LIGHT_INDICES_BINDING_POINT);
+
+	m_clusteringShader->bind();
+
+	m_clusteringShader->setUniformToValue("u_clusterGridSize", glm::uvec3(GRID_WIDTH, GRID_HEIGHT, GRID_DEPTH));
+	m_clusteringShader->setUniformToValue("u_maxLightsPerCluster", MAX_LIGHTS_PER_CLUSTER);
+	m_clusteringShader->setUniformToValue("u_lightCount", static_cast<uint32_t>(m_lightBounds.size()));
+	m_clusteringShader->setUniformToValue("u_viewMatrix", m_viewMatrix);
+	m_clusteringShader->setUniformToValue("u_inverseProjectionMatrix", glm::inverse(camera.getProjectionMatrix()));
+	m_clusteringShader->setUniformToValue("u_nearClip", m_nearClip);
+	m_clusteringShader->setUniformToValue("u_farClip", m_farClip);
+
+	RendererUtilities::dispatchCompute((CLUSTER_COUNT + CLUSTERING_WORK_GROUP_SIZE - 1) / CLUSTERING_WORK_GROUP_SIZE);
+
+	// The clusters are read by the fragment shaders
+	glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+
+	RendererLog::trace("Assigned {0} lights to {1} clusters", m_lightBounds.size(), CLUSTER_COUNT);
+}
+
+void LightClusterGrid::bind() const
+{
+	m_clusterBuffer->bind(CLUSTERS_BINDING_POINT);
+	m_clusterLightIndexBuffer->bind(CLUSTER_LIGHT_INDICES_BINDING_POINT);
+}
+
+void LightClusterGrid::setClusterUniforms(Shader& shader) const
+{
+	// Clusters are found from the fragment's depth with the inverse of the slice spacing used by the clustering shader
+	float depthSliceScale = static_cast<float>(GRID_DEPTH) / std::log(m_farClip / m_nearClip);
+
+	shader.setUniformToValue("u_clusterGridSize", glm::uvec3(GRID_WIDTH, GRID_HEIGHT, GRID_DEPTH));
+	shader.setUniformToValue("u_clusterTileSize", m_tileSize);
+	shader.setUniformToValue("u_clusterDepthSliceScale", depthSliceScale);
+	shader.setUniformToValue("u_nearClip", m_nearClip);
+	shader.setUniformToValue("u_viewMatrix", m_viewMatrix);
+}
@@ -0,0 +1,65 @@
+#pragma once
+#include "PCH.h"
+
+#include "glm/glm.hpp"
+
+#include "Camera.h"
+#include "Shader.h"
+#include "StorageBuffer.h"
+#include "Scene/PointLight.h"
+
+/*
+Divides the view frustum into a 3D grid of clusters (screen space tiles, split into exponentially spaced depth slices)
+and finds which point lights reach each cluster, by testing each light's sphere of influence against each cluster's bounds.
+
+The grid is built every frame with a compute shader. Fragment shaders then look up their cluster and only evaluate
+the lights in its list, so the cost of shading depends on how many lights are nearby rather than the total number of lights.
+
+The lights themselves are stored by each renderer in a storage buffer bound to POINT_LIGHTS_BINDING_POINT,
+in the same order as they were given to build().
+*/
+class LightClusterGrid
+{
+public:
+
+	static constexpr uint32_t LIGHT_BOUNDS_BINDING_POINT = 7;
+	static constexpr uint32_t CLUSTERS_BINDING_POINT = 8;
+	static constexpr uint32_t CLUSTER_LIGHT_INDICES_BINDING_POINT = 9;
+	static constexpr uint32_t POINT_LIGHTS_BINDING_POINT = 10;
+
+	static constexpr uint32_t GRID_WIDTH = 16;
+	static constexpr uint32_t GRID_HEIGHT = 9;
+	static constexpr uint32_t GRID_DEPTH = 24;
+	static constexpr uint32_t CLUSTER_COUNT = GRID_WIDTH * GRID_HEIGHT * GRID_DEPTH;
+
+	// Lights beyond this in a single cluster are ignored
+	static constexpr uint32_t MAX_LIGHTS_PER_CLUSTER = 256;
+
+public:
+
+	LightClusterGrid();
+	LightClusterGrid(const LightClusterGrid&) = delete;
+
+	// Assigns the lights to clusters, for a view of the given size
+	void build(const std::vector<Reference<PointLight>>& pointLights, const Camera& camera, uint32_t width, uint32_t height);
+
+	// Binds the clusters and their light lists, ready to be read by fragment shaders
+	void bind() const;
+
+	// Sets the uniforms a fragment shader needs to find its cluster
+	void setClusterUniforms(Shader& shader) const;
+
+private:
+
+	Unique<Shader> m_clusteringShader;
+
+	Unique<StorageBuffer> m_lightBoundsBuffer;
+	Unique<StorageBuffer> m_clusterBuffer;
+	Unique<StorageBuffer> m_clusterLightIndexBuffer;
+
+	std::vector<glm::vec4> m_lightBounds;
+
+	glm::mat4 m_viewMatrix = glm::mat4(1.0f);
+	glm::vec2 m_tileSize = glm::vec2(1.0f);
+	float m_nearClip = 0.0f, m_farClip = 0.0f;
+};
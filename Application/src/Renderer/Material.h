@@ -1,13 +1,56 @@
 #pragma once
 #include "PCH.h"
 
+#include <array>
+
 #include "glm/glm.hpp"
 
 #include "Texture.h"
 
 struct Material
 {
+	// The textures a material binds - draws which share them can be drawn without rebinding any textures
+	using TextureSet = std::array<const Texture*, 4>;
+
+	// How the alpha of the material's color is used - decided when the material is imported
+	// (glTF's OPAQUE is called SOLID here, as windows.h defines OPAQUE as a macro)
+	enum class AlphaMode
+	{
+		// Alpha is ignored
+		SOLID = 0,
+		// Fragments with alpha below alphaCutoff are discarded
+		MASK,
+		// Blended over what is behind it, after all opaque geometry
+		BLEND
+	};
+
+	virtual ~Material() = default;
+
+	static const char* getAlphaModeName(AlphaMode alphaMode)
+	{
+		switch (alphaMode)
+		{
+		case AlphaMode::SOLID:
+			return "Solid";
+			break;
+		case AlphaMode::MASK:
+			return "Mask";
+			break;
+		case AlphaMode::BLEND:
+			return "Blend";
+			break;
+		default:
+			return "Unknown";
+			break;
+		}
+	}
+
+	virtual TextureSet getTextureSet() const { return { normalMap.get() }; }
+
 	Reference<const Texture> normalMap;
+
+	AlphaMode alphaMode = AlphaMode::SOLID;
+	float alphaCutoff = 0.5f;
 };
 
 struct BlinnPhongMaterial : public Material
@@ -19,6 +62,8 @@ struct BlinnPhongMaterial : public Material
 	Reference<const Texture> diffuseMap;
 	Reference<const Texture> specularMap;
 	float shininess = 32.0f;
+
+	TextureSet getTextureSet() const override { return { diffuseMap.get(), specularMap.get(), normalMap.get() }; }
 };
 
 struct PBRMaterial : public Material
@@ -31,4 +76,6 @@ struct PBRMaterial : public Material
 	Reference<const Texture> baseColorMap;
 	Reference<const Texture> roughnessMap;
 	Reference<const Texture> metalnessMap;
+
+	TextureSet getTextureSet() const override { return { baseColorMap.get(), roughnessMap.get(), metalnessMap.get(), normalMap.get() }; }
 };
\ No newline at end of file
@@ -0,0 +1,431 @@
+#include "PCH.h"
+#include "PBRDeferredRendererImplementation.h"
+
+#include "Core/Application.h"
+
+#include "FrameCapture.h"
+#include "GeometryArena.h"
+#include "LightClusterGrid.h"
+#include "RenderGraph.h"
+
+// Must match the work group size of DeferredLighting.glsl.comp
+static constexpr uint32_t LIGHTING_TILE_SIZE = 16;
+
+// Image unit the lit HDR framebuffer is written to by the lighting pass
+static constexpr uint32_t LIGHTING_OUTPUT_IMAGE_UNIT = 0;
+
+PBRDeferredRendererImplementation::PBRDeferredRendererImplementation()
+{
+	m_antiAliasing = createUnique<AntiAliasing>();
+
+	// The G-buffer pass uses the same vertex shader as the forward PBR renderer
+	m_GBufferShader = createUnique<Shader>(std::initializer_list<std::string>
+	{
+		"Assets/Shaders/PBR.glsl.vert",
+		"Assets/Shaders/GBuffer.glsl.frag"
+	});
+
+	m_depthPrepassShader = createUnique<Shader>(std::initializer_list<std::string>
+	{
+		"Assets/Shaders/DepthPrepass.glsl.vert",
+		"Assets/Shaders/DepthPrepass.glsl.frag"
+	});
+
+	m_lightingShader = createUnique<Shader>(std::initializer_list<std::string>
+	{
+		"Assets/Shaders/DeferredLighting.glsl.comp"
+	});
+
+	m_postProcessingShader = createUnique<Shader>(std::initializer_list<std::string>
+	{
+		"Assets/Shaders/PBRPostProcessing.glsl.vert",
+		"Assets/Shaders/PBRPostProcessing.glsl.frag"
+	});
+
+	initialiseDefaultMaterialTextures();
+	initialiseQuadBuffers();
+
+	m_drawList = createUnique<IndirectDrawList>();
+	m_pointLightBuffer = createUnique<StorageBuffer>(sizeof(PBRRendererImplementation::PointLightData) * 1024);
+	m_pointShadowAtlas = createUnique<PointShadowAtlas>();
+	m_imageBasedLighting = createUnique<ImageBasedLighting>();
+
+	m_shadedSampleQuery = createUnique<Query>(Query::QueryType::SAMPLES_PASSED);
+
+	RendererLog::info("PBR deferred renderer initialised");
+}
+
+void PBRDeferredRendererImplementation::setAntiAliasingMode(AntiAliasing::Mode mode)
+{
+	if (AntiAliasing::getSampleCount(mode) > 1)
+		RendererLog::warn("The deferred renderer does not support {0}, so will not be anti-aliased", AntiAliasing::getModeName(mode));
+
+	m_antiAliasing->setMode(mode);
+}
+
+uint64_t PBRDeferredRendererImplementation::getRenderTargetMemoryUsage() const
+{
+	uint64_t memoryUsage = Framebuffer::getMemoryUsage(getGBufferSpecification()) + Framebuffer::getMemoryUsage(getLitHDRFramebufferSpecification()) + m_antiAliasing->getMemoryUsage();
+
+	if (m_antiAliasing->isPostProcess())
+		memoryUsage += Framebuffer::getMemoryUsage(getLDRFramebufferSpecification());
+
+	return memoryUsage + m_pointShadowAtlas->getMemoryUsage() + m_imageBasedLighting->getMemoryUsage();
+}
+
+void PBRDeferredRendererImplementation::beginScene(const Camera& camera, const std::vector<Reference<PointLight>>& pointLights)
+{
+	RendererLog::trace("Beginning to render a deferred PBR scene");
+
+	uploadPointLights(pointLights);
+	m_pointShadowAtlas->beginScene(pointLights, camera);
+
+	m_viewMatrix = camera.getViewMatrix();
+	m_projectionMatrix = camera.getProjectionMatrix();
+	m_projectionViewMatrix = m_projectionMatrix * m_viewMatrix;
+	m_viewPosition = camera.getCameraPosition();
+
+	m_drawList->clear(m_viewPosition);
+}
+
+void PBRDeferredRendererImplementation::endScene(float exposureLevel)
+{
+	// Shadow maps are kept from frame to frame rather than created by the graph, so they are drawn before it
+
+	m_drawList->upload();
+	m_pointShadowAtlas->drawShadowMaps(*m_drawList);
+
+	RenderGraph renderGraph;
+
+	RenderGraph::ResourceHandle GBuffer = renderGraph.createFramebuffer("G-buffer", getGBufferSpecification());
+	RenderGraph::ResourceHandle litHDRFramebuffer = renderGraph.createFramebuffer("Lit HDR", getLitHDRFramebufferSpecification());
+
+	renderGraph.addPass("Geometry", {}, { { GBuffer, RenderGraph::Access::ATTACHMENT } }, [this, GBuffer](RenderGraph& graph)
+	{
+		Framebuffer& framebuffer = graph.getFramebuffer(GBuffer);
+		framebuffer.bind();
+		framebuffer.clear();
+
+		GeometryArena::bind();
+		m_drawList->bind();
+
+		if (m_depthPrepassEnabled)
+			drawDepthPrepass();
+
+		drawGeometryPass();
+	});
+
+	// The lit image is written by a compute shader, so the graph puts a barrier between this and tone mapping
+	renderGraph.addPass("Lighting", { { GBuffer, RenderGraph::Access::TEXTURE } }, { { litHDRFramebuffer, RenderGraph::Access::IMAGE } }, [this, GBuffer, litHDRFramebuffer](RenderGraph& graph)
+	{
+		drawLightingPass(graph.getFramebuffer(GBuffer), graph.getFramebuffer(litHDRFramebuffer));
+	});
+
+	// Post process anti-aliasing runs on the tone mapped image, so it is drawn to the LDR framebuffer first
+
+	RenderGraph::ResourceHandle toneMappingOutput = RenderGraph::DEFAULT_FRAMEBUFFER;
+	if (m_antiAliasing->isPostProcess())
+		toneMappingOutput = renderGraph.createFramebuffer("LDR", getLDRFramebufferSpecification());
+
+	renderGraph.addPass("Tone mapping", { { litHDRFramebuffer, RenderGraph::Access::TEXTURE } }, { { toneMappingOutput, RenderGraph::Access::ATTACHMENT } }, [this, litHDRFramebuffer, toneMappingOutput, exposureLevel](RenderGraph& graph)
+	{
+		graph.bindFramebuffer(toneMappingOutput);
+
+		m_quadVertexBuffer->bind();
+		m_quadIndexBuffer->bind();
+
+		m_postProcessingShader->bind();
+
+		const Framebuffer& inputFramebuffer = graph.getFramebuffer(litHDRFramebuffer);
+		inputFramebuffer.bindColorAttachment();
+		m_postProcessingShader->setUniformToValue("u_inputTexture", 0);
+		m_postProcessingShader->setUniformToValue("u_textureCoordinatesScale", inputFramebuffer.getTextureCoordinatesScale());
+
+		m_postProcessingShader->setUniformToValue("u_exposure", exposureLevel);
+
+		RendererUtilities::drawIndexed(m_quadIndexBuffer->getCount());
+	});
+
+	if (m_antiAliasing->isPostProcess())
+	{
+		renderGraph.addPass("Anti-aliasing", { { toneMappingOutput, RenderGraph::Access::TEXTURE } }, { { RenderGraph::DEFAULT_FRAMEBUFFER, RenderGraph::Access::ATTACHMENT } }, [this, toneMappingOutput](RenderGraph& graph)
+		{
+			m_antiAliasing->draw(graph.getFramebuffer(toneMappingOutput));
+		});
+	}
+
+	// The lit image has no depth attachment, so depth is captured from the G-buffer
+	if (FrameCapture* frameCapture = getFrameCapture())
+		frameCapture->addAttachmentCapturePass(renderGraph, litHDRFramebuffer, GBuffer);
+
+	renderGraph.compile();
+	renderGraph.execute();
+
+	RendererLog::trace("Ended the rendering of a deferred PBR scene");
+}
+
+void PBRDeferredRendererImplementation::drawScene(Reference<Scene> scene, const Camera& camera)
+{
+	RendererLog::trace("Drawing deferred PBR scene");
+
+	Reference<PBRScene> physicallyBasedScene = std::static_pointer_cast<PBRScene>(scene);
+	m_imageBasedLighting->setEnvironmentMap(physicallyBasedScene->getEnvironmentMap(), physicallyBasedScene->getEnvironmentIntensity());
+
+	beginScene(camera, scene->getPointLights());
+
+	const auto& modelsAndTransforms = scene->getModelsAndTransforms();
+	for (uint32_t i = 0; i < static_cast<uint32_t>(modelsAndTransforms.size()); i++)
+	{
+		if (isModelVisible(i))
+			drawModel(modelsAndTransforms[i].first, modelsAndTransforms[i].second);
+	}
+
+	endScene(physicallyBasedScene->getExposureLevel());
+}
+
+void PBRDeferredRendererImplementation::drawModel(Reference<Model> model, const glm::mat4& transform)
+{
+	RendererLog::trace("Drawing deferred PBR model {0} with {1} meshes", model->getModelIdentifier(), static_cast<uint32_t>(model->getMeshes().size()));
+
+	// Draws are deferred until endScene so that the meshes of all models can be batched by material
+	m_drawList->addModel(model, transform);
+}
+
+void PBRDeferredRendererImplementation::drawDepthPrepass()
+{
+	GeometryArena::bindPositions();
+
+	m_depthPrepassShader->bind();
+	m_depthPrepassShader->setUniformToValue("u_projectionViewMatrix", m_projectionViewMatrix);
+
+	RendererUtilities::setColorWriteEnabled(false);
+
+	// Materials don't affect the depth of solid geometry, so its batches (which come first) can all be drawn at once
+	RendererUtilities::multiDrawIndexedIndirect(nullptr, m_drawList->getSolidDrawCount(), m_drawList->getCommands().data());
+
+	RendererUtilities::setColorWriteEnabled(true);
+
+	GeometryArena::bind();
+
+	RendererLog::trace("Drew depth pre-pass of {0} draws", m_drawList->getSolidDrawCount());
+}
+
+void PBRDeferredRendererImplementation::drawGeometryPass()
+{
+	if (m_shadedSampleCountingEnabled)
+		m_shadedSampleQuery->begin();
+
+	m_GBufferShader->bind();
+	m_GBufferShader->setUniformToValue("u_projectionViewMatrix", m_projectionViewMatrix);
+
+	m_boundTextureSet = IndirectDrawList::NO_TEXTURE_SET;
+
+	const std::vector<IndirectDrawList::Batch>& batches = m_drawList->getBatches();
+
+	for (uint32_t i = 0; i < static_cast<uint32_t>(batches.size()); i++)
+	{
+		// With the pre-pass, only the visible surface of each pixel is written to the G-buffer. There is no
+		// transparency pass, so blended batches are alpha tested like masked ones
+		if (i == 0 || batches[i].pass != batches[i - 1].pass)
+			setPassState(batches[i].pass == RenderQueue::Pass::SOLID ? RenderQueue::Pass::SOLID : RenderQueue::Pass::MASKED, m_depthPrepassEnabled);
+
+		setBatchMaterial(batches[i]);
+
+		RendererUtilities::multiDrawIndexedIndirect(IndirectDrawList::getCommandOffset(batches[i]), batches[i].drawCount, m_drawList->getBatchCommands(batches[i]));
+	}
+
+	if (m_shadedSampleCountingEnabled)
+	{
+		m_shadedSampleQuery->end();
+		m_shadedSampleCount = m_shadedSampleQuery->getResult();
+
+		RendererLog::trace("Wrote {0} samples to the G-buffer (depth pre-pass {1})", m_shadedSampleCount, m_depthPrepassEnabled ? "enabled" : "disabled");
+	}
+
+	resetPassState();
+
+	RendererLog::trace("Drew G-buffer pass of {0} draws in {1} batches", m_drawList->getDrawCount(), m_drawList->getBatchCount());
+}
+
+void PBRDeferredRendererImplementation::drawLightingPass(const Framebuffer& GBuffer, const Framebuffer& litHDRFramebuffer)
+{
+	GBuffer.bindColorAttachment(0, GBufferAttachment::BASE_COLOR_METALNESS);
+	GBuffer.bindColorAttachment(1, GBufferAttachment::NORMAL_ROUGHNESS);
+	GBuffer.bindDepthAttachment(2);
+
+	litHDRFramebuffer.bindColorAttachmentImage(LIGHTING_OUTPUT_IMAGE_UNIT);
+
+	m_pointLightBuffer->bind(LightClusterGrid::POINT_LIGHTS_BINDING_POINT);
+
+	m_lightingShader->bind();
+	m_pointShadowAtlas->bind(*m_lightingShader);
+	m_imageBasedLighting->bind(*m_lightingShader);
+
+	m_lightingShader->setUniformToValue("u_gBufferBaseColorMetalness", 0);
+	m_lightingShader->setUniformToValue("u_gBufferNormalRoughness", 1);
+	m_lightingShader->setUniformToValue("u_gBufferDepth", 2);
+
+	m_lightingShader->setUniformToValue("u_inverseProjectionViewMatrix", glm::inverse(m_projectionViewMatrix));
+	m_lightingShader->setUniformToValue("u_inverseProjectionMatrix", glm::inverse(m_projectionMatrix));
+	m_lightingShader->setUniformToValue("u_viewMatrix", m_viewMatrix);
+	m_lightingShader->setUniformToValue("u_viewPosition", m_viewPosition);
+	m_lightingShader->setUniformToValue("u_lightCount", static_cast<uint32_t>(m_pointLightData.size()));
+	m_lightingShader->setUniformToValue("u_clearColor", litHDRFramebuffer.getSpecification().clearColor);
+
+	// Only the render size of the framebuffers is shaded, which can be smaller than their allocated size
+	uint32_t renderWidth = litHDRFramebuffer.getRenderWidth();
+	uint32_t renderHeight = litHDRFramebuffer.getRenderHeight();
+	m_lightingShader->setUniformToValue("u_renderSize", glm::uvec2(renderWidth, renderHeight));
+
+	RendererUtilities::dispatchCompute(
+		(renderWidth + LIGHTING_TILE_SIZE - 1) / LIGHTING_TILE_SIZE,
+		(renderHeight + LIGHTING_TILE_SIZE - 1) / LIGHTING_TILE_SIZE
+	);
+
+	RendererLog::trace("Shaded the G-buffer with {0} point lights", m_pointLightData.size());
+}
+
+Framebuffer::FramebufferSpecification PBRDeferredRendererImplementation::getGBufferSpecification() const
+{
+	// See GBuffer.glsl.frag for what is stored in each attachment
+
+	Framebuffer::FramebufferSpecification GBufferSpecification;
+	GBufferSpecification.width = Application::getWindow().getWidth();
+	GBufferSpecification.height = Application::getWindow().getHeight();
+	GBufferSpecification.colorAttachmentFormats =
+	{
+		Framebuffer::ColorAttachmentFormat::RGBA8,
+		Framebuffer::ColorAttachmentFormat::RGB10A2
+	};
+	GBufferSpecification.clearColor = { 0.0f, 0.0f, 0.0f, 0.0f };
+
+	return GBufferSpecification;
+}
+
+Framebuffer::FramebufferSpecification PBRDeferredRendererImplementation::getLitHDRFramebufferSpecification() const
+{
+	// Only written to by the lighting pass, so has no depth. The clear color is written to pixels without any geometry
+
+	Framebuffer::FramebufferSpecification litHDRFramebufferSpecification;
+	litHDRFramebufferSpecification.width = Application::getWindow().getWidth();
+	litHDRFramebufferSpecification.height = Application::getWindow().getHeight();
+	litHDRFramebufferSpecification.colorAttachmentFormats = { Framebuffer::ColorAttachmentFormat::RGBA16F };
+	litHDRFramebufferSpecification.depthAttachmentFormat = Framebuffer::DepthAttachmentFormat::NONE;
+	litHDRFramebufferSpecification.clearColor = { 0.1f, 0.1f, 0.1f, 1.0f };
+
+	return litHDRFramebufferSpecification;
+}
+
+Framebuffer::FramebufferSpecification PBRDeferredRendererImplementation::getLDRFramebufferSpecification() const
+{
+	Framebuffer::FramebufferSpecification LDRFramebufferSpecification;
+	LDRFramebufferSpecification.width = Application::getWindow().getWidth();
+	LDRFramebufferSpecification.height = Application::getWindow().getHeight();
+	LDRFramebufferSpecification.depthAttachmentFormat = Framebuffer::DepthAttachmentFormat::NONE;
+
+	return LDRFramebufferSpecification;
+}
+
+void PBRDeferredRendererImplementation::initialiseDefaultMaterialTextures()
+{
+	uint8_t whitePixelImageData[4] = { 0xff, 0xff, 0xff, 0xff };
+	uint8_t monoChannelSaturatedPixelImageData = 0xff;
+
+	m_defaultBaseColorMapTexture = createUnique<Texture>(static_cast<void*>(whitePixelImageData), 1, 1, 4);
+	m_defaultRoughnessMapTexture = createUnique<Texture>(static_cast<void*>(&monoChannelSaturatedPixelImageData), 1, 1, 1);
+	m_defaultMetalnessMapTexture = createUnique<Texture>(static_cast<void*>(&monoChannelSaturatedPixelImageData), 1, 1, 1);
+}
+
+void PBRDeferredRendererImplementation::initialiseQuadBuffers()
+{
+	static constexpr float quadVertices[] =
+	{
+		-1.0f, -1.0f,  0.0f, 0.0f,
+		 1.0f, -1.0f,  1.0f, 0.0f,
+		 1.0f,  1.0f,  1.0f, 1.0f,
+		-1.0f,  1.0f,  0.0f, 1.0f
+	};
+
+	static constexpr uint32_t quadIndices[6] =
+	{
+		0, 1, 2,
+		0, 2, 3
+	};
+
+	VertexBufferLayout vertexBufferLayout =
+	{
+		{ ShaderDataType::FLOAT2, "a_position" },
+		{ ShaderDataType::FLOAT2, "a_textureCoordinates"},
+	};
+
+	m_quadVertexBuffer = createUnique<VertexBuffer>(static_cast<const void*>(quadVertices), sizeof(quadVertices), vertexBufferLayout);
+	m_quadIndexBuffer = createUnique<IndexBuffer>(quadIndices, 6);
+}
+
+void PBRDeferredRendererImplementation::uploadPointLights(const std::vector<Reference<PointLight>>& pointLights)
+{
+	m_pointLightData.clear();
+
+	for (const Reference<PointLight>& light : pointLights)
+	{
+		const PBRPointLight& pointLight = static_cast<const PBRPointLight&>(*light);
+		m_pointLightData.push_back({ pointLight.worldPosition, pointLight.lightRadius, pointLight.lightColor, pointLight.luminousPower });
+	}
+
+	if (!m_pointLightData.empty())
+		m_pointLightBuffer->setData(static_cast<const void*>(m_pointLightData.data()), sizeof(PBRRendererImplementation::PointLightData) * m_pointLightData.size());
+}
+
+void PBRDeferredRendererImplementation::setBatchMaterial(const IndirectDrawList::Batch& batch)
+{
+	const PBRMaterial& material = static_cast<const PBRMaterial&>(*batch.material);
+
+	setMaterialUniforms(material);
+
+	// Batches are sorted so that those sharing textures are next to each other, and only the first needs to bind them
+	if (batch.textureSet != m_boundTextureSet)
+	{
+		bindMaterialTextures(material);
+		m_boundTextureSet = batch.textureSet;
+	}
+}
+
+void PBRDeferredRendererImplementation::setMaterialUniforms(const PBRMaterial& material)
+{
+	m_GBufferShader->setUniformToValue("u_material.baseColor", material.baseColor);
+	m_GBufferShader->setUniformToValue("u_material.roughness", material.roughness);
+	m_GBufferShader->setUniformToValue("u_material.metalness", material.metalness);
+	m_GBufferShader->setUniformToValue("u_material.alphaCutoff", material.alphaCutoff);
+	m_GBufferShader->setUniformToValue("u_material.useAlphaTest", material.alphaMode != Material::AlphaMode::SOLID);
+}
+
+void PBRDeferredRendererImplementation::bindMaterialTextures(const PBRMaterial& material)
+{
+	if (material.baseColorMap)
+		material.baseColorMap->bind(0);
+	else
+		m_defaultBaseColorMapTexture->bind(0);
+
+	if (material.roughnessMap)
+		material.roughnessMap->bind(1);
+	else
+		m_defaultRoughnessMapTexture->bind(1);
+
+	if (material.metalnessMap)
+		material.metalnessMap->bind(2);
+	else
+		m_defaultMetalnessMapTexture->bind(2);
+
+	if (material.normalMap)
+	{
+		material.normalMap->bind(3);
+		m_GBufferShader->setUniformToValue("u_material.normalMap", 3);
+		m_GBufferShader->setUniformToValue("u_material.useNormalMap", true);
+	}
+	else
+		m_GBufferShader->setUniformToValue("u_material.useNormalMap", false);
+
+	m_GBufferShader->setUniformToValue("u_material.baseColorMap", 0);
+	m_GBufferShader->setUniformToValue("u_material.roughnessMap", 1);
+	m_GBufferShader->setUniformToValue("u_material.metalnessMap", 2);
+}
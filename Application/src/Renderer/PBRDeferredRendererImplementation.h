@@ -0,0 +1,111 @@
+#pragma once
+#include "PCH.h"
+
+#include "RendererUtilities.h"
+#include "RendererImplementation.h"
+#include "PBRRendererImplementation.h"
+#include "Framebuffer.h"
+#include "Shader.h"
+#include "Texture.h"
+#include "VertexBuffer.h"
+#include "IndexBuffer.h"
+#include "IndirectDrawList.h"
+#include "Query.h"
+#include "PointShadowAtlas.h"
+#include "ImageBasedLighting.h"
+
+/*
+Renders PBR scenes with deferred shading.
+
+The surface properties of the closest surface at each pixel are written to a compact (8 bytes per pixel, plus depth)
+single sample G-buffer. A compute shader then shades the G-buffer a 16x16 tile at a time, with each tile culling
+the point lights against its own depth range first, so each pixel evaluates the BRDF only once per light
+that can reach it (rather than for every overlapping fragment and MSAA sample, as the forward renderer does).
+
+Draws the same PBRScenes as PBRRendererImplementation, with the same BRDF and post processing. Only opaque geometry is supported.
+The G-buffer is single sampled, so the MSAA anti-aliasing modes are drawn without anti-aliasing - only the post process modes apply.
+*/
+class PBRDeferredRendererImplementation : public RendererImplementation
+{
+public:
+
+	// Matches the G-buffer outputs in GBuffer.glsl.frag
+	enum GBufferAttachment : uint32_t
+	{
+		BASE_COLOR_METALNESS = 0,
+		NORMAL_ROUGHNESS
+	};
+
+public:
+
+	PBRDeferredRendererImplementation();
+	virtual ~PBRDeferredRendererImplementation() = default;
+	PBRDeferredRendererImplementation(const PBRDeferredRendererImplementation&) = delete;
+
+	void beginScene(const Camera& camera, const std::vector<Reference<PointLight>>& pointLights) override;
+	void endScene(float exposureLevel = 1.0f) override;
+
+	void drawScene(Reference<Scene> scene, const Camera& camera) override;
+	void drawModel(Reference<Model> model, const glm::mat4& transform) override;
+
+	void setDepthPrepassEnabled(bool enabled) override { m_depthPrepassEnabled = enabled; }
+
+	void setShadedSampleCountingEnabled(bool enabled) override { m_shadedSampleCountingEnabled = enabled; }
+	uint64_t getShadedSampleCount() const override { return m_shadedSampleCount; }
+
+	void setAntiAliasingMode(AntiAliasing::Mode mode) override;
+	uint64_t getRenderTargetMemoryUsage() const override;
+
+private:
+
+	// The framebuffers each frame's render graph creates, at the window's size
+	Framebuffer::FramebufferSpecification getGBufferSpecification() const;
+	Framebuffer::FramebufferSpecification getLitHDRFramebufferSpecification() const;
+	// Only created with post process anti-aliasing, which runs on the tone mapped image
+	Framebuffer::FramebufferSpecification getLDRFramebufferSpecification() const;
+	void initialiseDefaultMaterialTextures();
+	void initialiseQuadBuffers();
+
+	void uploadPointLights(const std::vector<Reference<PointLight>>& pointLights);
+	void setBatchMaterial(const IndirectDrawList::Batch& batch);
+	void setMaterialUniforms(const PBRMaterial& material);
+	void bindMaterialTextures(const PBRMaterial& material);
+
+	void drawDepthPrepass();
+	void drawGeometryPass();
+	void drawLightingPass(const Framebuffer& GBuffer, const Framebuffer& litHDRFramebuffer);
+
+private:
+
+	Unique<AntiAliasing> m_antiAliasing;
+	Unique<IndirectDrawList> m_drawList;
+	uint32_t m_boundTextureSet = IndirectDrawList::NO_TEXTURE_SET;
+
+	bool m_depthPrepassEnabled = false;
+
+	bool m_shadedSampleCountingEnabled = false;
+	uint64_t m_shadedSampleCount = 0;
+	Unique<Query> m_shadedSampleQuery;
+
+	Unique<StorageBuffer> m_pointLightBuffer;
+	std::vector<PBRRendererImplementation::PointLightData> m_pointLightData;
+	Unique<PointShadowAtlas> m_pointShadowAtlas;
+	Unique<ImageBasedLighting> m_imageBasedLighting;
+
+	glm::mat4 m_viewMatrix = glm::mat4(1.0f);
+	glm::mat4 m_projectionMatrix = glm::mat4(1.0f);
+	glm::mat4 m_projectionViewMatrix = glm::mat4(1.0f);
+	glm::vec3 m_viewPosition = glm::vec3(0.0f);
+
+	Unique<Shader> m_GBufferShader;
+	Unique<Shader> m_depthPrepassShader;
+	Unique<Shader> m_lightingShader;
+	Unique<Shader> m_postProcessingShader;
+
+	Unique<Texture> m_defaultBaseColorMapTexture;
+	Unique<Texture> m_defaultRoughnessMapTexture;
+	Unique<Texture> m_defaultMetalnessMapTexture;
+
+	Unique<VertexBuffer> m_quadVertexBuffer;
+	Unique<IndexBuffer> m_quadIndexBuffer;
+};
@@ -1,10 +1,15 @@
 #include "PCH.h"
 #include "PBRRendererImplementation.h"
 
+#include "Core/Application.h"
+
+#include "FrameCapture.h"
+#include "GeometryArena.h"
+#include "RenderGraph.h"
+
 PBRRendererImplementation::PBRRendererImplementation()
 {
-	initialiseHDRMultisampleFramebuffer();
-	initialiseIntermediateHDRFramebuffer();
+	m_antiAliasing = createUnique<AntiAliasing>();
 
 	m_PBRShader = createUnique<Shader>(std::initializer_list<std::string>
 	{
@@ -12,120 +17,433 @@ PBRRendererImplementation::PBRRendererImplementation()
 		"Assets/Shaders/PBR.glsl.frag"
 	});
 
+	m_depthPrepassShader = createUnique<Shader>(std::initializer_list<std::string>
+	{
+		"Assets/Shaders/DepthPrepass.glsl.vert",
+		"Assets/Shaders/DepthPrepass.glsl.frag"
+	});
+
 	m_postProcessingShader = createUnique<Shader>(std::initializer_list<std::string>
 	{
 		"Assets/Shaders/PBRPostProcessing.glsl.vert",
 		"Assets/Shaders/PBRPostProcessing.glsl.frag"
 	});
 
+	m_resolvePostProcessingShader = createUnique<Shader>(std::initializer_list<std::string>
+	{
+		"Assets/Shaders/PBRPostProcessing.glsl.vert",
+		"Assets/Shaders/PBRResolvePostProcessing.glsl.frag"
+	});
+
 	initialiseDefaultMaterialTextures();
 	initialiseQuadBuffers();
 
-	Log::info("PBR renderer initialised");
+	m_drawList = createUnique<IndirectDrawList>();
+	m_lightClusterGrid = createUnique<LightClusterGrid>();
+	m_pointLightBuffer = createUnique<StorageBuffer>(sizeof(PointLightData) * 1024);
+
+	m_GPUCuller = createUnique<GPUCuller>();
+	m_pointShadowAtlas = createUnique<PointShadowAtlas>();
+	m_imageBasedLighting = createUnique<ImageBasedLighting>();
+	m_shadedSampleQuery = createUnique<Query>(Query::QueryType::SAMPLES_PASSED);
+
+	RendererLog::info("PBR renderer initialised");
 }
 
-void PBRRendererImplementation::onWindowResizeEvent(uint32_t width, uint32_t height)
+void PBRRendererImplementation::setAntiAliasingMode(AntiAliasing::Mode mode)
 {
-	m_multisampleHDRFramebuffer->onWindowResizeEvent(width, height);
-	m_intermediateHDRFramebuffer->onWindowResizeEvent(width, height);
+	// Which framebuffers are requested, and their sample counts, follow the mode from the next frame
+	m_antiAliasing->setMode(mode);
+}
+
+uint64_t PBRRendererImplementation::getRenderTargetMemoryUsage() const
+{
+	// MSAA samples are resolved as they are tone mapped, so there is no resolved HDR framebuffer
+	uint64_t memoryUsage = Framebuffer::getMemoryUsage(getHDRFramebufferSpecification()) + m_antiAliasing->getMemoryUsage();
+
+	if (m_antiAliasing->isPostProcess())
+		memoryUsage += Framebuffer::getMemoryUsage(getLDRFramebufferSpecification());
+	if (m_temporalUpscaler)
+		memoryUsage += m_temporalUpscaler->getMemoryUsage();
+
+	return memoryUsage + m_pointShadowAtlas->getMemoryUsage() + m_imageBasedLighting->getMemoryUsage();
+}
+
+void PBRRendererImplementation::setDynamicResolutionEnabled(bool enabled)
+{
+	if (enabled == static_cast<bool>(m_temporalUpscaler))
+		return;
+
+	// Temporal upscaling needs a single sample framebuffer, which is requested from the next frame
+	if (enabled)
+		m_temporalUpscaler = createUnique<TemporalUpscaler>();
+	else
+		m_temporalUpscaler.reset();
 }
 
 void PBRRendererImplementation::beginScene(const Camera& camera, const std::vector<Reference<PointLight>>& pointLights)
 {
-	Log::trace("Beginning to render a PBR scene");
+	RendererLog::trace("Beginning to render a PBR scene");
+
+	// With dynamic resolution, only the bottom left of the HDR framebuffer is drawn to, so that it isn't reallocated as the scale changes
+
+	m_renderWidth = Application::getWindow().getWidth();
+	m_renderHeight = Application::getWindow().getHeight();
+
+	if (m_temporalUpscaler)
+	{
+		m_renderWidth = static_cast<uint32_t>(std::round(static_cast<float>(m_renderWidth) * m_renderScale));
+		m_renderHeight = static_cast<uint32_t>(std::round(static_cast<float>(m_renderHeight) * m_renderScale));
+	}
+
+	// Lights are assigned to clusters with a compute shader, so this is done before the PBR shader is bound
+
+	m_lightClusterGrid->build(pointLights, camera, m_renderWidth, m_renderHeight);
+	m_lightClusterGrid->bind();
 
-	m_multisampleHDRFramebuffer->bind();
-	m_multisampleHDRFramebuffer->clear();
+	uploadPointLights(pointLights);
+	m_pointShadowAtlas->beginScene(pointLights, camera);
 
 	m_PBRShader->bind();
 
-	m_PBRShader->setUniformToValue("u_projectionViewMatrix", camera.getProjectionMatrix() * camera.getViewMatrix());
+	m_unjitteredProjectionViewMatrix = camera.getProjectionMatrix() * camera.getViewMatrix();
+	if (m_temporalUpscaler)
+		m_projectionViewMatrix = m_temporalUpscaler->getJitteredProjectionMatrix(camera.getProjectionMatrix(), m_renderWidth, m_renderHeight) * camera.getViewMatrix();
+	else
+		m_projectionViewMatrix = m_unjitteredProjectionViewMatrix;
+
+	m_PBRShader->setUniformToValue("u_projectionViewMatrix", m_projectionViewMatrix);
 	m_PBRShader->setUniformToValue("u_viewPosition", camera.getCameraPosition());
 
-	setLightUniforms(pointLights);
+	m_lightClusterGrid->setClusterUniforms(*m_PBRShader);
+	m_imageBasedLighting->bind(*m_PBRShader);
+
+	m_drawList->clear(camera.getCameraPosition());
 }
 
 void PBRRendererImplementation::endScene(float exposureLevel)
 {
-	m_multisampleHDRFramebuffer->blitToTargetFramebuffer(m_intermediateHDRFramebuffer);
+	// Shadow maps are kept from frame to frame rather than created by the graph, so they are drawn before it
+
+	m_drawList->upload();
+	m_pointShadowAtlas->drawShadowMaps(*m_drawList);
+	m_pointShadowAtlas->bind(*m_PBRShader);
 
-	m_quadVertexBuffer->bind();
-	m_quadIndexBuffer->bind();
+	RenderGraph renderGraph;
 
-	RendererUtilities::bindDefaultFramebuffer();
-	
-	m_postProcessingShader->bind();
+	RenderGraph::ResourceHandle HDRFramebuffer = renderGraph.createFramebuffer("HDR", getHDRFramebufferSpecification());
 
-	m_intermediateHDRFramebuffer->bindColorAttachment();
-	m_postProcessingShader->setUniformToValue("u_inputTexture", 0);
+	renderGraph.addPass("Scene", {}, { { HDRFramebuffer, RenderGraph::Access::ATTACHMENT } }, [this, HDRFramebuffer](RenderGraph& graph)
+	{
+		Framebuffer& framebuffer = graph.getFramebuffer(HDRFramebuffer);
+		framebuffer.setRenderSize(m_renderWidth, m_renderHeight);
+		framebuffer.bind();
+		framebuffer.clear();
+
+		m_PBRShader->bind();
+		drawBatches(framebuffer);
+	});
 
-	m_postProcessingShader->setUniformToValue("u_exposure", exposureLevel);
+	// Dynamic resolution frames are accumulated at the window's size, and the result is tone mapped. The upscaler
+	// keeps its output as the next frame's history, so it is imported rather than created by the graph
 
-	RendererUtilities::drawIndexed(m_quadIndexBuffer->getCount());
+	RenderGraph::ResourceHandle toneMappingInput = HDRFramebuffer;
+
+	if (m_temporalUpscaler)
+	{
+		RenderGraph::ResourceHandle upscaledFramebuffer = renderGraph.importFramebuffer("Temporal upscaling output", m_temporalUpscaler->getNextOutput());
+
+		renderGraph.addPass("Temporal upscaling", { { HDRFramebuffer, RenderGraph::Access::TEXTURE } }, { { upscaledFramebuffer, RenderGraph::Access::ATTACHMENT } }, [this, HDRFramebuffer](RenderGraph& graph)
+		{
+			m_temporalUpscaler->draw(graph.getFramebuffer(HDRFramebuffer), m_unjitteredProjectionViewMatrix);
+		});
 
-	Log::trace("Ended the rendering of a PBR scene");
+		toneMappingInput = upscaledFramebuffer;
+	}
+
+	// Post process anti-aliasing runs on the tone mapped image, so it is drawn to the LDR framebuffer first
+
+	RenderGraph::ResourceHandle toneMappingOutput = RenderGraph::DEFAULT_FRAMEBUFFER;
+	if (m_antiAliasing->isPostProcess())
+		toneMappingOutput = renderGraph.createFramebuffer("LDR", getLDRFramebufferSpecification());
+
+	// MSAA samples are tone mapped one by one and then averaged, in the same pass, rather than resolved beforehand
+	bool resolveWhileToneMapping = getHDRFramebufferSpecification().samples > 1;
+	RenderGraph::Access toneMappingInputAccess = resolveWhileToneMapping ? RenderGraph::Access::SAMPLES : RenderGraph::Access::TEXTURE;
+
+	renderGraph.addPass("Tone mapping", { { toneMappingInput, toneMappingInputAccess } }, { { toneMappingOutput, RenderGraph::Access::ATTACHMENT } }, [this, toneMappingInput, toneMappingOutput, exposureLevel, resolveWhileToneMapping](RenderGraph& graph)
+	{
+		graph.bindFramebuffer(toneMappingOutput);
+
+		m_quadVertexBuffer->bind();
+		m_quadIndexBuffer->bind();
+
+		const Framebuffer& inputFramebuffer = graph.getFramebuffer(toneMappingInput);
+		inputFramebuffer.bindColorAttachment();
+
+		// The resolving shader reads the pixel under each fragment, so doesn't use the texture coordinates
+		Shader& shader = resolveWhileToneMapping ? *m_resolvePostProcessingShader : *m_postProcessingShader;
+		shader.bind();
+
+		shader.setUniformToValue("u_inputTexture", 0);
+		if (resolveWhileToneMapping)
+			shader.setUniformToValue("u_sampleCount", inputFramebuffer.getSpecification().samples);
+		else
+			shader.setUniformToValue("u_textureCoordinatesScale", inputFramebuffer.getTextureCoordinatesScale());
+
+		shader.setUniformToValue("u_exposure", exposureLevel);
+
+		RendererUtilities::drawIndexed(m_quadIndexBuffer->getCount());
+	});
+
+	if (m_antiAliasing->isPostProcess())
+	{
+		renderGraph.addPass("Anti-aliasing", { { toneMappingOutput, RenderGraph::Access::TEXTURE } }, { { RenderGraph::DEFAULT_FRAMEBUFFER, RenderGraph::Access::ATTACHMENT } }, [this, toneMappingOutput](RenderGraph& graph)
+		{
+			m_antiAliasing->draw(graph.getFramebuffer(toneMappingOutput));
+		});
+	}
+
+	// The upscaled image is captured when there is one, though its depth is only in the HDR framebuffer
+	if (FrameCapture* frameCapture = getFrameCapture())
+		frameCapture->addAttachmentCapturePass(renderGraph, toneMappingInput, HDRFramebuffer);
+
+	renderGraph.compile();
+	renderGraph.execute();
+
+	RendererLog::trace("Ended the rendering of a PBR scene");
 }
 
 void PBRRendererImplementation::drawScene(Reference<Scene> scene, const Camera& camera)
 {
-	Log::trace("Drawing PBR scene");
+	RendererLog::trace("Drawing PBR scene");
+
+	Reference<PBRScene> physicallyBasedScene = std::static_pointer_cast<PBRScene>(scene);
+	m_imageBasedLighting->setEnvironmentMap(physicallyBasedScene->getEnvironmentMap(), physicallyBasedScene->getEnvironmentIntensity());
 
 	beginScene(camera, scene->getPointLights());
 
-	for (auto modelAndTransform : scene->getModelsAndTransforms())
-		drawModel(modelAndTransform.first, modelAndTransform.second);
+	const auto& modelsAndTransforms = scene->getModelsAndTransforms();
+	for (uint32_t i = 0; i < static_cast<uint32_t>(modelsAndTransforms.size()); i++)
+	{
+		if (isModelVisible(i))
+			drawModel(modelsAndTransforms[i].first, modelsAndTransforms[i].second);
+	}
 
-	float exposure = std::static_pointer_cast<PBRScene>(scene)->getExposureLevel();
-	endScene(exposure);
+	endScene(physicallyBasedScene->getExposureLevel());
 }
 
 void PBRRendererImplementation::drawModel(Reference<Model> model, const glm::mat4& transform)
 {
-	Log::trace("Drawing PBR model {0} with {1} meshes", model->getModelIdentifier(), static_cast<uint32_t>(model->getMeshes().size()));
+	RendererLog::trace("Drawing PBR model {0} with {1} meshes", model->getModelIdentifier(), static_cast<uint32_t>(model->getMeshes().size()));
 
-	model->getVertexBuffer()->bind();
-	model->getIndexBuffer()->bind();
+	// Draws are deferred until endScene so that the meshes of all models can be batched by material
+	m_drawList->addModel(model, transform);
+}
 
-	const std::vector<Reference<Material>>& materials = model->getMaterials();
-	const auto& materialToMeshMapping = model->getMaterialToMeshMapping();
-	const std::vector<Model::Mesh>& meshes = model->getMeshes();
+void PBRRendererImplementation::drawBatches(const Framebuffer& HDRFramebuffer)
+{
+	GeometryArena::bind();
+	m_drawList->bind();
 
-	for (uint32_t i = 0; i < materials.size(); i++)
+	if (m_GPUCullingEnabled)
 	{
-		const PBRMaterial& material = static_cast<const PBRMaterial&>(*materials[i]);
-		setMaterialUniforms(material);
+		drawBatchesWithGPUCulling(HDRFramebuffer);
+		return;
+	}
 
-		const std::vector<uint32_t>& meshesForTheCurrentMaterial = materialToMeshMapping.at(i);
+	if (m_depthPrepassEnabled)
+	{
+		drawDepthPrepass();
 
-		for (uint32_t meshIndex : meshesForTheCurrentMaterial)
-		{
-			const Model::Mesh& mesh = meshes[meshIndex];
+		GeometryArena::bind();
+		m_PBRShader->bind();
+	}
 
-			glm::mat4 meshTransform = transform * mesh.transform;
-			m_PBRShader->setUniformToValue("u_transform", meshTransform);
+	beginMainPass();
 
-			const void* startOfIndices = reinterpret_cast<const void*>(static_cast<uint64_t>(sizeof(uint32_t)) * static_cast<uint64_t>(mesh.baseIndex));
-			RendererUtilities::drawIndexedFromVertexOffset(mesh.indexCount, startOfIndices, mesh.baseVertex);
-		}
+	m_boundTextureSet = IndirectDrawList::NO_TEXTURE_SET;
+
+	const std::vector<IndirectDrawList::Batch>& batches = m_drawList->getBatches();
+
+	for (uint32_t i = 0; i < static_cast<uint32_t>(batches.size()); i++)
+	{
+		if (i == 0 || batches[i].pass != batches[i - 1].pass)
+			setPassState(batches[i].pass, m_depthPrepassEnabled);
+
+		setBatchMaterial(batches[i]);
+
+		RendererUtilities::multiDrawIndexedIndirect(IndirectDrawList::getCommandOffset(batches[i]), batches[i].drawCount, m_drawList->getBatchCommands(batches[i]));
 	}
+
+	endMainPass();
 }
 
-void PBRRendererImplementation::initialiseHDRMultisampleFramebuffer()
+void PBRRendererImplementation::drawBatchesWithGPUCulling(const Framebuffer& HDRFramebuffer)
 {
-	Framebuffer::FramebufferSpecification multisampleHDRFramebufferSpecification;
-	multisampleHDRFramebufferSpecification.colorAttachmentFormat = Framebuffer::ColorAttachmentFormat::RGBA16F;
-	multisampleHDRFramebufferSpecification.samples = 8;
-	multisampleHDRFramebufferSpecification.clearColor = { 0.1f, 0.1f, 0.1f, 1.0f };
+	// Draw everything which was visible against the previous frame's depth
+
+	// With the depth pre-pass, only depth is drawn until both phases have been culled, and then the
+	// visible draws of both phases are shaded. Otherwise, each phase is shaded as soon as it is culled
 
-	m_multisampleHDRFramebuffer = createUnique<Framebuffer>(multisampleHDRFramebufferSpecification);
+	m_GPUCuller->cull(*m_drawList, m_projectionViewMatrix, GPUCuller::Phase::EARLY);
+
+	if (m_depthPrepassEnabled)
+		drawCulledDepthPrepass(GPUCuller::Phase::EARLY);
+	else
+	{
+		beginMainPass();
+		drawCulledBatches(GPUCuller::Phase::EARLY);
+	}
+
+	// Then test what was hidden against the depth drawn so far this frame, to catch anything that has just come into view
+
+	m_GPUCuller->buildDepthPyramid(HDRFramebuffer, m_projectionViewMatrix);
+
+	m_GPUCuller->cull(*m_drawList, m_projectionViewMatrix, GPUCuller::Phase::LATE);
+
+	if (m_depthPrepassEnabled)
+	{
+		drawCulledDepthPrepass(GPUCuller::Phase::LATE);
+
+		beginMainPass();
+		drawCulledBatches(GPUCuller::Phase::EARLY);
+	}
+
+	drawCulledBatches(GPUCuller::Phase::LATE);
+
+	// Culled commands are compacted out of order, so blended batches are drawn unculled to keep them back to front
+	drawBlendedBatches();
+	endMainPass();
+
+	if (m_GPUCullingDebugReadbackEnabled)
+	{
+		m_GPUCullingVisibleDrawCount = m_GPUCuller->readBackVisibleDrawCount();
+		RendererLog::trace("GPU culling left {0} of {1} draws visible", m_GPUCullingVisibleDrawCount, m_drawList->getDrawCount());
+	}
+}
+
+void PBRRendererImplementation::drawCulledBatches(GPUCuller::Phase phase)
+{
+	// Culling binds its own compute shaders, so the PBR shader needs binding again
+	GeometryArena::bind();
+	m_PBRShader->bind();
+	m_GPUCuller->bind();
+
+	const std::vector<IndirectDrawList::Batch>& batches = m_drawList->getBatches();
+	m_boundTextureSet = IndirectDrawList::NO_TEXTURE_SET;
+
+	for (uint32_t i = 0; i < static_cast<uint32_t>(batches.size()); i++)
+	{
+		if (batches[i].pass == RenderQueue::Pass::BLENDED)
+			break;
+
+		if (i == 0 || batches[i].pass != batches[i - 1].pass)
+			setPassState(batches[i].pass, m_depthPrepassEnabled);
+
+		setBatchMaterial(batches[i]);
+
+		RendererUtilities::multiDrawIndexedIndirectCount(m_GPUCuller->getCommandOffset(phase, batches[i]), m_GPUCuller->getDrawCountOffset(phase, i), batches[i].drawCount, m_drawList->getBatchCommands(batches[i]));
+	}
+}
+
+void PBRRendererImplementation::drawBlendedBatches()
+{
+	GeometryArena::bind();
+	m_drawList->bind();
+	m_PBRShader->bind();
+
+	setPassState(RenderQueue::Pass::BLENDED, m_depthPrepassEnabled);
+
+	for (const IndirectDrawList::Batch& batch : m_drawList->getBatches())
+	{
+		if (batch.pass != RenderQueue::Pass::BLENDED)
+			continue;
+
+		setBatchMaterial(batch);
+
+		RendererUtilities::multiDrawIndexedIndirect(IndirectDrawList::getCommandOffset(batch), batch.drawCount, m_drawList->getBatchCommands(batch));
+	}
+}
+
+void PBRRendererImplementation::drawDepthPrepass()
+{
+	GeometryArena::bindPositions();
+
+	m_depthPrepassShader->bind();
+	m_depthPrepassShader->setUniformToValue("u_projectionViewMatrix", m_projectionViewMatrix);
+
+	RendererUtilities::setColorWriteEnabled(false);
+
+	// Materials don't affect the depth of solid geometry, so its batches (which come first) can all be drawn at once
+	RendererUtilities::multiDrawIndexedIndirect(nullptr, m_drawList->getSolidDrawCount(), m_drawList->getCommands().data());
+
+	RendererUtilities::setColorWriteEnabled(true);
+
+	RendererLog::trace("Drew depth pre-pass of {0} draws", m_drawList->getSolidDrawCount());
+}
+
+void PBRRendererImplementation::drawCulledDepthPrepass(GPUCuller::Phase phase)
+{
+	GeometryArena::bindPositions();
+
+	m_depthPrepassShader->bind();
+	m_depthPrepassShader->setUniformToValue("u_projectionViewMatrix", m_projectionViewMatrix);
+	m_GPUCuller->bind();
+
+	RendererUtilities::setColorWriteEnabled(false);
+
+	// The culled commands are compacted within each batch, so each batch still needs its own draw. Only solid
+	// batches are in the pre-pass, and they come first
+	const std::vector<IndirectDrawList::Batch>& batches = m_drawList->getBatches();
+	for (uint32_t i = 0; i < static_cast<uint32_t>(batches.size()) && batches[i].pass == RenderQueue::Pass::SOLID; i++)
+		RendererUtilities::multiDrawIndexedIndirectCount(m_GPUCuller->getCommandOffset(phase, batches[i]), m_GPUCuller->getDrawCountOffset(phase, i), batches[i].drawCount, m_drawList->getBatchCommands(batches[i]));
+
+	RendererUtilities::setColorWriteEnabled(true);
+
+	RendererLog::trace("Drew culled depth pre-pass ({0} phase)", phase == GPUCuller::Phase::EARLY ? "early" : "late");
+}
+
+void PBRRendererImplementation::beginMainPass()
+{
+	if (m_shadedSampleCountingEnabled)
+		m_shadedSampleQuery->begin();
+}
+
+void PBRRendererImplementation::endMainPass()
+{
+	if (m_shadedSampleCountingEnabled)
+	{
+		m_shadedSampleQuery->end();
+		m_shadedSampleCount = m_shadedSampleQuery->getResult();
+
+		RendererLog::trace("Shaded {0} samples in the main pass (depth pre-pass {1})", m_shadedSampleCount, m_depthPrepassEnabled ? "enabled" : "disabled");
+	}
+
+	resetPassState();
+}
+
+Framebuffer::FramebufferSpecification PBRRendererImplementation::getHDRFramebufferSpecification() const
+{
+	Framebuffer::FramebufferSpecification HDRFramebufferSpecification;
+	HDRFramebufferSpecification.width = Application::getWindow().getWidth();
+	HDRFramebufferSpecification.height = Application::getWindow().getHeight();
+	HDRFramebufferSpecification.colorAttachmentFormats = { Framebuffer::ColorAttachmentFormat::RGBA16F };
+	// Temporal upscaling anti-aliases the scene itself, and can't read multisampled depth
+	HDRFramebufferSpecification.samples = m_temporalUpscaler ? 1 : m_antiAliasing->getSampleCount();
+	HDRFramebufferSpecification.clearColor = { 0.1f, 0.1f, 0.1f, 1.0f };
+
+	return HDRFramebufferSpecification;
 }
 
-void PBRRendererImplementation::initialiseIntermediateHDRFramebuffer()
+Framebuffer::FramebufferSpecification PBRRendererImplementation::getLDRFramebufferSpecification() const
 {
-	Framebuffer::FramebufferSpecification intermediateHDRFramebufferSpecification;
-	intermediateHDRFramebufferSpecification.colorAttachmentFormat = Framebuffer::ColorAttachmentFormat::RGBA16F;
+	Framebuffer::FramebufferSpecification LDRFramebufferSpecification;
+	LDRFramebufferSpecification.width = Application::getWindow().getWidth();
+	LDRFramebufferSpecification.height = Application::getWindow().getHeight();
+	LDRFramebufferSpecification.depthAttachmentFormat = Framebuffer::DepthAttachmentFormat::NONE;
 
-	m_intermediateHDRFramebuffer = createReference<Framebuffer>(intermediateHDRFramebufferSpecification);
+	return LDRFramebufferSpecification;
 }
 
 void PBRRendererImplementation::initialiseDefaultMaterialTextures()
@@ -164,18 +482,35 @@ void PBRRendererImplementation::initialiseQuadBuffers()
 	m_quadIndexBuffer = createUnique<IndexBuffer>(quadIndices, 6);
 }
 
-void PBRRendererImplementation::setLightUniforms(const std::vector<Reference<PointLight>>& pointLights)
+void PBRRendererImplementation::uploadPointLights(const std::vector<Reference<PointLight>>& pointLights)
 {
-	m_PBRShader->setUniformToValue("u_pointLightNumber", static_cast<uint32_t>(pointLights.size()));
+	// Lights are in the same order as they were given to the cluster grid, as that is how the clusters refer to them
+
+	m_pointLightData.clear();
 
-	for (uint32_t i = 0; i < static_cast<uint32_t>(pointLights.size()); i++)
+	for (const Reference<PointLight>& light : pointLights)
 	{
-		const PBRPointLight& pointLight = static_cast<const PBRPointLight&>(*pointLights[i]);
-		std::string uniformName = "u_pointLights[" + std::to_string(i) + "]";
-		m_PBRShader->setUniformToValue(uniformName + ".worldPosition", pointLight.worldPosition);
-		m_PBRShader->setUniformToValue(uniformName + ".lightColor", pointLight.lightColor);
-		m_PBRShader->setUniformToValue(uniformName + ".luminousPower", pointLight.luminousPower);
-		m_PBRShader->setUniformToValue(uniformName + ".lightRadius", pointLight.lightRadius);
+		const PBRPointLight& pointLight = static_cast<const PBRPointLight&>(*light);
+		m_pointLightData.push_back({ pointLight.worldPosition, pointLight.lightRadius, pointLight.lightColor, pointLight.luminousPower });
+	}
+
+	if (!m_pointLightData.empty())
+		m_pointLightBuffer->setData(static_cast<const void*>(m_pointLightData.data()), sizeof(PointLightData) * m_pointLightData.size());
+
+	m_pointLightBuffer->bind(LightClusterGrid::POINT_LIGHTS_BINDING_POINT);
+}
+
+void PBRRendererImplementation::setBatchMaterial(const IndirectDrawList::Batch& batch)
+{
+	const PBRMaterial& material = static_cast<const PBRMaterial&>(*batch.material);
+
+	setMaterialUniforms(material);
+
+	// Batches are sorted so that those sharing textures are next to each other, and only the first needs to bind them
+	if (batch.textureSet != m_boundTextureSet)
+	{
+		bindMaterialTextures(material);
+		m_boundTextureSet = batch.textureSet;
 	}
 }
 
@@ -184,7 +519,12 @@ void PBRRendererImplementation::setMaterialUniforms(const PBRMaterial& material)
 	m_PBRShader->setUniformToValue("u_material.baseColor", material.baseColor);
 	m_PBRShader->setUniformToValue("u_material.roughness", material.roughness);
 	m_PBRShader->setUniformToValue("u_material.metalness", material.metalness);
+	m_PBRShader->setUniformToValue("u_material.alphaCutoff", material.alphaCutoff);
+	m_PBRShader->setUniformToValue("u_material.useAlphaTest", material.alphaMode == Material::AlphaMode::MASK);
+}
 
+void PBRRendererImplementation::bindMaterialTextures(const PBRMaterial& material)
+{
 	if (material.baseColorMap)
 		material.baseColorMap->bind(0);
 	else
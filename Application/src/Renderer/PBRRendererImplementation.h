@@ -8,39 +8,121 @@
 #include "Texture.h"
 #include "VertexBuffer.h"
 #include "IndexBuffer.h"
+#include "IndirectDrawList.h"
+#include "GPUCuller.h"
+#include "Query.h"
+#include "LightClusterGrid.h"
+#include "TemporalUpscaler.h"
+#include "PointShadowAtlas.h"
+#include "ImageBasedLighting.h"
 
 class PBRRendererImplementation : public RendererImplementation
 {
+public:
+
+	// Matches the PointLight struct in PBR.glsl.frag and DeferredLighting.glsl.comp (std430 layout)
+	struct PointLightData
+	{
+		glm::vec3 worldPosition;
+		float lightRadius;
+		glm::vec3 lightColor;
+		float luminousPower;
+	};
+
 public:
 
 	PBRRendererImplementation();
 	virtual ~PBRRendererImplementation() = default;
 	PBRRendererImplementation(const PBRRendererImplementation&) = delete;
 
-	void onWindowResizeEvent(uint32_t width, uint32_t height) override;
-
 	void beginScene(const Camera& camera, const std::vector<Reference<PointLight>>& pointLights) override;
 	void endScene(float exposureLevel = 1.0f) override;
 
 	void drawScene(Reference<Scene> scene, const Camera& camera) override;
 	void drawModel(Reference<Model> model, const glm::mat4& transform) override;
 
+	void setDepthPrepassEnabled(bool enabled) override { m_depthPrepassEnabled = enabled; }
+
+	void setShadedSampleCountingEnabled(bool enabled) override { m_shadedSampleCountingEnabled = enabled; }
+	uint64_t getShadedSampleCount() const override { return m_shadedSampleCount; }
+
+	void setGPUCullingEnabled(bool enabled) { m_GPUCullingEnabled = enabled; }
+	void setGPUCullingDebugReadbackEnabled(bool enabled) { m_GPUCullingDebugReadbackEnabled = enabled; }
+	// Only updated while debug readback is enabled
+	uint32_t getGPUCullingVisibleDrawCount() const { return m_GPUCullingVisibleDrawCount; }
+
+	void setAntiAliasingMode(AntiAliasing::Mode mode) override;
+	uint64_t getRenderTargetMemoryUsage() const override;
+
+	// Draws the scene at a fraction of the window's size (given by the render scale) and upscales it temporally
+	void setDynamicResolutionEnabled(bool enabled);
+	void setRenderScale(float renderScale) { m_renderScale = renderScale; }
+	// 1 while dynamic resolution is disabled
+	float getRenderScale() const { return m_temporalUpscaler ? m_renderScale : 1.0f; }
+
 private:
 
-	void initialiseHDRMultisampleFramebuffer();
-	void initialiseIntermediateHDRFramebuffer();
+	// The framebuffers each frame's render graph creates, at the window's size. The HDR framebuffer is multisampled for MSAA
+	// modes (and resolved as it is tone mapped), and the LDR framebuffer is only created for post process anti-aliasing
+	Framebuffer::FramebufferSpecification getHDRFramebufferSpecification() const;
+	Framebuffer::FramebufferSpecification getLDRFramebufferSpecification() const;
 	void initialiseDefaultMaterialTextures();
 	void initialiseQuadBuffers();
 
-	void setLightUniforms(const std::vector<Reference<PointLight>>& pointLights);
+	void uploadPointLights(const std::vector<Reference<PointLight>>& pointLights);
+	void setBatchMaterial(const IndirectDrawList::Batch& batch);
 	void setMaterialUniforms(const PBRMaterial& material);
+	void bindMaterialTextures(const PBRMaterial& material);
+
+	// The HDR framebuffer's depth is what GPU culling tests against
+	void drawBatches(const Framebuffer& HDRFramebuffer);
+	void drawBatchesWithGPUCulling(const Framebuffer& HDRFramebuffer);
+	void drawCulledBatches(GPUCuller::Phase phase);
+	void drawBlendedBatches();
+
+	void drawDepthPrepass();
+	void drawCulledDepthPrepass(GPUCuller::Phase phase);
+
+	void beginMainPass();
+	void endMainPass();
 
 private:
 
-	Unique<Framebuffer> m_multisampleHDRFramebuffer;
-	Reference<Framebuffer> m_intermediateHDRFramebuffer;
+	Unique<AntiAliasing> m_antiAliasing;
+	// The size the scene is drawn at this frame. The HDR framebuffer is always created at the window's size, with
+	// dynamic resolution drawing to a smaller render size within it
+	uint32_t m_renderWidth = 0, m_renderHeight = 0;
+	// Only used with dynamic resolution
+	Unique<TemporalUpscaler> m_temporalUpscaler;
+	float m_renderScale = 1.0f;
+	Unique<IndirectDrawList> m_drawList;
+	uint32_t m_boundTextureSet = IndirectDrawList::NO_TEXTURE_SET;
+
+	bool m_depthPrepassEnabled = false;
+
+	bool m_shadedSampleCountingEnabled = false;
+	uint64_t m_shadedSampleCount = 0;
+	Unique<Query> m_shadedSampleQuery;
+
+	Unique<LightClusterGrid> m_lightClusterGrid;
+	Unique<StorageBuffer> m_pointLightBuffer;
+	std::vector<PointLightData> m_pointLightData;
+
+	Unique<GPUCuller> m_GPUCuller;
+	Unique<PointShadowAtlas> m_pointShadowAtlas;
+	Unique<ImageBasedLighting> m_imageBasedLighting;
+	bool m_GPUCullingEnabled = true;
+	bool m_GPUCullingDebugReadbackEnabled = false;
+	uint32_t m_GPUCullingVisibleDrawCount = 0;
+	// Jittered while dynamic resolution is enabled, with the unjittered matrix kept for reprojection
+	glm::mat4 m_projectionViewMatrix = glm::mat4(1.0f);
+	glm::mat4 m_unjitteredProjectionViewMatrix = glm::mat4(1.0f);
+
 	Unique<Shader> m_PBRShader;
+	Unique<Shader> m_depthPrepassShader;
 	Unique<Shader> m_postProcessingShader;
+	// Post processing for a multisampled HDR framebuffer, which resolves it too
+	Unique<Shader> m_resolvePostProcessingShader;
 
 	Unique<Texture> m_defaultBaseColorMapTexture;
 	Unique<Texture> m_defaultRoughnessMapTexture;
@@ -0,0 +1,441 @@
+#include "PCH.h"
+#include "PointShadowAtlas.h"
+
+#include "glad/glad.h"
+#include "glm/gtc/matrix_transform.hpp"
+
+#include "Core/Profiler.h"
+
+#include "GLStateCache.h"
+#include "GeometryArena.h"
+
+static constexpr uint32_t INITIAL_SHADOW_COMMAND_CAPACITY = 1024;
+
+// Cube maps store the distance to the light over its radius, so 16 bits of depth go as far as every light's radius does
+static constexpr GLenum SHADOW_MAP_FORMAT = GL_DEPTH_COMPONENT16;
+static constexpr uint32_t SHADOW_MAP_BYTES_PER_TEXEL = 2;
+
+// Lights covering at least this fraction of the screen's height get each tier (the rest get the last)
+static constexpr std::array<float, PointShadowAtlas::TIER_COUNT - 1> TIER_SCREEN_COVERAGES = { 0.25f, 0.05f };
+
+// Depth bias in texels, as the depth error of a surface grows with the size of a texel
+static constexpr float DEPTH_BIAS_TEXELS = 2.0f;
+
+PointShadowAtlas::PointShadowAtlas()
+{
+	m_shadowShader = createUnique<Shader>(std::initializer_list<std::string>
+	{
+		"Assets/Shaders/PointShadow.glsl.vert",
+		"Assets/Shaders/PointShadow.glsl.geom",
+		"Assets/Shaders/PointShadow.glsl.frag"
+	});
+
+	m_shadowCommandBuffer = createUnique<IndirectBuffer>(INITIAL_SHADOW_COMMAND_CAPACITY);
+	m_pointLightShadowBuffer = createUnique<StorageBuffer>(sizeof(PointLightShadowData) * 1024);
+
+	createShadowMaps();
+
+	RendererLog::info("Point shadow atlas initialised with {0} bytes of cube maps", getMemoryUsage());
+}
+
+PointShadowAtlas::~PointShadowAtlas()
+{
+	deleteShadowMaps();
+}
+
+void PointShadowAtlas::beginScene(const std::vector<Reference<PointLight>>& pointLights, const Camera& camera)
+{
+	glm::mat4 projectionMatrix = camera.getProjectionMatrix();
+	glm::mat4 projectionViewMatrix = projectionMatrix * camera.getViewMatrix();
+
+	m_pointLights = pointLights;
+
+	m_screenCoverages.clear();
+	for (const Reference<PointLight>& light : pointLights)
+		m_screenCoverages.push_back(getScreenCoverage(*light, projectionViewMatrix, projectionMatrix, camera.getCameraPosition()));
+}
+
+void PointShadowAtlas::drawShadowMaps(const IndirectDrawList& drawList)
+{
+	PROFILE_GPU_SCOPE("Point light shadow maps");
+
+	// Find the lights whose cube maps are out of date
+
+	std::vector<RefreshCandidate> refreshCandidates;
+
+	for (uint32_t i = 0; i < static_cast<uint32_t>(m_pointLights.size()); i++)
+	{
+		const Reference<PointLight>& light = m_pointLights[i];
+		float screenCoverage = m_screenCoverages[i];
+
+		auto it = m_shadowMaps.find(light->identifier);
+		if (it != m_shadowMaps.end())
+			it->second.lastSeenFrame = m_frameIndex;
+
+		// Lights that can't be seen can wait until they can be
+		if (screenCoverage == 0.0f)
+			continue;
+
+		uint32_t tier = getTier(screenCoverage);
+		uint64_t drawSignature = getDrawSignature(drawList, *light);
+
+		if (it != m_shadowMaps.end())
+		{
+			const CachedShadowMap& shadowMap = it->second;
+			if (shadowMap.requestedTier == tier && shadowMap.lightPosition == light->worldPosition && shadowMap.lightRadius == light->lightRadius && shadowMap.drawSignature == drawSignature)
+				continue;
+		}
+
+		refreshCandidates.push_back({ light.get(), tier, screenCoverage, it != m_shadowMaps.end(), drawSignature });
+	}
+
+	// Lights no longer in the scene give up their cube maps
+
+	for (auto it = m_shadowMaps.begin(); it != m_shadowMaps.end();)
+	{
+		if (it->second.lastSeenFrame != m_frameIndex)
+		{
+			freeCubeMap(it->second);
+			it = m_shadowMaps.erase(it);
+		}
+		else
+			++it;
+	}
+
+	std::sort(refreshCandidates.begin(), refreshCandidates.end(), [](const RefreshCandidate& a, const RefreshCandidate& b)
+	{
+		if (a.hasShadowMap != b.hasShadowMap)
+			return !a.hasShadowMap;
+
+		return a.screenCoverage > b.screenCoverage;
+	});
+
+	uint32_t outOfDateCount = static_cast<uint32_t>(refreshCandidates.size());
+	if (refreshCandidates.size() > m_refreshBudget)
+		refreshCandidates.resize(m_refreshBudget);
+
+	// Gather the solid draws inside each light being refreshed, so they can all be uploaded at once
+
+	m_shadowCommands.clear();
+	std::vector<std::pair<uint32_t, uint32_t>> commandRanges;
+
+	const std::vector<DrawElementsIndirectCommand>& commands = drawList.getCommands();
+	const std::vector<IndirectDrawList::DrawData>& drawData = drawList.getDrawData();
+	const std::vector<IndirectDrawList::DrawBounds>& drawBounds = drawList.getDrawBounds();
+
+	for (const RefreshCandidate& candidate : refreshCandidates)
+	{
+		uint32_t firstCommand = static_cast<uint32_t>(m_shadowCommands.size());
+
+		for (uint32_t i = 0; i < drawList.getSolidDrawCount(); i++)
+		{
+			if (isDrawInsideLight(drawBounds[i], drawData[i].transform, *candidate.light))
+				m_shadowCommands.push_back(commands[i]);
+		}
+
+		commandRanges.push_back({ firstCommand, static_cast<uint32_t>(m_shadowCommands.size()) - firstCommand });
+	}
+
+	if (!m_shadowCommands.empty())
+		m_shadowCommandBuffer->setData(m_shadowCommands.data(), static_cast<uint32_t>(m_shadowCommands.size()));
+
+	// Draw the refreshed cube maps. Draws keep their base instance, so still find their transforms in the draw list's draw data
+
+	m_refreshedCount = 0;
+
+	if (!refreshCandidates.empty())
+	{
+		drawList.bind();
+		m_shadowCommandBuffer->bind();
+		GeometryArena::bindPositions();
+
+		m_shadowShader->bind();
+
+		// Cube faces are seen from inside, so both sides of each triangle are drawn rather than working out which are back faces
+		RendererUtilities::setFaceCullingEnabled(false);
+	}
+
+	for (uint32_t i = 0; i < static_cast<uint32_t>(refreshCandidates.size()); i++)
+	{
+		const RefreshCandidate& candidate = refreshCandidates[i];
+
+		auto it = m_shadowMaps.find(candidate.light->identifier);
+
+		// Moving to another tier needs a cube map in that tier, which is allocated before the old one is freed,
+		// so that the light keeps a shadow if there is no room
+		CachedShadowMap shadowMap = {};
+		if (it != m_shadowMaps.end() && it->second.tier == candidate.tier)
+			shadowMap = it->second;
+		else if (allocateCubeMap(candidate.tier, shadowMap))
+		{
+			if (it != m_shadowMaps.end())
+				freeCubeMap(it->second);
+		}
+		else if (it != m_shadowMaps.end())
+			shadowMap = it->second;
+		else
+			continue;
+
+		// Kept even if the cube map is in a lower tier, so that a full tier doesn't cause a refresh every frame
+		shadowMap.requestedTier = candidate.tier;
+		shadowMap.lightPosition = candidate.light->worldPosition;
+		shadowMap.lightRadius = candidate.light->lightRadius;
+		shadowMap.drawSignature = candidate.drawSignature;
+		shadowMap.lastSeenFrame = m_frameIndex;
+
+		drawShadowMap(*candidate.light, shadowMap, commandRanges[i].first, commandRanges[i].second);
+		m_shadowMaps[candidate.light->identifier] = shadowMap;
+
+		m_refreshedCount++;
+	}
+
+	if (!refreshCandidates.empty())
+		RendererUtilities::setFaceCullingEnabled(true);
+
+	// Upload every light's shadow, in the order of the lights
+
+	m_pointLightShadowData.clear();
+
+	for (const Reference<PointLight>& light : m_pointLights)
+	{
+		auto it = m_shadowMaps.find(light->identifier);
+		if (it == m_shadowMaps.end())
+		{
+			m_pointLightShadowData.push_back({ NO_SHADOW_MAP, 0, 0.0f, 0.0f });
+			continue;
+		}
+
+		const CachedShadowMap& shadowMap = it->second;
+		float depthBias = DEPTH_BIAS_TEXELS / static_cast<float>(TIER_RESOLUTIONS[shadowMap.tier]);
+		m_pointLightShadowData.push_back({ static_cast<int32_t>(shadowMap.tier), static_cast<int32_t>(shadowMap.cubeMapIndex), depthBias, 0.0f });
+	}
+
+	if (!m_pointLightShadowData.empty())
+		m_pointLightShadowBuffer->setData(static_cast<const void*>(m_pointLightShadowData.data()), sizeof(PointLightShadowData) * m_pointLightShadowData.size());
+
+	RendererLog::trace("Refreshed {0} point light shadow maps ({1} out of date, {2} cached)", m_refreshedCount, outOfDateCount, m_shadowMaps.size());
+
+	// The lights aren't needed until the next scene, and shouldn't be kept alive until then
+	m_pointLights.clear();
+
+	m_frameIndex++;
+}
+
+void PointShadowAtlas::bind(Shader& shader) const
+{
+	m_pointLightShadowBuffer->bind(POINT_LIGHT_SHADOWS_BINDING_POINT);
+
+	for (uint32_t tier = 0; tier < TIER_COUNT; tier++)
+	{
+		GLStateCache::bindTextureUnit(SHADOW_MAP_TEXTURE_SLOT + tier, m_cubeMapArrayRendererIDs[tier]);
+		shader.setUniformToValue("u_pointShadowMaps" + std::to_string(tier), static_cast<int32_t>(SHADOW_MAP_TEXTURE_SLOT + tier));
+	}
+}
+
+uint64_t PointShadowAtlas::getMemoryUsage() const
+{
+	uint64_t memoryUsage = 0;
+	for (uint32_t tier = 0; tier < TIER_COUNT; tier++)
+		memoryUsage += static_cast<uint64_t>(TIER_RESOLUTIONS[tier]) * TIER_RESOLUTIONS[tier] * 6 * TIER_CAPACITIES[tier] * SHADOW_MAP_BYTES_PER_TEXEL;
+
+	return memoryUsage;
+}
+
+void PointShadowAtlas::createShadowMaps()
+{
+	for (uint32_t tier = 0; tier < TIER_COUNT; tier++)
+	{
+		RendererID& cubeMapArrayRendererID = m_cubeMapArrayRendererIDs[tier];
+
+		glCreateTextures(GL_TEXTURE_CUBE_MAP_ARRAY, 1, &cubeMapArrayRendererID);
+		// The depth of a cube map array is its number of layer faces
+		glTextureStorage3D(cubeMapArrayRendererID, 1, SHADOW_MAP_FORMAT, TIER_RESOLUTIONS[tier], TIER_RESOLUTIONS[tier], TIER_CAPACITIES[tier] * 6);
+
+		// Lookups compare against the stored depth, and the comparisons of neighbouring texels are filtered (2x2 PCF)
+		glTextureParameteri(cubeMapArrayRendererID, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+		glTextureParameteri(cubeMapArrayRendererID, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+		glTextureParameteri(cubeMapArrayRendererID, GL_TEXTURE_COMPARE_MODE, GL_COMPARE_REF_TO_TEXTURE);
+		glTextureParameteri(cubeMapArrayRendererID, GL_TEXTURE_COMPARE_FUNC, GL_LEQUAL);
+
+		// Attached as a whole, so that the geometry shader can pick any layer face with gl_Layer
+		glCreateFramebuffers(1, &m_framebufferRendererIDs[tier]);
+		glNamedFramebufferTexture(m_framebufferRendererIDs[tier], GL_DEPTH_ATTACHMENT, cubeMapArrayRendererID, 0);
+		glNamedFramebufferDrawBuffer(m_framebufferRendererIDs[tier], GL_NONE);
+		glNamedFramebufferReadBuffer(m_framebufferRendererIDs[tier], GL_NONE);
+
+		ASSERT_MESSAGE(glCheckNamedFramebufferStatus(m_framebufferRendererIDs[tier], GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE, "Shadow map framebuffer {0} is incomplete", m_framebufferRendererIDs[tier]);
+
+		m_usedCubeMaps[tier].assign(TIER_CAPACITIES[tier], false);
+
+		RendererLog::info("Created shadow map cube map array {0} of {1} cube maps at {2}x{2}", cubeMapArrayRendererID, TIER_CAPACITIES[tier], TIER_RESOLUTIONS[tier]);
+	}
+}
+
+void PointShadowAtlas::deleteShadowMaps()
+{
+	for (uint32_t tier = 0; tier < TIER_COUNT; tier++)
+	{
+		GLStateCache::deleteFramebuffer(m_framebufferRendererIDs[tier]);
+		GLStateCache::deleteTexture(m_cubeMapArrayRendererIDs[tier]);
+	}
+}
+
+void PointShadowAtlas::drawShadowMap(const PointLight& light, const CachedShadowMap& shadowMap, uint32_t firstCommand, uint32_t commandCount)
+{
+	uint32_t resolution = TIER_RESOLUTIONS[shadowMap.tier];
+	uint32_t firstLayer = shadowMap.cubeMapIndex * 6;
+
+	// Clearing the layered framebuffer would clear every cube map in the array, so only this cube map's faces are cleared
+	float clearDepth = 1.0f;
+	glClearTexSubImage(m_cubeMapArrayRendererIDs[shadowMap.tier], 0, 0, 0, firstLayer, resolution, resolution, 6, GL_DEPTH_COMPONENT, GL_FLOAT, &clearDepth);
+
+	if (!commandCount)
+		return;
+
+	GLStateCache::bindFramebuffer(m_framebufferRendererIDs[shadowMap.tier]);
+	GLStateCache::setViewport(0, 0, resolution, resolution);
+
+	// Faces in the order of the cube map's layers, with the up directions cube maps are defined with
+	static const std::array<std::pair<glm::vec3, glm::vec3>, 6> faceDirections =
+	{{
+		{ {  1.0f,  0.0f,  0.0f }, { 0.0f, -1.0f,  0.0f } },
+		{ { -1.0f,  0.0f,  0.0f }, { 0.0f, -1.0f,  0.0f } },
+		{ {  0.0f,  1.0f,  0.0f }, { 0.0f,  0.0f,  1.0f } },
+		{ {  0.0f, -1.0f,  0.0f }, { 0.0f,  0.0f, -1.0f } },
+		{ {  0.0f,  0.0f,  1.0f }, { 0.0f, -1.0f,  0.0f } },
+		{ {  0.0f,  0.0f, -1.0f }, { 0.0f, -1.0f,  0.0f } }
+	}};
+
+	// Only the far plane matters for the stored distance, but the near plane clips anything right next to the light
+	glm::mat4 projectionMatrix = glm::perspective(glm::radians(90.0f), 1.0f, 0.01f * light.lightRadius, light.lightRadius);
+
+	for (uint32_t face = 0; face < 6; face++)
+	{
+		glm::mat4 viewMatrix = glm::lookAt(light.worldPosition, light.worldPosition + faceDirections[face].first, faceDirections[face].second);
+		m_shadowShader->setUniformToValue("u_faceProjectionViewMatrices[" + std::to_string(face) + "]", projectionMatrix * viewMatrix);
+	}
+
+	m_shadowShader->setUniformToValue("u_firstLayer", static_cast<int32_t>(firstLayer));
+	m_shadowShader->setUniformToValue("u_lightPosition", light.worldPosition);
+	m_shadowShader->setUniformToValue("u_lightRadius", light.lightRadius);
+
+	const void* startOfCommands = reinterpret_cast<const void*>(static_cast<uint64_t>(sizeof(DrawElementsIndirectCommand)) * firstCommand);
+	RendererUtilities::multiDrawIndexedIndirect(startOfCommands, commandCount, m_shadowCommands.data() + firstCommand);
+
+	RendererLog::trace("Drew shadow map of {0} draws into cube map {1} of tier {2}", commandCount, shadowMap.cubeMapIndex, shadowMap.tier);
+}
+
+float PointShadowAtlas::getScreenCoverage(const PointLight& light, const glm::mat4& projectionViewMatrix, const glm::mat4& projectionMatrix, const glm::vec3& viewPosition)
+{
+	// Test the light's sphere against the frustum planes, which are sums and differences of the matrix's rows
+
+	glm::vec4 rows[4];
+	for (uint32_t i = 0; i < 4; i++)
+		rows[i] = glm::vec4(projectionViewMatrix[0][i], projectionViewMatrix[1][i], projectionViewMatrix[2][i], projectionViewMatrix[3][i]);
+
+	for (uint32_t i = 0; i < 3; i++)
+	{
+		for (float sign : { 1.0f, -1.0f })
+		{
+			glm::vec4 plane = rows[3] + sign * rows[i];
+			if (glm::dot(glm::vec3(plane), light.worldPosition) + plane.w < -light.lightRadius * glm::length(glm::vec3(plane)))
+				return 0.0f;
+		}
+	}
+
+	float lightDistance = glm::length(light.worldPosition - viewPosition);
+	if (lightDistance <= light.lightRadius)
+		return 1.0f;
+
+	// The projected radius, in normalised device coordinates (where the screen's height is 2), is half the fraction covered
+	return std::min(light.lightRadius * projectionMatrix[1][1] / lightDistance, 1.0f);
+}
+
+uint32_t PointShadowAtlas::getTier(float screenCoverage)
+{
+	for (uint32_t tier = 0; tier < TIER_COUNT - 1; tier++)
+	{
+		if (screenCoverage >= TIER_SCREEN_COVERAGES[tier])
+			return tier;
+	}
+
+	return TIER_COUNT - 1;
+}
+
+bool PointShadowAtlas::isDrawInsideLight(const IndirectDrawList::DrawBounds& drawBounds, const glm::mat4& transform, const PointLight& light)
+{
+	// The world space box around the transformed bounds, tested against the light's sphere
+
+	glm::vec3 centre = glm::vec3(transform * glm::vec4(0.5f * (drawBounds.boundsMin + drawBounds.boundsMax), 1.0f));
+	glm::vec3 localExtents = 0.5f * (drawBounds.boundsMax - drawBounds.boundsMin);
+
+	glm::vec3 extents = glm::vec3(0.0f);
+	for (uint32_t i = 0; i < 3; i++)
+		extents += glm::abs(glm::vec3(transform[i])) * localExtents[i];
+
+	glm::vec3 closestPoint = glm::clamp(light.worldPosition, centre - extents, centre + extents);
+	glm::vec3 offset = closestPoint - light.worldPosition;
+
+	return glm::dot(offset, offset) <= light.lightRadius * light.lightRadius;
+}
+
+uint64_t PointShadowAtlas::getDrawSignature(const IndirectDrawList& drawList, const PointLight& light)
+{
+	// Draws are sorted front to back, so their order changes as the camera moves. Summing a hash of each draw
+	// keeps the signature the same whatever the order
+
+	const std::vector<DrawElementsIndirectCommand>& commands = drawList.getCommands();
+	const std::vector<IndirectDrawList::DrawData>& drawData = drawList.getDrawData();
+	const std::vector<IndirectDrawList::DrawBounds>& drawBounds = drawList.getDrawBounds();
+
+	uint64_t drawSignature = 0;
+
+	for (uint32_t i = 0; i < drawList.getSolidDrawCount(); i++)
+	{
+		if (!isDrawInsideLight(drawBounds[i], drawData[i].transform, light))
+			continue;
+
+		// FNV-1a over the geometry drawn and its transform
+		uint64_t drawHash = 14695981039346656037ull;
+		auto hashBytes = [&drawHash](const void* data, size_t size)
+		{
+			for (size_t j = 0; j < size; j++)
+			{
+				drawHash ^= static_cast<const uint8_t*>(data)[j];
+				drawHash *= 1099511628211ull;
+			}
+		};
+
+		hashBytes(&commands[i].count, sizeof(uint32_t));
+		hashBytes(&commands[i].firstIndex, sizeof(uint32_t));
+		hashBytes(&commands[i].baseVertex, sizeof(int32_t));
+		hashBytes(&drawData[i].transform, sizeof(glm::mat4));
+
+		drawSignature += drawHash;
+	}
+
+	return drawSignature;
+}
+
+bool PointShadowAtlas::allocateCubeMap(uint32_t preferredTier, CachedShadowMap& shadowMap)
+{
+	// Falls back to lower resolution tiers when the preferred one is full
+	for (uint32_t tier = preferredTier; tier < TIER_COUNT; tier++)
+	{
+		auto it = std::find(m_usedCubeMaps[tier].begin(), m_usedCubeMaps[tier].end(), false);
+		if (it == m_usedCubeMaps[tier].end())
+			continue;
+
+		*it = true;
+		shadowMap.tier = tier;
+		shadowMap.cubeMapIndex = static_cast<uint32_t>(it - m_usedCubeMaps[tier].begin());
+		return true;
+	}
+
+	return false;
+}
+
+void PointShadowAtlas::freeCubeMap(const CachedShadowMap& shadowMap)
+{
+	m_usedCubeMaps[shadowMap.tier][shadowMap.cubeMapIndex] = false;
+}
@@ -0,0 +1,147 @@
+#pragma once
+#include "PCH.h"
+
+#include <array>
+
+#include "glm/glm.hpp"
+
+#include "Camera.h"
+#include "Shader.h"
+#include "StorageBuffer.h"
+#include "IndirectBuffer.h"
+#include "IndirectDrawList.h"
+#include "Scene/PointLight.h"
+
+/*
+Omnidirectional shadow maps for point lights, kept from frame to frame in depth cube map arrays.
+
+There is one cube map array per resolution tier, and each light is given a cube map in the tier matching how much
+of the screen its sphere of influence covers. All six faces of a light's cube map are drawn in one pass, with a geometry
+shader sending each triangle to the faces (layers) that can see it, and only with the solid draws inside the light's radius.
+
+A light's cube map is only drawn again when the light moves, changes radius or tier, or when the draws inside its radius
+change (something moves into, out of or within it). At most the refresh budget of cube maps are drawn each frame,
+with lights that have no cube map yet going first and then the lights covering the most of the screen. Lights left
+over keep their old cube map until a later frame. Lights whose sphere is outside the view frustum aren't refreshed.
+
+The shadow of each light is stored in a storage buffer bound to POINT_LIGHT_SHADOWS_BINDING_POINT, in the same order
+as the lights were given to beginScene(), so it can be looked up with the same index as the light.
+*/
+class PointShadowAtlas
+{
+public:
+
+	// Matches the PointLightShadow struct in the lighting shaders (std430 layout)
+	struct PointLightShadowData
+	{
+		// NO_SHADOW_MAP if the light has no cube map
+		int32_t tier;
+		int32_t cubeMapIndex;
+		// Subtracted from the depth being tested, to stop surfaces shadowing themselves
+		float depthBias;
+		float padding;
+	};
+
+	static constexpr uint32_t POINT_LIGHT_SHADOWS_BINDING_POINT = 11;
+	// The texture slot of the first tier's cube map array, with the other tiers following
+	static constexpr uint32_t SHADOW_MAP_TEXTURE_SLOT = 8;
+
+	static constexpr uint32_t TIER_COUNT = 3;
+	static constexpr std::array<uint32_t, TIER_COUNT> TIER_RESOLUTIONS = { 512, 256, 128 };
+	static constexpr std::array<uint32_t, TIER_COUNT> TIER_CAPACITIES = { 4, 16, 32 };
+
+	static constexpr int32_t NO_SHADOW_MAP = -1;
+
+public:
+
+	PointShadowAtlas();
+	~PointShadowAtlas();
+	PointShadowAtlas(const PointShadowAtlas&) = delete;
+
+	// Finds how much of the screen each light covers, for the lights of the scene about to be drawn
+	void beginScene(const std::vector<Reference<PointLight>>& pointLights, const Camera& camera);
+	// Once the scene's draws have been added to the draw list and uploaded, draws the cube maps that need refreshing
+	// (within the budget) with its solid draws, and uploads each light's shadow
+	void drawShadowMaps(const IndirectDrawList& drawList);
+
+	// Binds the cube map arrays and the lights' shadows, and sets the shader's shadow map samplers
+	void bind(Shader& shader) const;
+
+	void setRefreshBudget(uint32_t refreshBudget) { m_refreshBudget = refreshBudget; }
+	uint32_t getRefreshedCount() const { return m_refreshedCount; }
+
+	// Bytes used by the cube map arrays
+	uint64_t getMemoryUsage() const;
+
+private:
+
+	struct CachedShadowMap
+	{
+		uint32_t tier;
+		uint32_t cubeMapIndex;
+
+		// What the cube map was drawn with. The tier can be lower than the one requested, if that was full
+		uint32_t requestedTier;
+		glm::vec3 lightPosition;
+		float lightRadius;
+		uint64_t drawSignature;
+
+		uint64_t lastSeenFrame;
+	};
+
+	struct RefreshCandidate
+	{
+		const PointLight* light;
+		uint32_t tier;
+		float screenCoverage;
+		bool hasShadowMap;
+		uint64_t drawSignature;
+	};
+
+	// The refresh budget by default
+	static constexpr uint32_t DEFAULT_REFRESH_BUDGET = 4;
+
+private:
+
+	void createShadowMaps();
+	void deleteShadowMaps();
+
+	void drawShadowMap(const PointLight& light, const CachedShadowMap& shadowMap, uint32_t firstCommand, uint32_t commandCount);
+
+	// Roughly the fraction of the screen's height covered by the light's sphere, or 0 outside the view frustum
+	static float getScreenCoverage(const PointLight& light, const glm::mat4& projectionViewMatrix, const glm::mat4& projectionMatrix, const glm::vec3& viewPosition);
+	static uint32_t getTier(float screenCoverage);
+
+	static bool isDrawInsideLight(const IndirectDrawList::DrawBounds& drawBounds, const glm::mat4& transform, const PointLight& light);
+	// Changes whenever a draw inside the light changes, regardless of the order the draws are in
+	static uint64_t getDrawSignature(const IndirectDrawList& drawList, const PointLight& light);
+
+	bool allocateCubeMap(uint32_t preferredTier, CachedShadowMap& shadowMap);
+	void freeCubeMap(const CachedShadowMap& shadowMap);
+
+private:
+
+	std::array<RendererID, TIER_COUNT> m_cubeMapArrayRendererIDs = {};
+	std::array<RendererID, TIER_COUNT> m_framebufferRendererIDs = {};
+	std::array<std::vector<bool>, TIER_COUNT> m_usedCubeMaps;
+
+	// The scene's lights, between beginScene and drawShadowMaps
+	std::vector<Reference<PointLight>> m_pointLights;
+	std::vector<float> m_screenCoverages;
+
+	// By light identifier
+	std::unordered_map<uint64_t, CachedShadowMap> m_shadowMaps;
+	uint64_t m_frameIndex = 0;
+
+	uint32_t m_refreshBudget = DEFAULT_REFRESH_BUDGET;
+	uint32_t m_refreshedCount = 0;
+
+	Unique<Shader> m_shadowShader;
+
+	// The solid draws inside each light refreshed this frame, one after the other
+	std::vector<DrawElementsIndirectCommand> m_shadowCommands;
+	Unique<IndirectBuffer> m_shadowCommandBuffer;
+
+	std::vector<PointLightShadowData> m_pointLightShadowData;
+	Unique<StorageBuffer> m_pointLightShadowBuffer;
+};
@@ -0,0 +1,30 @@
+#include "PCH.h"
+#include "PoseCamera.h"
+
+#include "glm/gtc/matrix_transform.hpp"
+
+PoseCamera::PoseCamera(float aspectRatio)
+    : m_aspectRatio(aspectRatio)
+{
+}
+
+void PoseCamera::setPose(const glm::vec3& position, const glm::vec3& focusPoint, float verticalFieldOfView)
+{
+    m_cameraPosition = position;
+    m_cameraFocusPoint = focusPoint;
+    m_vFov = verticalFieldOfView;
+}
+
+glm::mat4 PoseCamera::getViewMatrix() const
+{
+    // Looking straight up or down, the world up direction can't be used
+    glm::vec3 forwardDirection = glm::normalize(m_cameraFocusPoint - m_cameraPosition);
+    glm::vec3 upDirection = glm::abs(glm::dot(forwardDirection, WORLD_UP_DIRECTION)) > 0.999f ? glm::vec3(0.0f, 0.0f, -1.0f) : WORLD_UP_DIRECTION;
+
+    return glm::lookAt(m_cameraPosition, m_cameraFocusPoint, upDirection);
+}
+
+glm::mat4 PoseCamera::getProjectionMatrix() const
+{
+    return glm::perspective(glm::radians(m_vFov), m_aspectRatio, m_nearClip, m_farClip);
+}
@@ -0,0 +1,37 @@
+#pragma once
+#include "PCH.h"
+
+#include "Camera.h"
+
+/*
+A camera placed directly, by its position and the point it looks at, rather than controlled with the mouse. Used
+for rendering predetermined camera poses, such as the frames of a batch render.
+*/
+class PoseCamera : public Camera
+{
+public:
+
+	PoseCamera(float aspectRatio = DEFAULT_ASPECT_RATIO);
+
+	void setPose(const glm::vec3& position, const glm::vec3& focusPoint, float verticalFieldOfView);
+
+	glm::mat4 getViewMatrix() const override;
+	glm::mat4 getProjectionMatrix() const override;
+
+	glm::vec3 getCameraPosition() const override { return m_cameraPosition; }
+
+	float getNearClip() const override { return m_nearClip; }
+	float getFarClip() const override { return m_farClip; }
+
+private:
+
+	inline static const glm::vec3 WORLD_UP_DIRECTION = { 0.0f, 1.0f, 0.0f };
+
+	glm::vec3 m_cameraPosition = { 0.0f, 0.0f, 5.0f };
+	glm::vec3 m_cameraFocusPoint = { 0.0f, 0.0f, 0.0f };
+
+	// In degrees
+	float m_vFov = 45.0f;
+	float m_aspectRatio;
+	float m_nearClip = 0.01f, m_farClip = 100.0f;
+};
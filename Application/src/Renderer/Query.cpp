@@ -0,0 +1,70 @@
+#include "PCH.h"
+#include "Query.h"
+
+#include "glad/glad.h"
+
+Query::Query(QueryType queryType)
+	: m_queryType(queryType)
+{
+	glCreateQueries(convertQueryTypeToOpenGLTarget(queryType), 1, &m_rendererID);
+
+	RendererLog::info("Created query {0}", m_rendererID);
+}
+
+Query::~Query()
+{
+	glDeleteQueries(1, &m_rendererID);
+
+	RendererLog::info("Deleted query {0}", m_rendererID);
+}
+
+void Query::begin() const
+{
+	glBeginQuery(convertQueryTypeToOpenGLTarget(m_queryType), m_rendererID);
+
+	RendererLog::trace("Began query {0}", m_rendererID);
+}
+
+void Query::end() const
+{
+	glEndQuery(convertQueryTypeToOpenGLTarget(m_queryType));
+
+	RendererLog::trace("Ended query {0}", m_rendererID);
+}
+
+void Query::recordTimestamp() const
+{
+	ASSERT_MESSAGE(m_queryType == QueryType::TIMESTAMP, "Only timestamp queries can be recorded");
+
+	glQueryCounter(m_rendererID, GL_TIMESTAMP);
+}
+
+bool Query::isResultAvailable() const
+{
+	uint32_t resultAvailable = GL_FALSE;
+	glGetQueryObjectuiv(m_rendererID, GL_QUERY_RESULT_AVAILABLE, &resultAvailable);
+
+	return resultAvailable == GL_TRUE;
+}
+
+uint64_t Query::getResult() const
+{
+	uint64_t result = 0;
+	glGetQueryObjectui64v(m_rendererID, GL_QUERY_RESULT, &result);
+
+	return result;
+}
+
+uint32_t Query::convertQueryTypeToOpenGLTarget(QueryType queryType)
+{
+	switch (queryType)
+	{
+	case Query::QueryType::SAMPLES_PASSED: return GL_SAMPLES_PASSED; break;
+	case Query::QueryType::TIME_ELAPSED:   return GL_TIME_ELAPSED;   break;
+	case Query::QueryType::TIMESTAMP:      return GL_TIMESTAMP;      break;
+	default:
+		ASSERT_MESSAGE(false, "Cannot convert QueryType to OpenGL target");
+		return 0;
+		break;
+	}
+}
@@ -0,0 +1,50 @@
+#pragma once
+#include "PCH.h"
+
+#include "RendererUtilities.h"
+
+/*
+An OpenGL query object, which measures something about the commands issued between begin() and end().
+
+Only one query of each type can be active at a time, apart from timestamps, which are recorded rather than begun and ended.
+*/
+class Query
+{
+public:
+
+	enum class QueryType
+	{
+		// Number of samples which passed the depth test
+		SAMPLES_PASSED = 0,
+		// GPU time in nanoseconds
+		TIME_ELAPSED,
+		// GPU clock in nanoseconds, once the commands before recordTimestamp() have finished. Not begun or ended
+		TIMESTAMP
+	};
+
+public:
+
+	Query() = delete;
+	Query(QueryType queryType);
+	~Query();
+	Query(const Query&) = delete;
+
+	void begin() const;
+	void end() const;
+
+	// Timestamp queries only. They can be recorded while other queries are active, and nest
+	void recordTimestamp() const;
+
+	bool isResultAvailable() const;
+	// Waits for the queried commands to finish on the GPU if the result isn't available yet
+	uint64_t getResult() const;
+
+private:
+
+	static uint32_t convertQueryTypeToOpenGLTarget(QueryType queryType);
+
+private:
+
+	RendererID m_rendererID;
+	QueryType m_queryType;
+};
@@ -0,0 +1,370 @@
+#include "PCH.h"
+#include "RenderGraph.h"
+
+#include <set>
+
+#include "Core/Profiler.h"
+
+#include "RenderTargetPool.h"
+
+RenderGraph::RenderGraph()
+{
+	Resource defaultFramebuffer;
+	defaultFramebuffer.name = "Default framebuffer";
+	defaultFramebuffer.imported = true;
+
+	m_resources.push_back(defaultFramebuffer);
+}
+
+RenderGraph::ResourceHandle RenderGraph::createFramebuffer(const std::string& name, const Framebuffer::FramebufferSpecification& specification)
+{
+	ASSERT_MESSAGE(!m_compiled, "Framebuffer {0} created after the render graph was compiled", name);
+
+	Resource resource;
+	resource.name = name;
+	resource.specification = specification;
+
+	m_resources.push_back(resource);
+	return static_cast<ResourceHandle>(m_resources.size() - 1);
+}
+
+RenderGraph::ResourceHandle RenderGraph::importFramebuffer(const std::string& name, Framebuffer& framebuffer)
+{
+	ASSERT_MESSAGE(!m_compiled, "Framebuffer {0} imported after the render graph was compiled", name);
+
+	Resource resource;
+	resource.name = name;
+	resource.specification = framebuffer.getSpecification();
+	resource.framebuffer = &framebuffer;
+	resource.imported = true;
+
+	m_resources.push_back(resource);
+	return static_cast<ResourceHandle>(m_resources.size() - 1);
+}
+
+void RenderGraph::addPass(const std::string& name, const std::vector<ResourceAccess>& reads, const std::vector<ResourceAccess>& writes, const ExecuteFunction& execute)
+{
+	ASSERT_MESSAGE(!m_compiled, "Pass {0} added after the render graph was compiled", name);
+
+	for (const ResourceAccess& read : reads)
+	{
+		ASSERT_MESSAGE(read.resource < m_resources.size(), "Pass {0} reads a resource not in the render graph", name);
+		ASSERT_MESSAGE(read.access == Access::TEXTURE || read.access == Access::SAMPLES || read.access == Access::BLIT, "Pass {0} reads {1} with a write access", name, m_resources[read.resource].name);
+		ASSERT_MESSAGE(read.resource != DEFAULT_FRAMEBUFFER, "Pass {0} reads the default framebuffer", name);
+	}
+
+	for (const ResourceAccess& write : writes)
+	{
+		ASSERT_MESSAGE(write.resource < m_resources.size(), "Pass {0} writes a resource not in the render graph", name);
+		ASSERT_MESSAGE(write.access == Access::ATTACHMENT || write.access == Access::IMAGE, "Pass {0} writes {1} with a read access", name, m_resources[write.resource].name);
+		ASSERT_MESSAGE(write.access != Access::IMAGE || m_resources[write.resource].specification.samples == 1, "Pass {0} writes multisampled {1} as an image", name, m_resources[write.resource].name);
+	}
+
+	m_passes.push_back({ name, reads, writes, execute });
+}
+
+Framebuffer::FramebufferSpecification RenderGraph::getResolvedSpecification(const Framebuffer::FramebufferSpecification& specification)
+{
+	// Depth can't be resolved by a linear blit, and nothing reads it once the samples are resolved
+	Framebuffer::FramebufferSpecification resolvedSpecification = specification;
+	resolvedSpecification.depthAttachmentFormat = Framebuffer::DepthAttachmentFormat::NONE;
+	resolvedSpecification.samples = 1;
+
+	return resolvedSpecification;
+}
+
+void RenderGraph::compile()
+{
+	ASSERT_MESSAGE(!m_compiled, "Render graph has already been compiled");
+
+	insertResolves();
+	findDependencies();
+	cullPasses();
+	orderPasses();
+	findLifetimes();
+	findBarriers();
+
+	m_compiled = true;
+
+	RendererLog::trace("Compiled render graph of {0} passes ({1} culled) and {2} resources", static_cast<uint32_t>(m_passOrder.size()), static_cast<uint32_t>(m_passes.size() - m_passOrder.size()), static_cast<uint32_t>(m_resources.size()));
+}
+
+void RenderGraph::execute()
+{
+	ASSERT_MESSAGE(m_compiled, "Render graph must be compiled before it is executed");
+
+	for (uint32_t position = 0; position < static_cast<uint32_t>(m_passOrder.size()); position++)
+	{
+		for (Resource& resource : m_resources)
+		{
+			if (!resource.imported && resource.firstUse == position)
+				resource.framebuffer = &RenderTargetPool::acquire(resource.specification);
+		}
+
+		m_executingPass = m_passOrder[position];
+		Pass& pass = m_passes[m_executingPass];
+
+		RendererLog::trace("Executing render graph pass {0}", pass.name);
+
+		{
+			Profiler::Scope passScope(pass.name.c_str(), true);
+
+			if (pass.barrierBits != 0)
+				glMemoryBarrier(pass.barrierBits);
+
+			pass.execute(*this);
+		}
+
+		m_executingPass = INVALID_PASS;
+
+		// Released as soon as the last pass is done with them, so that the memory can go to framebuffers used later
+		for (Resource& resource : m_resources)
+		{
+			if (!resource.imported && resource.lastUse == position)
+			{
+				RenderTargetPool::release(*resource.framebuffer);
+				resource.framebuffer = nullptr;
+			}
+		}
+	}
+}
+
+Framebuffer& RenderGraph::getFramebuffer(ResourceHandle resource)
+{
+	ASSERT_MESSAGE(m_executingPass != INVALID_PASS, "Render graph framebuffers can only be got while a pass executes");
+	ASSERT_MESSAGE(resource != DEFAULT_FRAMEBUFFER, "The default framebuffer has no Framebuffer");
+
+	const Pass& pass = m_passes[m_executingPass];
+
+	// The pass's read was swapped for the resolved framebuffer when the graph was compiled
+	ResourceHandle resolvedResource = m_resources[resource].resolvedResource;
+	if (resolvedResource != INVALID_RESOURCE && passAccessesResource(pass, resolvedResource) && !passAccessesResource(pass, resource))
+		resource = resolvedResource;
+
+	ASSERT_MESSAGE(passAccessesResource(pass, resource), "Pass {0} did not declare that it uses {1}", pass.name, m_resources[resource].name);
+
+	return *m_resources[resource].framebuffer;
+}
+
+void RenderGraph::bindFramebuffer(ResourceHandle resource)
+{
+	if (resource == DEFAULT_FRAMEBUFFER)
+		RendererUtilities::bindDefaultFramebuffer();
+	else
+		getFramebuffer(resource).bind();
+}
+
+void RenderGraph::insertResolves()
+{
+	// Added once every pass has been looked at, as adding to the passes would move the reads being changed
+	std::vector<Pass> resolvePasses;
+
+	for (Pass& pass : m_passes)
+	{
+		for (ResourceAccess& read : pass.reads)
+		{
+			if (read.access != Access::TEXTURE || m_resources[read.resource].specification.samples == 1)
+				continue;
+
+			// Every pass sampling the framebuffer shares one resolve
+			ResourceHandle multisampledResource = read.resource;
+			if (m_resources[multisampledResource].resolvedResource == INVALID_RESOURCE)
+			{
+				ResourceHandle resolvedResource = createFramebuffer(m_resources[multisampledResource].name + " (resolved)", getResolvedSpecification(m_resources[multisampledResource].specification));
+				m_resources[multisampledResource].resolvedResource = resolvedResource;
+
+				ExecuteFunction resolve = [multisampledResource, resolvedResource](RenderGraph& renderGraph)
+				{
+					renderGraph.getFramebuffer(multisampledResource).blitToTargetFramebuffer(&renderGraph.getFramebuffer(resolvedResource));
+				};
+
+				// Passes are ordered by what they read and write, so where the resolve goes in the list doesn't matter
+				resolvePasses.push_back({ "Resolve " + m_resources[multisampledResource].name, { { multisampledResource, Access::BLIT } }, { { resolvedResource, Access::ATTACHMENT } }, resolve });
+			}
+
+			read.resource = m_resources[multisampledResource].resolvedResource;
+		}
+	}
+
+	m_passes.insert(m_passes.end(), resolvePasses.begin(), resolvePasses.end());
+}
+
+void RenderGraph::findDependencies()
+{
+	// Writes of a resource happen in the order they were added, and reads come after every write
+
+	std::vector<std::vector<uint32_t>> writers(m_resources.size());
+
+	for (uint32_t i = 0; i < static_cast<uint32_t>(m_passes.size()); i++)
+	{
+		for (const ResourceAccess& write : m_passes[i].writes)
+		{
+			if (!writers[write.resource].empty())
+				m_passes[i].dependencies.push_back(writers[write.resource].back());
+
+			writers[write.resource].push_back(i);
+		}
+	}
+
+	for (uint32_t i = 0; i < static_cast<uint32_t>(m_passes.size()); i++)
+	{
+		for (const ResourceAccess& read : m_passes[i].reads)
+		{
+			ASSERT_MESSAGE(!writers[read.resource].empty() || m_resources[read.resource].imported, "Pass {0} reads {1}, which nothing writes", m_passes[i].name, m_resources[read.resource].name);
+
+			// A pass can't depend on itself, for a resource it both reads and writes
+			for (uint32_t writer : writers[read.resource])
+			{
+				if (writer != i)
+					m_passes[i].dependencies.push_back(writer);
+			}
+		}
+	}
+}
+
+void RenderGraph::cullPasses()
+{
+	// Passes writing imported resources have effects outside the graph. Everything they depend on is needed too
+
+	std::vector<uint32_t> passesToVisit;
+
+	for (uint32_t i = 0; i < static_cast<uint32_t>(m_passes.size()); i++)
+	{
+		for (const ResourceAccess& write : m_passes[i].writes)
+		{
+			if (m_resources[write.resource].imported)
+			{
+				passesToVisit.push_back(i);
+				break;
+			}
+		}
+	}
+
+	while (!passesToVisit.empty())
+	{
+		uint32_t passIndex = passesToVisit.back();
+		passesToVisit.pop_back();
+
+		Pass& pass = m_passes[passIndex];
+		if (pass.kept)
+			continue;
+
+		pass.kept = true;
+		passesToVisit.insert(passesToVisit.end(), pass.dependencies.begin(), pass.dependencies.end());
+	}
+
+	for (const Pass& pass : m_passes)
+	{
+		if (!pass.kept)
+			RendererLog::trace("Culled render graph pass {0}, as nothing uses what it writes", pass.name);
+	}
+}
+
+void RenderGraph::orderPasses()
+{
+	// Kahn's algorithm, taking the earliest added of the passes that are ready each time, so that independent passes
+	// keep the order they were added in
+
+	std::vector<uint32_t> unorderedDependencyCounts(m_passes.size(), 0);
+	std::vector<std::vector<uint32_t>> dependents(m_passes.size());
+
+	for (uint32_t i = 0; i < static_cast<uint32_t>(m_passes.size()); i++)
+	{
+		if (!m_passes[i].kept)
+			continue;
+
+		for (uint32_t dependency : m_passes[i].dependencies)
+		{
+			unorderedDependencyCounts[i]++;
+			dependents[dependency].push_back(i);
+		}
+	}
+
+	std::set<uint32_t> readyPasses;
+	for (uint32_t i = 0; i < static_cast<uint32_t>(m_passes.size()); i++)
+	{
+		if (m_passes[i].kept && unorderedDependencyCounts[i] == 0)
+			readyPasses.insert(i);
+	}
+
+	m_passOrder.clear();
+
+	while (!readyPasses.empty())
+	{
+		uint32_t passIndex = *readyPasses.begin();
+		readyPasses.erase(readyPasses.begin());
+
+		m_passOrder.push_back(passIndex);
+
+		for (uint32_t dependent : dependents[passIndex])
+		{
+			if (--unorderedDependencyCounts[dependent] == 0)
+				readyPasses.insert(dependent);
+		}
+	}
+
+	uint32_t keptPassCount = static_cast<uint32_t>(std::count_if(m_passes.begin(), m_passes.end(), [](const Pass& pass) { return pass.kept; }));
+	ASSERT_MESSAGE(m_passOrder.size() == keptPassCount, "Render graph passes depend on each other in a cycle");
+}
+
+void RenderGraph::findLifetimes()
+{
+	for (uint32_t position = 0; position < static_cast<uint32_t>(m_passOrder.size()); position++)
+	{
+		const Pass& pass = m_passes[m_passOrder[position]];
+
+		auto extendLifetime = [this, position](const ResourceAccess& resourceAccess)
+		{
+			Resource& resource = m_resources[resourceAccess.resource];
+
+			if (resource.firstUse == INVALID_PASS)
+				resource.firstUse = position;
+			resource.lastUse = position;
+		};
+
+		std::for_each(pass.reads.begin(), pass.reads.end(), extendLifetime);
+		std::for_each(pass.writes.begin(), pass.writes.end(), extendLifetime);
+	}
+}
+
+void RenderGraph::findBarriers()
+{
+	// Framebuffer writes are visible to whatever comes next, but image stores need a barrier for the type of access that follows.
+	// Each type of barrier is only needed once after the write, but a read of one type doesn't make the image visible to another
+
+	std::vector<bool> writtenAsImage(m_resources.size(), false);
+	std::vector<uint32_t> issuedBarrierBits(m_resources.size(), 0);
+
+	auto addBarrier = [&writtenAsImage, &issuedBarrierBits](Pass& pass, ResourceHandle resource, uint32_t barrierBit)
+	{
+		if (!writtenAsImage[resource] || (issuedBarrierBits[resource] & barrierBit))
+			return;
+
+		pass.barrierBits |= barrierBit;
+		issuedBarrierBits[resource] |= barrierBit;
+	};
+
+	for (uint32_t passIndex : m_passOrder)
+	{
+		Pass& pass = m_passes[passIndex];
+
+		for (const ResourceAccess& read : pass.reads)
+			addBarrier(pass, read.resource, read.access == Access::BLIT ? GL_FRAMEBUFFER_BARRIER_BIT : GL_TEXTURE_FETCH_BARRIER_BIT);
+
+		for (const ResourceAccess& write : pass.writes)
+			addBarrier(pass, write.resource, write.access == Access::IMAGE ? GL_SHADER_IMAGE_ACCESS_BARRIER_BIT : GL_FRAMEBUFFER_BARRIER_BIT);
+
+		for (const ResourceAccess& write : pass.writes)
+		{
+			writtenAsImage[write.resource] = write.access == Access::IMAGE;
+			issuedBarrierBits[write.resource] = 0;
+		}
+	}
+}
+
+bool RenderGraph::passAccessesResource(const Pass& pass, ResourceHandle resource) const
+{
+	auto isResource = [resource](const ResourceAccess& resourceAccess) { return resourceAccess.resource == resource; };
+
+	return std::any_of(pass.reads.begin(), pass.reads.end(), isResource) || std::any_of(pass.writes.begin(), pass.writes.end(), isResource);
+}
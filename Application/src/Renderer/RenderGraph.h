@@ -0,0 +1,131 @@
+#pragma once
+#include "PCH.h"
+
+#include <functional>
+
+#include "Framebuffer.h"
+
+/*
+The passes a renderer draws in a frame, and the framebuffers they read and write, which are then ordered and run together.
+
+Each pass declares the framebuffers it reads and writes, and how. compile() then:
+	- Inserts a resolve before any pass which samples a multisampled framebuffer (as a TEXTURE rather than its SAMPLES), and
+	  gives the pass the resolved framebuffer instead
+	- Orders the passes so that every pass comes after the passes writing what it reads (and writes of the same framebuffer
+	  stay in the order they were added)
+	- Culls passes whose results are never used. Only writes to imported framebuffers (such as the default framebuffer) are
+	  used outside the graph, so only passes leading up to one of those are kept
+	- Finds the first and last pass using each transient framebuffer. They are requested from the render target pool just
+	  before the first and released just after the last, so the pool can give the memory of one to another whose use starts later
+	- Works out the memory barriers needed between passes, for framebuffers written by compute shaders through image units
+
+Graphs are built, compiled and executed once per frame.
+*/
+class RenderGraph
+{
+public:
+
+	using ResourceHandle = uint32_t;
+
+	enum class Access
+	{
+		// Writes
+		ATTACHMENT = 0,		// Bound as the framebuffer being drawn to, blitted to or cleared
+		IMAGE,				// Written to by a compute shader through an image unit (single sampled only)
+		// Reads
+		TEXTURE,			// Sampled or fetched from by a shader
+		SAMPLES,			// Fetched from sample by sample by a shader, so multisampled framebuffers aren't resolved first
+		BLIT				// The source of a blit, which may be multisampled
+	};
+
+	struct ResourceAccess
+	{
+		ResourceHandle resource;
+		Access access;
+	};
+
+	using ExecuteFunction = std::function<void(RenderGraph&)>;
+
+	static constexpr ResourceHandle DEFAULT_FRAMEBUFFER = 0;
+
+public:
+
+	RenderGraph();
+	~RenderGraph() = default;
+	RenderGraph(const RenderGraph&) = delete;
+
+	// A framebuffer only used within this graph, requested from the render target pool while it is needed
+	ResourceHandle createFramebuffer(const std::string& name, const Framebuffer::FramebufferSpecification& specification);
+	// A framebuffer which lives on after the graph has executed. The default framebuffer is always imported, as DEFAULT_FRAMEBUFFER
+	ResourceHandle importFramebuffer(const std::string& name, Framebuffer& framebuffer);
+
+	void addPass(const std::string& name, const std::vector<ResourceAccess>& reads, const std::vector<ResourceAccess>& writes, const ExecuteFunction& execute);
+
+	// The framebuffer a multisampled framebuffer is resolved to, before a pass samples it
+	static Framebuffer::FramebufferSpecification getResolvedSpecification(const Framebuffer::FramebufferSpecification& specification);
+
+	void compile();
+	// Runs the passes kept by compile() in order
+	void execute();
+
+	// Only valid while a pass which declared the resource is executing. A pass which samples a multisampled framebuffer is given
+	// the resolved framebuffer. Not for the default framebuffer, which has no Framebuffer
+	Framebuffer& getFramebuffer(ResourceHandle resource);
+	// Binds the framebuffer for drawing to, which can be the default framebuffer
+	void bindFramebuffer(ResourceHandle resource);
+
+private:
+
+	struct Resource
+	{
+		std::string name;
+		Framebuffer::FramebufferSpecification specification;
+		// Imported framebuffers are set from the start, and transient ones while they are in use
+		Framebuffer* framebuffer = nullptr;
+		bool imported = false;
+
+		// Set if a pass samples this multisampled framebuffer
+		ResourceHandle resolvedResource = INVALID_RESOURCE;
+
+		// Positions in the compiled order of the first and last kept passes to use the resource
+		uint32_t firstUse = INVALID_PASS, lastUse = INVALID_PASS;
+	};
+
+	struct Pass
+	{
+		std::string name;
+		std::vector<ResourceAccess> reads;
+		std::vector<ResourceAccess> writes;
+		ExecuteFunction execute;
+
+		// Indices of the passes which must execute before this one
+		std::vector<uint32_t> dependencies;
+		bool kept = false;
+		// Issued with glMemoryBarrier before the pass executes
+		uint32_t barrierBits = 0;
+	};
+
+	static constexpr ResourceHandle INVALID_RESOURCE = std::numeric_limits<ResourceHandle>::max();
+	static constexpr uint32_t INVALID_PASS = std::numeric_limits<uint32_t>::max();
+
+private:
+
+	void insertResolves();
+	void findDependencies();
+	void cullPasses();
+	void orderPasses();
+	void findLifetimes();
+	void findBarriers();
+
+	bool passAccessesResource(const Pass& pass, ResourceHandle resource) const;
+
+private:
+
+	std::vector<Resource> m_resources;
+	std::vector<Pass> m_passes;
+	// Indices of the kept passes, in the order they execute
+	std::vector<uint32_t> m_passOrder;
+
+	bool m_compiled = false;
+	uint32_t m_executingPass = INVALID_PASS;
+};
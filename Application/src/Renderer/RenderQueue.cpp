@@ -0,0 +1,98 @@
+#include "PCH.h"
+#include "RenderQueue.h"
+
+#include <array>
+#include <cstring>
+
+static constexpr uint32_t RADIX_BITS = 8;
+static constexpr uint32_t RADIX_BUCKET_COUNT = 1 << RADIX_BITS;
+static constexpr uint32_t RADIX_PASS_COUNT = 64 / RADIX_BITS;
+
+// The shader variant, texture set and material, which are kept together in every key layout
+static constexpr uint32_t STATE_BITS = RenderQueue::SHADER_VARIANT_BITS + RenderQueue::TEXTURE_SET_BITS + RenderQueue::MATERIAL_BITS;
+
+uint64_t RenderQueue::createSortKey(Pass pass, uint32_t shaderVariant, uint32_t textureSet, uint32_t material, float depth)
+{
+	ASSERT_MESSAGE(shaderVariant < MAX_SHADER_VARIANTS, "Shader variant does not fit within a sort key");
+	ASSERT_MESSAGE(textureSet < MAX_TEXTURE_SETS, "Texture set does not fit within a sort key");
+	ASSERT_MESSAGE(material < MAX_MATERIALS, "Material does not fit within a sort key");
+
+	// The bits of a non-negative float are ordered the same way as its value, so the depth
+	// can be quantised by keeping the most significant bits (dropping some of the mantissa)
+
+	uint32_t depthBits;
+	depth = std::max(depth, 0.0f);
+	std::memcpy(&depthBits, &depth, sizeof(uint32_t));
+	uint64_t quantisedDepth = depthBits >> (32 - DEPTH_BITS);
+
+	uint64_t state = static_cast<uint64_t>(shaderVariant);
+	state = (state << TEXTURE_SET_BITS) | textureSet;
+	state = (state << MATERIAL_BITS) | material;
+
+	uint64_t key = static_cast<uint64_t>(pass);
+
+	if (pass == Pass::BLENDED)
+	{
+		// Back to front
+		uint64_t invertedDepth = ((1ull << DEPTH_BITS) - 1) - quantisedDepth;
+		key = (key << DEPTH_BITS) | invertedDepth;
+		key = (key << STATE_BITS) | state;
+	}
+	else
+	{
+		key = (key << STATE_BITS) | state;
+		key = (key << DEPTH_BITS) | quantisedDepth;
+	}
+
+	return key;
+}
+
+uint64_t RenderQueue::getStateFromSortKey(uint64_t key)
+{
+	uint64_t pass = key >> (64 - PASS_BITS);
+
+	if (static_cast<Pass>(pass) == Pass::BLENDED)
+		return (pass << STATE_BITS) | (key & ((1ull << STATE_BITS) - 1));
+	else
+		return key >> DEPTH_BITS;
+}
+
+void RenderQueue::sort()
+{
+	uint32_t packetCount = static_cast<uint32_t>(m_packets.size());
+	m_sortingPackets.resize(packetCount);
+
+	for (uint32_t pass = 0; pass < RADIX_PASS_COUNT; pass++)
+	{
+		uint32_t shift = pass * RADIX_BITS;
+
+		std::array<uint32_t, RADIX_BUCKET_COUNT> bucketOffsets = {};
+
+		for (const DrawPacket& packet : m_packets)
+			bucketOffsets[(packet.key >> shift) & (RADIX_BUCKET_COUNT - 1)]++;
+
+		// Many of the key's bytes (the pass and shader variant especially) are usually the same for
+		// every packet, in which case the pass wouldn't change the order, so can be skipped
+		if (packetCount == 0 || bucketOffsets[(m_packets[0].key >> shift) & (RADIX_BUCKET_COUNT - 1)] == packetCount)
+			continue;
+
+		// Turn the counts into where each bucket starts
+
+		uint32_t offset = 0;
+		for (uint32_t& bucketOffset : bucketOffsets)
+		{
+			uint32_t count = bucketOffset;
+			bucketOffset = offset;
+			offset += count;
+		}
+
+		// Scattering in order keeps the sort stable, which each pass relies on to keep the order of the previous passes
+
+		for (const DrawPacket& packet : m_packets)
+			m_sortingPackets[bucketOffsets[(packet.key >> shift) & (RADIX_BUCKET_COUNT - 1)]++] = packet;
+
+		std::swap(m_packets, m_sortingPackets);
+	}
+
+	RendererLog::trace("Sorted {0} draw packets", packetCount);
+}
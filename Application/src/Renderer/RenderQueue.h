@@ -0,0 +1,75 @@
+#pragma once
+#include "PCH.h"
+
+/*
+A list of lightweight draw packets, each with a 64-bit key that encodes the order they should be drawn in.
+
+From the most to the least significant bits, a key is made up of:
+	pass           (4 bits)  - solid, then alpha tested, then blended geometry
+	shader variant (8 bits)
+	texture set    (12 bits) - textures are grouped above materials, as rebinding them costs more than setting uniforms
+	material       (16 bits)
+	depth          (24 bits) - front to back, so that the depth test rejects as many fragments as possible
+
+Blended draws must be drawn back to front to blend correctly, so for the blended pass the (inverted) depth
+is moved to just below the pass, giving up grouping by state for the correct order.
+
+Sorting the keys therefore groups draws which share state, and the packets are sorted with an LSD radix sort
+as integer keys sort in linear time.
+*/
+class RenderQueue
+{
+public:
+
+	enum class Pass
+	{
+		// Named SOLID rather than OPAQUE, which windows.h defines as a macro
+		SOLID = 0,
+		MASKED,
+		BLENDED
+	};
+
+	struct DrawPacket
+	{
+		uint64_t key;
+		// Index of the draw within whatever submitted the packet
+		uint32_t drawIndex;
+	};
+
+	static constexpr uint32_t PASS_BITS = 4;
+	static constexpr uint32_t SHADER_VARIANT_BITS = 8;
+	static constexpr uint32_t TEXTURE_SET_BITS = 12;
+	static constexpr uint32_t MATERIAL_BITS = 16;
+	static constexpr uint32_t DEPTH_BITS = 24;
+
+	static constexpr uint32_t MAX_SHADER_VARIANTS = 1 << SHADER_VARIANT_BITS;
+	static constexpr uint32_t MAX_TEXTURE_SETS = 1 << TEXTURE_SET_BITS;
+	static constexpr uint32_t MAX_MATERIALS = 1 << MATERIAL_BITS;
+
+public:
+
+	RenderQueue() = default;
+	RenderQueue(const RenderQueue&) = delete;
+
+	// Depth is the (non-negative) distance of the draw from the camera
+	static uint64_t createSortKey(Pass pass, uint32_t shaderVariant, uint32_t textureSet, uint32_t material, float depth);
+
+	static Pass getPassFromSortKey(uint64_t key) { return static_cast<Pass>(key >> (64 - PASS_BITS)); }
+
+	// Removes the depth from a key, leaving the state the draw needs (laid out the same way for every pass)
+	static uint64_t getStateFromSortKey(uint64_t key);
+
+	void clear() { m_packets.clear(); }
+
+	void submit(uint64_t key, uint32_t drawIndex) { m_packets.push_back({ key, drawIndex }); }
+
+	void sort();
+
+	const std::vector<DrawPacket>& getPackets() const { return m_packets; }
+
+private:
+
+	std::vector<DrawPacket> m_packets;
+	// Radix sorting isn't in place, so the packets are sorted back and forth between this and m_packets
+	std::vector<DrawPacket> m_sortingPackets;
+};
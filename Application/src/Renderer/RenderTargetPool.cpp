@@ -0,0 +1,122 @@
+#include "PCH.h"
+#include "RenderTargetPool.h"
+
+std::vector<RenderTargetPool::RenderTarget> RenderTargetPool::s_renderTargets;
+uint64_t RenderTargetPool::s_frameIndex = 0;
+
+void RenderTargetPool::init()
+{
+	s_frameIndex = 0;
+
+	RendererLog::info("Render target pool initialised");
+}
+
+void RenderTargetPool::shutdown()
+{
+	s_renderTargets.clear();
+}
+
+void RenderTargetPool::endFrame()
+{
+	for (auto it = s_renderTargets.begin(); it != s_renderTargets.end();)
+	{
+		ASSERT_MESSAGE(!it->inUse, "A render target was not released by the end of the frame");
+
+		if (s_frameIndex - it->lastUsedFrame >= UNUSED_FRAME_LIMIT)
+		{
+			const Framebuffer::FramebufferSpecification& specification = it->framebuffer->getSpecification();
+			RendererLog::trace("Deleting unused render target ({0}, {1})", specification.width, specification.height);
+
+			it = s_renderTargets.erase(it);
+		}
+		else
+			++it;
+	}
+
+	s_frameIndex++;
+}
+
+Framebuffer& RenderTargetPool::acquire(const Framebuffer::FramebufferSpecification& specification)
+{
+	Framebuffer* framebuffer = nullptr;
+
+	for (RenderTarget& renderTarget : s_renderTargets)
+	{
+		if (!renderTarget.inUse && isCompatible(renderTarget.framebuffer->getSpecification(), specification))
+		{
+			renderTarget.inUse = true;
+			renderTarget.lastUsedFrame = s_frameIndex;
+			framebuffer = renderTarget.framebuffer.get();
+			break;
+		}
+	}
+
+	if (!framebuffer)
+	{
+		Framebuffer::FramebufferSpecification allocatedSpecification = specification;
+		allocatedSpecification.width = roundUpToBucket(specification.width);
+		allocatedSpecification.height = roundUpToBucket(specification.height);
+		// The pool decides when targets are resized
+		allocatedSpecification.resizeWithWindowResizeEvents = false;
+
+		RenderTarget renderTarget;
+		renderTarget.framebuffer = createUnique<Framebuffer>(allocatedSpecification);
+		renderTarget.inUse = true;
+		renderTarget.lastUsedFrame = s_frameIndex;
+		framebuffer = renderTarget.framebuffer.get();
+
+		s_renderTargets.push_back(std::move(renderTarget));
+
+		RendererLog::info("Allocated render target ({0}, {1}) for a request of ({2}, {3}) - {4} targets in the pool", allocatedSpecification.width, allocatedSpecification.height, specification.width, specification.height, s_renderTargets.size());
+	}
+
+	// The clear color and render size can differ between requests sharing a target
+	framebuffer->setClearColor(specification.clearColor);
+	framebuffer->setRenderSize(specification.width, specification.height);
+
+	return *framebuffer;
+}
+
+void RenderTargetPool::release(const Framebuffer& framebuffer)
+{
+	for (RenderTarget& renderTarget : s_renderTargets)
+	{
+		if (renderTarget.framebuffer.get() != &framebuffer)
+			continue;
+
+		ASSERT_MESSAGE(renderTarget.inUse, "Render target has already been released");
+
+		// Whatever is given the target next will clear or overwrite it, so the contents needn't be kept
+		framebuffer.invalidate();
+		renderTarget.inUse = false;
+		return;
+	}
+
+	ASSERT_MESSAGE(false, "Framebuffer was not acquired from the render target pool");
+}
+
+uint64_t RenderTargetPool::getMemoryUsage()
+{
+	uint64_t memoryUsage = 0;
+	for (const RenderTarget& renderTarget : s_renderTargets)
+		memoryUsage += renderTarget.framebuffer->getMemoryUsage();
+
+	return memoryUsage;
+}
+
+bool RenderTargetPool::isCompatible(const Framebuffer::FramebufferSpecification& allocated, const Framebuffer::FramebufferSpecification& requested)
+{
+	return allocated.width == roundUpToBucket(requested.width)
+		&& allocated.height == roundUpToBucket(requested.height)
+		&& allocated.colorAttachmentFormats == requested.colorAttachmentFormats
+		&& allocated.depthAttachmentFormat == requested.depthAttachmentFormat
+		&& allocated.samples == requested.samples;
+}
+
+uint32_t RenderTargetPool::roundUpToBucket(uint32_t size)
+{
+	// A minimised window has no size, but still needs a target
+	size = std::max(size, 1u);
+
+	return ((size + SIZE_BUCKET - 1) / SIZE_BUCKET) * SIZE_BUCKET;
+}
@@ -0,0 +1,64 @@
+#pragma once
+#include "PCH.h"
+
+#include "Framebuffer.h"
+
+/*
+The framebuffers that renderers draw each frame to, which are requested by specification rather than owned by each renderer.
+
+Targets are allocated with their size rounded up to a bucket, and drawn to at the requested size within that (see
+Framebuffer::setRenderSize). Resizing the window only reallocates a target when it crosses a bucket boundary, and only
+once the target is next requested, so dragging the edge of the window doesn't recreate every target on every resize
+event, and targets of renderers not in use aren't reallocated at all.
+
+A released target is reused by the next request with the same formats and bucket, so transient targets whose lifetimes
+don't overlap (within a frame, or between renderers) share memory. Targets that haven't been requested for a few frames are deleted.
+*/
+class RenderTargetPool
+{
+public:
+
+	// Allocated widths and heights are multiples of this
+	static constexpr uint32_t SIZE_BUCKET = 64;
+
+public:
+
+	static void init();
+	static void shutdown();
+
+	// Deletes targets which have gone unused. Every acquired target must have been released by then
+	static void endFrame();
+
+	// A framebuffer with the specification's attachments, samples and clear color, and a render size of its width and height.
+	// The contents are undefined until it is cleared or drawn to, and it is the caller's until it is released
+	static Framebuffer& acquire(const Framebuffer::FramebufferSpecification& specification);
+	// Returns the framebuffer to the pool, discarding its contents
+	static void release(const Framebuffer& framebuffer);
+
+	// Bytes used by every allocated target, whether in use or not
+	static uint64_t getMemoryUsage();
+	static uint32_t getTargetCount() { return static_cast<uint32_t>(s_renderTargets.size()); }
+
+private:
+
+	struct RenderTarget
+	{
+		Unique<Framebuffer> framebuffer;
+		bool inUse = false;
+		uint64_t lastUsedFrame = 0;
+	};
+
+	// Frames a target can go unrequested for before it is deleted
+	static constexpr uint64_t UNUSED_FRAME_LIMIT = 8;
+
+private:
+
+	// Whether a framebuffer allocated with the specification can be given to a request for the other specification
+	static bool isCompatible(const Framebuffer::FramebufferSpecification& allocated, const Framebuffer::FramebufferSpecification& requested);
+	static uint32_t roundUpToBucket(uint32_t size);
+
+private:
+
+	static std::vector<RenderTarget> s_renderTargets;
+	static uint64_t s_frameIndex;
+};
@@ -3,26 +3,49 @@
 
 #include "glad/glad.h"
 
-RendererID Renderer::s_vertexArrayRendererID = 0;
+#include "Core/Profiler.h"
+
+#include "FrameStatistics.h"
+#include "GeometryArena.h"
+#include "GLStateCache.h"
+#include "RenderTargetPool.h"
+#include "VertexArray.h"
 
 Renderer::RendererType Renderer::s_currentRendererType = Renderer::RendererType::BLINN_PHONG;
+AntiAliasing::Mode Renderer::s_antiAliasingMode = AntiAliasing::Mode::MSAA_8X;
 
 RendererImplementation* Renderer::s_currentRendererImplementation = nullptr;
 Unique<BlinnPhongRendererImplementation> Renderer::s_blinnPhongRendererImplementation;
 Unique<PBRRendererImplementation> Renderer::s_PBRRendererImplementation;
+Unique<PBRDeferredRendererImplementation> Renderer::s_PBRDeferredRendererImplementation;
+
+std::array<Renderer::FrameTimeQuery, Renderer::FRAME_TIME_QUERY_COUNT> Renderer::s_frameTimeQueries;
+uint32_t Renderer::s_nextFrameTimeQuery = 0;
+std::map<std::pair<Renderer::RendererType, AntiAliasing::Mode>, float> Renderer::s_GPUFrameTimes;
+
+Unique<SoftwareOcclusionCuller> Renderer::s_occlusionCuller;
+bool Renderer::s_occlusionCullingEnabled = false;
+
+Unique<DynamicResolution> Renderer::s_dynamicResolution;
+bool Renderer::s_dynamicResolutionEnabled = false;
+
+Unique<FrameCapture> Renderer::s_frameCapture;
+
+// Weight of the newest frame in the averaged GPU frame times
+static constexpr float FRAME_TIME_SMOOTHING_FACTOR = 0.1f;
 
 static void openGLErrorCallback(GLenum source, GLenum type, GLuint id, GLenum severity, GLsizei length, const GLchar* message, const void* userParam)
 {
 	switch (severity)
 	{
 	case GL_DEBUG_SEVERITY_HIGH:
-		Log::critical("OpenGL Error [{0}]: {1}", type, message);
+		RendererLog::critical("OpenGL Error [{0}]: {1}", type, message);
 		break;
 	case GL_DEBUG_SEVERITY_MEDIUM:
-		Log::error("OpenGL Error [{0}]: {1}", type, message);
+		RendererLog::error("OpenGL Error [{0}]: {1}", type, message);
 		break;
 	case GL_DEBUG_SEVERITY_LOW:
-		Log::warn("OpenGL Error [{0}]: {1}", type, message);
+		RendererLog::warn("OpenGL Error [{0}]: {1}", type, message);
 		break;
 	default:
 		break;
@@ -46,43 +69,87 @@ void Renderer::init()
 	glEnable(GL_CULL_FACE);
 	glFrontFace(GL_CCW);
 
-	// Set up blending
+	// Set up blending - it is left disabled, and only enabled by the renderers for transparent geometry
 
-	glEnable(GL_BLEND);
 	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
-	// Create the one global Vertex Array Object (VAO).
-	// This VAO is necessary for OpenGL to work but adds no real functionality or performance.
-	// As such, one global VAO is used for everything
+	// All binds go through the state cache from here on
+
+	GLStateCache::init();
 
-	glCreateVertexArrays(1, &s_vertexArrayRendererID);
-	glBindVertexArray(s_vertexArrayRendererID);
+	// All model geometry lives in the geometry arena, so it must exist before any models are created
+	GeometryArena::init(Model::getVertexBufferLayout(), Model::getPositionVertexBufferLayout());
+	RenderTargetPool::init();
 
 	s_blinnPhongRendererImplementation = createUnique<BlinnPhongRendererImplementation>();
 	s_PBRRendererImplementation = createUnique<PBRRendererImplementation>();
+	s_PBRDeferredRendererImplementation = createUnique<PBRDeferredRendererImplementation>();
+
+	for (FrameTimeQuery& frameTimeQuery : s_frameTimeQueries)
+		frameTimeQuery.query = createUnique<Query>(Query::QueryType::TIME_ELAPSED);
+
+	s_occlusionCuller = createUnique<SoftwareOcclusionCuller>();
+	s_dynamicResolution = createUnique<DynamicResolution>();
 
 	s_currentRendererImplementation = static_cast<RendererImplementation*>(s_blinnPhongRendererImplementation.get());
 
-	Log::info("Renderer initialised");
+	RendererLog::info("Renderer initialised");
 }
 
 void Renderer::shutdown()
 {
-	glDeleteVertexArrays(1, &s_vertexArrayRendererID);
+	stopFrameCapture();
+
 	s_blinnPhongRendererImplementation.reset();
 	s_PBRRendererImplementation.reset();
+	s_PBRDeferredRendererImplementation.reset();
+
+	for (FrameTimeQuery& frameTimeQuery : s_frameTimeQueries)
+		frameTimeQuery = FrameTimeQuery();
+	s_GPUFrameTimes.clear();
+
+	s_occlusionCuller.reset();
+	s_dynamicResolution.reset();
+
+	RenderTargetPool::shutdown();
+	GeometryArena::shutdown();
+	VertexArray::clearCache();
+	GLStateCache::shutdown();
 }
 
 void Renderer::onWindowResizeEvent(uint32_t width, uint32_t height)
 {
-	glViewport(0, 0, width, height);
+	GLStateCache::setViewport(0, 0, width, height);
+}
+
+void Renderer::endFrame()
+{
+	PROFILE_GPU_SCOPE("End frame");
+
+	// Read before the window is updated, as the back buffer is undefined once it has been presented
+	if (s_frameCapture)
+		s_frameCapture->captureFrame();
+
+	RenderTargetPool::endFrame();
 
-	// Not just propogating the resize to the current renderer implementation
-	// as even the renderer not currently being used should be updating its state
-	// - if it doesn't, then when it gets switched in there may be issues
+	const GLStateCache::Statistics& statistics = GLStateCache::getStatistics();
 
-	s_blinnPhongRendererImplementation->onWindowResizeEvent(width, height);
-	s_PBRRendererImplementation->onWindowResizeEvent(width, height);
+	RendererLog::trace("GL state cache (issued / elided):");
+	RendererLog::trace("\tProgram binds:       {0} / {1}", statistics.programBinds, statistics.programBindsElided);
+	RendererLog::trace("\tBuffer binds:        {0} / {1}", statistics.bufferBinds, statistics.bufferBindsElided);
+	RendererLog::trace("\tTexture binds:       {0} / {1}", statistics.textureBinds, statistics.textureBindsElided);
+	RendererLog::trace("\tFramebuffer binds:   {0} / {1}", statistics.framebufferBinds, statistics.framebufferBindsElided);
+	RendererLog::trace("\tViewport changes:    {0} / {1}", statistics.viewportChanges, statistics.viewportChangesElided);
+	RendererLog::trace("\tVertex array binds:  {0} / {1}", statistics.vertexArrayBinds, statistics.vertexArrayBindsElided);
+	RendererLog::trace("\tUniform uploads:     {0} / {1}", statistics.uniformUploads, statistics.uniformUploadsElided);
+
+	FrameStatistics::endFrame();
+
+	RendererLog::trace("Render target pool: {0} targets, {1:.1f} MB", RenderTargetPool::getTargetCount(), static_cast<float>(RenderTargetPool::getMemoryUsage()) / (1024.0f * 1024.0f));
+
+	RendererLog::trace("GPU frame time (ms):");
+	for (const auto& [key, frameTime] : s_GPUFrameTimes)
+		RendererLog::trace("\t{0} ({1}): {2:.3f}", getRendererTypeName(key.first), AntiAliasing::getModeName(key.second), frameTime);
 }
 
 void Renderer::setRendererType(RendererType rendererType)
@@ -91,33 +158,95 @@ void Renderer::setRendererType(RendererType rendererType)
 	{
 	case Renderer::RendererType::BLINN_PHONG:
 		s_currentRendererImplementation = static_cast<RendererImplementation*>(s_blinnPhongRendererImplementation.get());
-		Log::info("Switched to Blinn-Phong Renderer Implementation");
+		RendererLog::info("Switched to Blinn-Phong Renderer Implementation");
 		break;
 	case Renderer::RendererType::PBR:
 		s_currentRendererImplementation = static_cast<RendererImplementation*>(s_PBRRendererImplementation.get());
-		Log::info("Switched to PBR Implementation");
+		RendererLog::info("Switched to PBR Implementation");
+		break;
+	case Renderer::RendererType::PBR_DEFERRED:
+		s_currentRendererImplementation = static_cast<RendererImplementation*>(s_PBRDeferredRendererImplementation.get());
+		RendererLog::info("Switched to PBR Deferred Implementation");
 		break;
 	default:
 		ASSERT_MESSAGE(false, "Unknown RendererType");
 		break;
 	}
 
-	Log::info("Switched renderer type");
+	s_currentRendererType = rendererType;
+
+	RendererLog::info("Switched renderer type");
+}
+
+bool Renderer::getRendererType(const std::string& name, RendererType& rendererType)
+{
+	static const std::unordered_map<std::string, RendererType> RENDERER_TYPE_NAMES =
+	{
+		{ "blinn-phong", RendererType::BLINN_PHONG },
+		{ "pbr", RendererType::PBR },
+		{ "deferred", RendererType::PBR_DEFERRED }
+	};
+
+	auto rendererTypeName = RENDERER_TYPE_NAMES.find(name);
+	if (rendererTypeName == RENDERER_TYPE_NAMES.end())
+		return false;
+
+	rendererType = rendererTypeName->second;
+	return true;
 }
 
 void Renderer::beginScene(const Camera& camera, const std::vector<Reference<PointLight>>& pointLights)
 {
+	PROFILE_GPU_SCOPE("Begin scene");
+
 	s_currentRendererImplementation->beginScene(camera, pointLights);
 }
 
 void Renderer::endScene(float exposureLevel)
 {
+	PROFILE_GPU_SCOPE("End scene");
+
 	s_currentRendererImplementation->endScene(exposureLevel);
 }
 
 void Renderer::drawScene(const Reference<Scene>& scene, const Camera& camera)
 {
+	PROFILE_GPU_SCOPE("Draw scene");
+
+	// Occlusion culling happens entirely on the CPU, before anything is submitted
+	if (s_occlusionCullingEnabled)
+	{
+		PROFILE_SCOPE("Software occlusion culling");
+		s_occlusionCuller->cullModels(scene->getModelsAndTransforms(), camera.getProjectionMatrix() * camera.getViewMatrix());
+		s_currentRendererImplementation->setModelVisibility(&s_occlusionCuller->getModelVisibility());
+	}
+	else
+		s_currentRendererImplementation->setModelVisibility(nullptr);
+
+	readFrameTimeQueryResults();
+
+	if (s_dynamicResolutionEnabled)
+		s_PBRRendererImplementation->setRenderScale(s_dynamicResolution->getRenderScale());
+
+	// If the GPU is so far behind that the next query is still in use, this frame isn't timed rather than waiting for it
+	FrameTimeQuery& frameTimeQuery = s_frameTimeQueries[s_nextFrameTimeQuery];
+	bool timed = !frameTimeQuery.pending;
+
+	if (timed)
+		frameTimeQuery.query->begin();
+
 	s_currentRendererImplementation->drawScene(scene, camera);
+
+	if (timed)
+	{
+		frameTimeQuery.query->end();
+		frameTimeQuery.rendererType = s_currentRendererType;
+		frameTimeQuery.antiAliasingMode = s_antiAliasingMode;
+		frameTimeQuery.renderScale = s_currentRendererType == RendererType::PBR ? s_PBRRendererImplementation->getRenderScale() : 1.0f;
+		frameTimeQuery.pending = true;
+
+		s_nextFrameTimeQuery = (s_nextFrameTimeQuery + 1) % FRAME_TIME_QUERY_COUNT;
+	}
 }
 
 void Renderer::drawModel(Reference<Model> model, const glm::mat4& transform)
@@ -125,6 +254,133 @@ void Renderer::drawModel(Reference<Model> model, const glm::mat4& transform)
 	s_currentRendererImplementation->drawModel(model, transform);
 }
 
+void Renderer::setDepthPrepassEnabled(bool enabled)
+{
+	s_blinnPhongRendererImplementation->setDepthPrepassEnabled(enabled);
+	s_PBRRendererImplementation->setDepthPrepassEnabled(enabled);
+	s_PBRDeferredRendererImplementation->setDepthPrepassEnabled(enabled);
+
+	RendererLog::info("Depth pre-pass {0}", enabled ? "enabled" : "disabled");
+}
+
+void Renderer::setShadedSampleCountingEnabled(bool enabled)
+{
+	s_blinnPhongRendererImplementation->setShadedSampleCountingEnabled(enabled);
+	s_PBRRendererImplementation->setShadedSampleCountingEnabled(enabled);
+	s_PBRDeferredRendererImplementation->setShadedSampleCountingEnabled(enabled);
+}
+
+uint64_t Renderer::getShadedSampleCount()
+{
+	return s_currentRendererImplementation->getShadedSampleCount();
+}
+
+void Renderer::setOcclusionCullingEnabled(bool enabled)
+{
+	s_occlusionCullingEnabled = enabled;
+
+	RendererLog::info("Software occlusion culling {0}", enabled ? "enabled" : "disabled");
+}
+
+const SoftwareOcclusionCuller::Statistics& Renderer::getOcclusionCullingStatistics()
+{
+	return s_occlusionCuller->getStatistics();
+}
+
+float Renderer::getGPUFrameTime(RendererType rendererType, AntiAliasing::Mode antiAliasingMode)
+{
+	auto it = s_GPUFrameTimes.find({ rendererType, antiAliasingMode });
+	return it != s_GPUFrameTimes.end() ? it->second : 0.0f;
+}
+
+float Renderer::getGPUFrameTime(RendererType rendererType)
+{
+	return getGPUFrameTime(rendererType, s_antiAliasingMode);
+}
+
+void Renderer::setAntiAliasingMode(AntiAliasing::Mode mode)
+{
+	if (mode == s_antiAliasingMode)
+		return;
+
+	s_blinnPhongRendererImplementation->setAntiAliasingMode(mode);
+	s_PBRRendererImplementation->setAntiAliasingMode(mode);
+	s_PBRDeferredRendererImplementation->setAntiAliasingMode(mode);
+
+	s_antiAliasingMode = mode;
+
+	RendererLog::info("Anti-aliasing set to {0}", AntiAliasing::getModeName(mode));
+	for (RendererType rendererType : { RendererType::BLINN_PHONG, RendererType::PBR, RendererType::PBR_DEFERRED })
+		RendererLog::info("\t{0} render targets: {1:.1f} MB", getRendererTypeName(rendererType), static_cast<float>(getRenderTargetMemoryUsage(rendererType)) / (1024.0f * 1024.0f));
+}
+
+uint64_t Renderer::getRenderTargetMemoryUsage(RendererType rendererType)
+{
+	return getRendererImplementation(rendererType)->getRenderTargetMemoryUsage();
+}
+
+void Renderer::setGPUCullingEnabled(bool enabled)
+{
+	s_PBRRendererImplementation->setGPUCullingEnabled(enabled);
+
+	RendererLog::info("GPU culling {0}", enabled ? "enabled" : "disabled");
+}
+
+void Renderer::setGPUCullingDebugReadbackEnabled(bool enabled)
+{
+	s_PBRRendererImplementation->setGPUCullingDebugReadbackEnabled(enabled);
+}
+
+uint32_t Renderer::getGPUCullingVisibleDrawCount()
+{
+	return s_PBRRendererImplementation->getGPUCullingVisibleDrawCount();
+}
+
+void Renderer::setDynamicResolutionEnabled(bool enabled)
+{
+	if (enabled == s_dynamicResolutionEnabled)
+		return;
+
+	s_dynamicResolutionEnabled = enabled;
+	s_dynamicResolution->reset();
+
+	s_PBRRendererImplementation->setDynamicResolutionEnabled(enabled);
+	s_PBRRendererImplementation->setRenderScale(s_dynamicResolution->getRenderScale());
+
+	RendererLog::info("Dynamic resolution {0} (target frame time {1:.2f} ms)", enabled ? "enabled" : "disabled", s_dynamicResolution->getTargetFrameTime());
+}
+
+void Renderer::setTargetFrameTime(float targetFrameTime)
+{
+	s_dynamicResolution->setTargetFrameTime(targetFrameTime);
+}
+
+float Renderer::getRenderScale()
+{
+	return s_PBRRendererImplementation->getRenderScale();
+}
+
+void Renderer::startFrameCapture(const FrameCapture::CaptureSpecification& specification)
+{
+	stopFrameCapture();
+
+	s_frameCapture = createUnique<FrameCapture>(specification);
+
+	for (RendererType rendererType : { RendererType::BLINN_PHONG, RendererType::PBR, RendererType::PBR_DEFERRED })
+		getRendererImplementation(rendererType)->setFrameCapture(s_frameCapture.get());
+}
+
+void Renderer::stopFrameCapture()
+{
+	if (!s_frameCapture)
+		return;
+
+	for (RendererType rendererType : { RendererType::BLINN_PHONG, RendererType::PBR, RendererType::PBR_DEFERRED })
+		getRendererImplementation(rendererType)->setFrameCapture(nullptr);
+
+	s_frameCapture.reset();
+}
+
 void Renderer::clear()
 {
 	RendererUtilities::clear();
@@ -139,3 +395,67 @@ void Renderer::bindDefaultFramebuffer()
 {
 	RendererUtilities::bindDefaultFramebuffer();
 }
+
+void Renderer::readFrameTimeQueryResults()
+{
+	for (FrameTimeQuery& frameTimeQuery : s_frameTimeQueries)
+	{
+		if (!frameTimeQuery.pending || !frameTimeQuery.query->isResultAvailable())
+			continue;
+
+		float frameTime = static_cast<float>(frameTimeQuery.query->getResult()) / 1000000.0f;
+		frameTimeQuery.pending = false;
+
+		// The first result for a renderer type and anti-aliasing mode is taken as is
+		std::pair<RendererType, AntiAliasing::Mode> key = { frameTimeQuery.rendererType, frameTimeQuery.antiAliasingMode };
+		auto it = s_GPUFrameTimes.find(key);
+		if (it == s_GPUFrameTimes.end())
+			s_GPUFrameTimes[key] = frameTime;
+		else
+			it->second += (frameTime - it->second) * FRAME_TIME_SMOOTHING_FACTOR;
+
+		// The controller is given each result unsmoothed, along with the scale it was drawn at
+		if (s_dynamicResolutionEnabled && frameTimeQuery.rendererType == RendererType::PBR)
+			s_dynamicResolution->addFrameTime(frameTime, frameTimeQuery.renderScale);
+	}
+}
+
+const char* Renderer::getRendererTypeName(RendererType rendererType)
+{
+	switch (rendererType)
+	{
+	case Renderer::RendererType::BLINN_PHONG:
+		return "Blinn-Phong";
+		break;
+	case Renderer::RendererType::PBR:
+		return "PBR";
+		break;
+	case Renderer::RendererType::PBR_DEFERRED:
+		return "PBR Deferred";
+		break;
+	default:
+		ASSERT_MESSAGE(false, "Unknown RendererType");
+		return "";
+		break;
+	}
+}
+
+RendererImplementation* Renderer::getRendererImplementation(RendererType rendererType)
+{
+	switch (rendererType)
+	{
+	case Renderer::RendererType::BLINN_PHONG:
+		return static_cast<RendererImplementation*>(s_blinnPhongRendererImplementation.get());
+		break;
+	case Renderer::RendererType::PBR:
+		return static_cast<RendererImplementation*>(s_PBRRendererImplementation.get());
+		break;
+	case Renderer::RendererType::PBR_DEFERRED:
+		return static_cast<RendererImplementation*>(s_PBRDeferredRendererImplementation.get());
+		break;
+	default:
+		ASSERT_MESSAGE(false, "Unknown RendererType");
+		return nullptr;
+		break;
+	}
+}
@@ -1,10 +1,18 @@
 #pragma once
 #include "PCH.h"
 
+#include <array>
+#include <map>
+
 #include "RendererUtilities.h"
 #include "RendererImplementation.h"
 #include "BlinnPhongRendererImplementation.h"
 #include "PBRRendererImplementation.h"
+#include "PBRDeferredRendererImplementation.h"
+#include "Query.h"
+#include "SoftwareOcclusionCuller.h"
+#include "DynamicResolution.h"
+#include "FrameCapture.h"
 
 class Renderer
 {
@@ -13,7 +21,8 @@ public:
 	enum class RendererType
 	{
 		BLINN_PHONG = 0,
-		PBR
+		PBR,
+		PBR_DEFERRED
 	};
 
 public:
@@ -21,9 +30,15 @@ public:
 	static void init();
 	static void shutdown();
 
+	// Render targets are resized when they are next requested, so this only updates the viewport of the default framebuffer
 	static void onWindowResizeEvent(uint32_t width, uint32_t height);
 
+	// Called once all drawing for a frame is done
+	static void endFrame();
+
 	static void setRendererType(RendererType rendererType);
+	// Looks a renderer type up by its name, as given on the command line: "blinn-phong", "pbr" or "deferred"
+	static bool getRendererType(const std::string& name, RendererType& rendererType);
 
 	// Drawing methods
 
@@ -33,6 +48,55 @@ public:
 	static void drawScene(const Reference<Scene>& scene, const Camera& camera);
 	static void drawModel(Reference<Model> model, const glm::mat4& transform);
 
+	// GPU time taken by drawScene, in milliseconds, averaged over recent frames drawn with the renderer type and anti-aliasing mode.
+	// Timer results are read a few frames late rather than waiting for the GPU, and are 0 until the first arrives
+	static float getGPUFrameTime(RendererType rendererType, AntiAliasing::Mode antiAliasingMode);
+	// As above, with the current anti-aliasing mode
+	static float getGPUFrameTime(RendererType rendererType);
+
+	// Anti-aliasing (all renderers, though the deferred renderer only supports the post process modes)
+
+	static void setAntiAliasingMode(AntiAliasing::Mode mode);
+	static AntiAliasing::Mode getAntiAliasingMode() { return s_antiAliasingMode; }
+	// Bytes used by the renderer type's framebuffers with the current anti-aliasing mode
+	static uint64_t getRenderTargetMemoryUsage(RendererType rendererType);
+
+	// Depth pre-pass (all renderers)
+
+	static void setDepthPrepassEnabled(bool enabled);
+	// Counting the samples shaded by the main pass stalls the CPU each frame, so is off by default
+	static void setShadedSampleCountingEnabled(bool enabled);
+	static uint64_t getShadedSampleCount();
+
+	// Software occlusion culling (all renderers) - models hidden behind the largest meshes are culled on the CPU before being drawn
+
+	static void setOcclusionCullingEnabled(bool enabled);
+	// Only updated while occlusion culling is enabled
+	static const SoftwareOcclusionCuller::Statistics& getOcclusionCullingStatistics();
+
+	// GPU culling (PBR renderer only)
+
+	static void setGPUCullingEnabled(bool enabled);
+	// Reading back the number of visible draws stalls the CPU each frame, so is off by default
+	static void setGPUCullingDebugReadbackEnabled(bool enabled);
+	static uint32_t getGPUCullingVisibleDrawCount();
+
+	// Dynamic resolution (PBR renderer only) - the scene is drawn at a scale adjusted each frame to hold the GPU
+	// frame time at a target, and temporally upscaled to the window
+
+	static void setDynamicResolutionEnabled(bool enabled);
+	// In milliseconds
+	static void setTargetFrameTime(float targetFrameTime);
+	static float getRenderScale();
+
+	// Frame capture (all renderers) - each frame is read back at the end of endFrame and written out on another thread,
+	// along with the HDR and depth framebuffers of the PBR renderers when asked for
+
+	static void startFrameCapture(const FrameCapture::CaptureSpecification& specification);
+	// Waits for the captured frames still being read back or written
+	static void stopFrameCapture();
+	static bool isFrameCaptureActive() { return static_cast<bool>(s_frameCapture); }
+
 	// Utility methods
 
 	static void clear();
@@ -43,11 +107,44 @@ public:
 
 private:
 
-	static RendererID s_vertexArrayRendererID;
+	struct FrameTimeQuery
+	{
+		Unique<Query> query;
+		RendererType rendererType = RendererType::BLINN_PHONG;
+		AntiAliasing::Mode antiAliasingMode = AntiAliasing::Mode::MSAA_8X;
+		float renderScale = 1.0f;
+		bool pending = false;
+	};
+
+	static constexpr uint32_t FRAME_TIME_QUERY_COUNT = 4;
+
+private:
+
+	static void readFrameTimeQueryResults();
+
+	static const char* getRendererTypeName(RendererType rendererType);
+	static RendererImplementation* getRendererImplementation(RendererType rendererType);
+
+private:
 
 	static RendererType s_currentRendererType;
+	static AntiAliasing::Mode s_antiAliasingMode;
 
 	static RendererImplementation* s_currentRendererImplementation;
 	static Unique<BlinnPhongRendererImplementation> s_blinnPhongRendererImplementation;
 	static Unique<PBRRendererImplementation> s_PBRRendererImplementation;
+	static Unique<PBRDeferredRendererImplementation> s_PBRDeferredRendererImplementation;
+
+	// Queries are reused in turn, so results can be read once the GPU has finished with them without stalling
+	static std::array<FrameTimeQuery, FRAME_TIME_QUERY_COUNT> s_frameTimeQueries;
+	static uint32_t s_nextFrameTimeQuery;
+	static std::map<std::pair<RendererType, AntiAliasing::Mode>, float> s_GPUFrameTimes;
+
+	static Unique<SoftwareOcclusionCuller> s_occlusionCuller;
+	static bool s_occlusionCullingEnabled;
+
+	static Unique<DynamicResolution> s_dynamicResolution;
+	static bool s_dynamicResolutionEnabled;
+
+	static Unique<FrameCapture> s_frameCapture;
 };
\ No newline at end of file
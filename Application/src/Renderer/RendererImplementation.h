@@ -2,22 +2,94 @@
 #include "PCH.h"
 
 #include "Camera.h"
+#include "AntiAliasing.h"
+#include "RenderQueue.h"
+#include "RendererUtilities.h"
 #include "Scene/PointLight.h"
 #include "Scene/Model.h"
 #include "Scene/Scene.h"
 
+class FrameCapture;
+
 class RendererImplementation
 {
 public:
 
 	virtual ~RendererImplementation() = default;
 
-	virtual void onWindowResizeEvent(uint32_t width, uint32_t height) = 0;
-
 	virtual void drawScene(Reference<Scene> scene, const Camera& camera) = 0;
 
 	virtual void beginScene(const Camera& camera, const std::vector<Reference<PointLight>>& pointLights) = 0;
 	virtual void endScene(float exposureLevel = 1.0f) = 0;
 
 	virtual void drawModel(Reference<Model> model, const glm::mat4& transform) = 0;
+
+	// Depth pre-pass - depth is drawn first so that the main pass only shades the visible surface of each pixel
+	virtual void setDepthPrepassEnabled(bool enabled) = 0;
+
+	// Counting the samples shaded by the main pass stalls the CPU each frame, so is off by default
+	virtual void setShadedSampleCountingEnabled(bool enabled) = 0;
+	// Only updated while shaded sample counting is enabled
+	virtual uint64_t getShadedSampleCount() const = 0;
+
+	// MSAA modes change the samples of the scene framebuffer, and post process modes anti-alias the final image
+	virtual void setAntiAliasingMode(AntiAliasing::Mode mode) = 0;
+	// Bytes of GPU memory the renderer's render targets need at the window's size, which depends on the anti-aliasing mode.
+	// Targets requested from the render target pool are counted in full, though the pool shares memory between them
+	virtual uint64_t getRenderTargetMemoryUsage() const = 0;
+
+	// One entry per model in the scene, set while occlusion culling is enabled - drawScene skips models marked as hidden
+	void setModelVisibility(const std::vector<uint8_t>* modelVisibility) { m_modelVisibility = modelVisibility; }
+
+	// Set while frames are captured, so that renderers with HDR and depth framebuffers can copy them out for capture
+	void setFrameCapture(FrameCapture* frameCapture) { m_frameCapture = frameCapture; }
+
+protected:
+
+	FrameCapture* getFrameCapture() const { return m_frameCapture; }
+
+	bool isModelVisible(uint32_t modelIndex) const { return !m_modelVisibility || (*m_modelVisibility)[modelIndex]; }
+
+	// Sets the depth and blending state for drawing the batches of a render queue pass
+	static void setPassState(RenderQueue::Pass pass, bool depthPrepassEnabled)
+	{
+		switch (pass)
+		{
+		case RenderQueue::Pass::SOLID:
+			// The pre-pass has already written the closest depth of each pixel, so only fragments
+			// at exactly that depth (the visible ones) are shaded
+			RendererUtilities::setDepthFunction(depthPrepassEnabled ? RendererUtilities::DepthFunction::EQUAL : RendererUtilities::DepthFunction::LESS);
+			RendererUtilities::setDepthWriteEnabled(!depthPrepassEnabled);
+			RendererUtilities::setBlendingEnabled(false);
+			break;
+		case RenderQueue::Pass::MASKED:
+			// Alpha tested geometry isn't in the pre-pass, as discarding fragments there would stop early depth testing
+			RendererUtilities::setDepthFunction(RendererUtilities::DepthFunction::LESS);
+			RendererUtilities::setDepthWriteEnabled(true);
+			RendererUtilities::setBlendingEnabled(false);
+			break;
+		case RenderQueue::Pass::BLENDED:
+			// Blended geometry is tested against, but doesn't hide, what is behind it
+			RendererUtilities::setDepthFunction(RendererUtilities::DepthFunction::LESS);
+			RendererUtilities::setDepthWriteEnabled(false);
+			RendererUtilities::setBlendingEnabled(true);
+			break;
+		default:
+			ASSERT_MESSAGE(false, "Cannot set state for render queue pass");
+			break;
+		}
+	}
+
+	// Restores the state changed by setPassState
+	static void resetPassState()
+	{
+		RendererUtilities::setDepthFunction(RendererUtilities::DepthFunction::LESS);
+		RendererUtilities::setDepthWriteEnabled(true);
+		RendererUtilities::setBlendingEnabled(false);
+	}
+
+private:
+
+	const std::vector<uint8_t>* m_modelVisibility = nullptr;
+	FrameCapture* m_frameCapture = nullptr;
 };
\ No newline at end of file
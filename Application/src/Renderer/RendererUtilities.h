@@ -5,16 +5,50 @@
 
 using RendererID = uint32_t;
 
+struct DrawElementsIndirectCommand;
+
 class RendererUtilities
 {
+public:
+
+	enum class DepthFunction
+	{
+		LESS = 0,
+		EQUAL
+	};
+
 public:
 
 	static void drawIndexed(uint32_t count);
 	static void drawIndexedFromVertexOffset(uint32_t count, const void* startOfIndices, uint32_t vertexOffset);
+	// Draws using the DrawElementsIndirectCommands in the bound indirect buffer. The CPU's copy of the commands is only
+	// read to count them in the frame statistics
+	static void multiDrawIndexedIndirect(const void* startOfCommands, uint32_t drawCount, const DrawElementsIndirectCommand* commands);
+	// As above, but the number of draws is read from the bound parameter buffer (and is at most maxDrawCount). All
+	// maxDrawCount commands are counted, as the number drawn is only known on the GPU
+	static void multiDrawIndexedIndirectCount(const void* startOfCommands, const void* drawCountOffset, uint32_t maxDrawCount, const DrawElementsIndirectCommand* commands);
+
+	static void dispatchCompute(uint32_t groupCountX, uint32_t groupCountY = 1, uint32_t groupCountZ = 1);
 
 	static void clear();
 
+	static void setDepthFunction(DepthFunction depthFunction);
+	// Clearing only clears depth while depth writes are enabled
+	static void setDepthWriteEnabled(bool enabled);
+	static void setColorWriteEnabled(bool enabled);
+	// Blending is off by default, and only enabled while transparent geometry is drawn
+	static void setBlendingEnabled(bool enabled);
+	// Back faces are culled by default
+	static void setFaceCullingEnabled(bool enabled);
+
 	static void setClearColor(const glm::vec4& color);
 
 	static void bindDefaultFramebuffer();
+	// The framebuffer drawn to in place of the window's (0), when there is no window to draw to
+	static void setDefaultFramebufferRendererID(RendererID rendererID) { s_defaultFramebufferRendererID = rendererID; }
+	static RendererID getDefaultFramebufferRendererID() { return s_defaultFramebufferRendererID; }
+
+private:
+
+	static RendererID s_defaultFramebufferRendererID;
 };
\ No newline at end of file
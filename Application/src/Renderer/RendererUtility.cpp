@@ -3,19 +3,53 @@
 
 #include "glad/glad.h"
 
+#include "Core/Application.h"
+
+#include "FrameStatistics.h"
+#include "GLStateCache.h"
+#include "IndirectBuffer.h"
+
+RendererID RendererUtilities::s_defaultFramebufferRendererID = 0;
+
 void RendererUtilities::drawIndexed(uint32_t count)
 {
 	// Just using GL_TRIANGLES as the render primitive for now
 	glDrawElements(GL_TRIANGLES, count, GL_UNSIGNED_INT, nullptr);
+	FrameStatistics::recordDraw(count);
 
-	Log::trace("Drew {0} indices", count);
+	RendererLog::trace("Drew {0} indices", count);
 }
 
 void RendererUtilities::drawIndexedFromVertexOffset(uint32_t count, const void* startOfIndices, uint32_t vertexOffset)
 {
 	glDrawElementsBaseVertex(GL_TRIANGLES, count, GL_UNSIGNED_INT, startOfIndices, static_cast<int32_t>(vertexOffset));
+	FrameStatistics::recordDraw(count);
+
+	RendererLog::trace("Drew {0} indices, from index {1}, with vertex offset {2}", count, startOfIndices, vertexOffset);
+}
+
+void RendererUtilities::multiDrawIndexedIndirect(const void* startOfCommands, uint32_t drawCount, const DrawElementsIndirectCommand* commands)
+{
+	glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, startOfCommands, drawCount, 0);
+	FrameStatistics::recordIndirectDraws(commands, drawCount);
+
+	RendererLog::trace("Multi-drew {0} indirect draws, from command offset {1}", drawCount, startOfCommands);
+}
+
+void RendererUtilities::multiDrawIndexedIndirectCount(const void* startOfCommands, const void* drawCountOffset, uint32_t maxDrawCount, const DrawElementsIndirectCommand* commands)
+{
+	glMultiDrawElementsIndirectCount(GL_TRIANGLES, GL_UNSIGNED_INT, startOfCommands, reinterpret_cast<GLintptr>(drawCountOffset), maxDrawCount, 0);
+	FrameStatistics::recordIndirectDraws(commands, maxDrawCount);
+
+	RendererLog::trace("Multi-drew up to {0} indirect draws, from command offset {1} with the draw count at {2}", maxDrawCount, startOfCommands, drawCountOffset);
+}
+
+void RendererUtilities::dispatchCompute(uint32_t groupCountX, uint32_t groupCountY, uint32_t groupCountZ)
+{
+	glDispatchCompute(groupCountX, groupCountY, groupCountZ);
+	FrameStatistics::recordComputeDispatch();
 
-	Log::trace("Drew {0} indices, from index {1}, with vertex offset {2}", count, startOfIndices, vertexOffset);
+	RendererLog::trace("Dispatched ({0}, {1}, {2}) compute work groups", groupCountX, groupCountY, groupCountZ);
 }
 
 void RendererUtilities::clear()
@@ -23,6 +57,45 @@ void RendererUtilities::clear()
 	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
 }
 
+void RendererUtilities::setDepthFunction(DepthFunction depthFunction)
+{
+	switch (depthFunction)
+	{
+	case RendererUtilities::DepthFunction::LESS:  glDepthFunc(GL_LESS);  break;
+	case RendererUtilities::DepthFunction::EQUAL: glDepthFunc(GL_EQUAL); break;
+	default:
+		ASSERT_MESSAGE(false, "Unknown depthFunction");
+		break;
+	}
+}
+
+void RendererUtilities::setDepthWriteEnabled(bool enabled)
+{
+	glDepthMask(enabled ? GL_TRUE : GL_FALSE);
+}
+
+void RendererUtilities::setColorWriteEnabled(bool enabled)
+{
+	GLboolean mask = enabled ? GL_TRUE : GL_FALSE;
+	glColorMask(mask, mask, mask, mask);
+}
+
+void RendererUtilities::setBlendingEnabled(bool enabled)
+{
+	if (enabled)
+		glEnable(GL_BLEND);
+	else
+		glDisable(GL_BLEND);
+}
+
+void RendererUtilities::setFaceCullingEnabled(bool enabled)
+{
+	if (enabled)
+		glEnable(GL_CULL_FACE);
+	else
+		glDisable(GL_CULL_FACE);
+}
+
 void RendererUtilities::setClearColor(const glm::vec4& color)
 {
 	glClearColor(color.r, color.g, color.b, color.a);
@@ -30,9 +103,11 @@ void RendererUtilities::setClearColor(const glm::vec4& color)
 
 void RendererUtilities::bindDefaultFramebuffer()
 {
-	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	// Render targets can set a viewport smaller than the window
+	GLStateCache::bindFramebuffer(s_defaultFramebufferRendererID);
+	GLStateCache::setViewport(0, 0, Application::getWindow().getWidth(), Application::getWindow().getHeight());
 
-	Log::trace("Bound the default framebuffer");
+	RendererLog::trace("Bound the default framebuffer");
 }
 
 
@@ -3,6 +3,8 @@
 
 #include "glm/gtc/type_ptr.hpp"
 
+#include "GLStateCache.h"
+
 Shader::Shader(const std::initializer_list<std::string>& individualShaderSourceFilePaths)
 	: m_individualShaderSourceFilePaths(individualShaderSourceFilePaths)
 {
@@ -14,131 +16,191 @@ Shader::Shader(const std::initializer_list<std::string>& individualShaderSourceF
 		linkProgram();
 		cleanUpIndividualShaders();
 
-		Log::info("Created shader {0}", m_rendererID);
+		ShaderLog::info("Created shader {0}", m_rendererID);
 	}
 	catch (const ShaderCreationException& e)
 	{
-		Log::error(e.what());
+		ShaderLog::error(e.what());
 	}
 }
 
 Shader::~Shader()
 {
-	glDeleteProgram(m_rendererID);
+	GLStateCache::deleteProgram(m_rendererID);
 
-	Log::info("Deleted shader {0}", m_rendererID);
+	ShaderLog::info("Deleted shader {0}", m_rendererID);
 }
 
 void Shader::bind() const
 {
-	glUseProgram(m_rendererID);
+	GLStateCache::useProgram(m_rendererID);
 
-	Log::trace("Bound shader {0}", m_rendererID);
+	ShaderLog::trace("Bound shader {0}", m_rendererID);
 }
 
 void Shader::setUniformToValue(const std::string uniformIdentifier, float value)
 {
-	glUniform1f(getUniformLocation(uniformIdentifier), value);
+	int32_t location = getUniformLocation(uniformIdentifier);
+	if (!GLStateCache::updateUniform(m_rendererID, location, value))
+		return;
+
+	glProgramUniform1f(m_rendererID, location, value);
 
-	Log::trace("Set uniform '{0}' in shader {1} to value = {2}", uniformIdentifier, m_rendererID, value);
+	ShaderLog::trace("Set uniform '{0}' in shader {1} to value = {2}", uniformIdentifier, m_rendererID, value);
 }
 
 void Shader::setUniformToValue(const std::string uniformIdentifier, const glm::vec2& value)
 {
-	glUniform2f(getUniformLocation(uniformIdentifier), value.x, value.y);
+	int32_t location = getUniformLocation(uniformIdentifier);
+	if (!GLStateCache::updateUniform(m_rendererID, location, value))
+		return;
 
-	Log::trace("Set uniform '{0}' in shader {1} to value of type glm::vec2", uniformIdentifier, m_rendererID);
+	glProgramUniform2f(m_rendererID, location, value.x, value.y);
+
+	ShaderLog::trace("Set uniform '{0}' in shader {1} to value of type glm::vec2", uniformIdentifier, m_rendererID);
 }
 
 void Shader::setUniformToValue(const std::string uniformIdentifier, const glm::vec3& value)
 {
-	glUniform3f(getUniformLocation(uniformIdentifier), value.x, value.y, value.z);
+	int32_t location = getUniformLocation(uniformIdentifier);
+	if (!GLStateCache::updateUniform(m_rendererID, location, value))
+		return;
+
+	glProgramUniform3f(m_rendererID, location, value.x, value.y, value.z);
 
-	Log::trace("Set uniform '{0}' in shader {1} to value of type glm::vec3", uniformIdentifier, m_rendererID);
+	ShaderLog::trace("Set uniform '{0}' in shader {1} to value of type glm::vec3", uniformIdentifier, m_rendererID);
 }
 
 void Shader::setUniformToValue(const std::string uniformIdentifier, const glm::vec4& value)
 {
-	glUniform4f(getUniformLocation(uniformIdentifier), value.x, value.y, value.z, value.w);
+	int32_t location = getUniformLocation(uniformIdentifier);
+	if (!GLStateCache::updateUniform(m_rendererID, location, value))
+		return;
 
-	Log::trace("Set uniform '{0}' in shader {1} to value of type glm::vec4", uniformIdentifier, m_rendererID);
+	glProgramUniform4f(m_rendererID, location, value.x, value.y, value.z, value.w);
+
+	ShaderLog::trace("Set uniform '{0}' in shader {1} to value of type glm::vec4", uniformIdentifier, m_rendererID);
 }
 
 void Shader::setUniformToValue(const std::string uniformIdentifier, const uint32_t value)
 {
-	glUniform1ui(getUniformLocation(uniformIdentifier), value);
+	int32_t location = getUniformLocation(uniformIdentifier);
+	if (!GLStateCache::updateUniform(m_rendererID, location, value))
+		return;
+
+	glProgramUniform1ui(m_rendererID, location, value);
 
-	Log::trace("Set uniform '{0}' in shader {1} to value = {2}", uniformIdentifier, m_rendererID, value);
+	ShaderLog::trace("Set uniform '{0}' in shader {1} to value = {2}", uniformIdentifier, m_rendererID, value);
 }
 
 void Shader::setUniformToValue(const std::string uniformIdentifier, const glm::uvec2& value)
 {
-	glUniform2ui(getUniformLocation(uniformIdentifier), value.x, value.y);
+	int32_t location = getUniformLocation(uniformIdentifier);
+	if (!GLStateCache::updateUniform(m_rendererID, location, value))
+		return;
 
-	Log::trace("Set uniform '{0}' in shader {1} to value of type glm::uvec2", uniformIdentifier, m_rendererID);
+	glProgramUniform2ui(m_rendererID, location, value.x, value.y);
+
+	ShaderLog::trace("Set uniform '{0}' in shader {1} to value of type glm::uvec2", uniformIdentifier, m_rendererID);
 }
 
 void Shader::setUniformToValue(const std::string uniformIdentifier, const glm::uvec3& value)
 {
-	glUniform3ui(getUniformLocation(uniformIdentifier), value.x, value.y, value.z);
+	int32_t location = getUniformLocation(uniformIdentifier);
+	if (!GLStateCache::updateUniform(m_rendererID, location, value))
+		return;
+
+	glProgramUniform3ui(m_rendererID, location, value.x, value.y, value.z);
 
-	Log::trace("Set uniform '{0}' in shader {1} to value of type glm::uvec3", uniformIdentifier, m_rendererID);
+	ShaderLog::trace("Set uniform '{0}' in shader {1} to value of type glm::uvec3", uniformIdentifier, m_rendererID);
 }
 
 void Shader::setUniformToValue(const std::string uniformIdentifier, const glm::uvec4& value)
 {
-	glUniform4ui(getUniformLocation(uniformIdentifier), value.x, value.y, value.z, value.w);
+	int32_t location = getUniformLocation(uniformIdentifier);
+	if (!GLStateCache::updateUniform(m_rendererID, location, value))
+		return;
 
-	Log::trace("Set uniform '{0}' in shader {1} to value of type glm::uvec4", uniformIdentifier, m_rendererID);
+	glProgramUniform4ui(m_rendererID, location, value.x, value.y, value.z, value.w);
+
+	ShaderLog::trace("Set uniform '{0}' in shader {1} to value of type glm::uvec4", uniformIdentifier, m_rendererID);
 }
 
 void Shader::setUniformToValue(const std::string uniformIdentifier, const int32_t value)
 {
-	glUniform1i(getUniformLocation(uniformIdentifier), value);
+	int32_t location = getUniformLocation(uniformIdentifier);
+	if (!GLStateCache::updateUniform(m_rendererID, location, value))
+		return;
+
+	glProgramUniform1i(m_rendererID, location, value);
 
-	Log::trace("Set uniform '{0}' in shader {1} to value = {2}", uniformIdentifier, m_rendererID, value);
+	ShaderLog::trace("Set uniform '{0}' in shader {1} to value = {2}", uniformIdentifier, m_rendererID, value);
 }
 
 void Shader::setUniformToValue(const std::string uniformIdentifier, const glm::ivec2& value)
 {
-	glUniform2i(getUniformLocation(uniformIdentifier), value.x, value.y);
+	int32_t location = getUniformLocation(uniformIdentifier);
+	if (!GLStateCache::updateUniform(m_rendererID, location, value))
+		return;
 
-	Log::trace("Set uniform '{0}' in shader {1} to value of type glm::ivec2", uniformIdentifier, m_rendererID);
+	glProgramUniform2i(m_rendererID, location, value.x, value.y);
+
+	ShaderLog::trace("Set uniform '{0}' in shader {1} to value of type glm::ivec2", uniformIdentifier, m_rendererID);
 }
 
 void Shader::setUniformToValue(const std::string uniformIdentifier, const glm::ivec3& value)
 {
-	glUniform3i(getUniformLocation(uniformIdentifier), value.x, value.y, value.z);
+	int32_t location = getUniformLocation(uniformIdentifier);
+	if (!GLStateCache::updateUniform(m_rendererID, location, value))
+		return;
+
+	glProgramUniform3i(m_rendererID, location, value.x, value.y, value.z);
 
-	Log::trace("Set uniform '{0}' in shader {1} to value of type glm::ivec3", uniformIdentifier, m_rendererID);
+	ShaderLog::trace("Set uniform '{0}' in shader {1} to value of type glm::ivec3", uniformIdentifier, m_rendererID);
 }
 
 void Shader::setUniformToValue(const std::string uniformIdentifier, const glm::ivec4& value)
 {
-	glUniform4i(getUniformLocation(uniformIdentifier), value.x, value.y, value.z, value.w);
+	int32_t location = getUniformLocation(uniformIdentifier);
+	if (!GLStateCache::updateUniform(m_rendererID, location, value))
+		return;
 
-	Log::trace("Set uniform '{0}' in shader {1} to value of type glm::ivec4", uniformIdentifier, m_rendererID);
+	glProgramUniform4i(m_rendererID, location, value.x, value.y, value.z, value.w);
+
+	ShaderLog::trace("Set uniform '{0}' in shader {1} to value of type glm::ivec4", uniformIdentifier, m_rendererID);
 }
 
 void Shader::setUniformToValue(const std::string uniformIdentifier, const glm::mat2& value)
 {
-	glUniformMatrix2fv(getUniformLocation(uniformIdentifier), 1, false, glm::value_ptr(value));
+	int32_t location = getUniformLocation(uniformIdentifier);
+	if (!GLStateCache::updateUniform(m_rendererID, location, value))
+		return;
+
+	glProgramUniformMatrix2fv(m_rendererID, location, 1, false, glm::value_ptr(value));
 
-	Log::trace("Set uniform '{0}' in shader {1} to value of type glm::mat2", uniformIdentifier, m_rendererID);
+	ShaderLog::trace("Set uniform '{0}' in shader {1} to value of type glm::mat2", uniformIdentifier, m_rendererID);
 }
 
 void Shader::setUniformToValue(const std::string uniformIdentifier, const glm::mat3& value)
 {
-	glUniformMatrix3fv(getUniformLocation(uniformIdentifier), 1, false, glm::value_ptr(value));
+	int32_t location = getUniformLocation(uniformIdentifier);
+	if (!GLStateCache::updateUniform(m_rendererID, location, value))
+		return;
 
-	Log::trace("Set uniform '{0}' in shader {1} to value of type glm::mat3", uniformIdentifier, m_rendererID);
+	glProgramUniformMatrix3fv(m_rendererID, location, 1, false, glm::value_ptr(value));
+
+	ShaderLog::trace("Set uniform '{0}' in shader {1} to value of type glm::mat3", uniformIdentifier, m_rendererID);
 }
 
 void Shader::setUniformToValue(const std::string uniformIdentifier, const glm::mat4& value)
 {
-	glUniformMatrix4fv(getUniformLocation(uniformIdentifier), 1, false, glm::value_ptr(value));
+	int32_t location = getUniformLocation(uniformIdentifier);
+	if (!GLStateCache::updateUniform(m_rendererID, location, value))
+		return;
+
+	glProgramUniformMatrix4fv(m_rendererID, location, 1, false, glm::value_ptr(value));
 
-	Log::trace("Set uniform '{0}' in shader {1} to value of type glm::mat4", uniformIdentifier, m_rendererID);
+	ShaderLog::trace("Set uniform '{0}' in shader {1} to value of type glm::mat4", uniformIdentifier, m_rendererID);
 }
 
 void Shader::retrieveAndCompileIndividualShaders()
@@ -211,7 +273,7 @@ IndividualShader::IndividualShader(const std::string& filePath)
 	retrieveTypeAndSource();
 	compileIndividualShader();
 
-	Log::info("Successfully created and compiled individual shader {0} with ID = {1}", m_filePath, m_rendererID);
+	ShaderLog::info("Successfully created and compiled individual shader {0} with ID = {1}", m_filePath, m_rendererID);
 }
 
 IndividualShader::~IndividualShader()
@@ -240,7 +302,7 @@ void IndividualShader::retrieveTypeAndSource()
 
 	m_source = buffer.str();
 
-	Log::trace("Retrieved individual shader source and type from {0}", m_filePath);
+	ShaderLog::trace("Retrieved individual shader source and type from {0}", m_filePath);
 }
 
 void IndividualShader::compileIndividualShader()
@@ -281,6 +343,8 @@ IndividualShader::IndividualShaderType IndividualShader::getShaderTypeFromFileEx
 {
 	if (extension == ".vert")
 		return IndividualShaderType::VERTEX;
+	else if (extension == ".geom")
+		return IndividualShaderType::GEOMETRY;
 	else if (extension == ".frag")
 		return IndividualShaderType::FRAGMENT;
 	else if (extension == ".comp")
@@ -297,6 +361,7 @@ GLenum IndividualShader::convertShaderTypeToOpenGLShaderType(IndividualShaderTyp
 	switch (individualShaderType)
 	{
 	case IndividualShaderType::VERTEX:   return GL_VERTEX_SHADER;   break;
+	case IndividualShaderType::GEOMETRY: return GL_GEOMETRY_SHADER; break;
 	case IndividualShaderType::FRAGMENT: return GL_FRAGMENT_SHADER; break;
 	case IndividualShaderType::COMPUTE:  return GL_COMPUTE_SHADER;  break;
 	default:
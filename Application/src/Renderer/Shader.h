@@ -82,6 +82,7 @@ public:
 	{
 		NONE = 0,
 		VERTEX,
+		GEOMETRY,
 		FRAGMENT,
 		COMPUTE
 	};
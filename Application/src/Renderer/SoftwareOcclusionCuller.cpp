@@ -0,0 +1,488 @@
+#include "PCH.h"
+#include "SoftwareOcclusionCuller.h"
+
+#include <immintrin.h>
+
+static constexpr uint32_t BAND_COUNT = SoftwareOcclusionCuller::DEPTH_BUFFER_HEIGHT / SoftwareOcclusionCuller::BAND_HEIGHT;
+static constexpr uint32_t HI_Z_WIDTH = SoftwareOcclusionCuller::DEPTH_BUFFER_WIDTH / SoftwareOcclusionCuller::HI_Z_CELL_SIZE;
+static constexpr uint32_t HI_Z_HEIGHT = SoftwareOcclusionCuller::DEPTH_BUFFER_HEIGHT / SoftwareOcclusionCuller::HI_Z_CELL_SIZE;
+
+static constexpr uint32_t MAX_WORKER_THREADS = 7;
+
+static_assert(SoftwareOcclusionCuller::DEPTH_BUFFER_WIDTH % 4 == 0, "Depth buffer rows must be a whole number of SIMD lanes");
+static_assert(SoftwareOcclusionCuller::DEPTH_BUFFER_HEIGHT % SoftwareOcclusionCuller::BAND_HEIGHT == 0, "Depth buffer must be a whole number of bands");
+static_assert(SoftwareOcclusionCuller::BAND_HEIGHT % SoftwareOcclusionCuller::HI_Z_CELL_SIZE == 0, "Bands must be a whole number of Hi-Z cells");
+
+SoftwareOcclusionCuller::SoftwareOcclusionCuller()
+	: SoftwareOcclusionCuller(std::min(std::max(std::thread::hardware_concurrency(), 1u) - 1, MAX_WORKER_THREADS))
+{
+}
+
+SoftwareOcclusionCuller::SoftwareOcclusionCuller(uint32_t workerThreadCount)
+{
+	m_depthBuffer.resize(DEPTH_BUFFER_WIDTH * DEPTH_BUFFER_HEIGHT, 1.0f);
+	m_hiZBuffer.resize(HI_Z_WIDTH * HI_Z_HEIGHT, 1.0f);
+	m_bandTriangleIndices.resize(BAND_COUNT);
+
+	startWorkerThreads(workerThreadCount);
+
+	RendererLog::info("Created software occlusion culler ({0}x{1}, {2} worker threads)", DEPTH_BUFFER_WIDTH, DEPTH_BUFFER_HEIGHT, workerThreadCount);
+}
+
+SoftwareOcclusionCuller::~SoftwareOcclusionCuller()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_workMutex);
+		m_shuttingDown = true;
+	}
+
+	m_workAvailable.notify_all();
+
+	for (std::thread& workerThread : m_workerThreads)
+		workerThread.join();
+
+	RendererLog::info("Deleted software occlusion culler");
+}
+
+void SoftwareOcclusionCuller::cullModels(const std::vector<std::pair<Reference<Model>, glm::mat4>>& modelsAndTransforms, const glm::mat4& projectionViewMatrix)
+{
+	beginFrame(projectionViewMatrix);
+
+	selectOccluders(modelsAndTransforms);
+	rasterizeOccluders();
+
+	// A model is drawn if any of its meshes is visible
+
+	m_modelVisibility.assign(modelsAndTransforms.size(), 0);
+
+	for (uint32_t i = 0; i < static_cast<uint32_t>(modelsAndTransforms.size()); i++)
+	{
+		const auto& [model, transform] = modelsAndTransforms[i];
+
+		bool anyMeshInView = false;
+
+		for (const Model::Mesh& mesh : model->getMeshes())
+		{
+			if (!mesh.vertexCount)
+				continue;
+
+			Visibility meshVisibility = testBounds(mesh.boundsMin, mesh.boundsMax, transform * mesh.transform);
+
+			if (meshVisibility == Visibility::VISIBLE)
+			{
+				m_modelVisibility[i] = 1;
+				break;
+			}
+
+			anyMeshInView |= meshVisibility == Visibility::OCCLUDED;
+		}
+
+		m_statistics.testedModelCount++;
+
+		if (!m_modelVisibility[i])
+		{
+			if (anyMeshInView)
+				m_statistics.occludedModelCount++;
+			else
+				m_statistics.outsideViewModelCount++;
+		}
+	}
+
+	RendererLog::trace("Software occlusion culling: {0} of {1} models occluded ({2:.1f}%), {3} outside the view, {4} occluder triangles from {5} meshes",
+		m_statistics.occludedModelCount, m_statistics.testedModelCount, m_statistics.getOccludedModelRatio() * 100.0f,
+		m_statistics.outsideViewModelCount, m_statistics.occluderTriangleCount, m_statistics.occluderMeshCount);
+}
+
+void SoftwareOcclusionCuller::beginFrame(const glm::mat4& projectionViewMatrix)
+{
+	m_projectionViewMatrix = projectionViewMatrix;
+
+	m_triangles.clear();
+	for (std::vector<uint32_t>& bandTriangleIndices : m_bandTriangleIndices)
+		bandTriangleIndices.clear();
+
+	m_statistics = Statistics();
+}
+
+void SoftwareOcclusionCuller::addOccluder(const void* vertices, size_t vertexStride, uint32_t vertexCount, const uint32_t* indices, uint32_t indexCount, const glm::mat4& transform)
+{
+	glm::mat4 modelProjectionViewMatrix = m_projectionViewMatrix * transform;
+
+	m_clipSpacePositions.resize(vertexCount);
+
+	const uint8_t* vertexBytes = static_cast<const uint8_t*>(vertices);
+	for (uint32_t i = 0; i < vertexCount; i++)
+	{
+		const glm::vec3& position = *reinterpret_cast<const glm::vec3*>(vertexBytes + i * vertexStride);
+		m_clipSpacePositions[i] = modelProjectionViewMatrix * glm::vec4(position, 1.0f);
+	}
+
+	const glm::vec2 screenSize(static_cast<float>(DEPTH_BUFFER_WIDTH), static_cast<float>(DEPTH_BUFFER_HEIGHT));
+
+	for (uint32_t i = 0; i + 2 < indexCount; i += 3)
+	{
+		glm::vec3 screenPositions[3];
+		bool crossesNearPlane = false;
+
+		for (uint32_t j = 0; j < 3; j++)
+		{
+			const glm::vec4& clipSpacePosition = m_clipSpacePositions[indices[i + j]];
+
+			// Triangles which cross the near plane aren't clipped, just skipped - leaving out an occluder is always safe
+			if (clipSpacePosition.z < -clipSpacePosition.w)
+			{
+				crossesNearPlane = true;
+				break;
+			}
+
+			glm::vec3 ndcPosition = glm::vec3(clipSpacePosition) / clipSpacePosition.w;
+			screenPositions[j] = glm::vec3((glm::vec2(ndcPosition) * 0.5f + 0.5f) * screenSize, ndcPosition.z * 0.5f + 0.5f);
+		}
+
+		if (crossesNearPlane)
+			continue;
+
+		const glm::vec3& v0 = screenPositions[0];
+		const glm::vec3& v1 = screenPositions[1];
+		const glm::vec3& v2 = screenPositions[2];
+
+		// Twice the signed area - back facing and degenerate triangles are skipped
+		glm::vec3 edge1 = v1 - v0;
+		glm::vec3 edge2 = v2 - v0;
+		float area = edge1.x * edge2.y - edge1.y * edge2.x;
+		if (area <= 0.0f)
+			continue;
+
+		ScreenTriangle triangle;
+
+		triangle.minX = std::max(static_cast<int32_t>(std::floor(std::min({ v0.x, v1.x, v2.x }))), 0);
+		triangle.maxX = std::min(static_cast<int32_t>(std::ceil(std::max({ v0.x, v1.x, v2.x }))), static_cast<int32_t>(DEPTH_BUFFER_WIDTH) - 1);
+		triangle.minY = std::max(static_cast<int32_t>(std::floor(std::min({ v0.y, v1.y, v2.y }))), 0);
+		triangle.maxY = std::min(static_cast<int32_t>(std::ceil(std::max({ v0.y, v1.y, v2.y }))), static_cast<int32_t>(DEPTH_BUFFER_HEIGHT) - 1);
+
+		if (triangle.minX > triangle.maxX || triangle.minY > triangle.maxY)
+			continue;
+
+		// Edge from vertex i to vertex j is (x_j - x_i) * (y - y_i) - (y_j - y_i) * (x - x_i)
+		for (uint32_t j = 0; j < 3; j++)
+		{
+			const glm::vec3& from = screenPositions[j];
+			const glm::vec3& to = screenPositions[(j + 1) % 3];
+
+			triangle.edgeA[j] = from.y - to.y;
+			triangle.edgeB[j] = to.x - from.x;
+			triangle.edgeC[j] = -(triangle.edgeA[j] * from.x + triangle.edgeB[j] * from.y);
+		}
+
+		triangle.depthA = (edge1.z * edge2.y - edge2.z * edge1.y) / area;
+		triangle.depthB = (edge2.z * edge1.x - edge1.z * edge2.x) / area;
+		triangle.depthC = v0.z - triangle.depthA * v0.x - triangle.depthB * v0.y;
+
+		uint32_t triangleIndex = static_cast<uint32_t>(m_triangles.size());
+		for (int32_t band = triangle.minY / static_cast<int32_t>(BAND_HEIGHT); band <= triangle.maxY / static_cast<int32_t>(BAND_HEIGHT); band++)
+			m_bandTriangleIndices[band].push_back(triangleIndex);
+
+		m_triangles.push_back(triangle);
+	}
+}
+
+void SoftwareOcclusionCuller::rasterizeOccluders()
+{
+	// Wake the worker threads, then rasterize alongside them
+
+	m_nextBand = 0;
+
+	{
+		std::lock_guard<std::mutex> lock(m_workMutex);
+		m_workGeneration++;
+		m_busyWorkerThreadCount = static_cast<uint32_t>(m_workerThreads.size());
+	}
+
+	m_workAvailable.notify_all();
+
+	rasterizeBands();
+
+	std::unique_lock<std::mutex> lock(m_workMutex);
+	m_workFinished.wait(lock, [this]() { return m_busyWorkerThreadCount == 0; });
+}
+
+SoftwareOcclusionCuller::Visibility SoftwareOcclusionCuller::testBounds(const glm::vec3& boundsMin, const glm::vec3& boundsMax, const glm::mat4& transform) const
+{
+	ScreenBounds screenBounds;
+	if (!projectBounds(boundsMin, boundsMax, transform, screenBounds))
+		return Visibility::VISIBLE;
+
+	// Every pixel the bounds touch
+
+	int32_t minX = std::max(static_cast<int32_t>(std::floor(screenBounds.min.x)), 0);
+	int32_t maxX = std::min(static_cast<int32_t>(std::ceil(screenBounds.max.x)) - 1, static_cast<int32_t>(DEPTH_BUFFER_WIDTH) - 1);
+	int32_t minY = std::max(static_cast<int32_t>(std::floor(screenBounds.min.y)), 0);
+	int32_t maxY = std::min(static_cast<int32_t>(std::ceil(screenBounds.max.y)) - 1, static_cast<int32_t>(DEPTH_BUFFER_HEIGHT) - 1);
+
+	if (minX > maxX || minY > maxY || screenBounds.minDepth > 1.0f)
+		return Visibility::OUTSIDE_VIEW;
+
+	// The bounds are hidden from any cell whose furthest depth is in front of them. Other cells are checked pixel by pixel
+
+	for (int32_t cellY = minY / HI_Z_CELL_SIZE; cellY <= maxY / static_cast<int32_t>(HI_Z_CELL_SIZE); cellY++)
+	{
+		for (int32_t cellX = minX / HI_Z_CELL_SIZE; cellX <= maxX / static_cast<int32_t>(HI_Z_CELL_SIZE); cellX++)
+		{
+			if (m_hiZBuffer[cellY * HI_Z_WIDTH + cellX] < screenBounds.minDepth)
+				continue;
+
+			int32_t cellMinX = std::max(cellX * static_cast<int32_t>(HI_Z_CELL_SIZE), minX);
+			int32_t cellMaxX = std::min((cellX + 1) * static_cast<int32_t>(HI_Z_CELL_SIZE) - 1, maxX);
+			int32_t cellMinY = std::max(cellY * static_cast<int32_t>(HI_Z_CELL_SIZE), minY);
+			int32_t cellMaxY = std::min((cellY + 1) * static_cast<int32_t>(HI_Z_CELL_SIZE) - 1, maxY);
+
+			if (isAnyPixelVisible(cellMinX, cellMaxX, cellMinY, cellMaxY, screenBounds.minDepth))
+				return Visibility::VISIBLE;
+		}
+	}
+
+	return Visibility::OCCLUDED;
+}
+
+void SoftwareOcclusionCuller::startWorkerThreads(uint32_t workerThreadCount)
+{
+	for (uint32_t i = 0; i < workerThreadCount; i++)
+		m_workerThreads.emplace_back(&SoftwareOcclusionCuller::runWorkerThread, this);
+}
+
+void SoftwareOcclusionCuller::runWorkerThread()
+{
+	uint64_t lastWorkGeneration = 0;
+
+	while (true)
+	{
+		{
+			std::unique_lock<std::mutex> lock(m_workMutex);
+			m_workAvailable.wait(lock, [&]() { return m_shuttingDown || m_workGeneration != lastWorkGeneration; });
+
+			if (m_shuttingDown)
+				return;
+
+			lastWorkGeneration = m_workGeneration;
+		}
+
+		rasterizeBands();
+
+		{
+			std::lock_guard<std::mutex> lock(m_workMutex);
+			m_busyWorkerThreadCount--;
+		}
+
+		m_workFinished.notify_one();
+	}
+}
+
+void SoftwareOcclusionCuller::rasterizeBands()
+{
+	for (uint32_t band = m_nextBand++; band < BAND_COUNT; band = m_nextBand++)
+	{
+		rasterizeBand(band);
+		buildHiZ(band);
+	}
+}
+
+void SoftwareOcclusionCuller::rasterizeBand(uint32_t band)
+{
+	int32_t bandMinY = static_cast<int32_t>(band * BAND_HEIGHT);
+	int32_t bandMaxY = bandMinY + static_cast<int32_t>(BAND_HEIGHT) - 1;
+
+	std::fill(m_depthBuffer.begin() + bandMinY * DEPTH_BUFFER_WIDTH, m_depthBuffer.begin() + (bandMaxY + 1) * DEPTH_BUFFER_WIDTH, 1.0f);
+
+	for (uint32_t triangleIndex : m_bandTriangleIndices[band])
+		rasterizeTriangle(m_triangles[triangleIndex], bandMinY, bandMaxY);
+}
+
+void SoftwareOcclusionCuller::rasterizeTriangle(const ScreenTriangle& triangle, int32_t bandMinY, int32_t bandMaxY)
+{
+	// Pixels are covered when their centre is inside all three edges, and are processed four at a time
+
+	const __m128 laneOffsets = _mm_setr_ps(0.5f, 1.5f, 2.5f, 3.5f);
+
+	const __m128 edgeA0 = _mm_set1_ps(triangle.edgeA[0]), edgeA1 = _mm_set1_ps(triangle.edgeA[1]), edgeA2 = _mm_set1_ps(triangle.edgeA[2]);
+	const __m128 depthA = _mm_set1_ps(triangle.depthA);
+	const __m128 zero = _mm_setzero_ps();
+
+	int32_t minY = std::max(triangle.minY, bandMinY);
+	int32_t maxY = std::min(triangle.maxY, bandMaxY);
+	// Rows are a whole number of lanes, so aligning the start keeps every group of four pixels within the row
+	int32_t minX = triangle.minX & ~3;
+
+	for (int32_t y = minY; y <= maxY; y++)
+	{
+		float pixelCentreY = static_cast<float>(y) + 0.5f;
+
+		// Value of the edges and depth at x = 0 on this row
+		__m128 rowEdge0 = _mm_set1_ps(triangle.edgeB[0] * pixelCentreY + triangle.edgeC[0]);
+		__m128 rowEdge1 = _mm_set1_ps(triangle.edgeB[1] * pixelCentreY + triangle.edgeC[1]);
+		__m128 rowEdge2 = _mm_set1_ps(triangle.edgeB[2] * pixelCentreY + triangle.edgeC[2]);
+		__m128 rowDepth = _mm_set1_ps(triangle.depthB * pixelCentreY + triangle.depthC);
+
+		float* depthRow = &m_depthBuffer[y * DEPTH_BUFFER_WIDTH];
+
+		for (int32_t x = minX; x <= triangle.maxX; x += 4)
+		{
+			__m128 pixelCentreX = _mm_add_ps(_mm_set1_ps(static_cast<float>(x)), laneOffsets);
+
+			__m128 edge0 = _mm_add_ps(_mm_mul_ps(edgeA0, pixelCentreX), rowEdge0);
+			__m128 edge1 = _mm_add_ps(_mm_mul_ps(edgeA1, pixelCentreX), rowEdge1);
+			__m128 edge2 = _mm_add_ps(_mm_mul_ps(edgeA2, pixelCentreX), rowEdge2);
+
+			__m128 covered = _mm_and_ps(_mm_and_ps(_mm_cmpge_ps(edge0, zero), _mm_cmpge_ps(edge1, zero)), _mm_cmpge_ps(edge2, zero));
+			if (_mm_movemask_ps(covered) == 0)
+				continue;
+
+			__m128 depth = _mm_add_ps(_mm_mul_ps(depthA, pixelCentreX), rowDepth);
+
+			__m128 previousDepth = _mm_loadu_ps(depthRow + x);
+			__m128 closestDepth = _mm_min_ps(previousDepth, depth);
+			_mm_storeu_ps(depthRow + x, _mm_or_ps(_mm_and_ps(covered, closestDepth), _mm_andnot_ps(covered, previousDepth)));
+		}
+	}
+}
+
+void SoftwareOcclusionCuller::buildHiZ(uint32_t band)
+{
+	uint32_t firstCellRow = (band * BAND_HEIGHT) / HI_Z_CELL_SIZE;
+	uint32_t lastCellRow = firstCellRow + BAND_HEIGHT / HI_Z_CELL_SIZE;
+
+	for (uint32_t cellY = firstCellRow; cellY < lastCellRow; cellY++)
+	{
+		for (uint32_t cellX = 0; cellX < HI_Z_WIDTH; cellX++)
+		{
+			__m128 furthestDepth = _mm_setzero_ps();
+
+			for (uint32_t y = cellY * HI_Z_CELL_SIZE; y < (cellY + 1) * HI_Z_CELL_SIZE; y++)
+			{
+				const float* depthRow = &m_depthBuffer[y * DEPTH_BUFFER_WIDTH + cellX * HI_Z_CELL_SIZE];
+
+				for (uint32_t x = 0; x < HI_Z_CELL_SIZE; x += 4)
+					furthestDepth = _mm_max_ps(furthestDepth, _mm_loadu_ps(depthRow + x));
+			}
+
+			// Reduce the four lanes to one
+			furthestDepth = _mm_max_ps(furthestDepth, _mm_shuffle_ps(furthestDepth, furthestDepth, _MM_SHUFFLE(2, 3, 0, 1)));
+			furthestDepth = _mm_max_ps(furthestDepth, _mm_shuffle_ps(furthestDepth, furthestDepth, _MM_SHUFFLE(1, 0, 3, 2)));
+
+			m_hiZBuffer[cellY * HI_Z_WIDTH + cellX] = _mm_cvtss_f32(furthestDepth);
+		}
+	}
+}
+
+void SoftwareOcclusionCuller::selectOccluders(const std::vector<std::pair<Reference<Model>, glm::mat4>>& modelsAndTransforms)
+{
+	struct OccluderCandidate
+	{
+		const Model* model;
+		const Model::Mesh* mesh;
+		glm::mat4 transform;
+		float screenArea;
+	};
+
+	std::vector<OccluderCandidate> candidates;
+
+	for (const auto& [model, transform] : modelsAndTransforms)
+	{
+		for (const Model::Mesh& mesh : model->getMeshes())
+		{
+			if (!mesh.vertexCount || mesh.indexCount / 3 > MAX_OCCLUDER_MESH_TRIANGLES)
+				continue;
+
+			glm::mat4 meshTransform = transform * mesh.transform;
+
+			// Meshes crossing the near plane are likely to cover much of the screen
+			float screenArea = 1.0f;
+
+			ScreenBounds screenBounds;
+			if (projectBounds(mesh.boundsMin, mesh.boundsMax, meshTransform, screenBounds))
+			{
+				glm::vec2 clampedMin = glm::clamp(screenBounds.min, glm::vec2(0.0f), glm::vec2(DEPTH_BUFFER_WIDTH, DEPTH_BUFFER_HEIGHT));
+				glm::vec2 clampedMax = glm::clamp(screenBounds.max, glm::vec2(0.0f), glm::vec2(DEPTH_BUFFER_WIDTH, DEPTH_BUFFER_HEIGHT));
+				glm::vec2 size = clampedMax - clampedMin;
+
+				screenArea = (size.x * size.y) / static_cast<float>(DEPTH_BUFFER_WIDTH * DEPTH_BUFFER_HEIGHT);
+			}
+
+			if (screenArea >= MIN_OCCLUDER_SCREEN_AREA)
+				candidates.push_back({ model.get(), &mesh, meshTransform, screenArea });
+		}
+	}
+
+	// Stable, so that meshes covering the same area are always chosen in the same order
+	std::stable_sort(candidates.begin(), candidates.end(), [](const OccluderCandidate& a, const OccluderCandidate& b) { return a.screenArea > b.screenArea; });
+
+	for (const OccluderCandidate& candidate : candidates)
+	{
+		uint32_t triangleCount = candidate.mesh->indexCount / 3;
+		if (m_statistics.occluderTriangleCount + triangleCount > MAX_OCCLUDER_TRIANGLES)
+			continue;
+
+		const Model::Vertex* vertices = candidate.model->getVertices().data() + candidate.mesh->baseVertex;
+		const uint32_t* indices = reinterpret_cast<const uint32_t*>(candidate.model->getTriangleIndices().data()) + candidate.mesh->baseIndex;
+
+		addOccluder(static_cast<const void*>(vertices), sizeof(Model::Vertex), candidate.mesh->vertexCount, indices, candidate.mesh->indexCount, candidate.transform);
+
+		m_statistics.occluderMeshCount++;
+		m_statistics.occluderTriangleCount += triangleCount;
+	}
+}
+
+bool SoftwareOcclusionCuller::projectBounds(const glm::vec3& boundsMin, const glm::vec3& boundsMax, const glm::mat4& transform, ScreenBounds& screenBounds) const
+{
+	glm::mat4 modelProjectionViewMatrix = m_projectionViewMatrix * transform;
+
+	const glm::vec2 screenSize(static_cast<float>(DEPTH_BUFFER_WIDTH), static_cast<float>(DEPTH_BUFFER_HEIGHT));
+
+	screenBounds.min = glm::vec2(std::numeric_limits<float>::max());
+	screenBounds.max = glm::vec2(std::numeric_limits<float>::lowest());
+	screenBounds.minDepth = std::numeric_limits<float>::max();
+
+	for (uint32_t i = 0; i < 8; i++)
+	{
+		glm::vec3 corner((i & 1) ? boundsMax.x : boundsMin.x, (i & 2) ? boundsMax.y : boundsMin.y, (i & 4) ? boundsMax.z : boundsMin.z);
+		glm::vec4 clipSpaceCorner = modelProjectionViewMatrix * glm::vec4(corner, 1.0f);
+
+		if (clipSpaceCorner.z < -clipSpaceCorner.w)
+			return false;
+
+		glm::vec3 ndcCorner = glm::vec3(clipSpaceCorner) / clipSpaceCorner.w;
+		glm::vec2 screenCorner = (glm::vec2(ndcCorner) * 0.5f + 0.5f) * screenSize;
+
+		screenBounds.min = glm::min(screenBounds.min, screenCorner);
+		screenBounds.max = glm::max(screenBounds.max, screenCorner);
+		screenBounds.minDepth = std::min(screenBounds.minDepth, ndcCorner.z * 0.5f + 0.5f);
+	}
+
+	return true;
+}
+
+bool SoftwareOcclusionCuller::isAnyPixelVisible(int32_t minX, int32_t maxX, int32_t minY, int32_t maxY, float depth) const
+{
+	// The bounds are visible at a pixel if nothing rasterized there is in front of their closest point
+
+	const __m128 boundsDepth = _mm_set1_ps(depth);
+	const __m128i laneIndices = _mm_setr_epi32(0, 1, 2, 3);
+	const __m128i firstLane = _mm_set1_epi32(minX - 1);
+	const __m128i lastLane = _mm_set1_epi32(maxX + 1);
+
+	for (int32_t y = minY; y <= maxY; y++)
+	{
+		const float* depthRow = &m_depthBuffer[y * DEPTH_BUFFER_WIDTH];
+
+		for (int32_t x = minX & ~3; x <= maxX; x += 4)
+		{
+			__m128i lanes = _mm_add_epi32(_mm_set1_epi32(x), laneIndices);
+			__m128 inBounds = _mm_castsi128_ps(_mm_and_si128(_mm_cmpgt_epi32(lanes, firstLane), _mm_cmplt_epi32(lanes, lastLane)));
+
+			__m128 visible = _mm_and_ps(inBounds, _mm_cmpge_ps(_mm_loadu_ps(depthRow + x), boundsDepth));
+			if (_mm_movemask_ps(visible) != 0)
+				return true;
+		}
+	}
+
+	return false;
+}
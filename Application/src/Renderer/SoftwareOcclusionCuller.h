@@ -0,0 +1,151 @@
+#pragma once
+#include "PCH.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+#include "glm/glm.hpp"
+
+#include "Scene/Model.h"
+
+/*
+Culls models which are hidden behind other geometry on the CPU, so that the result is known before anything is
+submitted to the GPU and never depends on reading back GPU results.
+
+Each frame a small set of occluders (the meshes covering the most of the screen, within a triangle budget) is
+rasterized into a low resolution depth buffer with an SSE rasterizer, four pixels at a time. The buffer is split
+into horizontal bands which are rasterized in parallel by worker threads, each band keeping the furthest depth
+of each of its 8x8 pixel cells as a coarse level of the depth hierarchy.
+
+Bounds are then projected to the screen and tested against the coarse level first, only falling back to the
+pixels of the cells the coarse test can't reject.
+
+Depth is only ever combined with min(), and each band is written by one thread, so the results are the same
+for any number of worker threads. Nothing here uses OpenGL.
+*/
+class SoftwareOcclusionCuller
+{
+public:
+
+	enum class Visibility
+	{
+		VISIBLE = 0,
+		OCCLUDED,
+		OUTSIDE_VIEW
+	};
+
+	struct Statistics
+	{
+		uint32_t testedModelCount = 0;
+		uint32_t occludedModelCount = 0;
+		uint32_t outsideViewModelCount = 0;
+		uint32_t occluderMeshCount = 0;
+		uint32_t occluderTriangleCount = 0;
+
+		float getOccludedModelRatio() const { return testedModelCount ? static_cast<float>(occludedModelCount) / static_cast<float>(testedModelCount) : 0.0f; }
+	};
+
+	// Width must be a multiple of 4 (the SIMD width) and height a multiple of the band height
+	static constexpr uint32_t DEPTH_BUFFER_WIDTH = 320;
+	static constexpr uint32_t DEPTH_BUFFER_HEIGHT = 192;
+	static constexpr uint32_t BAND_HEIGHT = 16;
+	static constexpr uint32_t HI_Z_CELL_SIZE = 8;
+
+	// Occluder selection
+	static constexpr uint32_t MAX_OCCLUDER_TRIANGLES = 32768;
+	static constexpr uint32_t MAX_OCCLUDER_MESH_TRIANGLES = 8192;
+	// Fraction of the screen covered by a mesh's bounds for it to be considered as an occluder
+	static constexpr float MIN_OCCLUDER_SCREEN_AREA = 0.02f;
+
+public:
+
+	// By default, uses one worker thread fewer than the number of hardware threads (the calling thread also rasterizes)
+	SoftwareOcclusionCuller();
+	SoftwareOcclusionCuller(uint32_t workerThreadCount);
+	~SoftwareOcclusionCuller();
+	SoftwareOcclusionCuller(const SoftwareOcclusionCuller&) = delete;
+
+	// Selects occluders from the models, rasterizes them and tests each model's meshes against them
+	void cullModels(const std::vector<std::pair<Reference<Model>, glm::mat4>>& modelsAndTransforms, const glm::mat4& projectionViewMatrix);
+
+	// One entry per model given to cullModels, non-zero if the model should be drawn
+	const std::vector<uint8_t>& getModelVisibility() const { return m_modelVisibility; }
+	const Statistics& getStatistics() const { return m_statistics; }
+
+	// Lower level use - clears the depth buffer, then occluders are added and rasterized before bounds are tested
+
+	void beginFrame(const glm::mat4& projectionViewMatrix);
+
+	// Positions are read as a glm::vec3 at the start of each vertex. Only front facing (counter-clockwise) triangles are rasterized
+	void addOccluder(const void* vertices, size_t vertexStride, uint32_t vertexCount, const uint32_t* indices, uint32_t indexCount, const glm::mat4& transform);
+	void rasterizeOccluders();
+
+	Visibility testBounds(const glm::vec3& boundsMin, const glm::vec3& boundsMax, const glm::mat4& transform) const;
+
+	// Depth of each pixel, in [0, 1] with 1 being the far plane, row by row from the bottom of the screen
+	const std::vector<float>& getDepthBuffer() const { return m_depthBuffer; }
+
+private:
+
+	// A triangle set up for rasterizing, in depth buffer pixels
+	struct ScreenTriangle
+	{
+		// Edge functions (a * x + b * y + c), which are positive inside the triangle
+		glm::vec3 edgeA, edgeB, edgeC;
+		// Plane of the depth over the triangle
+		float depthA, depthB, depthC;
+
+		int32_t minX, maxX, minY, maxY;
+	};
+
+	struct ScreenBounds
+	{
+		glm::vec2 min, max;
+		float minDepth;
+	};
+
+private:
+
+	void startWorkerThreads(uint32_t workerThreadCount);
+	void runWorkerThread();
+
+	void rasterizeBands();
+	void rasterizeBand(uint32_t band);
+	void rasterizeTriangle(const ScreenTriangle& triangle, int32_t bandMinY, int32_t bandMaxY);
+	void buildHiZ(uint32_t band);
+
+	void selectOccluders(const std::vector<std::pair<Reference<Model>, glm::mat4>>& modelsAndTransforms);
+
+	// Returns false if the bounds cross the near plane, in which case they cover an unknown part of the screen
+	bool projectBounds(const glm::vec3& boundsMin, const glm::vec3& boundsMax, const glm::mat4& transform, ScreenBounds& screenBounds) const;
+	bool isAnyPixelVisible(int32_t minX, int32_t maxX, int32_t minY, int32_t maxY, float depth) const;
+
+private:
+
+	glm::mat4 m_projectionViewMatrix = glm::mat4(1.0f);
+
+	std::vector<float> m_depthBuffer;
+	// The furthest depth in each HI_Z_CELL_SIZE x HI_Z_CELL_SIZE cell of the depth buffer
+	std::vector<float> m_hiZBuffer;
+
+	std::vector<ScreenTriangle> m_triangles;
+	// Indices of the triangles overlapping each band, in the order they were added
+	std::vector<std::vector<uint32_t>> m_bandTriangleIndices;
+	std::vector<glm::vec4> m_clipSpacePositions;
+
+	std::vector<uint8_t> m_modelVisibility;
+	Statistics m_statistics;
+
+	// Worker threads take bands in turn until all have been rasterized
+
+	std::vector<std::thread> m_workerThreads;
+	std::mutex m_workMutex;
+	std::condition_variable m_workAvailable;
+	std::condition_variable m_workFinished;
+	uint64_t m_workGeneration = 0;
+	uint32_t m_busyWorkerThreadCount = 0;
+	bool m_shuttingDown = false;
+	std::atomic<uint32_t> m_nextBand{ 0 };
+};
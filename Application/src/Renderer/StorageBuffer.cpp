@@ -0,0 +1,75 @@
+#include "PCH.h"
+#include "StorageBuffer.h"
+
+#include "glad/glad.h"
+
+#include "FrameStatistics.h"
+#include "GLStateCache.h"
+
+StorageBuffer::StorageBuffer(size_t size)
+	: m_size(size)
+{
+	glCreateBuffers(1, &m_rendererID);
+
+	glNamedBufferData(m_rendererID, size, nullptr, GL_DYNAMIC_DRAW);
+
+	RendererLog::info("Created storage buffer {0}", m_rendererID);
+}
+
+StorageBuffer::~StorageBuffer()
+{
+	GLStateCache::deleteBuffer(m_rendererID);
+
+	RendererLog::info("Deleted storage buffer {0}", m_rendererID);
+}
+
+void StorageBuffer::bind(uint32_t bindingPoint) const
+{
+	GLStateCache::bindBufferBase(GL_SHADER_STORAGE_BUFFER, bindingPoint, m_rendererID);
+
+	RendererLog::trace("Bound storage buffer {0} to binding point {1}", m_rendererID, bindingPoint);
+}
+
+void StorageBuffer::bindAsParameterBuffer() const
+{
+	GLStateCache::bindBuffer(GL_PARAMETER_BUFFER, m_rendererID);
+
+	RendererLog::trace("Bound storage buffer {0} as the parameter buffer", m_rendererID);
+}
+
+void StorageBuffer::setData(const void* data, size_t size)
+{
+	reserve(size);
+
+	glNamedBufferSubData(m_rendererID, 0, size, data);
+	FrameStatistics::recordUpload(size);
+
+	RendererLog::trace("Set {0} bytes of storage buffer {1}", size, m_rendererID);
+}
+
+void StorageBuffer::reserve(size_t size)
+{
+	if (size <= m_size)
+		return;
+
+	// Grow geometrically so that buffers which are refilled every frame settle on a size quickly
+
+	m_size = std::max(size, m_size * 2);
+	glNamedBufferData(m_rendererID, m_size, nullptr, GL_DYNAMIC_DRAW);
+
+	RendererLog::trace("Reallocated storage buffer {0} with size {1}", m_rendererID, m_size);
+}
+
+void StorageBuffer::clear(size_t offset, size_t size)
+{
+	glClearNamedBufferSubData(m_rendererID, GL_R32UI, offset, size, GL_RED_INTEGER, GL_UNSIGNED_INT, nullptr);
+
+	RendererLog::trace("Cleared {0} bytes of storage buffer {1}", size, m_rendererID);
+}
+
+void StorageBuffer::getData(void* data, size_t size, size_t offset) const
+{
+	glGetNamedBufferSubData(m_rendererID, offset, size, data);
+
+	RendererLog::trace("Read back {0} bytes of storage buffer {1}", size, m_rendererID);
+}
@@ -0,0 +1,37 @@
+#pragma once
+#include "PCH.h"
+
+#include "RendererUtilities.h"
+
+// A Shader Storage Buffer Object (SSBO), used to pass arrays of per-draw or per-light data to shaders
+class StorageBuffer
+{
+public:
+
+	StorageBuffer() = delete;
+	StorageBuffer(size_t size);
+	~StorageBuffer();
+	StorageBuffer(const StorageBuffer&) = delete;
+
+	void bind(uint32_t bindingPoint) const;
+	// Used when the buffer holds draw counts for glMultiDrawElementsIndirectCount
+	void bindAsParameterBuffer() const;
+
+	// The buffer is reallocated if the data does not fit within its current size
+	void setData(const void* data, size_t size);
+	// Ensures the buffer is at least size bytes - the contents are discarded if the buffer is reallocated
+	void reserve(size_t size);
+
+	// Sets a range of the buffer to zero
+	void clear(size_t offset, size_t size);
+
+	// Reads back from the GPU, which stalls until all commands writing to the buffer have finished
+	void getData(void* data, size_t size, size_t offset = 0) const;
+
+	size_t getSize() const { return m_size; }
+
+private:
+
+	RendererID m_rendererID;
+	size_t m_size = 0;
+};
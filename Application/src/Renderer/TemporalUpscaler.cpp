@@ -0,0 +1,147 @@
+#include "PCH.h"
+#include "TemporalUpscaler.h"
+
+#include "glm/gtc/matrix_transform.hpp"
+
+#include "Core/Application.h"
+
+TemporalUpscaler::TemporalUpscaler()
+{
+	m_temporalUpscalingShader = createUnique<Shader>(std::initializer_list<std::string>
+	{
+		"Assets/Shaders/PBRPostProcessing.glsl.vert",
+		"Assets/Shaders/TemporalUpscaling.glsl.frag"
+	});
+
+	initialiseHistoryFramebuffers();
+	initialiseQuadBuffers();
+}
+
+glm::mat4 TemporalUpscaler::getJitteredProjectionMatrix(const glm::mat4& projectionMatrix, uint32_t renderWidth, uint32_t renderHeight) const
+{
+	// Translating after the projection moves everything by the same amount on screen, whatever the type of projection
+	glm::vec2 jitter = getJitter();
+	glm::vec3 NDCOffset = glm::vec3(2.0f * jitter.x / static_cast<float>(renderWidth), 2.0f * jitter.y / static_cast<float>(renderHeight), 0.0f);
+
+	return glm::translate(glm::mat4(1.0f), NDCOffset) * projectionMatrix;
+}
+
+void TemporalUpscaler::draw(const Framebuffer& input, const glm::mat4& projectionViewMatrix)
+{
+	ASSERT_MESSAGE(input.getSpecification().samples == 1, "Temporal upscaling needs a single sample input");
+
+	// The history is kept from frame to frame, so isn't from the render target pool. Like the pool's targets, it is
+	// only resized once it is next used rather than on every window resize event
+	uint32_t windowWidth = std::max(Application::getWindow().getWidth(), 1u);
+	uint32_t windowHeight = std::max(Application::getWindow().getHeight(), 1u);
+	if (m_historyFramebuffers[0]->getSpecification().width != windowWidth || m_historyFramebuffers[0]->getSpecification().height != windowHeight)
+	{
+		for (Unique<Framebuffer>& historyFramebuffer : m_historyFramebuffers)
+			historyFramebuffer->onWindowResizeEvent(windowWidth, windowHeight);
+
+		m_historyValid = false;
+	}
+
+	const Framebuffer& history = *m_historyFramebuffers[m_currentHistory];
+	m_currentHistory = 1 - m_currentHistory;
+	const Framebuffer& output = *m_historyFramebuffers[m_currentHistory];
+
+	m_quadVertexBuffer->bind();
+	m_quadIndexBuffer->bind();
+
+	output.bind();
+
+	m_temporalUpscalingShader->bind();
+
+	input.bindColorAttachment(0);
+	input.bindDepthAttachment(1);
+	history.bindColorAttachment(2);
+	m_temporalUpscalingShader->setUniformToValue("u_inputTexture", 0);
+	m_temporalUpscalingShader->setUniformToValue("u_depthTexture", 1);
+	m_temporalUpscalingShader->setUniformToValue("u_historyTexture", 2);
+
+	// The texture coordinates are of the output, which is the whole of the history framebuffer
+	m_temporalUpscalingShader->setUniformToValue("u_textureCoordinatesScale", glm::vec2(1.0f));
+	m_temporalUpscalingShader->setUniformToValue("u_renderSize", glm::vec2(static_cast<float>(input.getRenderWidth()), static_cast<float>(input.getRenderHeight())));
+	m_temporalUpscalingShader->setUniformToValue("u_jitter", getJitter());
+	m_temporalUpscalingShader->setUniformToValue("u_historyValid", m_historyValid);
+
+	m_temporalUpscalingShader->setUniformToValue("u_inverseProjectionViewMatrix", glm::inverse(projectionViewMatrix));
+	m_temporalUpscalingShader->setUniformToValue("u_previousProjectionViewMatrix", m_previousProjectionViewMatrix);
+
+	RendererUtilities::drawIndexed(m_quadIndexBuffer->getCount());
+
+	m_previousProjectionViewMatrix = projectionViewMatrix;
+	m_historyValid = true;
+	m_frameIndex++;
+
+	RendererLog::trace("Upscaled ({0}, {1}) to ({2}, {3})", input.getRenderWidth(), input.getRenderHeight(), output.getSpecification().width, output.getSpecification().height);
+}
+
+uint64_t TemporalUpscaler::getMemoryUsage() const
+{
+	return m_historyFramebuffers[0]->getMemoryUsage() + m_historyFramebuffers[1]->getMemoryUsage();
+}
+
+void TemporalUpscaler::initialiseHistoryFramebuffers()
+{
+	// Created part way through, so start at the window's current size rather than the default
+
+	Framebuffer::FramebufferSpecification historyFramebufferSpecification;
+	historyFramebufferSpecification.width = Application::getWindow().getWidth();
+	historyFramebufferSpecification.height = Application::getWindow().getHeight();
+	historyFramebufferSpecification.colorAttachmentFormats = { Framebuffer::ColorAttachmentFormat::RGBA16F };
+	historyFramebufferSpecification.depthAttachmentFormat = Framebuffer::DepthAttachmentFormat::NONE;
+
+	for (Unique<Framebuffer>& historyFramebuffer : m_historyFramebuffers)
+		historyFramebuffer = createUnique<Framebuffer>(historyFramebufferSpecification);
+}
+
+void TemporalUpscaler::initialiseQuadBuffers()
+{
+	static constexpr float quadVertices[] =
+	{
+		-1.0f, -1.0f,  0.0f, 0.0f,
+		 1.0f, -1.0f,  1.0f, 0.0f,
+		 1.0f,  1.0f,  1.0f, 1.0f,
+		-1.0f,  1.0f,  0.0f, 1.0f
+	};
+
+	static constexpr uint32_t quadIndices[6] =
+	{
+		0, 1, 2,
+		0, 2, 3
+	};
+
+	VertexBufferLayout vertexBufferLayout =
+	{
+		{ ShaderDataType::FLOAT2, "a_position" },
+		{ ShaderDataType::FLOAT2, "a_textureCoordinates"},
+	};
+
+	m_quadVertexBuffer = createUnique<VertexBuffer>(static_cast<const void*>(quadVertices), sizeof(quadVertices), vertexBufferLayout);
+	m_quadIndexBuffer = createUnique<IndexBuffer>(quadIndices, 6);
+}
+
+glm::vec2 TemporalUpscaler::getJitter() const
+{
+	// The sequence starts from index 1, as index 0 is 0 in every base
+	uint32_t phase = (m_frameIndex % JITTER_PHASE_COUNT) + 1;
+
+	return glm::vec2(getHaltonSequenceValue(phase, 2), getHaltonSequenceValue(phase, 3)) - 0.5f;
+}
+
+float TemporalUpscaler::getHaltonSequenceValue(uint32_t index, uint32_t base)
+{
+	float value = 0.0f;
+	float fraction = 1.0f;
+
+	while (index > 0)
+	{
+		fraction /= static_cast<float>(base);
+		value += fraction * static_cast<float>(index % base);
+		index /= base;
+	}
+
+	return value;
+}
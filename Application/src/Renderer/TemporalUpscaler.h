@@ -0,0 +1,71 @@
+#pragma once
+#include "PCH.h"
+
+#include <array>
+
+#include "glm/glm.hpp"
+
+#include "Framebuffer.h"
+#include "Shader.h"
+#include "VertexBuffer.h"
+#include "IndexBuffer.h"
+
+/*
+Upscales a scene drawn at a reduced resolution back to the window's size, by accumulating frames over time.
+
+Each frame is drawn with its projection jittered by a different sub-pixel offset (from a Halton sequence), so that
+over several frames the samples cover every window pixel. The samples are blended into a history kept at the window's
+size, which is reprojected with the previous frame's matrices as the camera moves. As the samples also move within
+each pixel, this anti-aliases the scene too, so the scene is drawn single sampled while it is in use.
+*/
+class TemporalUpscaler
+{
+public:
+
+	TemporalUpscaler();
+	~TemporalUpscaler() = default;
+	TemporalUpscaler(const TemporalUpscaler&) = delete;
+
+	// The projection matrix offset by this frame's jitter, for a scene drawn at renderWidth by renderHeight
+	glm::mat4 getJitteredProjectionMatrix(const glm::mat4& projectionMatrix, uint32_t renderWidth, uint32_t renderHeight) const;
+
+	// Accumulates the render size of the input (its first color attachment and depth), drawn with this frame's jitter,
+	// into the history. projectionViewMatrix is the matrix the input was drawn with, without jitter
+	void draw(const Framebuffer& input, const glm::mat4& projectionViewMatrix);
+
+	// The framebuffer the next draw writes the upscaled scene to, at the window's size. It is kept as the following frame's history
+	Framebuffer& getNextOutput() const { return *m_historyFramebuffers[1 - m_currentHistory]; }
+
+	// Bytes used by the history framebuffers
+	uint64_t getMemoryUsage() const;
+
+private:
+
+	void initialiseHistoryFramebuffers();
+	void initialiseQuadBuffers();
+
+	// Offset of this frame's samples from the pixel centres, in pixels
+	glm::vec2 getJitter() const;
+
+	static float getHaltonSequenceValue(uint32_t index, uint32_t base);
+
+private:
+
+	// Frames in the jitter sequence before it repeats
+	static constexpr uint32_t JITTER_PHASE_COUNT = 16;
+
+private:
+
+	Unique<Shader> m_temporalUpscalingShader;
+
+	// The history is read from one and written to the other, swapping each frame
+	std::array<Unique<Framebuffer>, 2> m_historyFramebuffers;
+	uint32_t m_currentHistory = 0;
+	bool m_historyValid = false;
+
+	uint32_t m_frameIndex = 0;
+	glm::mat4 m_previousProjectionViewMatrix = glm::mat4(1.0f);
+
+	Unique<VertexBuffer> m_quadVertexBuffer;
+	Unique<IndexBuffer> m_quadIndexBuffer;
+};
@@ -9,6 +9,16 @@
 #include "stb_image.h"
 #include "glm/glm.hpp"
 
+#include "FrameStatistics.h"
+#include "GLStateCache.h"
+
+// Alphas at or below the low threshold count as transparent, and at or above the high threshold as opaque
+static constexpr uint8_t TRANSPARENT_ALPHA_THRESHOLD = 8;
+static constexpr uint8_t OPAQUE_ALPHA_THRESHOLD = 247;
+// Fraction of pixels with an alpha between the thresholds for a texture to be translucent rather
+// than alpha tested - filtering leaves some intermediate alphas around the edges of cut-outs
+static constexpr float TRANSLUCENT_PIXEL_FRACTION = 0.1f;
+
 Texture::Texture(const TextureSpecification& specification)
 	: m_specification(specification)
 {
@@ -18,11 +28,11 @@ Texture::Texture(const TextureSpecification& specification)
 		setUpTexture(imageData);
 		freeImageData(imageData);
 
-		Log::info("Created texture {0} with RendererID {1}", m_specification.filePath, m_rendererID);
+		AssetLog::info("Created texture {0} with RendererID {1}", m_specification.filePath, m_rendererID);
 	}
 	catch (const TextureCreationException& e)
 	{
-		Log::error(e.what());
+		AssetLog::error(e.what());
 	}
 }
 
@@ -35,21 +45,21 @@ Texture::Texture(void* imageData, uint32_t width, uint32_t height, uint32_t chan
 	m_channels = channels;
 
 	setUpTexture(imageData);
-	Log::info("Created texture {0} with RendererID {1}", m_specification.filePath, m_rendererID);
+	AssetLog::info("Created texture {0} with RendererID {1}", m_specification.filePath, m_rendererID);
 }
 
 Texture::~Texture()
 {
-	glDeleteTextures(1, &m_rendererID);
+	GLStateCache::deleteTexture(m_rendererID);
 
-	Log::info("Deleted texture {0} with RendererID {1}", m_specification.filePath, m_rendererID);
+	AssetLog::info("Deleted texture {0} with RendererID {1}", m_specification.filePath, m_rendererID);
 }
 
 void Texture::bind(uint32_t textureSlot) const
 {
-	glBindTextureUnit(textureSlot, m_rendererID);
+	GLStateCache::bindTextureUnit(textureSlot, m_rendererID);
 
-	Log::trace("Bound texture {0} with RendererID {1}, to texture slot {2}", m_specification.filePath, m_rendererID, textureSlot);
+	RendererLog::trace("Bound texture {0} with RendererID {1}, to texture slot {2}", m_specification.filePath, m_rendererID, textureSlot);
 }
 
 void* Texture::loadImageData()
@@ -67,7 +77,7 @@ void* Texture::loadImageData()
 	m_height = static_cast<uint32_t>(height);
 	m_channels = static_cast<uint32_t>(channels);
 
-	Log::trace("Loaded image data from {0}", m_specification.filePath);
+	AssetLog::trace("Loaded image data from {0}", m_specification.filePath);
 
 	return imageData;
 }
@@ -81,10 +91,13 @@ void Texture::setUpTexture(void* imageData)
 	const auto [internalFormat, sizedInternalFormat] = getOpenGLInternalFormats();
 	glTextureStorage2D(m_rendererID, mipMapLevels, sizedInternalFormat, m_width, m_height);
 	glTextureSubImage2D(m_rendererID, 0, 0, 0, m_width, m_height, internalFormat, GL_UNSIGNED_BYTE, imageData);
+	FrameStatistics::recordUpload(static_cast<uint64_t>(m_width) * m_height * m_channels);
 
 	glGenerateTextureMipmap(m_rendererID);
 
 	setUpTextureProperties();
+
+	calculateAlphaUsage(imageData);
 }
 
 void Texture::freeImageData(void* imageData) const
@@ -92,6 +105,35 @@ void Texture::freeImageData(void* imageData) const
 	stbi_image_free(imageData);
 }
 
+void Texture::calculateAlphaUsage(const void* imageData)
+{
+	m_alphaUsage = AlphaUsage::NONE;
+
+	if (m_channels != 4)
+		return;
+
+	const uint8_t* pixels = static_cast<const uint8_t*>(imageData);
+	uint64_t pixelCount = static_cast<uint64_t>(m_width) * static_cast<uint64_t>(m_height);
+
+	uint64_t transparentPixelCount = 0;
+	uint64_t translucentPixelCount = 0;
+
+	for (uint64_t i = 0; i < pixelCount; i++)
+	{
+		uint8_t alpha = pixels[i * 4 + 3];
+
+		if (alpha <= TRANSPARENT_ALPHA_THRESHOLD)
+			transparentPixelCount++;
+		else if (alpha < OPAQUE_ALPHA_THRESHOLD)
+			translucentPixelCount++;
+	}
+
+	if (static_cast<float>(translucentPixelCount) > TRANSLUCENT_PIXEL_FRACTION * static_cast<float>(pixelCount))
+		m_alphaUsage = AlphaUsage::TRANSLUCENT;
+	else if (transparentPixelCount > 0 || translucentPixelCount > 0)
+		m_alphaUsage = AlphaUsage::BINARY;
+}
+
 std::tuple<GLenum, GLenum> Texture::getOpenGLInternalFormats() const
 {
 	switch (m_channels)
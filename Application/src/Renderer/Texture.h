@@ -36,6 +36,17 @@ public:
 		NEAREST
 	};
 
+	// How the alpha channel of the texture's image is used, found from its pixels when the texture is created
+	enum class AlphaUsage
+	{
+		// No alpha channel, or every pixel is opaque
+		NONE = 0,
+		// Pixels are (almost all) either opaque or fully transparent, so can be alpha tested
+		BINARY,
+		// Many pixels are partly transparent, so need blending
+		TRANSLUCENT
+	};
+
 	struct TextureSpecification
 	{
 		std::string filePath;
@@ -57,6 +68,7 @@ public:
 
 	uint32_t getWidth() const { return m_width; }
 	uint32_t getHeight() const { return m_height; }
+	AlphaUsage getAlphaUsage() const { return m_alphaUsage; }
 
 	const TextureSpecification& getTextureSpecification() const { return m_specification; }
 
@@ -66,6 +78,8 @@ private:
 	void setUpTexture(void* imageData);
 	void freeImageData(void* imageData) const;
 
+	void calculateAlphaUsage(const void* imageData);
+
 	std::tuple<GLenum, GLenum> getOpenGLInternalFormats() const;
 
 	void setUpTextureProperties();
@@ -83,4 +97,5 @@ private:
 	uint32_t m_width, m_height;
 	uint32_t m_channels;
 	TextureSpecification m_specification;
+	AlphaUsage m_alphaUsage = AlphaUsage::NONE;
 };
@@ -0,0 +1,84 @@
+#include "PCH.h"
+#include "VertexArray.h"
+
+#include "glad/glad.h"
+
+#include "GLStateCache.h"
+
+// All attributes are read from the one vertex buffer, attached at this binding point
+static constexpr uint32_t VERTEX_BUFFER_BINDING_POINT = 0;
+
+std::map<VertexArray::LayoutKey, Unique<VertexArray>> VertexArray::s_vertexArrays;
+
+VertexArray::VertexArray(const VertexBufferLayout& vertexBufferLayout)
+	: m_stride(vertexBufferLayout.getStride())
+{
+	glCreateVertexArrays(1, &m_rendererID);
+
+	uint32_t currentOffset = 0;
+	uint32_t currentIndex = 0;
+
+	for (const VertexBufferAttributeSpecification& attribute : vertexBufferLayout.m_attributes)
+	{
+		GLenum openGLBaseType = convertShaderDataTypeToOpenGLBaseType(attribute.m_dataType);
+
+		if (attribute.isIntType())
+			glVertexArrayAttribIFormat(m_rendererID, currentIndex, attribute.m_componentCount, openGLBaseType, currentOffset);
+		else
+			glVertexArrayAttribFormat(m_rendererID, currentIndex, attribute.m_componentCount, openGLBaseType, attribute.m_normalise, currentOffset);
+
+		glVertexArrayAttribBinding(m_rendererID, currentIndex, VERTEX_BUFFER_BINDING_POINT);
+		glEnableVertexArrayAttrib(m_rendererID, currentIndex);
+
+		currentIndex++;
+		currentOffset += static_cast<uint32_t>(attribute.m_size);
+	}
+
+	RendererLog::info("Created vertex array {0} with {1} attributes", m_rendererID, currentIndex);
+}
+
+VertexArray::~VertexArray()
+{
+	GLStateCache::deleteVertexArray(m_rendererID);
+
+	RendererLog::info("Deleted vertex array {0}", m_rendererID);
+}
+
+void VertexArray::bind() const
+{
+	GLStateCache::bindVertexArray(m_rendererID);
+
+	RendererLog::trace("Bound vertex array {0}", m_rendererID);
+}
+
+void VertexArray::setVertexBuffer(RendererID vertexBuffer) const
+{
+	GLStateCache::setVertexArrayVertexBuffer(m_rendererID, VERTEX_BUFFER_BINDING_POINT, vertexBuffer, m_stride);
+}
+
+const VertexArray& VertexArray::getVertexArray(const VertexBufferLayout& vertexBufferLayout)
+{
+	LayoutKey layoutKey = createLayoutKey(vertexBufferLayout);
+
+	auto it = s_vertexArrays.find(layoutKey);
+	if (it == s_vertexArrays.end())
+		it = s_vertexArrays.emplace(std::move(layoutKey), createUnique<VertexArray>(vertexBufferLayout)).first;
+
+	return *it->second;
+}
+
+void VertexArray::clearCache()
+{
+	s_vertexArrays.clear();
+}
+
+VertexArray::LayoutKey VertexArray::createLayoutKey(const VertexBufferLayout& vertexBufferLayout)
+{
+	LayoutKey layoutKey;
+	layoutKey.reserve(vertexBufferLayout.m_attributes.size());
+
+	for (const VertexBufferAttributeSpecification& attribute : vertexBufferLayout.m_attributes)
+		layoutKey.emplace_back(attribute.m_dataType, attribute.m_normalise);
+
+	return layoutKey;
+}
@@ -0,0 +1,50 @@
+#pragma once
+#include "PCH.h"
+
+#include <map>
+
+#include "VertexBufferLayout.h"
+
+#include "RendererUtilities.h"
+
+/*
+A Vertex Array Object (VAO) whose attribute formats are specified once, from a vertex buffer layout.
+
+The attributes all read from a single vertex buffer binding point, so switching between vertex buffers
+with the same layout only changes which buffer is attached to it (glVertexArrayVertexBuffer), rather
+than specifying every attribute again.
+
+VAOs are shared between all layouts with the same attributes and are created the first time a layout is used.
+*/
+class VertexArray
+{
+public:
+
+	VertexArray() = delete;
+	VertexArray(const VertexBufferLayout& vertexBufferLayout);
+	~VertexArray();
+	VertexArray(const VertexArray&) = delete;
+
+	void bind() const;
+
+	// Attaches a buffer to the vertex buffer binding point of the VAO
+	void setVertexBuffer(RendererID vertexBuffer) const;
+
+	// Returns the VAO for a layout, creating it if this is the first time the layout has been used
+	static const VertexArray& getVertexArray(const VertexBufferLayout& vertexBufferLayout);
+	static void clearCache();
+
+private:
+
+	// Describes the attributes of a layout, so that layouts with the same attributes share a VAO
+	using LayoutKey = std::vector<std::pair<ShaderDataType, bool>>;
+
+	static LayoutKey createLayoutKey(const VertexBufferLayout& vertexBufferLayout);
+
+private:
+
+	RendererID m_rendererID;
+	uint32_t m_stride;
+
+	static std::map<LayoutKey, Unique<VertexArray>> s_vertexArrays;
+};
@@ -4,29 +4,67 @@
 #include "glad/glad.h"
 
 #include "RendererUtilities.h"
+#include "FrameStatistics.h"
+#include "GLStateCache.h"
 
 VertexBuffer::VertexBuffer(const void* data, size_t size, const VertexBufferLayout& vertexBufferLayout)
-	: m_vertexBufferLayout(vertexBufferLayout)
+	: m_size(size), m_vertexBufferLayout(vertexBufferLayout), m_vertexArray(&VertexArray::getVertexArray(vertexBufferLayout))
 {
 	glCreateBuffers(1, &m_rendererID);
 
 	// Just specifying static access frequency for all buffers at the moment
 	glNamedBufferData(m_rendererID, size, data, GL_STATIC_DRAW);
+	if (data)
+		FrameStatistics::recordUpload(size);
 
-	Log::info("Created vertex buffer {0}", m_rendererID);
+	RendererLog::info("Created vertex buffer {0}", m_rendererID);
+}
+
+VertexBuffer::VertexBuffer(size_t size, const VertexBufferLayout& vertexBufferLayout)
+	: m_size(size), m_vertexBufferLayout(vertexBufferLayout), m_vertexArray(&VertexArray::getVertexArray(vertexBufferLayout))
+{
+	glCreateBuffers(1, &m_rendererID);
+
+	glNamedBufferData(m_rendererID, size, nullptr, GL_DYNAMIC_DRAW);
+
+	RendererLog::info("Created empty vertex buffer {0} of size {1}", m_rendererID, size);
 }
 
 VertexBuffer::~VertexBuffer()
 {
-	glDeleteBuffers(1, &m_rendererID);
+	GLStateCache::deleteBuffer(m_rendererID);
 
-	Log::info("Deleted vertex buffer {0}", m_rendererID);
+	RendererLog::info("Deleted vertex buffer {0}", m_rendererID);
 }
 
 void VertexBuffer::bind() const
 {
-	glBindBuffer(GL_ARRAY_BUFFER, m_rendererID);
-	m_vertexBufferLayout.bind();
+	m_vertexArray->bind();
+	m_vertexArray->setVertexBuffer(m_rendererID);
 	
-	Log::trace("Bound vertex buffer {0}", m_rendererID);
+	RendererLog::trace("Bound vertex buffer {0}", m_rendererID);
+}
+
+void VertexBuffer::setData(const void* data, size_t size, size_t offset)
+{
+	ASSERT_MESSAGE(offset + size <= m_size, "Data does not fit within the vertex buffer");
+
+	glNamedBufferSubData(m_rendererID, offset, size, data);
+	FrameStatistics::recordUpload(size);
+
+	RendererLog::trace("Set {0} bytes of vertex buffer {1}, at offset {2}", size, m_rendererID, offset);
+}
+
+void VertexBuffer::resize(size_t size)
+{
+	RendererID previousRendererID = m_rendererID;
+
+	glCreateBuffers(1, &m_rendererID);
+	glNamedBufferData(m_rendererID, size, nullptr, GL_DYNAMIC_DRAW);
+	glCopyNamedBufferSubData(previousRendererID, m_rendererID, 0, 0, std::min(size, m_size));
+	GLStateCache::deleteBuffer(previousRendererID);
+
+	RendererLog::info("Resized vertex buffer {0} from {1} to {2} bytes (now vertex buffer {3})", previousRendererID, m_size, size, m_rendererID);
+
+	m_size = size;
 }
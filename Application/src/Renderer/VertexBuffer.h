@@ -2,6 +2,7 @@
 #include "PCH.h"
 
 #include "VertexBufferLayout.h"
+#include "VertexArray.h"
 
 #include "RendererUtilities.h"
 
@@ -11,13 +12,26 @@ public:
 
 	VertexBuffer() = delete;
 	VertexBuffer(const void* data, size_t size, const VertexBufferLayout& vertexBufferLayout);
+	// Creates an empty buffer whose contents are filled in later using setData
+	VertexBuffer(size_t size, const VertexBufferLayout& vertexBufferLayout);
 	~VertexBuffer();
 	VertexBuffer(const VertexBuffer&) = delete;
 
 	void bind() const;
 
+	void setData(const void* data, size_t size, size_t offset = 0);
+
+	// Reallocates the buffer with a new size, preserving as much of the existing contents as will fit
+	void resize(size_t size);
+
+	size_t getSize() const { return m_size; }
+	const VertexBufferLayout& getVertexBufferLayout() const { return m_vertexBufferLayout; }
+
 private:
 
 	RendererID m_rendererID;
+	size_t m_size = 0;
 	VertexBufferLayout m_vertexBufferLayout;
+	// Shared with all other vertex buffers with the same layout
+	const VertexArray* m_vertexArray;
 };
\ No newline at end of file
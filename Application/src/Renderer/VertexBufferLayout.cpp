@@ -10,48 +10,6 @@ VertexBufferLayout::VertexBufferLayout(const std::initializer_list<VertexBufferA
 	}));
 }
 
-void VertexBufferLayout::bind() const
-{
-	uint32_t currentOffset = 0;
-	uint32_t currentIndex = 0;
-
-	for (VertexBufferAttributeSpecification attribute : m_attributes)
-	{
-		GLenum openGLBaseType = convertShaderDataTypeToOpenGLBaseType(attribute.m_dataType);
-
-		if (attribute.isIntType())
-		{
-			glVertexAttribIPointer
-			(
-				currentIndex,
-				attribute.m_componentCount,
-				openGLBaseType,
-				m_stride,
-				reinterpret_cast<void*>(static_cast<uint64_t>((currentOffset)))
-			);
-		}
-		else
-		{
-			glVertexAttribPointer
-			(
-				currentIndex,
-				attribute.m_componentCount,
-				openGLBaseType,
-				attribute.m_normalise,
-				m_stride,
-				reinterpret_cast<void*>(static_cast<uint64_t>((currentOffset)))
-			);
-		}
-
-		glEnableVertexAttribArray(currentIndex);
-
-		currentIndex++;
-		currentOffset += static_cast<uint32_t>(attribute.m_size);
-	}
-
-	Log::trace("Specified Vertex Buffer Layout to OpenGL");
-}
-
 bool VertexBufferAttributeSpecification::isIntType() const
 {
 	switch (m_dataType)
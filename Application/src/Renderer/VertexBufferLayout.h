@@ -29,6 +29,7 @@ private:
 	size_t m_size;
 
 	friend class VertexBufferLayout;
+	friend class VertexArray;
 };
 
 class VertexBufferLayout
@@ -37,14 +38,12 @@ public:
 
 	VertexBufferLayout(const std::initializer_list<VertexBufferAttributeSpecification>& attributes);
 
-private:
-
-	void bind() const;
+	uint32_t getStride() const { return m_stride; }
 
 private:
 
 	std::vector<VertexBufferAttributeSpecification> m_attributes;
 	uint32_t m_stride = 0;
 
-	friend class VertexBuffer;
+	friend class VertexArray;
 };
\ No newline at end of file
@@ -21,6 +21,9 @@ public:
 
 	glm::vec3 getCameraPosition() const override;
 
+	float getNearClip() const override { return m_nearClip; }
+	float getFarClip() const override { return m_farClip; }
+
 private:
 
 	void panCamera(const glm::vec2& mousePositionDelta);
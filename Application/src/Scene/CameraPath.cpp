@@ -0,0 +1,59 @@
+#include "PCH.h"
+#include "CameraPath.h"
+
+#include "glm/gtc/constants.hpp"
+
+CameraPath CameraPath::loadFromFile(const std::filesystem::path& filePath)
+{
+	std::ifstream inputFileStream(filePath);
+	if (!inputFileStream)
+		throw CameraPathCreationException("Could not open camera path " + filePath.string());
+
+	CameraPath cameraPath;
+
+	std::string line;
+	uint32_t lineNumber = 0;
+	while (std::getline(inputFileStream, line))
+	{
+		lineNumber++;
+
+		size_t firstCharacter = line.find_first_not_of(" \t\r");
+		if (firstCharacter == std::string::npos || line[firstCharacter] == '#')
+			continue;
+
+		CameraPose pose;
+		std::istringstream lineStream(line);
+		lineStream >> pose.position.x >> pose.position.y >> pose.position.z >> pose.focusPoint.x >> pose.focusPoint.y >> pose.focusPoint.z;
+
+		if (!lineStream)
+			throw CameraPathCreationException("Line " + std::to_string(lineNumber) + " of camera path " + filePath.string() + " is not a camera pose");
+
+		// The field of view is optional
+		float verticalFieldOfView;
+		if (lineStream >> verticalFieldOfView)
+			pose.verticalFieldOfView = verticalFieldOfView;
+
+		cameraPath.m_poses.push_back(pose);
+	}
+
+	if (cameraPath.m_poses.empty())
+		throw CameraPathCreationException("Camera path " + filePath.string() + " has no camera poses");
+
+	AssetLog::info("Loaded {0} camera poses from {1}", cameraPath.m_poses.size(), filePath.string());
+
+	return cameraPath;
+}
+
+CameraPath CameraPath::createTurntable(uint32_t frameCount, float radius, float height)
+{
+	CameraPath cameraPath;
+	cameraPath.m_poses.resize(frameCount);
+
+	for (uint32_t frameIndex = 0; frameIndex < frameCount; frameIndex++)
+	{
+		float angle = glm::two_pi<float>() * static_cast<float>(frameIndex) / static_cast<float>(frameCount);
+		cameraPath.m_poses[frameIndex].position = { radius * glm::sin(angle), height, radius * glm::cos(angle) };
+	}
+
+	return cameraPath;
+}
@@ -0,0 +1,49 @@
+#pragma once
+#include "PCH.h"
+
+#include "glm/glm.hpp"
+
+/*
+The camera poses of a sequence of frames, one per frame. Loaded from a text file with one pose per line:
+
+	positionX positionY positionZ focusPointX focusPointY focusPointZ [verticalFieldOfViewInDegrees]
+
+Blank lines, and lines starting with #, are skipped. Alternatively a turntable path circles the origin.
+*/
+class CameraPath
+{
+public:
+
+	struct CameraPose
+	{
+		glm::vec3 position = { 0.0f, 0.0f, 5.0f };
+		glm::vec3 focusPoint = { 0.0f, 0.0f, 0.0f };
+		float verticalFieldOfView = 45.0f;
+	};
+
+	struct CameraPathCreationException : public std::exception
+	{
+		std::string errorMessage;
+
+		CameraPathCreationException(const std::string errorMessage)
+			: errorMessage("CameraPathCreationException Occured: " + errorMessage) {}
+
+		const char* what() const noexcept override
+		{
+			return errorMessage.c_str();
+		}
+	};
+
+public:
+
+	static CameraPath loadFromFile(const std::filesystem::path& filePath);
+	// Circles the origin once over the frames, at the radius and height, looking at the origin
+	static CameraPath createTurntable(uint32_t frameCount, float radius = 5.0f, float height = 1.0f);
+
+	uint32_t getFrameCount() const { return static_cast<uint32_t>(m_poses.size()); }
+	const CameraPose& getPose(uint32_t frameIndex) const { return m_poses[frameIndex]; }
+
+private:
+
+	std::vector<CameraPose> m_poses;
+};
@@ -3,6 +3,7 @@
 
 #include "assimp/Importer.hpp"
 #include "assimp/postprocess.h"
+#include "assimp/GltfMaterial.h"
 
 static const uint32_t ASSIMP_PREPROCESS_FLAGS =
 	aiPostProcessSteps::aiProcess_CalcTangentSpace         | // If not provided by the model, calculate tangent and bitangent vectors for each vertex
@@ -39,20 +40,20 @@ Model::Model(const std::string& filePath, MaterialModel materialModel)
 	if (m_assimpScene->mFlags & AI_SCENE_FLAGS_VALIDATION_WARNING)
 		throw ModelCreationException("Model could not be validated: " + std::string(importer.GetErrorString()));
 
-	Log::trace("Successfully loaded source model file {0}", m_modelIdentifier);
+	AssetLog::trace("Successfully loaded source model file {0}", m_modelIdentifier);
 
 	m_meshes.reserve(m_assimpScene->mNumMeshes);
 
 	processMeshes();
 	processModelGraph();
-	createBuffers();
+	uploadGeometry();
 
 	processMaterials(materialModel);
 
-	Log::info("Created model {0}", m_modelIdentifier);
-	Log::trace("\tVertices:  {0}", m_vertices.size());
-	Log::trace("\tIndices:   {0}", m_triangleIndices.size() * 3u);
-	Log::trace("\tMaterials: {0}", m_materials.size());
+	AssetLog::info("Created model {0}", m_modelIdentifier);
+	AssetLog::trace("\tVertices:  {0}", m_vertices.size());
+	AssetLog::trace("\tIndices:   {0}", m_triangleIndices.size() * 3u);
+	AssetLog::trace("\tMaterials: {0}", m_materials.size());
 }
 
 Model::Model(const std::string modelIdentifier, const std::vector<Vertex>& vertices, const std::vector<TriangleIndex>& triangleIndices, const Reference<Material>& material)
@@ -60,12 +61,41 @@ Model::Model(const std::string modelIdentifier, const std::vector<Vertex>& verti
 	  m_vertices(vertices), m_triangleIndices(triangleIndices), m_assimpScene(nullptr)
 {
 	createOneMeshForAllGeometry();
-	createBuffers();
+	uploadGeometry();
 
 	m_materials.push_back(material);
 	m_materialToMeshMapping[0] = { 0 };
 }
 
+Model::~Model()
+{
+	GeometryArena::free(m_geometryAllocation);
+}
+
+const VertexBufferLayout& Model::getVertexBufferLayout()
+{
+	static const VertexBufferLayout vertexBufferLayout =
+	{
+		{ ShaderDataType::FLOAT3, "a_position" },
+		{ ShaderDataType::FLOAT3, "a_normal" },
+		{ ShaderDataType::FLOAT2, "a_textureCoordinates"},
+		{ ShaderDataType::FLOAT3, "a_tangent"},
+		{ ShaderDataType::FLOAT3, "a_bitangent"}
+	};
+
+	return vertexBufferLayout;
+}
+
+const VertexBufferLayout& Model::getPositionVertexBufferLayout()
+{
+	static const VertexBufferLayout positionVertexBufferLayout =
+	{
+		{ ShaderDataType::FLOAT3, "a_position" }
+	};
+
+	return positionVertexBufferLayout;
+}
+
 void Model::processMeshes()
 {
 	for (uint32_t i = 0; i < m_assimpScene->mNumMeshes; i++)
@@ -84,6 +114,7 @@ void Model::processMeshes()
 		setMaterialToMeshBinding(materialIndex, static_cast<uint32_t>(m_meshes.size()));
 
 		processMeshGeometry(assimpMesh);
+		calculateMeshBounds(mesh);
 
 		m_meshes.push_back(mesh);
 	}
@@ -96,19 +127,19 @@ void Model::processModelGraph()
 	processNode(rootNode, rootTransform);
 }
 
-void Model::createBuffers()
+void Model::uploadGeometry()
 {
-	VertexBufferLayout vertexBufferLayout =
-	{
-		{ ShaderDataType::FLOAT3, "a_position" },
-		{ ShaderDataType::FLOAT3, "a_normal" },
-		{ ShaderDataType::FLOAT2, "a_textureCoordinates"},
-		{ ShaderDataType::FLOAT3, "a_tangent"},
-		{ ShaderDataType::FLOAT3, "a_bitangent"}
-	};
+	// Rather than owning its own buffers, the model's geometry is placed in the scene-wide geometry arena
+	// so that all models can be drawn without rebinding buffers
 
-	m_vertexBuffer = createReference<VertexBuffer>(static_cast<void*>(m_vertices.data()), m_vertices.size() * sizeof(Vertex), vertexBufferLayout);
-	m_indexBuffer = createReference<IndexBuffer>(reinterpret_cast<uint32_t*>(m_triangleIndices.data()), static_cast<uint32_t>(m_triangleIndices.size()) * 3u);
+	// Depth-only passes only need positions, so these are split out into their own stream (12 bytes per vertex rather than 56)
+	std::vector<glm::vec3> positions(m_vertices.size());
+	std::transform(m_vertices.begin(), m_vertices.end(), positions.begin(), [](const Vertex& vertex) { return vertex.position; });
+
+	m_geometryAllocation = GeometryArena::allocate(
+		static_cast<const void*>(m_vertices.data()), positions.data(), static_cast<uint32_t>(m_vertices.size()),
+		reinterpret_cast<const uint32_t*>(m_triangleIndices.data()), static_cast<uint32_t>(m_triangleIndices.size()) * 3u
+	);
 }
 
 void Model::createOneMeshForAllGeometry()
@@ -120,6 +151,7 @@ void Model::createOneMeshForAllGeometry()
 	mesh.baseVertex = 0;
 	mesh.baseIndex = 0;
 	mesh.name = m_modelIdentifier;
+	calculateMeshBounds(mesh);
 
 	m_meshes.push_back(mesh);
 }
@@ -132,6 +164,22 @@ void Model::setMaterialToMeshBinding(uint32_t materialIndex, uint32_t meshIndex)
 		m_materialToMeshMapping[materialIndex] = std::vector<uint32_t>({ meshIndex });
 }
 
+void Model::calculateMeshBounds(Mesh& mesh) const
+{
+	mesh.boundsMin = glm::vec3(std::numeric_limits<float>::max());
+	mesh.boundsMax = glm::vec3(std::numeric_limits<float>::lowest());
+
+	for (uint32_t i = mesh.baseVertex; i < mesh.baseVertex + mesh.vertexCount; i++)
+	{
+		mesh.boundsMin = glm::min(mesh.boundsMin, m_vertices[i].position);
+		mesh.boundsMax = glm::max(mesh.boundsMax, m_vertices[i].position);
+	}
+
+	// Keep empty meshes well formed, so that culling them doesn't produce NaNs
+	if (!mesh.vertexCount)
+		mesh.boundsMin = mesh.boundsMax = glm::vec3(0.0f);
+}
+
 void Model::processMeshGeometry(const aiMesh* assimpMesh)
 {
 	for (uint32_t i = 0; i < assimpMesh->mNumVertices; i++)
@@ -217,19 +265,21 @@ void Model::processBlinnPhongMaterials()
 
 		processBlinnPhongMaterialTextures(assimpMaterial, material);
 		processBlinnPhongMaterialConstants(assimpMaterial, material);
+		processMaterialAlphaMode(assimpMaterial, *material, material->diffuseColor.a, material->diffuseMap);
 
 		m_materials.push_back(material);
 
-		Log::info("Loaded Blinn-Phong material {0} from model {1}", materialName, m_modelIdentifier);
-		Log::trace("\tDiffuse color:    ({0}, {1}, {2}, {3})", material->diffuseColor.r, material->diffuseColor.g, material->diffuseColor.b, material->diffuseColor.a);
-		Log::trace("\tSpecular color:   ({0}, {1}, {2})", material->specularColor.r, material->specularColor.g, material->specularColor.b);
-		Log::trace("\tShininess:        {0}", material->shininess);
+		AssetLog::info("Loaded Blinn-Phong material {0} from model {1}", materialName, m_modelIdentifier);
+		AssetLog::trace("\tDiffuse color:    ({0}, {1}, {2}, {3})", material->diffuseColor.r, material->diffuseColor.g, material->diffuseColor.b, material->diffuseColor.a);
+		AssetLog::trace("\tSpecular color:   ({0}, {1}, {2})", material->specularColor.r, material->specularColor.g, material->specularColor.b);
+		AssetLog::trace("\tShininess:        {0}", material->shininess);
+		AssetLog::trace("\tAlpha mode:       {0}", Material::getAlphaModeName(material->alphaMode));
 		if (material->diffuseMap)
-			Log::trace("\tDiffuse map:      {0}", material->diffuseMap->getTextureSpecification().filePath);
+			AssetLog::trace("\tDiffuse map:      {0}", material->diffuseMap->getTextureSpecification().filePath);
 		if (material->specularMap)
-			Log::trace("\tSpecular map:     {0}", material->specularMap->getTextureSpecification().filePath);
+			AssetLog::trace("\tSpecular map:     {0}", material->specularMap->getTextureSpecification().filePath);
 		if (material->normalMap)
-			Log::trace("\tNormal map:       {0}", material->normalMap->getTextureSpecification().filePath);
+			AssetLog::trace("\tNormal map:       {0}", material->normalMap->getTextureSpecification().filePath);
 	}
 }
 
@@ -245,21 +295,23 @@ void Model::processPBRMaterials()
 
 		processPBRMaterialTextures(assimpMaterial, material);
 		processPBRMaterialConstants(assimpMaterial, material);
+		processMaterialAlphaMode(assimpMaterial, *material, material->baseColor.a, material->baseColorMap);
 
 		m_materials.push_back(material);
 
-		Log::info("Loaded PBR material {0} from model {1}", materialName, m_modelIdentifier);
-		Log::trace("\tBase color:       ({0}, {1}, {2}, {3})", material->baseColor.r, material->baseColor.g, material->baseColor.b, material->baseColor.a);
-		Log::trace("\tRoughness:        {0}", material->roughness);
-		Log::trace("\tMetalness:        {0}", material->metalness);
+		AssetLog::info("Loaded PBR material {0} from model {1}", materialName, m_modelIdentifier);
+		AssetLog::trace("\tBase color:       ({0}, {1}, {2}, {3})", material->baseColor.r, material->baseColor.g, material->baseColor.b, material->baseColor.a);
+		AssetLog::trace("\tRoughness:        {0}", material->roughness);
+		AssetLog::trace("\tMetalness:        {0}", material->metalness);
+		AssetLog::trace("\tAlpha mode:       {0}", Material::getAlphaModeName(material->alphaMode));
 		if (material->baseColorMap)
-			Log::trace("\tBase color map:   {0}", material->baseColorMap->getTextureSpecification().filePath);
+			AssetLog::trace("\tBase color map:   {0}", material->baseColorMap->getTextureSpecification().filePath);
 		if (material->roughnessMap)
-			Log::trace("\tRoughness map:    {0}", material->roughnessMap->getTextureSpecification().filePath);
+			AssetLog::trace("\tRoughness map:    {0}", material->roughnessMap->getTextureSpecification().filePath);
 		if (material->metalnessMap)
-			Log::trace("\tMetalness map:    {0}", material->metalnessMap->getTextureSpecification().filePath);
+			AssetLog::trace("\tMetalness map:    {0}", material->metalnessMap->getTextureSpecification().filePath);
 		if (material->normalMap)
-			Log::trace("\tNormal map:       {0}", material->normalMap->getTextureSpecification().filePath);
+			AssetLog::trace("\tNormal map:       {0}", material->normalMap->getTextureSpecification().filePath);
 	}
 }
 
@@ -375,6 +427,43 @@ void Model::processPBRMaterialConstants(const aiMaterial* assimpMaterial, Refere
 	}
 }
 
+void Model::processMaterialAlphaMode(const aiMaterial* assimpMaterial, Material& material, float colorAlpha, const Reference<const Texture>& colorMap)
+{
+	// glTF files state the alpha mode, so it only needs to be worked out for other formats
+
+	float assimpAlphaCutoff;
+	if (assimpMaterial->Get(AI_MATKEY_GLTF_ALPHACUTOFF, assimpAlphaCutoff) == aiReturn_SUCCESS)
+		material.alphaCutoff = assimpAlphaCutoff;
+
+	aiString assimpAlphaMode;
+	if (assimpMaterial->Get(AI_MATKEY_GLTF_ALPHAMODE, assimpAlphaMode) == aiReturn_SUCCESS)
+	{
+		std::string alphaMode = assimpAlphaMode.C_Str();
+
+		if (alphaMode == "MASK")
+			material.alphaMode = Material::AlphaMode::MASK;
+		else if (alphaMode == "BLEND")
+			material.alphaMode = Material::AlphaMode::BLEND;
+		else
+			material.alphaMode = Material::AlphaMode::SOLID;
+
+		return;
+	}
+
+	float assimpOpacity;
+	if (assimpMaterial->Get(AI_MATKEY_OPACITY, assimpOpacity) == aiReturn_SUCCESS && assimpOpacity < 1.0f)
+		colorAlpha *= assimpOpacity;
+
+	Texture::AlphaUsage colorMapAlphaUsage = colorMap ? colorMap->getAlphaUsage() : Texture::AlphaUsage::NONE;
+
+	if (colorAlpha < 1.0f || colorMapAlphaUsage == Texture::AlphaUsage::TRANSLUCENT)
+		material.alphaMode = Material::AlphaMode::BLEND;
+	else if (colorMapAlphaUsage == Texture::AlphaUsage::BINARY)
+		material.alphaMode = Material::AlphaMode::MASK;
+	else
+		material.alphaMode = Material::AlphaMode::SOLID;
+}
+
 Reference<Texture> Model::loadMaterialTexture(const char* textureFilePathRelativeToModel, Texture::TextureSpecification textureSpecification)
 {
 	std::stringstream ss;
@@ -4,8 +4,8 @@
 #include "glm/glm.hpp"
 #include "assimp/scene.h"
 
-#include "Renderer/VertexBuffer.h"
-#include "Renderer/IndexBuffer.h"
+#include "Renderer/VertexBufferLayout.h"
+#include "Renderer/GeometryArena.h"
 #include "Renderer/Material.h"
 #include "Renderer/Texture.h"
 
@@ -49,6 +49,9 @@ public:
 		uint32_t indexCount;
 		uint32_t baseVertex;
 		uint32_t baseIndex;
+		// Axis aligned bounding box of the mesh's vertices, in the mesh's own space (before Mesh::transform)
+		glm::vec3 boundsMin;
+		glm::vec3 boundsMax;
 		std::string name;
 	};
 
@@ -63,6 +66,7 @@ public:
 	Model() = delete;
 	Model(const std::string& filePath, MaterialModel materialModel);
 	Model(const std::string modelIdentifier, const std::vector<Vertex>& vertices, const std::vector<TriangleIndex>& triangleIndices, const Reference<Material>& material);
+	~Model();
 	Model(const Model&) = delete;
 
 	static Reference<Model> create(const std::string& filePath, MaterialModel materialModel) { return createReference<Model>(filePath, materialModel); }
@@ -71,12 +75,21 @@ public:
 
 	const std::vector<Mesh>& getMeshes() { return m_meshes; }
 
-	const Reference<VertexBuffer>& getVertexBuffer() { return m_vertexBuffer; }
-	const Reference<IndexBuffer>& getIndexBuffer() { return m_indexBuffer; }
+	// Location of the model's geometry within the scene-wide geometry arena
+	const GeometryArena::Allocation& getGeometryAllocation() const { return m_geometryAllocation; }
+
+	// Layout of Model::Vertex, which is shared by all models in the geometry arena
+	static const VertexBufferLayout& getVertexBufferLayout();
+	// Layout of the position-only stream split out of Model::Vertex, used by depth-only passes
+	static const VertexBufferLayout& getPositionVertexBufferLayout();
 
 	const std::vector<Reference<Material>>& getMaterials() { return m_materials; }
 	const std::unordered_map<uint32_t, std::vector<uint32_t>>& getMaterialToMeshMapping() { return m_materialToMeshMapping; }
 
+	// The CPU copy of the geometry, kept for the software occlusion culler
+	const std::vector<Vertex>& getVertices() const { return m_vertices; }
+	const std::vector<TriangleIndex>& getTriangleIndices() const { return m_triangleIndices; }
+
 	uint32_t getVertexCount() const { return static_cast<uint32_t>(m_vertices.size()); }
 	uint32_t getTriangleCount() const { return static_cast<uint32_t>(m_triangleIndices.size()); }
 
@@ -84,9 +97,10 @@ private:
 
 	void processMeshes();
 	void processModelGraph();
-	void createBuffers();
+	void uploadGeometry();
 	void createOneMeshForAllGeometry();
 	void setMaterialToMeshBinding(uint32_t materialIndex, uint32_t meshIndex);
+	void calculateMeshBounds(Mesh& mesh) const;
 	void processMeshGeometry(const aiMesh* assimpMesh);
 	void processNode(const aiNode* node, const glm::mat4& transformToModelSpace);
 	void processVertex(const aiMesh* assimpMesh, uint32_t vertexOffset);
@@ -99,6 +113,8 @@ private:
 	void processBlinnPhongMaterialConstants(const aiMaterial* assimpMaterial, Reference<BlinnPhongMaterial>& material);
 	void processPBRMaterialTextures(const aiMaterial* assimpMaterial, Reference<PBRMaterial>& material);
 	void processPBRMaterialConstants(const aiMaterial* assimpMaterial, Reference<PBRMaterial>& material);
+	// Classifies how the material uses alpha, from its color's alpha and the alpha channel of its color map
+	void processMaterialAlphaMode(const aiMaterial* assimpMaterial, Material& material, float colorAlpha, const Reference<const Texture>& colorMap);
 	Reference<Texture> loadMaterialTexture(const char* textureFilePathRelativeToModel, Texture::TextureSpecification textureSpecification = Texture::TextureSpecification());
 
 private:
@@ -112,8 +128,7 @@ private:
 	std::vector<Vertex> m_vertices;
 	std::vector<TriangleIndex> m_triangleIndices;
 
-	Reference<VertexBuffer> m_vertexBuffer;
-	Reference<IndexBuffer> m_indexBuffer;
+	GeometryArena::Allocation m_geometryAllocation;
 
 	std::vector<Reference<Material>> m_materials;
 	std::unordered_map<uint32_t, std::vector<uint32_t>> m_materialToMeshMapping;
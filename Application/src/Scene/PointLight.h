@@ -1,21 +1,37 @@
 #pragma once
 #include "PCH.h"
 
+#include <atomic>
+
 #include "glm/glm.hpp"
 #include "glm/gtc/constants.hpp"
 
 struct PointLight
 {
+	PointLight()
+		: identifier(s_nextIdentifier.fetch_add(1, std::memory_order_relaxed)) {}
 	virtual ~PointLight() = default;
 
+	// A copy of the same type
+	virtual Reference<PointLight> clone() const = 0;
+
+	// Unique to the light, and shared by its clones, so that what is cached for a light outlives a snapshot of its scene
+	uint64_t identifier;
+
 	glm::vec3 worldPosition = { 0.0f, 0.0f, 0.0f };
 	float lightRadius = 10.0f;
+
+private:
+
+	inline static std::atomic<uint64_t> s_nextIdentifier = 0;
 };
 
 struct BlinnPhongPointLight : public PointLight
 {
 	static Reference<BlinnPhongPointLight> create() { return createReference<BlinnPhongPointLight>(); }
 
+	Reference<PointLight> clone() const override { return createReference<BlinnPhongPointLight>(*this); }
+
 	glm::vec3 diffuseComponent = { 1.0f, 1.0f, 1.0f };
 	glm::vec3 specularComponent = { 1.0f, 1.0f, 1.0f };
 };
@@ -24,6 +40,8 @@ struct PBRPointLight : public PointLight
 {
 	static Reference<PBRPointLight> create() { return createReference<PBRPointLight>(); }
 
+	Reference<PointLight> clone() const override { return createReference<PBRPointLight>(*this); }
+
 	glm::vec3 lightColor = { 1.0f, 1.0f, 1.0f };
 	// PI becomes the default luminous intensity in the shader
 	float luminousPower = 4.0f * glm::pi<float>() * glm::pi<float>();
@@ -10,3 +10,41 @@ void Scene::addPointLight(const Reference<PointLight>& pointLight)
 {
 	m_pointLights.push_back(pointLight);
 }
+
+Reference<Scene> Scene::clone() const
+{
+	Reference<Scene> scene = createReference<Scene>();
+	copyContentsTo(*scene);
+
+	return scene;
+}
+
+void Scene::copyContentsTo(Scene& scene) const
+{
+	scene.m_modelsAndTransforms = m_modelsAndTransforms;
+
+	scene.m_pointLights.clear();
+	scene.m_pointLights.reserve(m_pointLights.size());
+	for (const Reference<PointLight>& pointLight : m_pointLights)
+		scene.m_pointLights.push_back(pointLight->clone());
+}
+
+Reference<Scene> BlinnPhongScene::clone() const
+{
+	Reference<BlinnPhongScene> scene = BlinnPhongScene::create();
+	copyContentsTo(*scene);
+
+	return scene;
+}
+
+Reference<Scene> PBRScene::clone() const
+{
+	Reference<PBRScene> scene = PBRScene::create();
+	copyContentsTo(*scene);
+
+	scene->m_exposureLevel = m_exposureLevel;
+	scene->m_environmentMap = m_environmentMap;
+	scene->m_environmentIntensity = m_environmentIntensity;
+
+	return scene;
+}
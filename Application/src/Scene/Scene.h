@@ -5,6 +5,7 @@
 
 #include "PointLight.h"
 #include "Model.h"
+#include "Renderer/EnvironmentMap.h"
 
 class Scene
 {
@@ -19,6 +20,14 @@ public:
 	const std::vector<Reference<PointLight>>& getPointLights() const { return m_pointLights; }
 	const std::vector<std::pair<Reference<Model>, glm::mat4>>& getModelsAndTransforms() const { return m_modelsAndTransforms; }
 
+	// A copy of the same type that later changes to this scene don't affect, so it can be drawn on another thread.
+	// Transforms and point lights are copied, while models are shared, as they aren't changed once created
+	virtual Reference<Scene> clone() const;
+
+protected:
+
+	void copyContentsTo(Scene& scene) const;
+
 private:
 
 	std::vector<std::pair<Reference<Model>, glm::mat4>> m_modelsAndTransforms;
@@ -32,6 +41,8 @@ public:
 	BlinnPhongScene() = default;
 
 	static Reference<BlinnPhongScene> create() { return createReference<BlinnPhongScene>(); }
+
+	Reference<Scene> clone() const override;
 };
 
 class PBRScene : public Scene
@@ -42,10 +53,23 @@ public:
 
 	static Reference<PBRScene> create() { return createReference<PBRScene>(); }
 
+	Reference<Scene> clone() const override;
+
 	float getExposureLevel() const { return m_exposureLevel; }
 	void setExposureLevel(float exposureLevel) { m_exposureLevel = exposureLevel; }
 
+	// Lights the scene with image based lighting. Without one, the scene has a constant ambient term
+	const Reference<EnvironmentMap>& getEnvironmentMap() const { return m_environmentMap; }
+	void setEnvironmentMap(const Reference<EnvironmentMap>& environmentMap) { m_environmentMap = environmentMap; }
+
+	// Scales the environment map's radiance, to balance it against the point lights
+	float getEnvironmentIntensity() const { return m_environmentIntensity; }
+	void setEnvironmentIntensity(float environmentIntensity) { m_environmentIntensity = environmentIntensity; }
+
 private:
 
 	float m_exposureLevel = 1.0f;
+
+	Reference<EnvironmentMap> m_environmentMap;
+	float m_environmentIntensity = 1.0f;
 };
\ No newline at end of file
@@ -0,0 +1,20 @@
+#pragma once
+#include "PCH.h"
+
+#include "Renderer/CameraSnapshot.h"
+#include "Scene.h"
+
+/*
+Everything the render thread needs to draw one frame, taken by the main thread once it has updated the workspace: a
+copy of the scene's transforms, lights and exposure (see Scene::clone), the camera's matrices, and the renderer
+settings changed during the update. Nothing in it is changed after it is handed to the render thread.
+*/
+struct SceneSnapshot
+{
+	Reference<Scene> scene;
+	CameraSnapshot camera;
+
+	// Renderer calls made during the update, which need the OpenGL context, so are made on the render thread before the
+	// frame is drawn
+	std::vector<std::function<void()>> rendererCommands;
+};
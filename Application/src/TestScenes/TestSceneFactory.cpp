@@ -24,3 +24,20 @@ Reference<TestScene> TestSceneFactory::create(TestSceneIdentifier testSceneIdent
 		break;
 	}
 }
+
+bool TestSceneFactory::getTestSceneIdentifier(const std::string& name, TestSceneIdentifier& testSceneIdentifier)
+{
+	static const std::unordered_map<std::string, TestSceneIdentifier> TEST_SCENE_NAMES =
+	{
+		{ "fresnel", TestSceneIdentifier::FRESNEL_SCENE },
+		{ "hdr", TestSceneIdentifier::HDR_SCENE },
+		{ "frame-time", TestSceneIdentifier::FRAME_TIME_SCENE }
+	};
+
+	auto testSceneName = TEST_SCENE_NAMES.find(name);
+	if (testSceneName == TEST_SCENE_NAMES.end())
+		return false;
+
+	testSceneIdentifier = testSceneName->second;
+	return true;
+}
@@ -17,4 +17,7 @@ public:
 public:
 
 	static Reference<TestScene> create(TestSceneIdentifier testSceneIdentifier);
+
+	// Looks a test scene up by its name, as given on the command line: "fresnel", "hdr" or "frame-time"
+	static bool getTestSceneIdentifier(const std::string& name, TestSceneIdentifier& testSceneIdentifier);
 };
\ No newline at end of file